@@ -19,6 +19,7 @@
 #include "db/filename.h"
 #include "db/internal_stats.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
 #include "rocksdb/db.h"
@@ -28,15 +29,92 @@
 #include "rocksdb/table.h"
 #include "table/block_based_table_builder.h"
 #include "table/internal_iterator.h"
+#include "util/compression.h"
 #include "util/file_reader_writer.h"
 #include "util/iostats_context_imp.h"
 #include "util/stop_watch.h"
+#include "util/sync_point.h"
 #include "util/thread_status_util.h"
 
 namespace rocksdb {
 
 class TableFactory;
 
+namespace {
+
+// Samples the keys and values of iter for a compression dictionary, in a
+// single pass over them. Samples of 1 << sample_len_shift bytes are taken
+// every stride bytes of the entries. Whenever twice as many samples as fit
+// in sample_bytes are buffered, every other one is dropped and the stride is
+// doubled, so that the samples stay spread evenly over the data. As many of
+// them as fit in sample_bytes are returned, also evenly spread.
+// The output of a flush or recovery is a single file whose contents are in
+// memory, so they can be sampled before the file is written.
+std::string SampleForCompressionDict(InternalIterator* iter,
+                                     size_t sample_bytes,
+                                     size_t sample_len_shift) {
+  const size_t kSampleLen = static_cast<size_t>(1) << sample_len_shift;
+  const size_t kNumSamples = std::max<size_t>(sample_bytes / kSampleLen, 1);
+
+  // The i-th sample starts at i * kSampleLen; only the last one may be
+  // shorter than kSampleLen
+  std::string samples;
+  uint64_t stride = kSampleLen;
+  uint64_t offset = 0;       // Offset of the next unread byte
+  uint64_t next_sample = 0;  // Offset where the next sample begins
+  size_t sample_remaining = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    for (const Slice& data : {iter->key(), iter->value()}) {
+      size_t pos = 0;
+      while (pos < data.size()) {
+        if (sample_remaining == 0) {
+          if (offset + (data.size() - pos) <= next_sample) {
+            // No sample starts in the rest of data
+            offset += data.size() - pos;
+            break;
+          }
+          pos += static_cast<size_t>(next_sample - offset);
+          offset = next_sample;
+          if (samples.size() == 2 * kNumSamples * kSampleLen) {
+            // Keep the even samples, which are 2 * stride apart. The next
+            // one, at kNumSamples * 2 * stride, starts here.
+            for (size_t i = 1; i < kNumSamples; i++) {
+              samples.replace(i * kSampleLen, kSampleLen, samples,
+                              2 * i * kSampleLen, kSampleLen);
+            }
+            samples.resize(kNumSamples * kSampleLen);
+            stride *= 2;
+          }
+          next_sample += stride;
+          sample_remaining = kSampleLen;
+        }
+        size_t len = std::min(sample_remaining, data.size() - pos);
+        samples.append(data.data() + pos, len);
+        pos += len;
+        offset += len;
+        sample_remaining -= len;
+      }
+    }
+  }
+
+  const size_t num_samples = (samples.size() + kSampleLen - 1) / kSampleLen;
+  if (num_samples <= kNumSamples) {
+    return samples;
+  }
+  std::string result;
+  result.reserve(kNumSamples * kSampleLen);
+  for (size_t i = 0; i < kNumSamples; i++) {
+    result.append(samples, i * num_samples / kNumSamples * kSampleLen,
+                  kSampleLen);
+  }
+  if (result.size() > sample_bytes) {
+    result.resize(sample_bytes);
+  }
+  return result;
+}
+
+}  // namespace
+
 TableBuilder* NewTableBuilder(
     const ImmutableCFOptions& ioptions,
     const InternalKeyComparator& internal_comparator,
@@ -45,7 +123,8 @@ TableBuilder* NewTableBuilder(
     uint32_t column_family_id, const std::string& column_family_name,
     WritableFileWriter* file, const CompressionType compression_type,
     const CompressionOptions& compression_opts,
-    const std::string* compression_dict, const bool skip_filters) {
+    const std::string* compression_dict, const bool skip_filters,
+    const uint64_t creation_time) {
   assert((column_family_id ==
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily) ==
          column_family_name.empty());
@@ -53,14 +132,15 @@ TableBuilder* NewTableBuilder(
       TableBuilderOptions(ioptions, internal_comparator,
                           int_tbl_prop_collector_factories, compression_type,
                           compression_opts, compression_dict, skip_filters,
-                          column_family_name),
+                          column_family_name, creation_time),
       column_family_id, file);
 }
 
 Status BuildTable(
     const std::string& dbname, Env* env, const ImmutableCFOptions& ioptions,
     const MutableCFOptions& mutable_cf_options, const EnvOptions& env_options,
-    TableCache* table_cache, InternalIterator* iter, FileMetaData* meta,
+    TableCache* table_cache, InternalIterator* iter,
+    std::unique_ptr<InternalIterator> range_del_iter, FileMetaData* meta,
     const InternalKeyComparator& internal_comparator,
     const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
         int_tbl_prop_collector_factories,
@@ -80,6 +160,12 @@ Status BuildTable(
   Status s;
   meta->fd.file_size = 0;
   iter->SeekToFirst();
+  RangeDelAggregator range_del_agg(internal_comparator, snapshots);
+  s = range_del_agg.AddTombstones(std::move(range_del_iter));
+  if (!s.ok()) {
+    // may be non-ok if a range tombstone key is unparsable
+    return s;
+  }
 
   std::string fname = TableFileName(ioptions.db_paths, meta->fd.GetNumber(),
                                     meta->fd.GetPathId());
@@ -89,7 +175,24 @@ Status BuildTable(
 #endif  // !ROCKSDB_LITE
   TableProperties tp;
 
-  if (iter->Valid()) {
+  if (iter->Valid() || !range_del_agg.IsEmpty()) {
+    // The output is a single file, so its dictionary is made from samples of
+    // all of its data.
+    std::string compression_dict;
+    const int kSampleLenShift = 6;  // 2^6 = 64-byte samples
+    const size_t kSampleBytes =
+        compression != kNoCompression && compression_opts.use_dict_for_flush
+            ? CompressionDictSampleBytes(compression, compression_opts)
+            : 0;
+    if (kSampleBytes > 0) {
+      compression_dict = FinishCompressionDict(
+          SampleForCompressionDict(iter, kSampleBytes, kSampleLenShift),
+          kSampleLenShift, compression, compression_opts);
+      TEST_SYNC_POINT_CALLBACK("BuildTable:CompressionDict",
+                               &compression_dict);
+      iter->SeekToFirst();
+    }
+
     TableBuilder* builder;
     unique_ptr<WritableFileWriter> file_writer;
     {
@@ -105,10 +208,18 @@ Status BuildTable(
 
       file_writer.reset(new WritableFileWriter(std::move(file), env_options));
 
+      // The data of a flushed table is as old as the flush. The creation time
+      // is left unknown if the clock can't be read.
+      int64_t current_time = 0;
+      if (!env->GetCurrentTime(&current_time).ok()) {
+        current_time = 0;
+      }
       builder = NewTableBuilder(
           ioptions, internal_comparator, int_tbl_prop_collector_factories,
           column_family_id, column_family_name, file_writer.get(), compression,
-          compression_opts);
+          compression_opts,
+          compression_dict.empty() ? nullptr : &compression_dict,
+          false /* skip_filters */, static_cast<uint64_t>(current_time));
     }
 
     MergeHelper merge(env, internal_comparator.user_comparator(),
@@ -120,7 +231,8 @@ Status BuildTable(
     CompactionIterator c_iter(iter, internal_comparator.user_comparator(),
                               &merge, kMaxSequenceNumber, &snapshots,
                               earliest_write_conflict_snapshot, env,
-                              true /* internal key corruption is not ok */);
+                              true /* internal key corruption is not ok */,
+                              &range_del_agg);
     c_iter.SeekToFirst();
     for (; c_iter.Valid(); c_iter.Next()) {
       const Slice& key = c_iter.key();
@@ -135,6 +247,9 @@ Status BuildTable(
             ThreadStatus::FLUSH_BYTES_WRITTEN, IOSTATS(bytes_written));
       }
     }
+    // A flush has a single output file, so all the tombstones go to it
+    range_del_agg.AddToBuilder(builder, nullptr /* lower_bound */,
+                               nullptr /* upper_bound */, meta);
 
     // Finish and check for builder errors
     bool empty = builder->NumEntries() == 0;
@@ -136,6 +136,20 @@ Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
   return Status::OK();
 }
 
+Status CheckCompactionOptionsSupported(const DBOptions& db_options,
+                                       const ColumnFamilyOptions& cf_options) {
+  if (cf_options.compaction_style == kCompactionStyleFIFO &&
+      cf_options.compaction_options_fifo.ttl > 0 &&
+      (db_options.max_open_files != -1 ||
+       db_options.skip_table_open_on_db_open)) {
+    return Status::NotSupported(
+        "FIFO compaction TTL (compaction_options_fifo.ttl) is only supported "
+        "when all files are kept open (max_open_files = -1 and "
+        "skip_table_open_on_db_open = false)");
+  }
+  return Status::OK();
+}
+
 ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
                                     const InternalKeyComparator* icmp,
                                     const ColumnFamilyOptions& src) {
@@ -198,8 +212,12 @@ ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
   if (result.compaction_style == kCompactionStyleFIFO) {
     result.num_levels = 1;
     // since we delete level0 files in FIFO compaction when there are too many
-    // of them, these options don't really mean anything
-    result.level0_file_num_compaction_trigger = std::numeric_limits<int>::max();
+    // of them, these options don't really mean anything. The compaction
+    // trigger is kept when small files are merged.
+    if (!result.compaction_options_fifo.allow_compaction) {
+      result.level0_file_num_compaction_trigger =
+          std::numeric_limits<int>::max();
+    }
     result.level0_slowdown_writes_trigger = std::numeric_limits<int>::max();
     result.level0_stop_writes_trigger = std::numeric_limits<int>::max();
   }
@@ -356,7 +374,10 @@ ColumnFamilyData::ColumnFamilyData(
       column_family_set_(column_family_set),
       pending_flush_(false),
       pending_compaction_(false),
-      prev_compaction_needed_bytes_(0) {
+      prev_compaction_needed_bytes_(0),
+      pacing_pressure_(0),
+      pacing_base_rate_(0),
+      pacing_write_rate_(0) {
   Ref();
 
   // Convert user defined table properties collector factories to internal ones.
@@ -483,7 +504,9 @@ std::unique_ptr<WriteControllerToken> SetupDelay(
     bool auto_comapctions_disabled) {
   const uint64_t kMinWriteRate = 1024u;  // Minimum write rate 1KB/s.
 
-  uint64_t write_rate = write_controller->delayed_write_rate();
+  // Write pacing may have left the rate above max_write_rate
+  uint64_t write_rate =
+      std::min(write_controller->delayed_write_rate(), max_write_rate);
 
   if (auto_comapctions_disabled) {
     // When auto compaction is disabled, always use the value user gave.
@@ -540,6 +563,34 @@ int GetL0ThresholdSpeedupCompaction(int level0_file_num_compaction_trigger,
                        level0_file_num_compaction_trigger) /
                           4);
 }
+
+// Returns how close the column family is to getting its writes delayed. It is
+// 0 until compaction is sped up because of level-0 files, or until the
+// estimated pending compaction bytes reach half of the soft limit, and grows
+// linearly to 1 at the slowdown triggers.
+double GetWritePacingPressure(const VersionStorageInfo* vstorage,
+                              const MutableCFOptions& mutable_cf_options) {
+  double pressure = 0;
+  if (mutable_cf_options.level0_slowdown_writes_trigger >= 0) {
+    int l0_start = GetL0ThresholdSpeedupCompaction(
+        mutable_cf_options.level0_file_num_compaction_trigger,
+        mutable_cf_options.level0_slowdown_writes_trigger);
+    int l0_end = mutable_cf_options.level0_slowdown_writes_trigger;
+    int l0_files = vstorage->l0_delay_trigger_count();
+    if (l0_end > l0_start && l0_files > l0_start) {
+      pressure = static_cast<double>(l0_files - l0_start) / (l0_end - l0_start);
+    }
+  }
+  uint64_t soft_limit = mutable_cf_options.soft_pending_compaction_bytes_limit;
+  uint64_t compaction_needed_bytes =
+      vstorage->estimated_compaction_needed_bytes();
+  if (soft_limit > 0 && compaction_needed_bytes > soft_limit / 2) {
+    pressure = std::max(
+        pressure, static_cast<double>(compaction_needed_bytes - soft_limit / 2) /
+                      (soft_limit - soft_limit / 2));
+  }
+  return std::min(pressure, 1.0);
+}
 }  // namespace
 
 void ColumnFamilyData::RecalculateWriteStallConditions(
@@ -549,6 +600,12 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
     auto write_controller = column_family_set_->write_controller_;
     uint64_t compaction_needed_bytes =
         vstorage->estimated_compaction_needed_bytes();
+    pacing_pressure_ = 0;
+    if (mutable_cf_options.adaptive_write_pacing &&
+        !mutable_cf_options.disable_auto_compactions) {
+      pacing_pressure_ = GetWritePacingPressure(vstorage, mutable_cf_options);
+    }
+    bool paced = false;
 
     if (imm()->NumNotFlushed() >= mutable_cf_options.max_write_buffer_number) {
       write_controller_token_ = write_controller->GetStopToken();
@@ -625,6 +682,39 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
           "bytes %" PRIu64 " rate %" PRIu64,
           name_.c_str(), vstorage->estimated_compaction_needed_bytes(),
           write_controller->delayed_write_rate());
+    } else if (pacing_pressure_ > 0) {
+      if (pacing_base_rate_ == 0) {
+        // Start from the rate writes are coming in at. It is measured only
+        // here since the pacing itself holds writes back afterwards.
+        pacing_base_rate_ = std::max(write_controller->estimated_write_rate(),
+                                     ioptions_.delayed_write_rate);
+      }
+      uint64_t write_rate =
+          pacing_base_rate_ -
+          static_cast<uint64_t>(
+              (pacing_base_rate_ - ioptions_.delayed_write_rate) *
+              pacing_pressure_);
+      if (pacing_write_rate_ == 0 || write_rate < pacing_write_rate_) {
+        RecordTick(ioptions_.statistics, WRITE_PACING_RATE_DECREASES);
+      } else if (write_rate > pacing_write_rate_) {
+        RecordTick(ioptions_.statistics, WRITE_PACING_RATE_INCREASES);
+      }
+      pacing_write_rate_ = write_rate;
+      paced = true;
+      // The delayed write rate is shared by the whole DB. If another column
+      // family holds a delay token, pacing may only lower it.
+      write_controller_token_.reset();
+      if (write_controller->NeedsDelay()) {
+        write_rate =
+            std::min(write_rate, write_controller->delayed_write_rate());
+      }
+      write_controller_token_ = write_controller->GetDelayToken(write_rate);
+      Log(InfoLogLevel::INFO_LEVEL, ioptions_.info_log,
+          "[%s] Pacing writes at rate %" PRIu64
+          " because of write pressure %.2f: %d level-0 files, estimated "
+          "pending compaction bytes %" PRIu64,
+          name_.c_str(), write_rate, pacing_pressure_,
+          vstorage->l0_delay_trigger_count(), compaction_needed_bytes);
     } else if (vstorage->l0_delay_trigger_count() >=
                GetL0ThresholdSpeedupCompaction(
                    mutable_cf_options.level0_file_num_compaction_trigger,
@@ -651,6 +741,10 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
     } else {
       write_controller_token_.reset();
     }
+    if (!paced) {
+      pacing_base_rate_ = 0;
+      pacing_write_rate_ = 0;
+    }
     prev_compaction_needed_bytes_ = compaction_needed_bytes;
   }
 }
@@ -671,6 +765,16 @@ uint64_t ColumnFamilyData::GetTotalSstFilesSize() const {
   return VersionSet::GetTotalSstFilesSize(dummy_versions_);
 }
 
+size_t ColumnFamilyData::GetPacedWriteBufferSize(
+    const MutableCFOptions& mutable_cf_options) {
+  if (pacing_pressure_ <= 0) {
+    return mutable_cf_options.write_buffer_size;
+  }
+  RecordTick(ioptions_.statistics, WRITE_PACING_FLUSH_TRIGGER_RAISED);
+  return static_cast<size_t>(mutable_cf_options.write_buffer_size *
+                             (1 + pacing_pressure_));
+}
+
 MemTable* ColumnFamilyData::ConstructNewMemtable(
     const MutableCFOptions& mutable_cf_options, SequenceNumber earliest_seq) {
   assert(current_ != nullptr);
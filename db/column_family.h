@@ -136,6 +136,9 @@ extern Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options);
 extern Status CheckConcurrentWritesSupported(
     const ColumnFamilyOptions& cf_options);
 
+extern Status CheckCompactionOptionsSupported(
+    const DBOptions& db_options, const ColumnFamilyOptions& cf_options);
+
 extern ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
                                            const InternalKeyComparator* icmp,
                                            const ColumnFamilyOptions& src);
@@ -235,6 +238,11 @@ class ColumnFamilyData {
   uint64_t GetTotalSstFilesSize() const;  // REQUIRE: DB mutex held
   void SetMemtable(MemTable* new_mem) { mem_ = new_mem; }
 
+  // Returns the write buffer size for the next memtable, raised by
+  // adaptive_write_pacing while writes are under pressure.
+  // REQUIRES: DB mutex held
+  size_t GetPacedWriteBufferSize(const MutableCFOptions& mutable_cf_options);
+
   // See Memtable constructor for explanation of earliest_seq param.
   MemTable* ConstructNewMemtable(const MutableCFOptions& mutable_cf_options,
                                  SequenceNumber earliest_seq);
@@ -390,6 +398,12 @@ class ColumnFamilyData {
   bool pending_compaction_;
 
   uint64_t prev_compaction_needed_bytes_;
+
+  // State of adaptive_write_pacing: the current pressure in [0, 1], and while
+  // writes are paced, the rate the pacing started from and the current rate.
+  double pacing_pressure_;
+  uint64_t pacing_base_rate_;
+  uint64_t pacing_write_rate_;
 };
 
 // ColumnFamilySet has interesting thread-safety requirements
@@ -1727,8 +1727,9 @@ TEST_F(ColumnFamilyTest, SameCFManualAutomaticCompactionsLevel) {
 
   threads.join();
   WaitForCompaction();
-  // VERIFY compaction "one"
-  AssertFilesPerLevel("0,1", 1);
+  // VERIFY compaction "one". The automatic compaction, blocked by the manual
+  // one from compacting into L1, merged the new L0 files into one instead.
+  AssertFilesPerLevel("1,1", 1);
 
   // Compare against saved keys
   std::set<std::string>::iterator key_iter = keys_.begin();
@@ -2586,6 +2587,178 @@ TEST_F(ColumnFamilyTest, WriteStallSingleColumnFamily) {
             dbfull()->TEST_write_controler().delayed_write_rate());
 }
 
+TEST_F(ColumnFamilyTest, AdaptiveWritePacing) {
+  class TimeSetEnv : public EnvWrapper {
+   public:
+    TimeSetEnv() : EnvWrapper(nullptr) {}
+    uint64_t now_micros_ = 1000000;
+    virtual uint64_t NowMicros() override { return now_micros_; }
+  };
+
+  const uint64_t kBaseRate = 810000u;
+  const uint64_t kWriteRate = 4 * kBaseRate;
+  const size_t kWriteBufferSize = 1 << 20;
+  db_options_.delayed_write_rate = kBaseRate;
+  db_options_.statistics = rocksdb::CreateDBStatistics();
+
+  Open({"default"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+  WriteController& write_controller = dbfull()->TEST_write_controler();
+  Statistics* stats = db_options_.statistics.get();
+
+  MutableCFOptions mutable_cf_options(
+      Options(db_options_, column_family_options_),
+      ImmutableCFOptions(Options(db_options_, column_family_options_)));
+  mutable_cf_options.write_buffer_size = kWriteBufferSize;
+  mutable_cf_options.level0_file_num_compaction_trigger = 4;
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+
+  // Writes come in at four times the delayed write rate
+  TimeSetEnv env;
+  write_controller.RecordWrite(&env, kWriteRate);
+  env.now_micros_ += 1000000;
+  write_controller.RecordWrite(&env, kWriteRate);
+  ASSERT_EQ(kWriteRate, write_controller.estimated_write_rate());
+
+  // Without the option, only the slowdown triggers delay writes
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!write_controller.NeedsDelay());
+  ASSERT_EQ(kWriteBufferSize, cfd->GetPacedWriteBufferSize(mutable_cf_options));
+
+  mutable_cf_options.adaptive_write_pacing = true;
+  vstorage->TEST_set_estimated_compaction_needed_bytes(100);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!write_controller.NeedsDelay());
+
+  // Halfway from half of the soft limit to the soft limit
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!write_controller.IsStopped());
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  ASSERT_EQ(kWriteRate - (kWriteRate - kBaseRate) / 2,
+            write_controller.delayed_write_rate());
+  ASSERT_EQ(1U, stats->getTickerCount(WRITE_PACING_RATE_DECREASES));
+  ASSERT_EQ(kWriteBufferSize * 3 / 2,
+            cfd->GetPacedWriteBufferSize(mutable_cf_options));
+  ASSERT_EQ(1U, stats->getTickerCount(WRITE_PACING_FLUSH_TRIGGER_RAISED));
+
+  // The pacing keeps the rate it started from even though writes slow down
+  env.now_micros_ += 1000000;
+  write_controller.RecordWrite(&env, kBaseRate * 2);
+  vstorage->TEST_set_estimated_compaction_needed_bytes(175);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kWriteRate - (kWriteRate - kBaseRate) / 4 * 3,
+            write_controller.delayed_write_rate());
+  ASSERT_EQ(2U, stats->getTickerCount(WRITE_PACING_RATE_DECREASES));
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(125);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kWriteRate - (kWriteRate - kBaseRate) / 4,
+            write_controller.delayed_write_rate());
+  ASSERT_EQ(1U, stats->getTickerCount(WRITE_PACING_RATE_INCREASES));
+
+  // Level-0 files count too: compaction is sped up at 8 files, writes are
+  // delayed at 20
+  vstorage->set_l0_delay_trigger_count(14);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kWriteRate - (kWriteRate - kBaseRate) / 2,
+            write_controller.delayed_write_rate());
+  ASSERT_EQ(3U, stats->getTickerCount(WRITE_PACING_RATE_DECREASES));
+
+  // The regular slowdown takes over at the trigger
+  vstorage->set_l0_delay_trigger_count(20);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  ASSERT_EQ(kWriteBufferSize * 2, cfd->GetPacedWriteBufferSize(mutable_cf_options));
+
+  vstorage->set_l0_delay_trigger_count(0);
+  vstorage->TEST_set_estimated_compaction_needed_bytes(50);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!write_controller.NeedsDelay());
+  ASSERT_EQ(kWriteBufferSize, cfd->GetPacedWriteBufferSize(mutable_cf_options));
+  ASSERT_EQ(2U, stats->getTickerCount(WRITE_PACING_FLUSH_TRIGGER_RAISED));
+}
+
+TEST_F(ColumnFamilyTest, AdaptiveWritePacingTwoColumnFamilies) {
+  class TimeSetEnv : public EnvWrapper {
+   public:
+    TimeSetEnv() : EnvWrapper(nullptr) {}
+    uint64_t now_micros_ = 1000000;
+    virtual uint64_t NowMicros() override { return now_micros_; }
+  };
+
+  const uint64_t kBaseRate = 810000u;
+  const uint64_t kWriteRate = 4 * kBaseRate;
+  const uint64_t kPacedRate = kWriteRate - (kWriteRate - kBaseRate) / 2;
+  db_options_.delayed_write_rate = kBaseRate;
+
+  Open();
+  CreateColumnFamilies({"one"});
+  ColumnFamilyData* cfd =
+      static_cast<ColumnFamilyHandleImpl*>(db_->DefaultColumnFamily())->cfd();
+  VersionStorageInfo* vstorage = cfd->current()->storage_info();
+  ColumnFamilyData* cfd1 =
+      static_cast<ColumnFamilyHandleImpl*>(handles_[1])->cfd();
+  VersionStorageInfo* vstorage1 = cfd1->current()->storage_info();
+  WriteController& write_controller = dbfull()->TEST_write_controler();
+
+  MutableCFOptions mutable_cf_options(
+      Options(db_options_, column_family_options_),
+      ImmutableCFOptions(Options(db_options_, column_family_options_)));
+  mutable_cf_options.level0_slowdown_writes_trigger = 20;
+  mutable_cf_options.level0_stop_writes_trigger = 10000;
+  mutable_cf_options.soft_pending_compaction_bytes_limit = 200;
+  mutable_cf_options.hard_pending_compaction_bytes_limit = 2000;
+  MutableCFOptions mutable_cf_options1 = mutable_cf_options;
+  mutable_cf_options.adaptive_write_pacing = true;
+
+  TimeSetEnv env;
+  write_controller.RecordWrite(&env, kWriteRate);
+  env.now_micros_ += 1000000;
+  write_controller.RecordWrite(&env, kWriteRate);
+
+  // The default column family paces writes above the delayed write rate
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kPacedRate, write_controller.delayed_write_rate());
+
+  // A column family that is slowed down doesn't start from the paced rate
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(300);
+  cfd1->RecalculateWriteStallConditions(mutable_cf_options1);
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  ASSERT_EQ(kBaseRate, write_controller.delayed_write_rate());
+
+  // While it is, pacing doesn't raise the rate again
+  vstorage->TEST_set_estimated_compaction_needed_bytes(125);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kBaseRate, write_controller.delayed_write_rate());
+
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(400);
+  cfd1->RecalculateWriteStallConditions(mutable_cf_options1);
+  ASSERT_EQ(kBaseRate / 1.2, write_controller.delayed_write_rate());
+  vstorage->TEST_set_estimated_compaction_needed_bytes(150);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kBaseRate / 1.2, write_controller.delayed_write_rate());
+
+  // Once the other column family is no longer slowed down, the paced rate
+  // applies
+  vstorage1->TEST_set_estimated_compaction_needed_bytes(20);
+  cfd1->RecalculateWriteStallConditions(mutable_cf_options1);
+  ASSERT_TRUE(write_controller.NeedsDelay());
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_EQ(kPacedRate, write_controller.delayed_write_rate());
+
+  vstorage->TEST_set_estimated_compaction_needed_bytes(50);
+  cfd->RecalculateWriteStallConditions(mutable_cf_options);
+  ASSERT_TRUE(!write_controller.NeedsDelay());
+}
+
 TEST_F(ColumnFamilyTest, CompactionSpeedupSingleColumnFamily) {
   db_options_.base_background_compactions = 2;
   db_options_.max_background_compactions = 6;
@@ -144,6 +144,10 @@ Status CompactedDBImpl::Open(const Options& options,
   if (options.max_open_files != -1) {
     return Status::InvalidArgument("require max_open_files = -1");
   }
+  if (options.skip_table_open_on_db_open) {
+    return Status::InvalidArgument(
+        "require skip_table_open_on_db_open = false");
+  }
   if (options.merge_operator.get() != nullptr) {
     return Status::InvalidArgument("merge operator is not supported");
   }
@@ -11,25 +11,35 @@ namespace rocksdb {
 
 class CompactionIteratorTest : public testing::Test {
  public:
-  CompactionIteratorTest() : cmp_(BytewiseComparator()), snapshots_({}) {}
+  CompactionIteratorTest()
+      : cmp_(BytewiseComparator()), icmp_(cmp_), snapshots_({}) {}
 
   void InitIterator(const std::vector<std::string>& ks,
                     const std::vector<std::string>& vs,
+                    const std::vector<std::string>& range_del_ks,
+                    const std::vector<std::string>& range_del_vs,
                     SequenceNumber last_sequence) {
+    std::unique_ptr<InternalIterator> range_del_iter(
+        new test::VectorIterator(range_del_ks, range_del_vs));
+    range_del_agg_.reset(new RangeDelAggregator(icmp_, snapshots_));
+    ASSERT_OK(range_del_agg_->AddTombstones(std::move(range_del_iter)));
+
     merge_helper_.reset(new MergeHelper(Env::Default(), cmp_, nullptr, nullptr,
                                         nullptr, 0U, false, 0));
     iter_.reset(new test::VectorIterator(ks, vs));
     iter_->SeekToFirst();
     c_iter_.reset(new CompactionIterator(
         iter_.get(), cmp_, merge_helper_.get(), last_sequence, &snapshots_,
-        kMaxSequenceNumber, Env::Default(), false));
+        kMaxSequenceNumber, Env::Default(), false, range_del_agg_.get()));
   }
 
   const Comparator* cmp_;
+  const InternalKeyComparator icmp_;
   std::vector<SequenceNumber> snapshots_;
   std::unique_ptr<MergeHelper> merge_helper_;
   std::unique_ptr<test::VectorIterator> iter_;
   std::unique_ptr<CompactionIterator> c_iter_;
+  std::unique_ptr<RangeDelAggregator> range_del_agg_;
 };
 
 // It is possible that the output of the compaction iterator is empty even if
@@ -37,7 +47,7 @@ class CompactionIteratorTest : public testing::Test {
 TEST_F(CompactionIteratorTest, EmptyResult) {
   InitIterator({test::KeyStr("a", 5, kTypeSingleDeletion),
                 test::KeyStr("a", 3, kTypeValue)},
-               {"", "val"}, 5);
+               {"", "val"}, {}, {}, 5);
   c_iter_->SeekToFirst();
   ASSERT_FALSE(c_iter_->Valid());
 }
@@ -48,7 +58,7 @@ TEST_F(CompactionIteratorTest, CorruptionAfterSingleDeletion) {
   InitIterator({test::KeyStr("a", 5, kTypeSingleDeletion),
                 test::KeyStr("a", 3, kTypeValue, true),
                 test::KeyStr("b", 10, kTypeValue)},
-               {"", "val", "val2"}, 10);
+               {"", "val", "val2"}, {}, {}, 10);
   c_iter_->SeekToFirst();
   ASSERT_TRUE(c_iter_->Valid());
   ASSERT_EQ(test::KeyStr("a", 5, kTypeSingleDeletion),
@@ -63,6 +73,33 @@ TEST_F(CompactionIteratorTest, CorruptionAfterSingleDeletion) {
   ASSERT_FALSE(c_iter_->Valid());
 }
 
+TEST_F(CompactionIteratorTest, RangeDeletionWithSnapshots) {
+  snapshots_ = {10};
+  InitIterator({test::KeyStr("a", 5, kTypeValue),
+                test::KeyStr("b", 15, kTypeValue),
+                test::KeyStr("b", 8, kTypeValue),
+                test::KeyStr("c", 12, kTypeValue),
+                test::KeyStr("d", 3, kTypeValue)},
+               {"av5", "bv15", "bv8", "cv12", "dv3"},
+               {test::KeyStr("a", 20, kTypeRangeDeletion),
+                test::KeyStr("c", 6, kTypeRangeDeletion)},
+               {"c", "e"}, 20);
+  c_iter_->SeekToFirst();
+  // b@15 and d@3 are covered by a newer tombstone of their snapshot stripe.
+  // a@5 and b@8 are visible to the snapshot at 10, which predates [a, c)@20,
+  // and the end key of [a, c)@20 is exclusive.
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("a", 5, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("b", 8, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_TRUE(c_iter_->Valid());
+  ASSERT_EQ(test::KeyStr("c", 12, kTypeValue), c_iter_->key().ToString());
+  c_iter_->Next();
+  ASSERT_FALSE(c_iter_->Valid());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -47,7 +47,9 @@
 #include "table/block_based_table_factory.h"
 #include "table/merger.h"
 #include "table/table_builder.h"
+#include "table/table_reader.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/file_reader_writer.h"
 #include "util/iostats_context_imp.h"
 #include "util/log_buffer.h"
@@ -288,7 +290,8 @@ CompactionJob::CompactionJob(
       table_cache_(std::move(table_cache)),
       event_logger_(event_logger),
       paranoid_file_checks_(paranoid_file_checks),
-      measure_io_stats_(measure_io_stats) {
+      measure_io_stats_(measure_io_stats),
+      oldest_input_creation_time_(0) {
   assert(log_buffer_ != nullptr);
   const auto* cfd = compact_->compaction->column_family_data();
   ThreadStatusUtil::SetColumnFamily(cfd, cfd->ioptions()->env,
@@ -382,6 +385,10 @@ void CompactionJob::Prepare() {
   }
 }
 
+// The number of keys sampled from each universal compaction input file in
+// L0, per allowed subcompaction
+static const size_t kKeyAnchorsPerSubcompaction = 4;
+
 struct RangeWithSize {
   Range range;
   uint64_t size;
@@ -402,6 +409,10 @@ void CompactionJob::GenSubcompactionBoundaries() {
   std::vector<Slice> bounds;
   int start_lvl = c->start_level();
   int out_lvl = c->output_level();
+  // Every input level of a universal compaction is a whole sorted run, and an
+  // L0 file alone may cover the entire key range.
+  const bool universal =
+      cfd->ioptions()->compaction_style == kCompactionStyleUniversal;
 
   // Add the starting and/or ending key of certain input files as a potential
   // boundary
@@ -422,16 +433,36 @@ void CompactionJob::GenSubcompactionBoundaries() {
           bounds.emplace_back(flevel->files[i].smallest_key);
           bounds.emplace_back(flevel->files[i].largest_key);
         }
+        if (universal) {
+          // The endpoints of files that each span the whole key range can't
+          // split the work, so also sample keys from inside the files
+          const size_t max_anchors =
+              static_cast<size_t>(db_options_.max_subcompactions) *
+              kKeyAnchorsPerSubcompaction;
+          for (size_t i = 0; i < num_files; i++) {
+            Status s = cfd->table_cache()->ApproximateKeyAnchors(
+                env_options_, cfd->internal_comparator(),
+                flevel->files[i].fd, max_anchors, &key_anchors_);
+            if (!s.ok() && !s.IsNotSupported()) {
+              Log(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+                  "[%s] Failed to sample keys of file #%" PRIu64
+                  " for subcompactions: %s",
+                  cfd->GetName().c_str(), flevel->files[i].fd.GetNumber(),
+                  s.ToString().c_str());
+            }
+          }
+        }
       } else {
         // For all other levels add the smallest/largest key in the level to
         // encompass the range covered by that level
         bounds.emplace_back(flevel->files[0].smallest_key);
         bounds.emplace_back(flevel->files[num_files - 1].largest_key);
-        if (lvl == out_lvl) {
+        if (lvl == out_lvl || universal) {
           // For the last level include the starting keys of all files since
           // the last level is the largest and probably has the widest key
           // range. Since it's range partitioned, the ending key of one file
           // and the starting key of the next are very close (or identical).
+          // The same holds for every sorted run of a universal compaction.
           for (size_t i = 1; i < num_files; i++) {
             bounds.emplace_back(flevel->files[i].smallest_key);
           }
@@ -440,6 +471,10 @@ void CompactionJob::GenSubcompactionBoundaries() {
     }
   }
 
+  for (const auto& anchor : key_anchors_) {
+    bounds.emplace_back(anchor);
+  }
+
   std::sort(bounds.begin(), bounds.end(),
     [cfd_comparator] (const Slice& a, const Slice& b) -> bool {
       return cfd_comparator->Compare(ExtractUserKey(a), ExtractUserKey(b)) < 0;
@@ -472,8 +507,7 @@ void CompactionJob::GenSubcompactionBoundaries() {
   // Group the ranges into subcompactions
   const double min_file_fill_percent = 4.0 / 5;
   uint64_t max_output_files = static_cast<uint64_t>(
-      std::ceil(sum / min_file_fill_percent /
-                c->mutable_cf_options()->MaxFileSizeForLevel(out_lvl)));
+      std::ceil(sum / min_file_fill_percent / c->max_output_file_size()));
   uint64_t subcompactions =
       std::min({static_cast<uint64_t>(ranges.size()),
                 static_cast<uint64_t>(db_options_.max_subcompactions),
@@ -516,6 +550,7 @@ Status CompactionJob::Run() {
   const size_t num_threads = compact_->sub_compact_states.size();
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
+  oldest_input_creation_time_ = GetOldestInputCreationTime();
 
   // Launch a thread for each of subcompactions 1...num_threads-1
   std::vector<std::thread> thread_pool;
@@ -646,8 +681,11 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
 
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
+  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
+  RangeDelAggregator range_del_agg(cfd->internal_comparator(),
+                                   existing_snapshots_);
   std::unique_ptr<InternalIterator> input(
-      versions_->MakeInputIterator(sub_compact->compaction));
+      versions_->MakeInputIterator(sub_compact->compaction, &range_del_agg));
 
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
@@ -668,20 +706,23 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     prev_prepare_write_nanos = IOSTATS(prepare_write_nanos);
   }
 
-  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
   const MutableCFOptions* mutable_cf_options =
       sub_compact->compaction->mutable_cf_options();
 
   // To build compression dictionary, we sample the first output file, assuming
   // it'll reach the maximum length, and then use the dictionary for compressing
   // subsequent output files. The dictionary may be less than max_dict_bytes if
-  // the first output file's length is less than the maximum.
+  // the first output file's length is less than the maximum. With
+  // zstd_max_train_bytes, more is sampled and a ZSTD dictionary is trained
+  // from the samples.
   const int kSampleLenShift = 6;  // 2^6 = 64-byte samples
+  const CompressionType output_compression =
+      sub_compact->compaction->output_compression();
+  const size_t kSampleBytes = CompressionDictSampleBytes(
+      output_compression, cfd->ioptions()->compression_opts);
   std::set<size_t> sample_begin_offsets;
-  if (bottommost_level_ &&
-      cfd->ioptions()->compression_opts.max_dict_bytes > 0) {
-    const size_t kMaxSamples =
-        cfd->ioptions()->compression_opts.max_dict_bytes >> kSampleLenShift;
+  if (bottommost_level_ && kSampleBytes > 0) {
+    const size_t kMaxSamples = kSampleBytes >> kSampleLenShift;
     const size_t kOutFileLen = mutable_cf_options->MaxFileSizeForLevel(
         compact_->compaction->output_level());
     if (kOutFileLen != port::kMaxSizet) {
@@ -725,7 +766,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   sub_compact->c_iter.reset(new CompactionIterator(
       input.get(), cfd->user_comparator(), &merge, versions_->LastSequence(),
       &existing_snapshots_, earliest_write_conflict_snapshot_, env_, false,
-      sub_compact->compaction, compaction_filter));
+      &range_del_agg, sub_compact->compaction, compaction_filter));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
   const auto& c_iter_stats = c_iter->iter_stats();
@@ -734,7 +775,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // dictionary from the first output file.
   size_t data_begin_offset = 0;
   std::string compression_dict;
-  compression_dict.reserve(cfd->ioptions()->compression_opts.max_dict_bytes);
+  compression_dict.reserve(kSampleBytes);
 
   // TODO(noetzli): check whether we could check !shutting_down_->... only
   // only occasionally (see diff D42687)
@@ -752,7 +793,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       break;
     } else if (sub_compact->ShouldStopBefore(key) &&
                sub_compact->builder != nullptr) {
-      status = FinishCompactionOutputFile(input->status(), sub_compact);
+      status = FinishCompactionOutputFile(input->status(), sub_compact,
+                                          &range_del_agg, &key);
       if (!status.ok()) {
         break;
       }
@@ -835,14 +877,29 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     // and 0.6MB instead of 1MB and 0.2MB)
     if (sub_compact->builder->FileSize() >=
         sub_compact->compaction->max_output_file_size()) {
-      status = FinishCompactionOutputFile(input->status(), sub_compact);
+      // The file ends before the next key, so advance first to know where the
+      // file's range tombstones end. The input status is taken before
+      // advancing, as it used to be.
+      Status input_status = input->status();
+      c_iter->Next();
+      const Slice* next_key = nullptr;
+      if (c_iter->Valid() &&
+          (end == nullptr ||
+           cfd->user_comparator()->Compare(c_iter->user_key(), *end) < 0)) {
+        next_key = &c_iter->key();
+      }
+      status = FinishCompactionOutputFile(input_status, sub_compact,
+                                          &range_del_agg, next_key);
       if (sub_compact->outputs.size() == 1) {
         // Use dictionary from first output file for compression of subsequent
         // files.
-        sub_compact->compression_dict = std::move(compression_dict);
+        sub_compact->compression_dict = FinishCompressionDict(
+            std::move(compression_dict), kSampleLenShift, output_compression,
+            cfd->ioptions()->compression_opts);
       }
+    } else {
+      c_iter->Next();
     }
-    c_iter->Next();
   }
 
   sub_compact->num_input_records = c_iter_stats.num_input_records;
@@ -865,8 +922,15 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = Status::ShutdownInProgress(
         "Database shutdown or Column family drop during compaction");
   }
+  if (status.ok() && sub_compact->builder == nullptr &&
+      sub_compact->outputs.empty() && !range_del_agg.IsEmpty()) {
+    // The subcompaction's input may consist of range tombstones only. An
+    // output file left without entries is dropped again when finished.
+    status = OpenCompactionOutputFile(sub_compact);
+  }
   if (status.ok() && sub_compact->builder != nullptr) {
-    status = FinishCompactionOutputFile(input->status(), sub_compact);
+    status = FinishCompactionOutputFile(input->status(), sub_compact,
+                                        &range_del_agg);
   }
   if (status.ok()) {
     status = input->status();
@@ -917,7 +981,8 @@ void CompactionJob::RecordDroppedKeys(
 }
 
 Status CompactionJob::FinishCompactionOutputFile(
-    const Status& input_status, SubcompactionState* sub_compact) {
+    const Status& input_status, SubcompactionState* sub_compact,
+    RangeDelAggregator* range_del_agg, const Slice* next_table_min_key) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_SYNC_FILE);
   assert(sub_compact != nullptr);
@@ -932,8 +997,47 @@ Status CompactionJob::FinishCompactionOutputFile(
   // Check for iterator errors
   Status s = input_status;
   auto meta = &sub_compact->current_output()->meta;
+  if (s.ok() && range_del_agg != nullptr && !range_del_agg->IsEmpty()) {
+    Slice lower_bound_guard, upper_bound_guard;
+    const Slice* lower_bound;
+    const Slice* upper_bound;
+    if (sub_compact->outputs.size() == 1) {
+      // The first output file also takes the tombstones between the
+      // subcompaction's start and its smallest key.
+      lower_bound = sub_compact->start;
+    } else if (meta->smallest.size() > 0) {
+      // The previous output file took the tombstones before this file's
+      // smallest key.
+      lower_bound_guard = meta->smallest.user_key();
+      lower_bound = &lower_bound_guard;
+    } else {
+      lower_bound = nullptr;
+    }
+    if (next_table_min_key != nullptr) {
+      // The next output file takes the tombstones from its smallest key on.
+      upper_bound_guard = ExtractUserKey(*next_table_min_key);
+      upper_bound = &upper_bound_guard;
+    } else {
+      upper_bound = sub_compact->end;
+    }
+    range_del_agg->AddToBuilder(sub_compact->builder.get(), lower_bound,
+                                upper_bound, meta, bottommost_level_);
+  }
   const uint64_t current_entries = sub_compact->builder->NumEntries();
   meta->marked_for_compaction = sub_compact->builder->NeedCompact();
+  if (s.ok() && current_entries == 0) {
+    // Only range tombstones that belong to other files were seen, so no
+    // table is generated.
+    sub_compact->builder->Abandon();
+    sub_compact->builder.reset();
+    sub_compact->outfile.reset();
+    env_->DeleteFile(TableFileName(db_options_.db_paths, meta->fd.GetNumber(),
+                                   meta->fd.GetPathId()));
+    // Also remove the file from outputs, or it would be added to the
+    // VersionEdit.
+    sub_compact->outputs.pop_back();
+    return s;
+  }
   if (s.ok()) {
     s = sub_compact->builder->Finish();
   } else {
@@ -977,6 +1081,9 @@ Status CompactionJob::FinishCompactionOutputFile(
       tp = sub_compact->builder->GetTableProperties();
       sub_compact->current_output()->table_properties =
           std::make_shared<TableProperties>(tp);
+      if (db_options_.skip_table_open_on_db_open) {
+        meta->SetTableStats(tp);
+      }
       Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
           "[%s] [JOB %d] Generated table #%" PRIu64 ": %" PRIu64
           " keys, %" PRIu64 " bytes%s",
@@ -1118,11 +1225,29 @@ Status CompactionJob::OpenCompactionOutputFile(
       cfd->int_tbl_prop_collector_factories(), cfd->GetID(), cfd->GetName(),
       sub_compact->outfile.get(), sub_compact->compaction->output_compression(),
       cfd->ioptions()->compression_opts, &sub_compact->compression_dict,
-      skip_filters));
+      skip_filters, oldest_input_creation_time_));
   LogFlush(db_options_.info_log);
   return s;
 }
 
+uint64_t CompactionJob::GetOldestInputCreationTime() const {
+  auto* c = compact_->compaction;
+  uint64_t oldest = port::kMaxUint64;
+  for (size_t i = 0; i < c->num_input_levels(); i++) {
+    for (const FileMetaData* f : *c->inputs(i)) {
+      // Only look at the table readers already pinned, which is the case for
+      // all files when max_open_files is -1, to save table cache lookups
+      TableReader* reader = f->fd.table_reader;
+      if (reader == nullptr || reader->GetTableProperties() == nullptr ||
+          reader->GetTableProperties()->creation_time == 0) {
+        return 0;
+      }
+      oldest = std::min(oldest, reader->GetTableProperties()->creation_time);
+    }
+  }
+  return oldest == port::kMaxUint64 ? 0 : oldest;
+}
+
 void CompactionJob::CleanupCompaction() {
   for (SubcompactionState& sub_compact : compact_->sub_compact_states) {
     const auto& sub_status = sub_compact.status;
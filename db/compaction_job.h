@@ -93,11 +93,19 @@ class CompactionJob {
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
 
+  // next_table_min_key is the first key of the subcompaction's next output
+  // file, or nullptr if the current output is its last file. The range
+  // tombstones of range_del_agg up to that key are added to the output.
   Status FinishCompactionOutputFile(const Status& input_status,
-                                    SubcompactionState* sub_compact);
+                                    SubcompactionState* sub_compact,
+                                    RangeDelAggregator* range_del_agg,
+                                    const Slice* next_table_min_key = nullptr);
   Status InstallCompactionResults(const MutableCFOptions& mutable_cf_options);
   void RecordCompactionIOStats();
   Status OpenCompactionOutputFile(SubcompactionState* sub_compact);
+  // Returns the earliest creation time of the input files, or 0 if that of
+  // any input file is unknown or its table reader isn't pinned
+  uint64_t GetOldestInputCreationTime() const;
   void CleanupCompaction();
   void UpdateCompactionJobStats(
     const InternalStats::CompactionStats& stats) const;
@@ -152,6 +160,12 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<Slice> boundaries_;
+  // Owns the keys sampled from inside input files that boundaries_ may point
+  // to
+  std::vector<std::string> key_anchors_;
+  // The creation time recorded in the output files: that of the oldest input
+  // file, or 0 if it is unknown
+  uint64_t oldest_input_creation_time_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
 };
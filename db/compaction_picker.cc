@@ -21,6 +21,7 @@
 
 #include "db/column_family.h"
 #include "db/filename.h"
+#include "table/table_reader.h"
 #include "util/log_buffer.h"
 #include "util/random.h"
 #include "util/statistics.h"
@@ -38,6 +39,44 @@ uint64_t TotalCompensatedFileSize(const std::vector<FileMetaData*>& files) {
   return sum;
 }
 
+// Looks for a span of the newest L0 files, none of them being compacted, to
+// merge into a single L0 file. The files are ordered newest first, and only a
+// span starting at the newest file keeps the output ordered by sequence
+// number among the rest. Files are added as long as the bytes rewritten per
+// file removed don't grow, which keeps a large file from being merged over
+// and over. Returns false if the span has fewer than min_files_to_compact
+// files, or if it rewrites max_compact_bytes_per_del_file or more per file
+// removed.
+bool FindIntraL0Compaction(const std::vector<FileMetaData*>& level_files,
+                           size_t min_files_to_compact,
+                           uint64_t max_compact_bytes_per_del_file,
+                           CompactionInputFiles* inputs) {
+  if (level_files.empty() || level_files[0]->being_compacted) {
+    return false;
+  }
+  uint64_t compact_bytes = level_files[0]->fd.GetFileSize();
+  uint64_t compact_bytes_per_del_file = port::kMaxUint64;
+  size_t span_len;
+  for (span_len = 1; span_len < level_files.size(); ++span_len) {
+    if (level_files[span_len]->being_compacted) {
+      break;
+    }
+    compact_bytes += level_files[span_len]->fd.GetFileSize();
+    uint64_t new_compact_bytes_per_del_file = compact_bytes / span_len;
+    if (new_compact_bytes_per_del_file > compact_bytes_per_del_file) {
+      break;
+    }
+    compact_bytes_per_del_file = new_compact_bytes_per_del_file;
+  }
+  if (span_len < min_files_to_compact ||
+      compact_bytes_per_del_file >= max_compact_bytes_per_del_file) {
+    return false;
+  }
+  inputs->level = 0;
+  inputs->files.assign(level_files.begin(), level_files.begin() + span_len);
+  return true;
+}
+
 // Universal compaction is not supported in ROCKSDB_LITE
 #ifndef ROCKSDB_LITE
 
@@ -957,6 +996,14 @@ Compaction* LevelCompactionPicker::PickCompaction(
         inputs.clear();
         if (level == 0) {
           skipped_l0 = true;
+          // L0->base_level is blocked by a running compaction. Merge the
+          // newest L0 files among themselves meanwhile to keep the number of
+          // L0 files, hence the read amplification, down.
+          if (PickIntraL0Compaction(vstorage, mutable_cf_options, &inputs)) {
+            output_level = 0;
+            compaction_reason = CompactionReason::kLevelL0FilesNum;
+            break;
+          }
         }
       }
     }
@@ -981,7 +1028,7 @@ Compaction* LevelCompactionPicker::PickCompaction(
 
   // Two level 0 compaction won't run at the same time, so don't need to worry
   // about files on level 0 being compacted.
-  if (level == 0) {
+  if (level == 0 && output_level != 0) {
     assert(level0_compactions_in_progress_.empty());
     InternalKey smallest, largest;
     GetRange(inputs, &smallest, &largest);
@@ -997,15 +1044,25 @@ Compaction* LevelCompactionPicker::PickCompaction(
     GetRange(inputs, &smallest, &largest);
     if (RangeInCompaction(vstorage, &smallest, &largest, output_level,
                           &parent_index)) {
-      return nullptr;
+      inputs.clear();
+      if (is_manual ||
+          !PickIntraL0Compaction(vstorage, mutable_cf_options, &inputs)) {
+        return nullptr;
+      }
+      output_level = 0;
     }
     assert(!inputs.files.empty());
   }
 
+  // An intra-L0 compaction writes a single file back to L0, so it has no
+  // output level inputs and no grandparents to cut its output at.
+  const bool intra_l0 = (output_level == 0);
+
   // Setup input files from output level
   CompactionInputFiles output_level_inputs;
   output_level_inputs.level = output_level;
-  if (!SetupOtherInputs(cf_name, mutable_cf_options, vstorage, &inputs,
+  if (!intra_l0 &&
+      !SetupOtherInputs(cf_name, mutable_cf_options, vstorage, &inputs,
                         &output_level_inputs, &parent_index, base_index)) {
     return nullptr;
   }
@@ -1016,11 +1073,14 @@ Compaction* LevelCompactionPicker::PickCompaction(
   }
 
   std::vector<FileMetaData*> grandparents;
-  GetGrandparents(vstorage, inputs, output_level_inputs, &grandparents);
+  if (!intra_l0) {
+    GetGrandparents(vstorage, inputs, output_level_inputs, &grandparents);
+  }
   auto c = new Compaction(
       vstorage, mutable_cf_options, std::move(compaction_inputs), output_level,
-      mutable_cf_options.MaxFileSizeForLevel(output_level),
-      mutable_cf_options.MaxGrandParentOverlapBytes(level),
+      intra_l0 ? port::kMaxUint64
+               : mutable_cf_options.MaxFileSizeForLevel(output_level),
+      intra_l0 ? LLONG_MAX : mutable_cf_options.MaxGrandParentOverlapBytes(level),
       GetPathId(ioptions_, mutable_cf_options, output_level),
       GetCompressionType(ioptions_, vstorage, mutable_cf_options, output_level,
                          vstorage->base_level()),
@@ -1044,6 +1104,20 @@ Compaction* LevelCompactionPicker::PickCompaction(
   return c;
 }
 
+bool LevelCompactionPicker::PickIntraL0Compaction(
+    VersionStorageInfo* vstorage, const MutableCFOptions& mutable_cf_options,
+    CompactionInputFiles* inputs) {
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(0);
+  // Only worth it once L0 has grown a few files past the compaction trigger
+  if (level_files.size() <
+      static_cast<size_t>(
+          mutable_cf_options.level0_file_num_compaction_trigger + 2)) {
+    return false;
+  }
+  return FindIntraL0Compaction(level_files, kMinFilesForIntraL0Compaction,
+                               port::kMaxUint64, inputs);
+}
+
 /*
  * Find the optimal path to place a file
  * Given a level, finds the path where levels up to it will fit in levels
@@ -1765,16 +1839,92 @@ Compaction* UniversalCompactionPicker::PickCompactionUniversalSizeAmp(
       CompactionReason::kUniversalSizeAmplification);
 }
 
+namespace {
+// Returns the creation time recorded in the table properties of f, or 0 if
+// it is unknown. Only files whose table reader is pinned, which is the case
+// for all files with max_open_files = -1, are looked at, as this is called
+// with the DB mutex held.
+uint64_t GetFileCreationTime(const FileMetaData* f) {
+  if (f->fd.table_reader == nullptr) {
+    return 0;
+  }
+  auto props = f->fd.table_reader->GetTableProperties();
+  return props != nullptr ? props->creation_time : 0;
+}
+
+// Returns true if f was created more than ttl seconds before current_time
+bool IsFileExpired(const FileMetaData* f, uint64_t ttl,
+                   uint64_t current_time) {
+  uint64_t creation_time = GetFileCreationTime(f);
+  return creation_time > 0 && current_time >= ttl &&
+         creation_time < current_time - ttl;
+}
+}  // namespace
+
 bool FIFOCompactionPicker::NeedsCompaction(
     const VersionStorageInfo* vstorage) const {
   const int kLevel0 = 0;
-  return vstorage->CompactionScore(kLevel0) >= 1;
+  if (vstorage->CompactionScore(kLevel0) >= 1) {
+    return true;
+  }
+  const uint64_t ttl = ioptions_.compaction_options_fifo.ttl;
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(kLevel0);
+  if (ttl == 0 || level_files.empty()) {
+    return false;
+  }
+  // The oldest file expires first
+  int64_t current_time;
+  if (!ioptions_.env->GetCurrentTime(&current_time).ok()) {
+    return false;
+  }
+  return IsFileExpired(level_files.back(), ttl,
+                       static_cast<uint64_t>(current_time));
 }
 
-Compaction* FIFOCompactionPicker::PickCompaction(
+Compaction* FIFOCompactionPicker::PickTTLCompaction(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage, LogBuffer* log_buffer) {
+  const uint64_t ttl = ioptions_.compaction_options_fifo.ttl;
+  assert(ttl > 0);
+  const int kLevel0 = 0;
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(kLevel0);
+  int64_t current_time;
+  Status s = ioptions_.env->GetCurrentTime(&current_time);
+  if (!s.ok()) {
+    LogToBuffer(log_buffer,
+                "[%s] FIFO compaction: Couldn't get current time: %s. "
+                "Not doing compactions based on TTL.",
+                cf_name.c_str(), s.ToString().c_str());
+    return nullptr;
+  }
+
+  std::vector<CompactionInputFiles> inputs;
+  inputs.emplace_back();
+  inputs[0].level = 0;
+  // delete the expired files, oldest first
+  for (auto ritr = level_files.rbegin(); ritr != level_files.rend(); ++ritr) {
+    auto f = *ritr;
+    if (!IsFileExpired(f, ttl, static_cast<uint64_t>(current_time))) {
+      break;
+    }
+    inputs[0].files.push_back(f);
+    LogToBuffer(log_buffer, "[%s] FIFO compaction: picking file %" PRIu64
+                            " with creation time %" PRIu64 " for deletion",
+                cf_name.c_str(), f->fd.GetNumber(), GetFileCreationTime(f));
+  }
+  if (inputs[0].files.empty()) {
+    return nullptr;
+  }
+
+  return new Compaction(
+      vstorage, mutable_cf_options, std::move(inputs), 0, 0, 0, 0,
+      kNoCompression, {}, /* is manual */ false, vstorage->CompactionScore(0),
+      /* is deletion compaction */ true, CompactionReason::kFIFOTtl);
+}
+
+Compaction* FIFOCompactionPicker::PickSizeCompaction(
     const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
     VersionStorageInfo* vstorage, LogBuffer* log_buffer) {
-  assert(vstorage->num_levels() == 1);
   const int kLevel0 = 0;
   const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(kLevel0);
   uint64_t total_size = 0;
@@ -1785,6 +1935,35 @@ Compaction* FIFOCompactionPicker::PickCompaction(
   if (total_size <= ioptions_.compaction_options_fifo.max_table_files_size ||
       level_files.size() == 0) {
     // total size not exceeded
+    if (ioptions_.compaction_options_fifo.allow_compaction &&
+        level_files.size() > 0) {
+      // Merge the newest files if they are about the size of a flush, so that
+      // files merged before aren't merged again
+      CompactionInputFiles comp_inputs;
+      if (FindIntraL0Compaction(
+              level_files,
+              static_cast<size_t>(std::max(
+                  mutable_cf_options.level0_file_num_compaction_trigger, 2)),
+              static_cast<uint64_t>(mutable_cf_options.write_buffer_size *
+                                    1.1),
+              &comp_inputs)) {
+        LogToBuffer(log_buffer,
+                    "[%s] FIFO compaction: merging %" ROCKSDB_PRIszt
+                    " files. Total size %" PRIu64 ", max size %" PRIu64 "\n",
+                    cf_name.c_str(), comp_inputs.size(), total_size,
+                    ioptions_.compaction_options_fifo.max_table_files_size);
+        return new Compaction(
+            vstorage, mutable_cf_options, {comp_inputs}, 0,
+            port::kMaxUint64 /* a single output file */,
+            LLONG_MAX /* max_grandparent_overlap_bytes */,
+            0 /* output_path_id */,
+            GetCompressionType(ioptions_, vstorage, mutable_cf_options, 0,
+                               vstorage->base_level()),
+            {}, /* is manual */ false, vstorage->CompactionScore(0),
+            /* is deletion compaction */ false,
+            CompactionReason::kFIFOReduceNumFiles);
+      }
+    }
     LogToBuffer(log_buffer,
                 "[%s] FIFO compaction: nothing to do. Total size %" PRIu64
                 ", max size %" PRIu64 "\n",
@@ -1793,14 +1972,6 @@ Compaction* FIFOCompactionPicker::PickCompaction(
     return nullptr;
   }
 
-  if (!level0_compactions_in_progress_.empty()) {
-    LogToBuffer(log_buffer,
-                "[%s] FIFO compaction: Already executing compaction. No need "
-                "to run parallel compactions since compactions are very fast",
-                cf_name.c_str());
-    return nullptr;
-  }
-
   std::vector<CompactionInputFiles> inputs;
   inputs.emplace_back();
   inputs[0].level = 0;
@@ -1818,11 +1989,35 @@ Compaction* FIFOCompactionPicker::PickCompaction(
       break;
     }
   }
-  Compaction* c = new Compaction(
+  return new Compaction(
       vstorage, mutable_cf_options, std::move(inputs), 0, 0, 0, 0,
       kNoCompression, {}, /* is manual */ false, vstorage->CompactionScore(0),
       /* is deletion compaction */ true, CompactionReason::kFIFOMaxSize);
-  level0_compactions_in_progress_.insert(c);
+}
+
+Compaction* FIFOCompactionPicker::PickCompaction(
+    const std::string& cf_name, const MutableCFOptions& mutable_cf_options,
+    VersionStorageInfo* vstorage, LogBuffer* log_buffer) {
+  assert(vstorage->num_levels() == 1);
+
+  if (!level0_compactions_in_progress_.empty()) {
+    LogToBuffer(log_buffer,
+                "[%s] FIFO compaction: Already executing compaction. No need "
+                "to run parallel compactions since compactions are very fast",
+                cf_name.c_str());
+    return nullptr;
+  }
+
+  Compaction* c = nullptr;
+  if (ioptions_.compaction_options_fifo.ttl > 0) {
+    c = PickTTLCompaction(cf_name, mutable_cf_options, vstorage, log_buffer);
+  }
+  if (c == nullptr) {
+    c = PickSizeCompaction(cf_name, mutable_cf_options, vstorage, log_buffer);
+  }
+  if (c != nullptr) {
+    level0_compactions_in_progress_.insert(c);
+  }
   return c;
 }
 
@@ -213,6 +213,15 @@ class LevelCompactionPicker : public CompactionPicker {
                                                 VersionStorageInfo* vstorage,
                                                 CompactionInputFiles* inputs,
                                                 int* level, int* output_level);
+
+  // For when L0->base_level can't run: pick a span of the newest L0 files,
+  // none of them being compacted, to merge into a single L0 file. Returns
+  // false if there are too few such files for it to pay off.
+  bool PickIntraL0Compaction(VersionStorageInfo* vstorage,
+                             const MutableCFOptions& mutable_cf_options,
+                             CompactionInputFiles* inputs);
+
+  static const size_t kMinFilesForIntraL0Compaction = 4;
 };
 
 #ifndef ROCKSDB_LITE
@@ -307,6 +316,21 @@ class FIFOCompactionPicker : public CompactionPicker {
 
   virtual bool NeedsCompaction(
       const VersionStorageInfo* vstorage) const override;
+
+ private:
+  // Picks the files older than compaction_options_fifo.ttl for deletion
+  Compaction* PickTTLCompaction(const std::string& cf_name,
+                                const MutableCFOptions& mutable_cf_options,
+                                VersionStorageInfo* version,
+                                LogBuffer* log_buffer);
+
+  // Picks the oldest files for deletion if the files are too large in total,
+  // or else, with compaction_options_fifo.allow_compaction, the newest small
+  // files to merge
+  Compaction* PickSizeCompaction(const std::string& cf_name,
+                                 const MutableCFOptions& mutable_cf_options,
+                                 VersionStorageInfo* version,
+                                 LogBuffer* log_buffer);
 };
 
 class NullCompactionPicker : public CompactionPicker {
@@ -788,6 +788,74 @@ TEST_F(CompactionPickerTest, NotScheduleL1IfL0WithHigherPri3) {
   ASSERT_TRUE(compaction.get() != nullptr);
 }
 
+TEST_F(CompactionPickerTest, IntraL0WhenL0ToL1Blocked) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+
+  // 6 L0 files of similar size, newest first
+  Add(0, 1U, "100", "150", 200000U, 0, 160, 161);
+  Add(0, 2U, "100", "150", 200000U, 0, 140, 141);
+  Add(0, 3U, "100", "150", 200000U, 0, 120, 121);
+  Add(0, 4U, "100", "150", 200000U, 0, 100, 101);
+  Add(0, 5U, "100", "150", 200000U, 0, 80, 81);
+  Add(0, 6U, "100", "150", 200000U, 0, 60, 61);
+  // L0->L1 is blocked by the L1 file being compacted
+  Add(1, 7U, "050", "300", 1000000U, 0, 0, 0);
+  file_map_[7u].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(CompactionReason::kLevelL0FilesNum,
+            compaction->compaction_reason());
+  ASSERT_EQ(1U, compaction->num_input_levels());
+  ASSERT_EQ(6U, compaction->num_input_files(0));
+  ASSERT_EQ(0, compaction->output_level());
+  ASSERT_FALSE(compaction->ShouldFormSubcompactions());
+}
+
+TEST_F(CompactionPickerTest, IntraL0StopsAtLargeOrBusyFile) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+
+  // Merging file 5 in would rewrite more bytes per file removed
+  Add(0, 1U, "100", "150", 200000U, 0, 160, 161);
+  Add(0, 2U, "100", "150", 200000U, 0, 140, 141);
+  Add(0, 3U, "100", "150", 200000U, 0, 120, 121);
+  Add(0, 4U, "100", "150", 200000U, 0, 100, 101);
+  Add(0, 5U, "100", "150", 10000000U, 0, 80, 81);
+  Add(0, 6U, "100", "150", 200000U, 0, 60, 61);
+  Add(1, 7U, "050", "300", 1000000U, 0, 0, 0);
+  file_map_[7u].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(4U, compaction->num_input_files(0));
+  ASSERT_EQ(0, compaction->output_level());
+  ASSERT_EQ(1U, compaction->input(0, 0)->fd.GetNumber());
+  ASSERT_EQ(4U, compaction->input(0, 3)->fd.GetNumber());
+
+  // With one of the newest files already being compacted, the span left is
+  // too short
+  NewVersionStorage(6, kCompactionStyleLevel);
+  Add(0, 1U, "100", "150", 200000U, 0, 160, 161);
+  Add(0, 2U, "100", "150", 200000U, 0, 140, 141);
+  Add(0, 3U, "100", "150", 200000U, 0, 120, 121);
+  Add(0, 4U, "100", "150", 200000U, 0, 100, 101);
+  Add(0, 5U, "100", "150", 200000U, 0, 80, 81);
+  Add(0, 6U, "100", "150", 200000U, 0, 60, 61);
+  Add(1, 7U, "050", "300", 1000000U, 0, 0, 0);
+  file_map_[3u].first->being_compacted = true;
+  file_map_[7u].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+  compaction.reset(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() == nullptr);
+}
+
 TEST_F(CompactionPickerTest, EstimateCompactionBytesNeeded1) {
   int num_levels = ioptions_.num_levels;
   ioptions_.level_compaction_dynamic_level_bytes = false;
@@ -141,6 +141,59 @@ TEST_F(DBBloomFilterTest, GetFilterByPrefixBloom) {
   ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 2);
 }
 
+TEST_F(DBBloomFilterTest, MemtableWholeKeyBloomFilter) {
+  Options options = last_options_;
+  options.memtable_prefix_bloom_size_ratio =
+      8.0 * 1024.0 / static_cast<double>(options.write_buffer_size);
+  options.memtable_whole_key_filtering = true;
+  DestroyAndReopen(options);
+  SetPerfLevel(kEnableCount);
+  perf_context.Reset();
+
+  // No prefix extractor: the filter holds the whole keys
+  ASSERT_OK(Put("AAAA", "v1"));
+  ASSERT_OK(Put("ZBRA", "v2"));
+  ASSERT_EQ("v1", Get("AAAA"));
+  ASSERT_EQ("v2", Get("ZBRA"));
+  ASSERT_EQ(2, perf_context.bloom_memtable_hit_count);
+  ASSERT_EQ(0, perf_context.bloom_memtable_miss_count);
+  ASSERT_EQ("NOT_FOUND", Get("RXDB"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_miss_count);
+
+  // With a prefix extractor, a missing key that shares a prefix with an
+  // existing one is still filtered out, and prefix seeks keep working.
+  options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+  DestroyAndReopen(options);
+  perf_context.Reset();
+  ASSERT_OK(Put("foo1", "v1"));
+  ASSERT_OK(Put("foo2", "v2"));
+  ASSERT_EQ("v1", Get("foo1"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_hit_count);
+  ASSERT_EQ("NOT_FOUND", Get("foo3"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_miss_count);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek("foo");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("foo1", iter->key().ToString());
+  iter->Seek("bar");
+  ASSERT_FALSE(iter->Valid() && iter->key().starts_with("bar"));
+  iter.reset();
+
+#ifndef ROCKSDB_LITE
+  // The option can be turned off dynamically. The next memtable only filters
+  // by prefix, so a missing key with an existing prefix gets searched.
+  ASSERT_OK(dbfull()->SetOptions({{"memtable_whole_key_filtering", "false"}}));
+  ASSERT_OK(Flush());
+  perf_context.Reset();
+  ASSERT_OK(Put("bar1", "v3"));
+  ASSERT_EQ("v3", Get("bar1"));
+  ASSERT_EQ("NOT_FOUND", Get("bar2"));
+  ASSERT_EQ(2, perf_context.bloom_memtable_hit_count);
+  ASSERT_EQ(0, perf_context.bloom_memtable_miss_count);
+#endif  // ROCKSDB_LITE
+  SetPerfLevel(kDisable);
+}
+
 TEST_F(DBBloomFilterTest, WholeKeyFilterProp) {
   Options options = last_options_;
   options.prefix_extractor.reset(NewFixedPrefixTransform(3));
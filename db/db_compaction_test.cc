@@ -253,6 +253,102 @@ TEST_F(DBCompactionTest, SkipStatsUpdateTest) {
   ASSERT_GT(env_->random_file_open_counter_.load(), kMaxFileOpenCount);
 }
 
+TEST_F(DBCompactionTest, SkipTableOpenOnDBOpen) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.max_open_files = -1;
+  options.skip_table_open_on_db_open = true;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // One compacted file moved to L2 by ReFitLevel(), one flushed file
+  // trivially moved to L1 and two flushed ones
+  for (int i = 0; i < 3; i++) {
+    for (int k = 0; k < 100; k++) {
+      ASSERT_OK(Put(Key(k), "v" + ToString(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  CompactRangeOptions cro;
+  cro.change_level = true;
+  cro.target_level = 2;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ("0,0,1", FilesPerLevel());
+
+  int trivial_moves = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:TrivialMove",
+      [&](void* arg) { trivial_moves++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  for (int k = 0; k < 100; k++) {
+    ASSERT_OK(Put(Key(300 + k), "v3"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  ASSERT_EQ(1, trivial_moves);
+  ASSERT_EQ("0,1,1", FilesPerLevel());
+
+  for (int i = 1; i < 3; i++) {
+    for (int k = 0; k < 100; k++) {
+      ASSERT_OK(Put(Key(i * 100 + k), "v" + ToString(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("2,1,1", FilesPerLevel());
+
+  // The second reopen reads the stats from a MANIFEST written by the first
+  for (int reopen = 0; reopen < 2; reopen++) {
+    env_->random_file_open_counter_.store(0);
+    Reopen(options);
+    // Neither the tables nor their properties were read, yet the stats of
+    // every file are there
+    ASSERT_EQ(0, env_->random_file_open_counter_.load());
+    uint64_t num_keys = 0;
+    ASSERT_TRUE(db_->GetIntProperty("rocksdb.estimate-num-keys", &num_keys));
+    ASSERT_EQ(400U, num_keys);
+  }
+
+  // Tables are opened on first access
+  ASSERT_EQ("v2", Get(Key(50)));
+  ASSERT_EQ(1, env_->random_file_open_counter_.load());
+  ASSERT_EQ("v1", Get(Key(150)));
+  ASSERT_EQ("v2", Get(Key(250)));
+  ASSERT_EQ(3, env_->random_file_open_counter_.load());
+  ASSERT_EQ("v3", Get(Key(350)));
+  ASSERT_EQ(4, env_->random_file_open_counter_.load());
+  ASSERT_EQ("v2", Get(Key(50)));
+  ASSERT_EQ(4, env_->random_file_open_counter_.load());
+}
+
+TEST_F(DBCompactionTest, NoTableStatsInManifestByDefault) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  // Without skip_table_open_on_db_open, no file is written in the
+  // kNewFile4 format that carries the stats, even when files are moved
+  int num_new_file4 = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "VersionEdit::EncodeTo:NewFile4:CustomizeFields",
+      [&](void* arg) { num_new_file4++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  for (int k = 0; k < 100; k++) {
+    ASSERT_OK(Put(Key(k), "v"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  CompactRangeOptions cro;
+  cro.change_level = true;
+  cro.target_level = 2;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  Reopen(options);
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_EQ(0, num_new_file4);
+  ASSERT_EQ("v", Get(Key(50)));
+}
+
 TEST_F(DBCompactionTest, TestTableReaderForCompaction) {
   Options options = CurrentOptions();
   options.env = env_;
@@ -2404,6 +2500,69 @@ TEST_F(DBCompactionTest, SuggestCompactRangeNoTwoLevel0Compactions) {
   dbfull()->TEST_WaitForCompact();
 }
 
+TEST_F(DBCompactionTest, IntraL0CompactionKeepsDeletions) {
+  Options options = CurrentOptions();
+  options.level0_file_num_compaction_trigger = 2;
+  options.num_levels = 3;
+  options.base_background_compactions = 2;
+  options.max_background_compactions = 2;
+  DestroyAndReopen(options);
+
+  // Hold the first compaction, L0->L1, until an intra-L0 compaction ran.
+  std::atomic<int> num_compactions(0);
+  std::atomic<int> num_intra_l0_compactions(0);
+  rocksdb::SyncPoint::GetInstance()->LoadDependency(
+      {{"DBCompactionTest::IntraL0:L0ToL1Started",
+        "DBCompactionTest::IntraL0:WaitForL0ToL1"},
+       {"DBImpl::BackgroundCompaction:NonTrivial:AfterRun",
+        "DBCompactionTest::IntraL0:ReleaseL0ToL1"},
+       {"DBCompactionTest::IntraL0:ReleaseL0ToL1",
+        "DBCompactionTest::IntraL0:BlockL0ToL1"}});
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Start", [&](void* /*arg*/) {
+        if (num_compactions.fetch_add(1) == 0) {
+          TEST_SYNC_POINT("DBCompactionTest::IntraL0:L0ToL1Started");
+          TEST_SYNC_POINT("DBCompactionTest::IntraL0:BlockL0ToL1");
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:NonTrivial", [&](void* arg) {
+        if (*static_cast<int*>(arg) == 0) {
+          num_intra_l0_compactions++;
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  const int kNumKeys = 10;
+  for (int num = 0; num < options.level0_file_num_compaction_trigger;
+       num++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(num)));
+    }
+    ASSERT_OK(Flush());
+  }
+  TEST_SYNC_POINT("DBCompactionTest::IntraL0:WaitForL0ToL1");
+
+  // The puts are being compacted to L1. Delete the keys in enough new L0
+  // files to have them merged among themselves meanwhile.
+  for (int num = 0; num < 4; num++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Delete(Key(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+  TEST_SYNC_POINT("DBCompactionTest::IntraL0:ReleaseL0ToL1");
+  dbfull()->TEST_WaitForCompact();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(1, num_intra_l0_compactions.load());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("NOT_FOUND", Get(Key(i)));
+  }
+  ASSERT_EQ("1,1", FilesPerLevel(0));
+}
+
 
 TEST_P(DBCompactionTestWithParam, ForceBottommostLevelCompaction) {
   int32_t trivial_move = 0;
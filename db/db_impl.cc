@@ -21,12 +21,16 @@
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstdio>
+#include <deque>
+#include <functional>
 #include <map>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -50,6 +54,7 @@
 #include "db/memtable_list.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
 #include "db/transaction_log_impl.h"
@@ -66,6 +71,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
@@ -194,6 +200,12 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
     result.db_paths.emplace_back(dbname, std::numeric_limits<uint64_t>::max());
   }
 
+  if (result.use_direct_reads && result.compaction_readahead_size == 0) {
+    // Without the page cache, compaction inputs would otherwise be read one
+    // block at a time.
+    result.compaction_readahead_size = 1024 * 1024 * 2;
+  }
+
   if (result.compaction_readahead_size > 0) {
     result.new_table_reader_for_compaction_inputs = true;
   }
@@ -205,6 +217,10 @@ DBOptions SanitizeOptions(const std::string& dbname, const DBOptions& src) {
     result.avoid_flush_during_recovery = false;
   }
 
+  if (result.wal_recovery_threads < 1) {
+    result.wal_recovery_threads = 1;
+  }
+
   return result;
 }
 
@@ -233,6 +249,9 @@ static Status ValidateOptions(
     if (s.ok() && db_options.allow_concurrent_memtable_write) {
       s = CheckConcurrentWritesSupported(cfd.options);
     }
+    if (s.ok()) {
+      s = CheckCompactionOptionsSupported(db_options, cfd.options);
+    }
     if (!s.ok()) {
       return s;
     }
@@ -258,6 +277,20 @@ static Status ValidateOptions(
         "then os caching (allow_os_buffer) must also be enabled. ");
   }
 
+  if (db_options.allow_mmap_reads && db_options.use_direct_reads) {
+    return Status::NotSupported(
+        "If memory mapped reads (allow_mmap_reads) are enabled "
+        "then direct reads (use_direct_reads) must be disabled. ");
+  }
+
+  if (db_options.allow_mmap_writes &&
+      db_options.use_direct_io_for_flush_and_compaction) {
+    return Status::NotSupported(
+        "If memory mapped writes (allow_mmap_writes) are enabled "
+        "then direct I/O writes (use_direct_io_for_flush_and_compaction) "
+        "must be disabled. ");
+  }
+
   return Status::OK();
 }
 
@@ -322,7 +355,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       write_thread_(options.enable_write_thread_adaptive_yield
                         ? options.write_thread_max_yield_usec
                         : 0,
-                    options.write_thread_slow_yield_usec),
+                    options.write_thread_slow_yield_usec,
+                    options.enable_pipelined_write),
       write_controller_(options.delayed_write_rate),
       last_batch_group_size_(0),
       unscheduled_flushes_(0),
@@ -340,6 +374,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       next_job_id_(1),
       has_unpersisted_data_(false),
       env_options_(db_options_),
+      env_options_for_compaction_(
+          env_->OptimizeForCompactionTableWrite(env_options_, db_options_)),
 #ifndef ROCKSDB_LITE
       wal_manager_(db_options_, env_options_),
 #endif  // ROCKSDB_LITE
@@ -1322,6 +1358,118 @@ Status DBImpl::Recover(
   return s;
 }
 
+namespace {
+// Reads the records of a log file on a background thread into a bounded
+// queue, so that reading and checksumming the log overlaps with inserting
+// its records into the memtables.
+class LogRecordPrefetcher {
+ public:
+  // read_status is the status the reader's reporter records corruptions in,
+  // nullptr if corruptions are ignored
+  LogRecordPrefetcher(log::Reader* reader, WALRecoveryMode recovery_mode,
+                      const Status* read_status)
+      : reader_(reader),
+        recovery_mode_(recovery_mode),
+        read_status_(read_status),
+        cv_(&mu_),
+        buffered_bytes_(0),
+        done_(false),
+        stop_(false),
+        thread_(&LogRecordPrefetcher::BackgroundRead, this) {}
+
+  ~LogRecordPrefetcher() {
+    {
+      MutexLock l(&mu_);
+      stop_ = true;
+      cv_.SignalAll();
+    }
+    thread_.join();
+  }
+
+  // Same contract as log::Reader::ReadRecord(). Once it returns false,
+  // *read_status tells whether the log ended because of a corruption.
+  bool ReadRecord(Slice* record, std::string* scratch) {
+    MutexLock l(&mu_);
+    while (records_.empty() && !done_) {
+      cv_.Wait();
+    }
+    if (records_.empty()) {
+      return false;
+    }
+    scratch->swap(records_.front());
+    records_.pop_front();
+    buffered_bytes_ -= scratch->size();
+    cv_.SignalAll();
+    *record = Slice(*scratch);
+    return true;
+  }
+
+ private:
+  static const size_t kMaxBufferedBytes = 8 << 20;
+
+  void BackgroundRead() {
+    std::string scratch;
+    Slice record;
+    while (reader_->ReadRecord(&record, &scratch, recovery_mode_) &&
+           (read_status_ == nullptr || read_status_->ok())) {
+      std::string buffered(record.data(), record.size());
+      MutexLock l(&mu_);
+      while (buffered_bytes_ >= kMaxBufferedBytes && !stop_) {
+        cv_.Wait();
+      }
+      if (stop_) {
+        break;
+      }
+      buffered_bytes_ += buffered.size();
+      records_.push_back(std::move(buffered));
+      cv_.SignalAll();
+    }
+    MutexLock l(&mu_);
+    done_ = true;
+    cv_.SignalAll();
+  }
+
+  log::Reader* reader_;
+  const WALRecoveryMode recovery_mode_;
+  const Status* read_status_;
+  port::Mutex mu_;
+  port::CondVar cv_;
+  std::deque<std::string> records_;
+  size_t buffered_bytes_;
+  bool done_;
+  bool stop_;
+  std::thread thread_;
+};
+
+// Accepts the batches that MemTableInserter can apply concurrently: merges
+// may read the memtable and prepared sections rebuild transactions, so they
+// are rejected like the records that don't parse.
+class ConcurrentRecoveryChecker : public WriteBatch::Handler {
+ public:
+  virtual Status PutCF(uint32_t /*column_family_id*/, const Slice& /*key*/,
+                       const Slice& /*value*/) override {
+    return Status::OK();
+  }
+  virtual Status DeleteCF(uint32_t /*column_family_id*/,
+                          const Slice& /*key*/) override {
+    return Status::OK();
+  }
+  virtual Status SingleDeleteCF(uint32_t /*column_family_id*/,
+                                const Slice& /*key*/) override {
+    return Status::OK();
+  }
+  virtual Status DeleteRangeCF(uint32_t /*column_family_id*/,
+                               const Slice& /*begin_key*/,
+                               const Slice& /*end_key*/) override {
+    return Status::OK();
+  }
+  virtual Status MergeCF(uint32_t /*column_family_id*/, const Slice& /*key*/,
+                         const Slice& /*value*/) override {
+    return Status::NotSupported();
+  }
+};
+}  // namespace
+
 // REQUIRES: log_numbers are sorted in ascending order
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
                                SequenceNumber* next_sequence, bool read_only) {
@@ -1384,6 +1532,25 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
   bool stop_replay_for_corruption = false;
   bool flushed = false;
   SequenceNumber recovered_sequence = 0;
+  // With wal_recovery_threads > 1 every log is read on a background thread.
+  // If the memtables also take concurrent inserts, batches are queued up and
+  // applied by several threads at once.
+  const bool prefetch_records = db_options_.wal_recovery_threads > 1;
+  const bool concurrent_inserts =
+      prefetch_records && db_options_.allow_concurrent_memtable_write;
+  const size_t kMaxPendingBatchBytes = 1 << 20;
+  struct PendingBatch {
+    WriteBatch batch;
+    size_t record_size;
+    Status status;
+    // Whether the batch can be inserted concurrently with the others
+    bool concurrent;
+  };
+  std::vector<PendingBatch> pending_batches;
+  size_t pending_bytes = 0;
+  uint64_t total_records = 0;
+  uint64_t total_bytes = 0;
+  const uint64_t recovery_start_micros = env_->NowMicros();
   for (auto log_number : log_numbers) {
     // The previous incarnation may not have written any MANIFEST
     // records after allocating this log number.  So we manually
@@ -1411,7 +1578,8 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     unique_ptr<SequentialFileReader> file_reader;
     {
       unique_ptr<SequentialFile> file;
-      status = env_->NewSequentialFile(fname, &file, env_options_);
+      status = env_->NewSequentialFile(fname, &file,
+                                       env_->OptimizeForLogRead(env_options_));
       if (!status.ok()) {
         MaybeIgnoreError(&status);
         if (!status.ok()) {
@@ -1437,23 +1605,195 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     } else {
       reporter.status = &status;
     }
+    // A background reader reports corruptions into a status of its own,
+    // which is taken over once all the records before them were replayed
+    Status read_status;
+    LogReporter read_reporter = reporter;
+    if (prefetch_records && reporter.status != nullptr) {
+      read_reporter.status = &read_status;
+    }
     // We intentially make log::Reader do checksumming even if
     // paranoid_checks==false so that corruptions cause entire commits
     // to be skipped instead of propagating bad information (like overly
     // large sequence numbers).
-    log::Reader reader(db_options_.info_log, std::move(file_reader), &reporter,
-                       true /*checksum*/, 0 /*initial_offset*/, log_number);
+    log::Reader reader(db_options_.info_log, std::move(file_reader),
+                       &read_reporter, true /*checksum*/, 0 /*initial_offset*/,
+                       log_number);
+    std::unique_ptr<LogRecordPrefetcher> prefetcher;
+    if (prefetch_records) {
+      prefetcher.reset(new LogRecordPrefetcher(
+          &reader, db_options_.wal_recovery_mode, read_reporter.status));
+    }
 
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
     std::string scratch;
     Slice record;
     WriteBatch batch;
+    auto read_record = [&]() {
+      if (prefetcher == nullptr) {
+        return reader.ReadRecord(&record, &scratch,
+                                 db_options_.wal_recovery_mode);
+      }
+      if (prefetcher->ReadRecord(&record, &scratch)) {
+        return true;
+      }
+      if (status.ok()) {
+        status = read_status;
+      }
+      return false;
+    };
 
-    while (
-        !stop_replay_by_wal_filter &&
-        reader.ReadRecord(&record, &scratch, db_options_.wal_recovery_mode) &&
-        status.ok()) {
+    // Flushes the memtables that filled up during the inserts. We can do
+    // this because this is called before client has access to the DB and
+    // there is only a single thread operating on DB
+    auto flush_scheduled_memtables = [&]() {
+      ColumnFamilyData* cfd;
+      while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+        cfd->Unref();
+        // If this asserts, it means that InsertInto failed in
+        // filtering updates to already-flushed column families
+        assert(cfd->GetLogNumber() <= log_number);
+        auto iter = version_edits.find(cfd->GetID());
+        assert(iter != version_edits.end());
+        VersionEdit* edit = &iter->second;
+        Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+        if (!s.ok()) {
+          return s;
+        }
+        flushed = true;
+
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               *next_sequence);
+      }
+      return Status::OK();
+    };
+
+    // Applies the pending batches in log order. Their sequence numbers were
+    // assigned when they were read, as if every record of a batch used one.
+    //
+    // The batches are first checked on several threads. Runs of batches that
+    // passed are then inserted from several threads too, each with its own
+    // ColumnFamilyMemTablesImpl as in the concurrent write path. A batch that
+    // didn't pass is inserted on this thread once the batches before it are
+    // in and none after it. If it doesn't use all of its sequence numbers,
+    // e.g. because it was cut short by an error that is ignored, the batches
+    // after it are moved down as the serial replay would. Insert errors are
+    // reported in status and stop the replay, flush errors are returned.
+    auto apply_pending_batches = [&]() {
+      if (pending_batches.empty()) {
+        return Status::OK();
+      }
+      size_t num_threads =
+          std::min(pending_batches.size(),
+                   static_cast<size_t>(db_options_.wal_recovery_threads));
+      TEST_SYNC_POINT_CALLBACK("DBImpl::RecoverLogFiles:ConcurrentInserts",
+                               &num_threads);
+      // Calls fn on the pending batches in [begin, end) from several threads
+      auto for_each_pending = [&](
+          size_t begin, size_t end,
+          const std::function<void(PendingBatch*, ColumnFamilyMemTablesImpl*)>&
+              fn) {
+        std::atomic<size_t> next_batch(begin);
+        auto run = [&]() {
+          ColumnFamilyMemTablesImpl column_family_memtables(
+              versions_->GetColumnFamilySet());
+          size_t i;
+          while ((i = next_batch.fetch_add(1)) < end) {
+            fn(&pending_batches[i], &column_family_memtables);
+          }
+        };
+        std::vector<std::thread> thread_pool;
+        for (size_t i = 1; i < std::min(end - begin, num_threads); i++) {
+          thread_pool.emplace_back(run);
+        }
+        // Always run on this thread as well
+        run();
+        for (auto& thread : thread_pool) {
+          thread.join();
+        }
+      };
+
+      for_each_pending(0, pending_batches.size(),
+                       [](PendingBatch* pending, ColumnFamilyMemTablesImpl*) {
+        ConcurrentRecoveryChecker checker;
+        pending->concurrent = pending->batch.Iterate(&checker).ok();
+      });
+      // status may hold a read error already, which follows these batches
+      bool insert_failed = false;
+      size_t begin = 0;
+      while (begin < pending_batches.size() && !insert_failed) {
+        size_t end = begin;
+        while (end < pending_batches.size() &&
+               pending_batches[end].concurrent) {
+          end++;
+        }
+        for_each_pending(begin, end, [&](PendingBatch* pending,
+                                         ColumnFamilyMemTablesImpl* memtables) {
+          pending->status = WriteBatchInternal::InsertInto(
+              &pending->batch, memtables, &flush_scheduler_, true, log_number,
+              this, true /* concurrent_memtable_writes */);
+        });
+        // The checked batches cannot fail to insert while missing column
+        // families are ignored, so this is a safety net. The whole run is in
+        // the memtables already.
+        for (size_t i = begin; i < end && !insert_failed; i++) {
+          Status s = pending_batches[i].status;
+          MaybeIgnoreError(&s);
+          if (!s.ok()) {
+            insert_failed = true;
+            status = s;
+            reporter.Corruption(pending_batches[i].record_size, s);
+            WriteBatch* last = &pending_batches[end - 1].batch;
+            *next_sequence = WriteBatchInternal::Sequence(last) +
+                             WriteBatchInternal::Count(last);
+          }
+        }
+        if (!insert_failed && end < pending_batches.size()) {
+          PendingBatch& pending = pending_batches[end];
+          const SequenceNumber sequence =
+              WriteBatchInternal::Sequence(&pending.batch);
+          SequenceNumber batch_next_sequence = sequence;
+          Status s = WriteBatchInternal::InsertInto(
+              &pending.batch, column_family_memtables_.get(),
+              &flush_scheduler_, true, log_number, this,
+              false /* concurrent_memtable_writes */, &batch_next_sequence);
+          MaybeIgnoreError(&s);
+          if (!s.ok()) {
+            // The replay stops here: the batches after this one are dropped
+            insert_failed = true;
+            status = s;
+            reporter.Corruption(pending.record_size, s);
+            *next_sequence = batch_next_sequence;
+          } else if (batch_next_sequence !=
+                     sequence + WriteBatchInternal::Count(&pending.batch)) {
+            for (size_t i = end + 1; i < pending_batches.size(); i++) {
+              WriteBatch* later = &pending_batches[i].batch;
+              WriteBatchInternal::SetSequence(later, batch_next_sequence);
+              batch_next_sequence += WriteBatchInternal::Count(later);
+            }
+            *next_sequence = batch_next_sequence;
+          }
+        }
+        if (!read_only) {
+          Status s = flush_scheduled_memtables();
+          if (!s.ok()) {
+            return s;
+          }
+        }
+        begin = end + 1;
+      }
+      pending_batches.clear();
+      pending_bytes = 0;
+      return Status::OK();
+    };
+
+    uint64_t log_records = 0;
+    uint64_t log_bytes = 0;
+    const uint64_t log_start_micros = env_->NowMicros();
+    while (!stop_replay_by_wal_filter && read_record() && status.ok()) {
+      log_records++;
+      log_bytes += record.size();
       if (record.size() < WriteBatchInternal::kHeader) {
         reporter.Corruption(record.size(),
                             Status::Corruption("log record too small"));
@@ -1560,6 +1900,33 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
 #endif  // ROCKSDB_LITE
 
+      if (concurrent_inserts && !no_prev_seq) {
+        // The records are only parsed when the batch is applied, so assume
+        // that each of them uses a sequence number, as they do unless the
+        // batch turns out to be corrupted or to have a prepared section
+        *next_sequence += WriteBatchInternal::Count(&batch);
+        pending_bytes += batch.GetDataSize();
+        pending_batches.push_back(
+            {std::move(batch), record.size(), Status(), false});
+        if (pending_bytes >= kMaxPendingBatchBytes) {
+          Status s = apply_pending_batches();
+          if (!s.ok()) {
+            return s;
+          }
+        }
+        continue;
+      }
+      {
+        // Everything else is inserted in log order
+        Status s = apply_pending_batches();
+        if (!s.ok()) {
+          return s;
+        }
+        if (!status.ok()) {
+          continue;
+        }
+      }
+
       // If column family was not found, it might mean that the WAL write
       // batch references to the column family that was dropped after the
       // insert. We don't want to fail the whole write batch in that case --
@@ -1586,31 +1953,32 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->Unref();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= log_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
-
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence);
+        status = flush_scheduled_memtables();
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
         }
       }
     }
+    // Stop reading ahead if the replay ended early
+    prefetcher.reset();
+    {
+      Status s = apply_pending_batches();
+      if (!s.ok()) {
+        return s;
+      }
+    }
+
+    uint64_t log_micros =
+        std::max<uint64_t>(env_->NowMicros() - log_start_micros, 1);
+    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+        "Recovered log #%" PRIu64 ": %" PRIu64 " records, %" PRIu64
+        " bytes in %.3f seconds, %.1f MB/s",
+        log_number, log_records, log_bytes, log_micros / 1000000.0,
+        log_bytes / 1048576.0 * 1000000.0 / log_micros);
+    total_records += log_records;
+    total_bytes += log_bytes;
 
     if (!status.ok()) {
       if (db_options_.wal_recovery_mode ==
@@ -1702,6 +2070,15 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
     }
   }
 
+  uint64_t recovery_micros =
+      std::max<uint64_t>(env_->NowMicros() - recovery_start_micros, 1);
+  Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+      "Recovered %" ROCKSDB_PRIszt " log files: %" PRIu64 " records, %" PRIu64
+      " bytes in %.3f seconds, %.1f MB/s (%d recovery threads)",
+      log_numbers.size(), total_records, total_bytes,
+      recovery_micros / 1000000.0,
+      total_bytes / 1048576.0 * 1000000.0 / recovery_micros,
+      db_options_.wal_recovery_threads);
   event_logger_.Log() << "job" << job_id << "event"
                       << "recovery_finished";
 
@@ -1741,14 +2118,17 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
           snapshots_.GetAll(&earliest_write_conflict_snapshot);
 
       s = BuildTable(
-          dbname_, env_, *cfd->ioptions(), mutable_cf_options, env_options_,
-          cfd->table_cache(), iter.get(), &meta, cfd->internal_comparator(),
+          dbname_, env_, *cfd->ioptions(), mutable_cf_options,
+          env_options_for_compaction_, cfd->table_cache(), iter.get(),
+          std::unique_ptr<InternalIterator>(mem->NewRangeTombstoneIterator(ro)),
+          &meta, cfd->internal_comparator(),
           cfd->int_tbl_prop_collector_factories(), cfd->GetID(), cfd->GetName(),
           snapshot_seqs, earliest_write_conflict_snapshot,
           GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
           cfd->ioptions()->compression_opts, paranoid_file_checks,
           cfd->internal_stats(), TableFileCreationReason::kRecovery,
-          &event_logger_, job_id);
+          &event_logger_, job_id, Env::IO_HIGH, &table_properties,
+          0 /* level */);
       LogFlush(db_options_.info_log);
       Log(InfoLogLevel::DEBUG_LEVEL, db_options_.info_log,
           "[%s] [WriteLevel0TableForRecovery]"
@@ -1764,10 +2144,10 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   // should not be added to the manifest.
   int level = 0;
   if (s.ok() && meta.fd.GetFileSize() > 0) {
-    edit->AddFile(level, meta.fd.GetNumber(), meta.fd.GetPathId(),
-                  meta.fd.GetFileSize(), meta.smallest, meta.largest,
-                  meta.smallest_seqno, meta.largest_seqno,
-                  meta.marked_for_compaction);
+    if (db_options_.skip_table_open_on_db_open) {
+      meta.SetTableStats(table_properties);
+    }
+    edit->AddFile(level, meta);
   }
 
   InternalStats::CompactionStats stats(1);
@@ -1836,9 +2216,9 @@ Status DBImpl::FlushMemTableToOutputFile(
       snapshots_.GetAll(&earliest_write_conflict_snapshot);
 
   FlushJob flush_job(
-      dbname_, cfd, db_options_, mutable_cf_options, env_options_,
-      versions_.get(), &mutex_, &shutting_down_, snapshot_seqs,
-      earliest_write_conflict_snapshot, job_context, log_buffer,
+      dbname_, cfd, db_options_, mutable_cf_options,
+      env_options_for_compaction_, versions_.get(), &mutex_, &shutting_down_,
+      snapshot_seqs, earliest_write_conflict_snapshot, job_context, log_buffer,
       directories_.GetDbDir(), directories_.GetDataDir(0U),
       GetCompressionFlush(*cfd->ioptions(), mutable_cf_options), stats_,
       &event_logger_, mutable_cf_options.report_bg_io_stats);
@@ -2202,8 +2582,8 @@ Status DBImpl::CompactFilesImpl(
 
   assert(is_snapshot_supported_ || snapshots_.empty());
   CompactionJob compaction_job(
-      job_context->job_id, c.get(), db_options_, env_options_, versions_.get(),
-      &shutting_down_, log_buffer, directories_.GetDbDir(),
+      job_context->job_id, c.get(), db_options_, env_options_for_compaction_,
+      versions_.get(), &shutting_down_, log_buffer, directories_.GetDbDir(),
       directories_.GetDataDir(c->output_path_id()), stats_, &mutex_, &bg_error_,
       snapshot_seqs, earliest_write_conflict_snapshot, table_cache_,
       &event_logger_, c->mutable_cf_options()->paranoid_file_checks,
@@ -2516,10 +2896,7 @@ Status DBImpl::ReFitLevel(ColumnFamilyData* cfd, int level, int target_level) {
     edit.SetColumnFamily(cfd->GetID());
     for (const auto& f : vstorage->LevelFiles(level)) {
       edit.DeleteFile(level, f->fd.GetNumber());
-      edit.AddFile(to_level, f->fd.GetNumber(), f->fd.GetPathId(),
-                   f->fd.GetFileSize(), f->smallest, f->largest,
-                   f->smallest_seqno, f->largest_seqno,
-                   f->marked_for_compaction);
+      edit.AddFile(to_level, *f);
     }
     Log(InfoLogLevel::DEBUG_LEVEL, db_options_.info_log,
         "[%s] Apply version edit:\n%s", cfd->GetName().c_str(),
@@ -2792,7 +3169,8 @@ InternalIterator* DBImpl::NewInternalIterator(
   SuperVersion* super_version = cfd->GetSuperVersion()->Ref();
   mutex_.Unlock();
   ReadOptions roptions;
-  return NewInternalIterator(roptions, cfd, super_version, arena);
+  return NewInternalIterator(roptions, cfd, super_version, arena,
+                             nullptr /* range_del_agg */);
 }
 
 Status DBImpl::FlushMemTable(ColumnFamilyData* cfd,
@@ -3174,6 +3552,15 @@ void DBImpl::BackgroundCallCompaction(void* arg) {
     InstrumentedMutexLock l(&mutex_);
     num_running_compactions_++;
 
+    if (db_options_.rate_limiter != nullptr) {
+      // An auto-tuned rate limiter keeps its rate up while we are behind.
+      if (write_controller_.NeedSpeedupCompaction()) {
+        db_options_.rate_limiter->ReportCompactionPressure();
+      }
+      MeasureTime(stats_, RATE_LIMITER_BYTES_PER_SEC,
+                  db_options_.rate_limiter->GetBytesPerSecond());
+    }
+
     auto pending_outputs_inserted_elem =
         CaptureCurrentFileNumberInPendingOutputs();
 
@@ -3420,10 +3807,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
       for (size_t i = 0; i < c->num_input_files(l); i++) {
         FileMetaData* f = c->input(l, i);
         c->edit()->DeleteFile(c->level(l), f->fd.GetNumber());
-        c->edit()->AddFile(c->output_level(), f->fd.GetNumber(),
-                           f->fd.GetPathId(), f->fd.GetFileSize(), f->smallest,
-                           f->largest, f->smallest_seqno, f->largest_seqno,
-                           f->marked_for_compaction);
+        c->edit()->AddFile(c->output_level(), *f);
 
         LogToBuffer(log_buffer,
                     "[%s] Moving #%" PRIu64 " to level-%d %" PRIu64 " bytes\n",
@@ -3472,7 +3856,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
 
     assert(is_snapshot_supported_ || snapshots_.empty());
     CompactionJob compaction_job(
-        job_context->job_id, c.get(), db_options_, env_options_,
+        job_context->job_id, c.get(), db_options_, env_options_for_compaction_,
         versions_.get(), &shutting_down_, log_buffer, directories_.GetDbDir(),
         directories_.GetDataDir(c->output_path_id()), stats_, &mutex_,
         &bg_error_, snapshot_seqs, earliest_write_conflict_snapshot,
@@ -3693,23 +4077,37 @@ static void CleanupIteratorState(void* arg1, void* arg2) {
 }
 }  // namespace
 
-InternalIterator* DBImpl::NewInternalIterator(const ReadOptions& read_options,
-                                              ColumnFamilyData* cfd,
-                                              SuperVersion* super_version,
-                                              Arena* arena) {
+InternalIterator* DBImpl::NewInternalIterator(
+    const ReadOptions& read_options, ColumnFamilyData* cfd,
+    SuperVersion* super_version, Arena* arena,
+    RangeDelAggregator* range_del_agg) {
   InternalIterator* internal_iter;
   assert(arena != nullptr);
+  Status s;
   // Need to create internal iterator from the arena.
   MergeIteratorBuilder merge_iter_builder(&cfd->internal_comparator(), arena);
   // Collect iterator for mutable mem
   merge_iter_builder.AddIterator(
       super_version->mem->NewIterator(read_options, arena));
+  if (range_del_agg != nullptr) {
+    s = range_del_agg->AddTombstones(std::unique_ptr<InternalIterator>(
+        super_version->mem->NewRangeTombstoneIterator(read_options)));
+  }
   // Collect all needed child iterators for immutable memtables
   super_version->imm->AddIterators(read_options, &merge_iter_builder);
+  if (range_del_agg != nullptr && s.ok()) {
+    s = super_version->imm->AddRangeTombstones(read_options, range_del_agg);
+  }
   // Collect iterators for files in L0 - Ln
   super_version->current->AddIterators(read_options, env_options_,
-                                       &merge_iter_builder);
+                                       &merge_iter_builder,
+                                       s.ok() ? range_del_agg : nullptr);
   internal_iter = merge_iter_builder.Finish();
+  if (!s.ok()) {
+    // Without the tombstones the iterator could surface deleted keys.
+    internal_iter->~InternalIterator();
+    internal_iter = NewErrorInternalIterator(s, arena);
+  }
   IterState* cleanup =
       new IterState(this, &mutex_, super_version,
                     read_options.background_purge_on_iterator_cleanup);
@@ -3800,6 +4198,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
   // Prepare to store a list of merge operations if merge occurs.
   MergeContext merge_context;
+  RangeDelAggregator range_del_agg(cfd->internal_comparator(), snapshot);
 
   Status s;
   // First look in the memtable, then in the immutable memtable (if any).
@@ -3812,10 +4211,11 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
       (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
   bool done = false;
   if (!skip_memtable) {
-    if (sv->mem->Get(lkey, value, &s, &merge_context)) {
+    if (sv->mem->Get(lkey, value, &s, &merge_context, &range_del_agg)) {
       done = true;
       RecordTick(stats_, MEMTABLE_HIT);
-    } else if (sv->imm->Get(lkey, value, &s, &merge_context)) {
+    } else if (sv->imm->Get(lkey, value, &s, &merge_context,
+                            &range_del_agg)) {
       done = true;
       RecordTick(stats_, MEMTABLE_HIT);
     }
@@ -3823,7 +4223,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
   if (!done) {
     PERF_TIMER_GUARD(get_from_output_files_time);
     sv->current->Get(read_options, lkey, value, &s, &merge_context,
-                     value_found);
+                     &range_del_agg, value_found);
     RecordTick(stats_, MEMTABLE_MISS);
   }
 
@@ -3852,34 +4252,44 @@ std::vector<Status> DBImpl::MultiGet(
   struct MultiGetColumnFamilyData {
     ColumnFamilyData* cfd;
     SuperVersion* super_version;
+    // Keys of this column family that missed the memtables
+    std::vector<MultiGetKey> sst_keys;
+    // The range tombstones of the memtables and of the files probed so far,
+    // shared by all of sst_keys since they have the same snapshot. Created
+    // with the first key that misses the memtables.
+    std::unique_ptr<RangeDelAggregator> range_del_agg;
   };
-  std::unordered_map<uint32_t, MultiGetColumnFamilyData*> multiget_cf_data;
+  std::unordered_map<uint32_t, std::unique_ptr<MultiGetColumnFamilyData>>
+      multiget_cf_data;
   // fill up and allocate outside of mutex
   for (auto cf : column_family) {
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(cf);
     auto cfd = cfh->cfd();
     if (multiget_cf_data.find(cfd->GetID()) == multiget_cf_data.end()) {
-      auto mgcfd = new MultiGetColumnFamilyData();
+      std::unique_ptr<MultiGetColumnFamilyData> mgcfd(
+          new MultiGetColumnFamilyData());
       mgcfd->cfd = cfd;
-      multiget_cf_data.insert({cfd->GetID(), mgcfd});
+      multiget_cf_data.emplace(cfd->GetID(), std::move(mgcfd));
     }
   }
 
-  mutex_.Lock();
+  // As in GetImpl(), the snapshot is taken before the SuperVersions are
+  // acquired, so every write covered by it is visible through them. The
+  // SuperVersions come from the thread-local cache and don't need mutex_.
   if (read_options.snapshot != nullptr) {
     snapshot = reinterpret_cast<const SnapshotImpl*>(
         read_options.snapshot)->number_;
   } else {
     snapshot = versions_->LastSequence();
   }
-  for (auto mgd_iter : multiget_cf_data) {
+  for (auto& mgd_iter : multiget_cf_data) {
     mgd_iter.second->super_version =
-        mgd_iter.second->cfd->GetSuperVersion()->Ref();
+        GetAndRefSuperVersion(mgd_iter.second->cfd);
   }
-  mutex_.Unlock();
 
-  // Contain a list of merge operations if merge occurs.
-  MergeContext merge_context;
+  // Contain a list of merge operations if merge occurs, one per key.
+  std::vector<MergeContext> merge_contexts(keys.size());
+  std::vector<std::unique_ptr<LookupKey>> lookup_keys(keys.size());
 
   // Note: this always resizes the values array
   size_t num_keys = keys.size();
@@ -3890,65 +4300,94 @@ std::vector<Status> DBImpl::MultiGet(
   uint64_t bytes_read = 0;
   PERF_TIMER_STOP(get_snapshot_time);
 
-  // For each of the given keys, apply the entire "get" process as follows:
-  // First look in the memtable, then in the immutable memtable (if any).
-  // s is both in/out. When in, s could either be OK or MergeInProgress.
-  // merge_operands will contain the sequence of merges in the latter case.
+  // First look every key up in the memtable, then in the immutable memtable
+  // (if any). s is both in/out. When in, s could either be OK or
+  // MergeInProgress. merge_operands will contain the sequence of merges in
+  // the latter case. Keys that are not resolved by the memtables are
+  // collected per column family and looked up in the SST files as a batch.
+  bool skip_memtable =
+      (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
   for (size_t i = 0; i < num_keys; ++i) {
-    merge_context.Clear();
     Status& s = stat_list[i];
     std::string* value = &(*values)[i];
 
-    LookupKey lkey(keys[i], snapshot);
+    lookup_keys[i].reset(new LookupKey(keys[i], snapshot));
     auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family[i]);
     auto mgd_iter = multiget_cf_data.find(cfh->cfd()->GetID());
     assert(mgd_iter != multiget_cf_data.end());
-    auto mgd = mgd_iter->second;
+    auto mgd = mgd_iter->second.get();
     auto super_version = mgd->super_version;
-    bool skip_memtable =
-        (read_options.read_tier == kPersistedTier && has_unpersisted_data_);
     bool done = false;
     if (!skip_memtable) {
-      if (super_version->mem->Get(lkey, value, &s, &merge_context)) {
+      RangeDelAggregator range_del_agg(mgd->cfd->internal_comparator(),
+                                       snapshot);
+      if (super_version->mem->Get(*lookup_keys[i], value, &s,
+                                  &merge_contexts[i], &range_del_agg)) {
         done = true;
-        // TODO(?): RecordTick(stats_, MEMTABLE_HIT)?
-      } else if (super_version->imm->Get(lkey, value, &s, &merge_context)) {
+        RecordTick(stats_, MEMTABLE_HIT);
+      } else if (super_version->imm->Get(*lookup_keys[i], value, &s,
+                                         &merge_contexts[i], &range_del_agg)) {
         done = true;
-        // TODO(?): RecordTick(stats_, MEMTABLE_HIT)?
+        RecordTick(stats_, MEMTABLE_HIT);
+      }
+    }
+    if (!done && mgd->range_del_agg == nullptr) {
+      // The memtable tombstones are the same for every key of the column
+      // family, so they are read only once for the whole batch.
+      mgd->range_del_agg.reset(
+          new RangeDelAggregator(mgd->cfd->internal_comparator(), snapshot));
+      if (!skip_memtable) {
+        Status add_status = mgd->range_del_agg->AddTombstones(
+            std::unique_ptr<InternalIterator>(
+                super_version->mem->NewRangeTombstoneIterator(read_options)));
+        if (add_status.ok()) {
+          add_status = super_version->imm->AddRangeTombstones(
+              read_options, mgd->range_del_agg.get());
+        }
+        if (!add_status.ok()) {
+          mgd->range_del_agg.reset();
+          s = add_status;
+          done = true;
+        }
       }
     }
     if (!done) {
-      PERF_TIMER_GUARD(get_from_output_files_time);
-      super_version->current->Get(read_options, lkey, value, &s,
-                                  &merge_context);
-      // TODO(?): RecordTick(stats_, MEMTABLE_MISS)?
+      mgd->sst_keys.push_back({lookup_keys[i].get(), value, &s,
+                               &merge_contexts[i], mgd->range_del_agg.get()});
+      RecordTick(stats_, MEMTABLE_MISS);
     }
+  }
 
-    if (s.ok()) {
-      bytes_read += value->size();
+  {
+    PERF_TIMER_GUARD(get_from_output_files_time);
+    for (auto& mgd_iter : multiget_cf_data) {
+      auto mgd = mgd_iter.second.get();
+      if (mgd->sst_keys.empty()) {
+        continue;
+      }
+      // Version::MultiGet() walks the files in key order, so sort the batch
+      // by user key. The sort is stable to keep duplicate keys in order.
+      const Comparator* ucmp = mgd->cfd->user_comparator();
+      std::stable_sort(mgd->sst_keys.begin(), mgd->sst_keys.end(),
+                       [ucmp](const MultiGetKey& a, const MultiGetKey& b) {
+                         return ucmp->Compare(a.lkey->user_key(),
+                                              b.lkey->user_key()) < 0;
+                       });
+      mgd->super_version->current->MultiGet(read_options, &mgd->sst_keys);
     }
   }
 
-  // Post processing (decrement reference counts and record statistics)
-  PERF_TIMER_GUARD(get_post_process_time);
-  autovector<SuperVersion*> superversions_to_delete;
-
-  // TODO(icanadi) do we need lock here or just around Cleanup()?
-  mutex_.Lock();
-  for (auto mgd_iter : multiget_cf_data) {
-    auto mgd = mgd_iter.second;
-    if (mgd->super_version->Unref()) {
-      mgd->super_version->Cleanup();
-      superversions_to_delete.push_back(mgd->super_version);
+  for (size_t i = 0; i < num_keys; ++i) {
+    if (stat_list[i].ok()) {
+      bytes_read += (*values)[i].size();
     }
   }
-  mutex_.Unlock();
 
-  for (auto td : superversions_to_delete) {
-    delete td;
-  }
-  for (auto mgd : multiget_cf_data) {
-    delete mgd.second;
+  // Post processing (decrement reference counts and record statistics)
+  PERF_TIMER_GUARD(get_post_process_time);
+  for (auto& mgd_iter : multiget_cf_data) {
+    auto mgd = mgd_iter.second.get();
+    ReturnAndCleanupSuperVersion(mgd->cfd, mgd->super_version);
   }
 
   RecordTick(stats_, NUMBER_MULTIGET_CALLS);
@@ -3971,6 +4410,9 @@ Status DBImpl::CreateColumnFamily(const ColumnFamilyOptions& cf_options,
   if (s.ok() && db_options_.allow_concurrent_memtable_write) {
     s = CheckConcurrentWritesSupported(cf_options);
   }
+  if (s.ok()) {
+    s = CheckCompactionOptionsSupported(db_options_, cf_options);
+  }
   if (!s.ok()) {
     return s;
   }
@@ -4246,7 +4688,8 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
         read_options.prefix_same_as_start, read_options.pin_data);
 
     InternalIterator* internal_iter =
-        NewInternalIterator(read_options, cfd, sv, db_iter->GetArena());
+        NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
+                            db_iter->GetRangeDelAggregator());
     db_iter->SetIterUnderDBIter(internal_iter);
 
     return db_iter;
@@ -4319,7 +4762,8 @@ Status DBImpl::NewIterators(
           sv->mutable_cf_options.max_sequential_skip_in_iterations,
           sv->version_number, nullptr, false, read_options.pin_data);
       InternalIterator* internal_iter =
-          NewInternalIterator(read_options, cfd, sv, db_iter->GetArena());
+          NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
+                              db_iter->GetRangeDelAggregator());
       db_iter->SetIterUnderDBIter(internal_iter);
       iterators->push_back(db_iter);
     }
@@ -4422,12 +4866,18 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     return status;
   }
 
+  if (db_options_.enable_pipelined_write) {
+    return PipelinedWriteImpl(write_options, my_batch, callback, log_used,
+                              log_ref, disable_memtable);
+  }
+
   PERF_TIMER_GUARD(write_pre_and_post_process_time);
   WriteThread::Writer w;
   w.batch = my_batch;
   w.sync = write_options.sync;
   w.disableWAL = write_options.disableWAL;
   w.disable_memtable = disable_memtable;
+  w.hint_per_batch = write_options.memtable_insert_hint_per_batch;
   w.in_batch_group = false;
   w.callback = callback;
   w.log_ref = log_ref;
@@ -4497,84 +4947,11 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   assert(!single_column_family_mode_ ||
          versions_->GetColumnFamilySet()->NumberOfColumnFamilies() == 1);
 
-  uint64_t max_total_wal_size = (db_options_.max_total_wal_size == 0)
-                                    ? 4 * max_total_in_memory_state_
-                                    : db_options_.max_total_wal_size;
-  if (UNLIKELY(!single_column_family_mode_ &&
-               alive_log_files_.begin()->getting_flushed == false &&
-               total_log_size_ > max_total_wal_size)) {
-    uint64_t flush_column_family_if_log_file = alive_log_files_.begin()->number;
-    alive_log_files_.begin()->getting_flushed = true;
-    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
-        "Flushing all column families with data in WAL number %" PRIu64
-        ". Total log size is %" PRIu64 " while max_total_wal_size is %" PRIu64,
-        flush_column_family_if_log_file, total_log_size_, max_total_wal_size);
-    // no need to refcount because drop is happening in write thread, so can't
-    // happen while we're in the write thread
-    for (auto cfd : *versions_->GetColumnFamilySet()) {
-      if (cfd->IsDropped()) {
-        continue;
-      }
-      if (cfd->GetLogNumber() <= flush_column_family_if_log_file) {
-        status = SwitchMemtable(cfd, &context);
-        if (!status.ok()) {
-          break;
-        }
-        cfd->imm()->FlushRequested();
-        SchedulePendingFlush(cfd);
-      }
-    }
-    MaybeScheduleFlushOrCompaction();
-  } else if (UNLIKELY(write_buffer_manager_->ShouldFlush())) {
-    // Before a new memtable is added in SwitchMemtable(),
-    // write_buffer_manager_->ShouldFlush() will keep returning true. If another
-    // thread is writing to another DB with the same write buffer, they may also
-    // be flushed. We may end up with flushing much more DBs than needed. It's
-    // suboptimal but still correct.
-    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
-        "Flushing column family with largest mem table size. Write buffer is "
-        "using %" PRIu64 " bytes out of a total of %" PRIu64 ".",
-        write_buffer_manager_->memory_usage(),
-        write_buffer_manager_->buffer_size());
-    // no need to refcount because drop is happening in write thread, so can't
-    // happen while we're in the write thread
-    ColumnFamilyData* largest_cfd = nullptr;
-    size_t largest_cfd_size = 0;
-
-    for (auto cfd : *versions_->GetColumnFamilySet()) {
-      if (cfd->IsDropped()) {
-        continue;
-      }
-      if (!cfd->mem()->IsEmpty()) {
-        // We only consider active mem table, hoping immutable memtable is
-        // already in the process of flushing.
-        size_t cfd_size = cfd->mem()->ApproximateMemoryUsage();
-        if (largest_cfd == nullptr || cfd_size > largest_cfd_size) {
-          largest_cfd = cfd;
-          largest_cfd_size = cfd_size;
-        }
-      }
-    }
-    if (largest_cfd != nullptr) {
-      status = SwitchMemtable(largest_cfd, &context);
-      if (status.ok()) {
-        largest_cfd->imm()->FlushRequested();
-        SchedulePendingFlush(largest_cfd);
-        MaybeScheduleFlushOrCompaction();
-      }
-    }
-  }
-
-  if (UNLIKELY(status.ok() && !bg_error_.ok())) {
-    status = bg_error_;
-  }
-
-  if (UNLIKELY(status.ok() && !flush_scheduler_.Empty())) {
-    status = ScheduleFlushes(&context);
-  }
+  status = PreprocessWrite(&context);
 
   if (UNLIKELY(status.ok() && (write_controller_.IsStopped() ||
-                               write_controller_.NeedsDelay()))) {
+                               write_controller_.NeedsDelay() ||
+                               write_buffer_manager_->ShouldStall()))) {
     PERF_TIMER_STOP(write_pre_and_post_process_time);
     PERF_TIMER_GUARD(write_delay_time);
     // We don't know size of curent batch so that we always use the size
@@ -4584,6 +4961,9 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     status = DelayWrite(last_batch_group_size_);
     PERF_TIMER_START(write_pre_and_post_process_time);
   }
+  // Each group leader accounts the size of the previous group, the size of
+  // its own being known only once the mutex is released.
+  write_controller_.RecordWrite(env_, last_batch_group_size_);
 
   uint64_t last_sequence = versions_->LastSequence();
   WriteThread::Writer* last_writer = &w;
@@ -4664,64 +5044,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     uint64_t log_size = 0;
     if (!write_options.disableWAL) {
       PERF_TIMER_GUARD(write_wal_time);
-
-      WriteBatch* merged_batch = nullptr;
-      if (write_group.size() == 1 && write_group[0]->ShouldWriteToWAL()) {
-        merged_batch = write_group[0]->batch;
-        write_group[0]->log_used = logfile_number_;
-      } else {
-        // WAL needs all of the batches flattened into a single batch.
-        // We could avoid copying here with an iov-like AddRecord
-        // interface
-        merged_batch = &tmp_batch_;
-        for (auto writer : write_group) {
-          if (writer->ShouldWriteToWAL()) {
-            WriteBatchInternal::Append(merged_batch, writer->batch);
-          }
-          writer->log_used = logfile_number_;
-        }
-      }
-
-      if (log_used != nullptr) {
-        *log_used = logfile_number_;
-      }
-
-      WriteBatchInternal::SetSequence(merged_batch, current_sequence);
-
-      Slice log_entry = WriteBatchInternal::Contents(merged_batch);
-      status = logs_.back().writer->AddRecord(log_entry);
-      total_log_size_ += log_entry.size();
-      alive_log_files_.back().AddSize(log_entry.size());
-      log_empty_ = false;
-      log_size = log_entry.size();
-      RecordTick(stats_, WAL_FILE_BYTES, log_size);
-      if (status.ok() && need_log_sync) {
-        RecordTick(stats_, WAL_FILE_SYNCED);
-        StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
-        // It's safe to access logs_ with unlocked mutex_ here because:
-        //  - we've set getting_synced=true for all logs,
-        //    so other threads won't pop from logs_ while we're here,
-        //  - only writer thread can push to logs_, and we're in
-        //    writer thread, so no one will push to logs_,
-        //  - as long as other threads don't modify it, it's safe to read
-        //    from std::deque from multiple threads concurrently.
-        for (auto& log : logs_) {
-          status = log.writer->file()->Sync(db_options_.use_fsync);
-          if (!status.ok()) {
-            break;
-          }
-        }
-        if (status.ok() && need_log_dir_sync) {
-          // We only sync WAL directory the first time WAL syncing is
-          // requested, so that in case users never turn on WAL sync,
-          // we can avoid the disk I/O in the write code path.
-          status = directories_.GetWalDir()->Fsync();
-        }
-      }
-
-      if (merged_batch == &tmp_batch_) {
-        tmp_batch_.Clear();
-      }
+      status = WriteToWAL(write_group, log_used, need_log_sync,
+                          need_log_dir_sync, current_sequence, &log_size);
     }
     if (status.ok()) {
       PERF_TIMER_GUARD(write_memtable_time);
@@ -4836,6 +5160,451 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   return status;
 }
 
+Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
+                                  WriteBatch* my_batch, WriteCallback* callback,
+                                  uint64_t* log_used, uint64_t log_ref,
+                                  bool disable_memtable) {
+  PERF_TIMER_GUARD(write_pre_and_post_process_time);
+  WriteThread::Writer w;
+  w.batch = my_batch;
+  w.sync = write_options.sync;
+  w.disableWAL = write_options.disableWAL;
+  w.disable_memtable = disable_memtable;
+  w.hint_per_batch = write_options.memtable_insert_hint_per_batch;
+  w.in_batch_group = false;
+  w.callback = callback;
+  w.log_ref = log_ref;
+
+  if (!write_options.disableWAL) {
+    RecordTick(stats_, WRITE_WITH_WAL);
+  }
+
+  StopWatch write_sw(env_, db_options_.statistics.get(), DB_WRITE);
+
+  write_thread_.JoinBatchGroup(&w);
+  if (w.state != WriteThread::STATE_GROUP_LEADER) {
+    RecordTick(stats_, WRITE_DONE_BY_OTHER);
+  } else {
+    // Write the batch group to the WAL. The memtable inserts are done by
+    // the memtable writer queue, so that the next batch group can write
+    // the WAL meanwhile.
+    WriteContext context;
+    mutex_.Lock();
+
+    if (!write_options.disableWAL) {
+      default_cf_internal_stats_->AddDBStats(InternalStats::WRITE_WITH_WAL, 1);
+    }
+
+    RecordTick(stats_, WRITE_DONE_BY_SELF);
+    default_cf_internal_stats_->AddDBStats(InternalStats::WRITE_DONE_BY_SELF,
+                                           1);
+
+    Status status = PreprocessWrite(&context);
+
+    if (UNLIKELY(status.ok() && (write_controller_.IsStopped() ||
+                                 write_controller_.NeedsDelay() ||
+                                 write_buffer_manager_->ShouldStall()))) {
+      PERF_TIMER_STOP(write_pre_and_post_process_time);
+      PERF_TIMER_GUARD(write_delay_time);
+      status = DelayWrite(last_batch_group_size_);
+      PERF_TIMER_START(write_pre_and_post_process_time);
+    }
+    write_controller_.RecordWrite(env_, last_batch_group_size_);
+
+    WriteThread::Writer* last_writer = &w;
+    autovector<WriteThread::Writer*> write_group;
+    bool need_log_sync = !write_options.disableWAL && write_options.sync;
+    bool need_log_dir_sync = need_log_sync && !log_dir_synced_;
+
+    if (status.ok() && need_log_sync) {
+      while (logs_.front().getting_synced) {
+        log_sync_cv_.Wait();
+      }
+      for (auto& log : logs_) {
+        assert(!log.getting_synced);
+        log.getting_synced = true;
+      }
+    }
+
+    mutex_.Unlock();
+
+    last_batch_group_size_ =
+        write_thread_.EnterAsBatchGroupLeader(&w, &last_writer, &write_group);
+
+    if (status.ok()) {
+      // Callbacks may look at the latest state of the memtables, e.g. to
+      // detect write conflicts, so the previous batch groups have to be
+      // fully applied first.
+      for (auto writer : write_group) {
+        if (writer->callback != nullptr) {
+          write_thread_.WaitForMemTableWriters();
+          break;
+        }
+      }
+
+      // Sequence numbers are handed out here, in WAL order, but are only
+      // published once the memtable inserts are done.
+      const SequenceNumber current_sequence =
+          write_thread_.UpdateLastSequence(versions_->LastSequence()) + 1;
+      SequenceNumber next_sequence = current_sequence;
+      int total_count = 0;
+      uint64_t total_byte_size = 0;
+      for (auto writer : write_group) {
+        if (writer->CheckCallback(this)) {
+          if (writer->ShouldWriteToMemtable()) {
+            writer->sequence = next_sequence;
+            int count = WriteBatchInternal::Count(writer->batch);
+            next_sequence += count;
+            total_count += count;
+          }
+
+          if (writer->ShouldWriteToWAL()) {
+            total_byte_size = WriteBatchInternal::AppendedByteSize(
+                total_byte_size, WriteBatchInternal::ByteSize(writer->batch));
+          }
+        }
+      }
+      write_thread_.UpdateLastSequence(next_sequence - 1);
+
+      // Record statistics
+      RecordTick(stats_, NUMBER_KEYS_WRITTEN, total_count);
+      RecordTick(stats_, BYTES_WRITTEN, total_byte_size);
+      MeasureTime(stats_, BYTES_PER_WRITE, total_byte_size);
+      PERF_TIMER_STOP(write_pre_and_post_process_time);
+
+      if (write_options.disableWAL) {
+        has_unpersisted_data_ = true;
+      }
+
+      uint64_t log_size = 0;
+      if (!write_options.disableWAL) {
+        PERF_TIMER_GUARD(write_wal_time);
+        status = WriteToWAL(write_group, log_used, need_log_sync,
+                            need_log_dir_sync, current_sequence, &log_size);
+      }
+
+      if (status.ok()) {
+        // Update stats while we are an exclusive group leader
+        auto stats = default_cf_internal_stats_;
+        stats->AddDBStats(InternalStats::BYTES_WRITTEN, total_byte_size);
+        stats->AddDBStats(InternalStats::NUMBER_KEYS_WRITTEN, total_count);
+        if (!write_options.disableWAL) {
+          if (write_options.sync) {
+            stats->AddDBStats(InternalStats::WAL_FILE_SYNCED, 1);
+          }
+          stats->AddDBStats(InternalStats::WAL_FILE_BYTES, log_size);
+        }
+        uint64_t for_other = write_group.size() - 1;
+        if (for_other > 0) {
+          stats->AddDBStats(InternalStats::WRITE_DONE_BY_OTHER, for_other);
+          if (!write_options.disableWAL) {
+            stats->AddDBStats(InternalStats::WRITE_WITH_WAL, for_other);
+          }
+        }
+      }
+      PERF_TIMER_START(write_pre_and_post_process_time);
+    }
+
+    if (db_options_.paranoid_checks && !status.ok() && !status.IsBusy()) {
+      mutex_.Lock();
+      if (bg_error_.ok()) {
+        bg_error_ = status;  // stop compaction & fail any further writes
+      }
+      mutex_.Unlock();
+    }
+
+    if (need_log_sync) {
+      mutex_.Lock();
+      MarkLogsSynced(logfile_number_, need_log_dir_sync, status);
+      mutex_.Unlock();
+    }
+
+    // Hands the writers that go to the memtable over to the memtable writer
+    // queue and waits until w has something left to do.
+    write_thread_.ExitAsBatchGroupLeader(&w, last_writer, status);
+  }
+
+  if (w.state == WriteThread::STATE_MEMTABLE_WRITER_LEADER) {
+    PERF_TIMER_GUARD(write_memtable_time);
+
+    WriteThread::Writer* last_writer = &w;
+    autovector<WriteThread::Writer*> memtable_write_group;
+    write_thread_.EnterAsMemTableWriter(&w, &last_writer,
+                                        &memtable_write_group);
+    // Sequence numbers were handed out in queue order, so the last writer
+    // holds the largest ones
+    const SequenceNumber last_sequence =
+        last_writer->sequence +
+        WriteBatchInternal::Count(last_writer->batch) - 1;
+
+    // See WriteImpl for when the memtable can be updated concurrently
+    bool parallel = db_options_.allow_concurrent_memtable_write &&
+                    memtable_write_group.size() > 1;
+    for (auto writer : memtable_write_group) {
+      parallel = parallel && !writer->batch->HasMerge();
+    }
+
+    if (!parallel) {
+      Status status;
+      for (auto writer : memtable_write_group) {
+        WriteBatchInternal::SetSequence(writer->batch, writer->sequence);
+        status = WriteBatchInternal::InsertInto(
+            writer, column_family_memtables_.get(), &flush_scheduler_,
+            write_options.ignore_missing_column_families, 0 /*log_number*/,
+            this);
+        if (!status.ok()) {
+          break;
+        }
+      }
+      if (status.ok()) {
+        SetTickerCount(stats_, SEQUENCE_NUMBER, last_sequence);
+        versions_->SetLastSequence(last_sequence);
+      } else {
+        MemTableInsertStatusCheck(status);
+      }
+      w.status = status;
+      write_thread_.ExitAsMemTableWriter(&w, last_writer, status);
+    } else {
+      WriteThread::ParallelGroup pg;
+      pg.leader = &w;
+      pg.last_writer = last_writer;
+      pg.last_sequence = last_sequence;
+      pg.early_exit_allowed = true;
+      pg.running.store(static_cast<uint32_t>(memtable_write_group.size()),
+                       std::memory_order_relaxed);
+      write_thread_.LaunchParallelMemTableWriters(&pg);
+
+      ColumnFamilyMemTablesImpl column_family_memtables(
+          versions_->GetColumnFamilySet());
+      WriteBatchInternal::SetSequence(w.batch, w.sequence);
+      w.status = WriteBatchInternal::InsertInto(
+          &w, &column_family_memtables, &flush_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/,
+          this, true /*concurrent_memtable_writes*/);
+
+      // CompleteParallelWorker returns true if this thread should
+      // handle exit, false means somebody else did
+      if (write_thread_.CompleteParallelWorker(&w)) {
+        if (w.status.ok()) {
+          SetTickerCount(stats_, SEQUENCE_NUMBER, last_sequence);
+          versions_->SetLastSequence(last_sequence);
+        } else {
+          MemTableInsertStatusCheck(w.status);
+        }
+        write_thread_.ExitAsMemTableWriter(&w, last_writer, w.status);
+      }
+    }
+  } else if (w.state == WriteThread::STATE_PARALLEL_FOLLOWER) {
+    PERF_TIMER_GUARD(write_memtable_time);
+
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    WriteBatchInternal::SetSequence(w.batch, w.sequence);
+    w.status = WriteBatchInternal::InsertInto(
+        &w, &column_family_memtables, &flush_scheduler_,
+        write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+        true /*concurrent_memtable_writes*/);
+
+    if (write_thread_.CompleteParallelWorker(&w)) {
+      // we're responsible for early exit
+      auto last_sequence = w.parallel_group->last_sequence;
+      SetTickerCount(stats_, SEQUENCE_NUMBER, last_sequence);
+      versions_->SetLastSequence(last_sequence);
+      write_thread_.EarlyExitParallelGroup(&w);
+    }
+  }
+  assert(w.state == WriteThread::STATE_COMPLETED ||
+         w.state == WriteThread::STATE_MEMTABLE_WRITER_LEADER);
+
+  if (log_used != nullptr) {
+    *log_used = w.log_used;
+  }
+  return w.FinalStatus();
+}
+
+// Called by the thread that finishes a memtable writer group.  A non-OK
+// status means that the memtables have diverged from the WAL, so further
+// writes are stopped.
+void DBImpl::MemTableInsertStatusCheck(const Status& status) {
+  if (!status.ok()) {
+    mutex_.Lock();
+    if (bg_error_.ok()) {
+      bg_error_ = status;
+    }
+    mutex_.Unlock();
+  }
+}
+
+// Pipelined write only.  Waits for the writers already handed over to the
+// memtable writer queue.  The mutex is released meanwhile since memtable
+// inserts may need it, e.g. for the DB::Get() done by MemTableInserter
+// when max_successive_merges is set.
+// REQUIRES: mutex_ is held
+// REQUIRES: this thread is currently at the front of the writer queue
+void DBImpl::WaitForMemTableWriters() {
+  mutex_.AssertHeld();
+  if (db_options_.enable_pipelined_write) {
+    mutex_.Unlock();
+    write_thread_.WaitForMemTableWriters();
+    mutex_.Lock();
+  }
+}
+
+// REQUIRES: mutex_ is held
+// REQUIRES: this thread is currently at the front of the writer queue
+Status DBImpl::PreprocessWrite(WriteContext* context) {
+  mutex_.AssertHeld();
+  Status status;
+
+  uint64_t max_total_wal_size = (db_options_.max_total_wal_size == 0)
+                                    ? 4 * max_total_in_memory_state_
+                                    : db_options_.max_total_wal_size;
+  if (UNLIKELY(!single_column_family_mode_ &&
+               alive_log_files_.begin()->getting_flushed == false &&
+               total_log_size_ > max_total_wal_size)) {
+    uint64_t flush_column_family_if_log_file = alive_log_files_.begin()->number;
+    alive_log_files_.begin()->getting_flushed = true;
+    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+        "Flushing all column families with data in WAL number %" PRIu64
+        ". Total log size is %" PRIu64 " while max_total_wal_size is %" PRIu64,
+        flush_column_family_if_log_file, total_log_size_, max_total_wal_size);
+    // no need to refcount because drop is happening in write thread, so can't
+    // happen while we're in the write thread
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      if (cfd->GetLogNumber() <= flush_column_family_if_log_file) {
+        status = SwitchMemtable(cfd, context);
+        if (!status.ok()) {
+          break;
+        }
+        cfd->imm()->FlushRequested();
+        SchedulePendingFlush(cfd);
+      }
+    }
+    MaybeScheduleFlushOrCompaction();
+  } else if (UNLIKELY(write_buffer_manager_->ShouldFlush())) {
+    // Before a new memtable is added in SwitchMemtable(),
+    // write_buffer_manager_->ShouldFlush() will keep returning true. If another
+    // thread is writing to another DB with the same write buffer, they may also
+    // be flushed. We may end up with flushing much more DBs than needed. It's
+    // suboptimal but still correct.
+    Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+        "Flushing column family with largest mem table size. Write buffer is "
+        "using %" PRIu64 " bytes out of a total of %" PRIu64 ".",
+        write_buffer_manager_->memory_usage(),
+        write_buffer_manager_->buffer_size());
+    // no need to refcount because drop is happening in write thread, so can't
+    // happen while we're in the write thread
+    ColumnFamilyData* largest_cfd = nullptr;
+    size_t largest_cfd_size = 0;
+
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      if (!cfd->mem()->IsEmpty()) {
+        // We only consider active mem table, hoping immutable memtable is
+        // already in the process of flushing.
+        size_t cfd_size = cfd->mem()->ApproximateMemoryUsage();
+        if (largest_cfd == nullptr || cfd_size > largest_cfd_size) {
+          largest_cfd = cfd;
+          largest_cfd_size = cfd_size;
+        }
+      }
+    }
+    if (largest_cfd != nullptr) {
+      status = SwitchMemtable(largest_cfd, context);
+      if (status.ok()) {
+        largest_cfd->imm()->FlushRequested();
+        SchedulePendingFlush(largest_cfd);
+        MaybeScheduleFlushOrCompaction();
+      }
+    }
+  }
+
+  if (UNLIKELY(status.ok() && !bg_error_.ok())) {
+    status = bg_error_;
+  }
+
+  if (UNLIKELY(status.ok() && !flush_scheduler_.Empty())) {
+    // The pending memtable writers may still schedule flushes
+    WaitForMemTableWriters();
+    status = ScheduleFlushes(context);
+  }
+
+  return status;
+}
+
+// Appends the batches of write_group that go to the WAL as a single record
+// starting at sequence, and syncs the WAL if requested.
+// REQUIRES: this thread is the leader of the write batch group
+Status DBImpl::WriteToWAL(const autovector<WriteThread::Writer*>& write_group,
+                          uint64_t* log_used, bool need_log_sync,
+                          bool need_log_dir_sync, SequenceNumber sequence,
+                          uint64_t* log_size) {
+  WriteBatch* merged_batch = nullptr;
+  if (write_group.size() == 1 && write_group[0]->ShouldWriteToWAL()) {
+    merged_batch = write_group[0]->batch;
+    write_group[0]->log_used = logfile_number_;
+  } else {
+    // WAL needs all of the batches flattened into a single batch.
+    // We could avoid copying here with an iov-like AddRecord
+    // interface
+    merged_batch = &tmp_batch_;
+    for (auto writer : write_group) {
+      if (writer->ShouldWriteToWAL()) {
+        WriteBatchInternal::Append(merged_batch, writer->batch);
+      }
+      writer->log_used = logfile_number_;
+    }
+  }
+
+  if (log_used != nullptr) {
+    *log_used = logfile_number_;
+  }
+
+  WriteBatchInternal::SetSequence(merged_batch, sequence);
+
+  Slice log_entry = WriteBatchInternal::Contents(merged_batch);
+  Status status = logs_.back().writer->AddRecord(log_entry);
+  total_log_size_ += log_entry.size();
+  alive_log_files_.back().AddSize(log_entry.size());
+  log_empty_ = false;
+  *log_size = log_entry.size();
+  RecordTick(stats_, WAL_FILE_BYTES, *log_size);
+  if (status.ok() && need_log_sync) {
+    RecordTick(stats_, WAL_FILE_SYNCED);
+    StopWatch sw(env_, stats_, WAL_FILE_SYNC_MICROS);
+    // It's safe to access logs_ with unlocked mutex_ here because:
+    //  - we've set getting_synced=true for all logs,
+    //    so other threads won't pop from logs_ while we're here,
+    //  - only writer thread can push to logs_, and we're in
+    //    writer thread, so no one will push to logs_,
+    //  - as long as other threads don't modify it, it's safe to read
+    //    from std::deque from multiple threads concurrently.
+    for (auto& log : logs_) {
+      status = log.writer->file()->Sync(db_options_.use_fsync);
+      if (!status.ok()) {
+        break;
+      }
+    }
+    if (status.ok() && need_log_dir_sync) {
+      // We only sync WAL directory the first time WAL syncing is
+      // requested, so that in case users never turn on WAL sync,
+      // we can avoid the disk I/O in the write code path.
+      status = directories_.GetWalDir()->Fsync();
+    }
+  }
+
+  if (merged_batch == &tmp_batch_) {
+    tmp_batch_.Clear();
+  }
+
+  return status;
+}
+
 // REQUIRES: mutex_ is held
 // REQUIRES: this thread is currently at the front of the writer queue
 Status DBImpl::DelayWrite(uint64_t num_bytes) {
@@ -4858,6 +5627,20 @@ Status DBImpl::DelayWrite(uint64_t num_bytes) {
       TEST_SYNC_POINT("DBImpl::DelayWrite:Wait");
       bg_cv_.Wait();
     }
+
+    if (bg_error_.ok() && write_buffer_manager_->ShouldStall()) {
+      // The memtables of all the DBs sharing the write buffer manager are
+      // over its limit. Stop writes until flushes free enough memory. Memory
+      // freed by another DB doesn't signal bg_cv_, so wake up periodically.
+      const uint64_t kWriteBufferStallPollMicros = 1000;
+      std::unique_ptr<WriteControllerToken> stop_token =
+          write_controller_.GetStopToken();
+      while (bg_error_.ok() && write_buffer_manager_->ShouldStall()) {
+        delayed = true;
+        TEST_SYNC_POINT("DBImpl::DelayWrite:WriteBufferManagerStall");
+        bg_cv_.TimedWait(env_->NowMicros() + kWriteBufferStallPollMicros);
+      }
+    }
   }
   if (delayed) {
     default_cf_internal_stats_->AddDBStats(InternalStats::WRITE_STALL_MICROS,
@@ -4902,6 +5685,8 @@ void DBImpl::NotifyOnMemTableSealed(ColumnFamilyData* cfd,
 // REQUIRES: this thread is currently at the front of the writer queue
 Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
   mutex_.AssertHeld();
+  // The old memtable must not be switched out under a pending insert
+  WaitForMemTableWriters();
   unique_ptr<WritableFile> lfile;
   log::Writer* new_log = nullptr;
   MemTable* new_mem = nullptr;
@@ -4920,6 +5705,9 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
       creating_new_log ? versions_->NewFileNumber() : logfile_number_;
   SuperVersion* new_superversion = nullptr;
   const MutableCFOptions mutable_cf_options = *cfd->GetLatestMutableCFOptions();
+  MutableCFOptions new_mem_options = mutable_cf_options;
+  new_mem_options.write_buffer_size =
+      cfd->GetPacedWriteBufferSize(mutable_cf_options);
 
   // Set current_memtble_info for memtable sealed callback
 #ifndef ROCKSDB_LITE
@@ -4955,8 +5743,8 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
         // Our final size should be less than write_buffer_size
         // (compression, etc) but err on the side of caution.
         lfile->SetPreallocationBlockSize(
-            mutable_cf_options.write_buffer_size / 10 +
-            mutable_cf_options.write_buffer_size);
+            new_mem_options.write_buffer_size / 10 +
+            new_mem_options.write_buffer_size);
         unique_ptr<WritableFileWriter> file_writer(
             new WritableFileWriter(std::move(lfile), opt_env_opt));
         new_log = new log::Writer(std::move(file_writer), new_log_number,
@@ -4966,7 +5754,7 @@ Status DBImpl::SwitchMemtable(ColumnFamilyData* cfd, WriteContext* context) {
 
     if (s.ok()) {
       SequenceNumber seq = versions_->LastSequence();
-      new_mem = cfd->ConstructNewMemtable(mutable_cf_options, seq);
+      new_mem = cfd->ConstructNewMemtable(new_mem_options, seq);
       new_superversion = new SuperVersion();
     }
 
@@ -5610,6 +6398,14 @@ Status DB::SingleDelete(const WriteOptions& opt,
   return Write(opt, &batch);
 }
 
+Status DB::DeleteRange(const WriteOptions& opt,
+                       ColumnFamilyHandle* column_family,
+                       const Slice& begin_key, const Slice& end_key) {
+  WriteBatch batch;
+  batch.DeleteRange(column_family, begin_key, end_key);
+  return Write(opt, &batch);
+}
+
 Status DB::Merge(const WriteOptions& opt, ColumnFamilyHandle* column_family,
                  const Slice& key, const Slice& value) {
   WriteBatch batch;
@@ -6116,13 +6912,15 @@ Status DBImpl::GetLatestSequenceForKey(SuperVersion* sv, const Slice& key,
   MergeContext merge_context;
 
   SequenceNumber current_seq = versions_->LastSequence();
+  RangeDelAggregator range_del_agg(sv->mem->GetInternalKeyComparator(),
+                                   current_seq);
   LookupKey lkey(key, current_seq);
 
   *seq = kMaxSequenceNumber;
   *found_record_for_key = false;
 
   // Check if there is a record for this key in the latest memtable
-  sv->mem->Get(lkey, nullptr, &s, &merge_context, seq);
+  sv->mem->Get(lkey, nullptr, &s, &merge_context, &range_del_agg, seq);
 
   if (!(s.ok() || s.IsNotFound() || s.IsMergeInProgress())) {
     // unexpected error reading memtable.
@@ -6140,7 +6938,7 @@ Status DBImpl::GetLatestSequenceForKey(SuperVersion* sv, const Slice& key,
   }
 
   // Check if there is a record for this key in the immutable memtables
-  sv->imm->Get(lkey, nullptr, &s, &merge_context, seq);
+  sv->imm->Get(lkey, nullptr, &s, &merge_context, &range_del_agg, seq);
 
   if (!(s.ok() || s.IsNotFound() || s.IsMergeInProgress())) {
     // unexpected error reading memtable.
@@ -6158,7 +6956,8 @@ Status DBImpl::GetLatestSequenceForKey(SuperVersion* sv, const Slice& key,
   }
 
   // Check if there is a record for this key in the immutable memtables
-  sv->imm->GetFromHistory(lkey, nullptr, &s, &merge_context, seq);
+  sv->imm->GetFromHistory(lkey, nullptr, &s, &merge_context, &range_del_agg,
+                          seq);
 
   if (!(s.ok() || s.IsNotFound() || s.IsMergeInProgress())) {
     // unexpected error reading memtable.
@@ -6182,7 +6981,8 @@ Status DBImpl::GetLatestSequenceForKey(SuperVersion* sv, const Slice& key,
     ReadOptions read_options;
 
     sv->current->Get(read_options, lkey, nullptr, &s, &merge_context,
-                     nullptr /* value_found */, found_record_for_key, seq);
+                     &range_del_agg, nullptr /* value_found */,
+                     found_record_for_key, seq);
 
     if (!(s.ok() || s.IsNotFound() || s.IsMergeInProgress())) {
       // unexpected error reading SST files
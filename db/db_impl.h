@@ -49,6 +49,7 @@
 namespace rocksdb {
 
 class MemTable;
+class RangeDelAggregator;
 class TableCache;
 class Version;
 class VersionEdit;
@@ -505,10 +506,13 @@ class DBImpl : public DB {
   std::unordered_map<std::string, RecoveredTransaction*>
       recovered_transactions_;
 
+  // If range_del_agg is not nullptr, the range tombstones of the memtables
+  // and files are added to it.
   InternalIterator* NewInternalIterator(const ReadOptions&,
                                         ColumnFamilyData* cfd,
                                         SuperVersion* super_version,
-                                        Arena* arena);
+                                        Arena* arena,
+                                        RangeDelAggregator* range_del_agg);
 
   // Except in DB::Open(), WriteOptionsFile can only be called when:
   // 1. WriteThread::Writer::EnterUnbatched() is used.
@@ -622,6 +626,24 @@ class DBImpl : public DB {
   Status WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                                      MemTable* mem, VersionEdit* edit);
 
+  // Write path used when DBOptions::enable_pipelined_write is set
+  Status PipelinedWriteImpl(const WriteOptions& options, WriteBatch* updates,
+                            WriteCallback* callback, uint64_t* log_used,
+                            uint64_t log_ref, bool disable_memtable);
+
+  // Switches memtables and schedules flushes as needed before a batch
+  // group is written
+  Status PreprocessWrite(WriteContext* context);
+
+  Status WriteToWAL(const autovector<WriteThread::Writer*>& write_group,
+                    uint64_t* log_used, bool need_log_sync,
+                    bool need_log_dir_sync, SequenceNumber sequence,
+                    uint64_t* log_size);
+
+  void MemTableInsertStatusCheck(const Status& status);
+
+  void WaitForMemTableWriters();
+
   // num_bytes: for slowdown case, delay time is calculated based on
   //            `num_bytes` going through.
   Status DelayWrite(uint64_t num_bytes);
@@ -963,6 +985,9 @@ class DBImpl : public DB {
   // The options to access storage files
   const EnvOptions env_options_;
 
+  // The options to write the table files of flushes and compactions
+  const EnvOptions env_options_for_compaction_;
+
   // A set of compactions that are running right now
   // REQUIRES: mutex held
   std::unordered_set<Compaction*> running_compactions_;
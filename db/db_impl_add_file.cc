@@ -272,7 +272,8 @@ Status DBImpl::AddFile(ColumnFamilyHandle* column_family,
       Arena arena;
       ReadOptions ro;
       ro.total_order_seek = true;
-      ScopedArenaIterator iter(NewInternalIterator(ro, cfd, sv, &arena));
+      ScopedArenaIterator iter(
+          NewInternalIterator(ro, cfd, sv, &arena, nullptr /* range_del_agg */));
 
       for (size_t i = 0; i < num_files; i++) {
         StatsTimer t(env_, &micro_list[i]);
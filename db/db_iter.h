@@ -21,6 +21,7 @@ namespace rocksdb {
 class Arena;
 class DBIter;
 class InternalIterator;
+class RangeDelAggregator;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
@@ -52,6 +53,11 @@ class ArenaWrappedDBIter : public Iterator {
   // Set the internal iterator wrapped inside the DB Iterator. Usually it is
   // a merging iterator.
   virtual void SetIterUnderDBIter(InternalIterator* iter);
+
+  // The range tombstones the wrapped DB Iterator consults. The caller building
+  // the internal iterator adds the tombstones of the memtables and files.
+  virtual RangeDelAggregator* GetRangeDelAggregator();
+
   virtual bool Valid() const override;
   virtual void SeekToFirst() override;
   virtual void SeekToLast() override;
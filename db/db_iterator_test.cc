@@ -1597,6 +1597,76 @@ TEST_F(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+TEST_F(DBIteratorTest, AutoReadahead) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 4 << 20;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.no_block_cache = true;
+  table_options.max_auto_readahead_size = 16 * 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  std::string value(1024, 'a');
+  for (int i = 0; i < 200; i++) {
+    ASSERT_OK(Put(Key(i), value));
+  }
+  ASSERT_OK(Flush());
+
+  SetPerfLevel(kEnableCount);
+  auto scan = [&](const ReadOptions& read_options) {
+    perf_context.Reset();
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(value, iter->value());
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(200, count);
+  };
+
+  // Every data block but the first few is prefetched before the scan
+  // reaches it
+  scan(ReadOptions());
+  ASSERT_GT(perf_context.block_prefetch_bytes, 150U * 1024);
+  ASSERT_GT(perf_context.block_prefetch_hit_count, 190U);
+  ASSERT_LE(perf_context.block_prefetch_hit_count, 200U);
+
+  // A point lookup doesn't read ahead
+  perf_context.Reset();
+  ASSERT_EQ(value, Get(Key(100)));
+  ASSERT_EQ(0U, perf_context.block_prefetch_bytes);
+
+  // Stopping a scan early leaves the rest of the window unused
+  {
+    perf_context.Reset();
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->SeekToFirst();
+    for (int i = 0; i < 10; i++) {
+      ASSERT_TRUE(iter->Valid());
+      iter->Next();
+    }
+  }
+  ASSERT_GT(perf_context.block_prefetch_bytes, 0U);
+  ASSERT_GT(perf_context.block_prefetch_wasted_bytes, 0U);
+
+  // Iterators with an explicit readahead size don't prefetch
+  ReadOptions read_options;
+  read_options.readahead_size = 64 * 1024;
+  scan(read_options);
+  ASSERT_EQ(0U, perf_context.block_prefetch_bytes);
+
+  table_options.max_auto_readahead_size = 0;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  scan(ReadOptions());
+  ASSERT_EQ(0U, perf_context.block_prefetch_bytes);
+  SetPerfLevel(kDisable);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -0,0 +1,288 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "utilities/merge_operators.h"
+
+namespace rocksdb {
+
+class DBRangeDelTest : public DBTestBase {
+ public:
+  DBRangeDelTest() : DBTestBase("/db_range_del_test") {}
+
+  std::string GetNumericStr(int key) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%08d", key);
+    return std::string(buf);
+  }
+
+  // Returns the user keys visible to a forward iteration
+  std::string IterKeys(const Snapshot* snapshot = nullptr) {
+    ReadOptions read_opts;
+    read_opts.snapshot = snapshot;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+    std::string result;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      if (!result.empty()) {
+        result += ",";
+      }
+      result += iter->key().ToString();
+    }
+    EXPECT_OK(iter->status());
+    return result;
+  }
+
+  // Returns the user keys visible to a backward iteration, in forward order
+  std::string ReverseIterKeys() {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    std::string result;
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      if (!result.empty()) {
+        result = "," + result;
+      }
+      result = iter->key().ToString() + result;
+    }
+    EXPECT_OK(iter->status());
+    return result;
+  }
+};
+
+TEST_F(DBRangeDelTest, WriteBatch) {
+  WriteBatch batch;
+  batch.Put("a", "val");
+  batch.DeleteRange("a", "b");
+  batch.Put("b", "val");
+  ASSERT_TRUE(batch.HasDeleteRange());
+  ASSERT_EQ(3, batch.Count());
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("val", Get("b"));
+}
+
+TEST_F(DBRangeDelTest, EndKeyIsExclusive) {
+  ASSERT_OK(Put("a", "val"));
+  ASSERT_OK(Put("b", "val"));
+  ASSERT_OK(Put("c", "val"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "c"));
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("val", Get("c"));
+  ASSERT_EQ("c", IterKeys());
+  ASSERT_EQ("c", ReverseIterKeys());
+
+  // Keys written after the range deletion are not covered by it
+  ASSERT_OK(Put("b", "val2"));
+  ASSERT_EQ("val2", Get("b"));
+  ASSERT_EQ("b,c", IterKeys());
+  ASSERT_EQ("b,c", ReverseIterKeys());
+}
+
+TEST_F(DBRangeDelTest, FlushOutputHasOnlyRangeTombstones) {
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "dr1",
+                             "dr2"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+}
+
+TEST_F(DBRangeDelTest, TombstonesInSstCoverOlderFiles) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(GetNumericStr(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             GetNumericStr(2), GetNumericStr(8)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1,1", FilesPerLevel());
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(i >= 2 && i < 8 ? "NOT_FOUND" : "val", Get(GetNumericStr(i)));
+  }
+  std::string expected = GetNumericStr(0) + "," + GetNumericStr(1) + "," +
+                         GetNumericStr(8) + "," + GetNumericStr(9);
+  ASSERT_EQ(expected, IterKeys());
+  ASSERT_EQ(expected, ReverseIterKeys());
+
+  std::vector<Slice> keys;
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 10; ++i) {
+    key_strs.push_back(GetNumericStr(i));
+  }
+  for (const auto& key_str : key_strs) {
+    keys.push_back(key_str);
+  }
+  std::vector<std::string> values;
+  std::vector<Status> statuses = db_->MultiGet(ReadOptions(), keys, &values);
+  for (int i = 0; i < 10; ++i) {
+    if (i >= 2 && i < 8) {
+      ASSERT_TRUE(statuses[i].IsNotFound());
+    } else {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ("val", values[i]);
+    }
+  }
+
+  // Reopening must not change the result
+  Reopen(opts);
+  ASSERT_EQ(expected, IterKeys());
+}
+
+TEST_F(DBRangeDelTest, MultiGetSharesTombstonesAcrossKeys) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(GetNumericStr(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             GetNumericStr(2), GetNumericStr(8)));
+  ASSERT_OK(Flush());
+  // A newer file rewrites a key covered by the older tombstone
+  ASSERT_OK(Put(GetNumericStr(5), "new"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2,1", FilesPerLevel());
+  // The memtable tombstone covers keys that are looked up in the files
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             GetNumericStr(0), GetNumericStr(2)));
+
+  std::vector<Slice> keys;
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < 10; ++i) {
+    key_strs.push_back(GetNumericStr(i));
+  }
+  for (const auto& key_str : key_strs) {
+    keys.push_back(key_str);
+  }
+  std::vector<std::string> values;
+  std::vector<Status> statuses = db_->MultiGet(ReadOptions(), keys, &values);
+  for (int i = 0; i < 10; ++i) {
+    std::string expected = Get(GetNumericStr(i));
+    if (i == 5) {
+      ASSERT_EQ("new", expected);
+    } else if (i < 8) {
+      ASSERT_EQ("NOT_FOUND", expected);
+    }
+    if (expected == "NOT_FOUND") {
+      ASSERT_TRUE(statuses[i].IsNotFound());
+    } else {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(expected, values[i]);
+    }
+  }
+}
+
+TEST_F(DBRangeDelTest, CompactionDropsCoveredKeys) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(GetNumericStr(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             GetNumericStr(0), GetNumericStr(10)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2", FilesPerLevel());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  // Both the keys and the tombstone are gone since there is no snapshot and
+  // the output level is the bottommost level.
+  ASSERT_EQ("", FilesPerLevel());
+  ASSERT_EQ("", IterKeys());
+  ASSERT_EQ("[ ]", AllEntriesFor(GetNumericStr(5)));
+}
+
+TEST_F(DBRangeDelTest, CompactionPreservesSnapshotKeys) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  ASSERT_OK(Put("a", "val"));
+  ASSERT_OK(Put("b", "val"));
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "z"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  ASSERT_EQ("NOT_FOUND", Get("a"));
+  ASSERT_EQ("val", Get("a", snapshot));
+  ASSERT_EQ("", IterKeys());
+  ASSERT_EQ("a,b", IterKeys(snapshot));
+
+  db_->ReleaseSnapshot(snapshot);
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ("", FilesPerLevel());
+}
+
+TEST_F(DBRangeDelTest, CompactionOutputSpansMultipleFiles) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  opts.target_file_size_base = 4 << 10;
+  Reopen(opts);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_OK(Put(GetNumericStr(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             GetNumericStr(50), GetNumericStr(150)));
+  ASSERT_OK(Flush());
+  // Compact L0 into L1; the snapshot keeps the covered keys, so the tombstone
+  // is written to every output file it overlaps.
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 0);
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(2), 1);
+
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_EQ(i >= 50 && i < 150, Get(GetNumericStr(i)) == "NOT_FOUND");
+    ASSERT_NE("NOT_FOUND", Get(GetNumericStr(i), snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+}
+
+TEST_F(DBRangeDelTest, MergeOperandsAfterRangeDeletion) {
+  Options opts = CurrentOptions();
+  opts.merge_operator = MergeOperators::CreateStringAppendOperator();
+  opts.disable_auto_compactions = true;
+  Reopen(opts);
+
+  ASSERT_OK(db_->Merge(WriteOptions(), "key", "a"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->Merge(WriteOptions(), "key", "b"));
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "key",
+                             "key2"));
+  ASSERT_OK(db_->Merge(WriteOptions(), "key", "c"));
+  ASSERT_EQ("c", Get("key"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("c", Get("key"));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("c", Get("key"));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
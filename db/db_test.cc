@@ -3225,6 +3225,99 @@ TEST_P(DBTestWithParam, FIFOCompactionTest) {
     }
   }
 }
+
+TEST_F(DBTest, FIFOCompactionWithTTLTest) {
+  Options options;
+  options.compaction_style = kCompactionStyleFIFO;
+  options.write_buffer_size = 1 << 20;  // 1MB
+  options.arena_block_size = 4096;
+  options.compaction_options_fifo.max_table_files_size = 1 << 20;  // 1MB
+  options.compaction_options_fifo.ttl = 60 * 60;                    // 1 hour
+  options.compression = kNoCompression;
+  options.create_if_missing = true;
+  options = CurrentOptions(options);
+
+  // The TTL is checked against the properties of the open table readers
+  options.max_open_files = 100;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+  options.max_open_files = -1;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_OK(Put(ToString(i * 100 + j), RandomString(&rnd, 980)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(NumTableFilesAtLevel(0), 5);
+
+  // Two hours later all the files have expired. They are dropped once the
+  // next flush considers a compaction.
+  env_->addon_time_.fetch_add(2 * 60 * 60);
+  for (int j = 0; j < 10; ++j) {
+    ASSERT_OK(Put(ToString(500 + j), RandomString(&rnd, 980)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ(NumTableFilesAtLevel(0), 1);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ("NOT_FOUND", Get(ToString(i * 100)));
+  }
+  ASSERT_NE("NOT_FOUND", Get(ToString(500)));
+}
+
+TEST_F(DBTest, FIFOCompactionToReduceNumFiles) {
+  Options options;
+  options.compaction_style = kCompactionStyleFIFO;
+  options.write_buffer_size = 1 << 20;  // 1MB
+  options.arena_block_size = 4096;
+  options.compaction_options_fifo.max_table_files_size = 100 << 20;  // 100MB
+  options.compaction_options_fifo.allow_compaction = true;
+  options.level0_file_num_compaction_trigger = 6;
+  options.compression = kNoCompression;
+  options.create_if_missing = true;
+  options = CurrentOptions(options);
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 20; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_OK(Put(ToString(i * 100 + j), RandomString(&rnd, 980)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  }
+  // The small flushed files are merged into larger ones once they reach the
+  // trigger, and nothing is deleted since the size limit is far away.
+  ASSERT_LT(NumTableFilesAtLevel(0), 10);
+  for (int i = 0; i < 20; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_NE("NOT_FOUND", Get(ToString(i * 100 + j)));
+    }
+  }
+
+  // Deletes of keys flushed earlier must survive the merges of the newer
+  // files they are in.
+  for (int i = 0; i < options.level0_file_num_compaction_trigger; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      ASSERT_OK(Delete(ToString(i * 100 + j)));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  }
+  ASSERT_LT(NumTableFilesAtLevel(0), 10);
+  for (int i = 0; i < 20; ++i) {
+    for (int j = 0; j < 10; ++j) {
+      if (i < options.level0_file_num_compaction_trigger) {
+        ASSERT_EQ("NOT_FOUND", Get(ToString(i * 100 + j)));
+      } else {
+        ASSERT_NE("NOT_FOUND", Get(ToString(i * 100 + j)));
+      }
+    }
+  }
+}
 #endif  // ROCKSDB_LITE
 
 // verify that we correctly deprecated timeout_hint_us
@@ -3362,15 +3455,14 @@ TEST_F(DBTest, ConcurrentMemtableNotSupported) {
   options.create_if_missing = true;
 
   DestroyDB(dbname_, options);
-  options.memtable_factory.reset(NewHashLinkListRepFactory(4, 0, 3, true, 4));
+  options.memtable_factory.reset(new VectorRepFactory(100));
   ASSERT_NOK(TryReopen(options));
 
   options.memtable_factory.reset(new SkipListFactory);
   ASSERT_OK(TryReopen(options));
 
   ColumnFamilyOptions cf_options(options);
-  cf_options.memtable_factory.reset(
-      NewHashLinkListRepFactory(4, 0, 3, true, 4));
+  cf_options.memtable_factory.reset(new VectorRepFactory(100));
   ColumnFamilyHandle* handle;
   ASSERT_NOK(db_->CreateColumnFamily(cf_options, "name", &handle));
 }
@@ -9,10 +9,13 @@
 #include <atomic>
 #include <cstdlib>
 #include <functional>
+#include <thread>
+#include <fcntl.h>
 
 #include "db/db_test_util.h"
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/wal_filter.h"
 
 namespace rocksdb {
@@ -365,6 +368,73 @@ TEST_F(DBTest2, SharedWriteBufferLimitAcrossDB) {
   ASSERT_OK(DestroyDB(dbname2, options));
 }
 
+TEST_F(DBTest2, WriteBufferManagerStall) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 500000;  // this is never hit
+  options.max_write_buffer_number = 4;
+  options.max_background_flushes = 1;
+  options.write_buffer_manager.reset(
+      new WriteBufferManager(100000, nullptr, true /* allow_stall */));
+  env_->SetBackgroundThreads(1, Env::HIGH);
+  Reopen(options);
+
+  // Block the flushes
+  test::SleepingBackgroundTask sleeping_task_high;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask,
+                 &sleeping_task_high, Env::Priority::HIGH);
+  sleeping_task_high.WaitUntilSleeping();
+
+  std::atomic<bool> stalled(false);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::DelayWrite:WriteBufferManagerStall",
+      [&](void* arg) { stalled = true; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  // The memtable goes over the limit. The next write switches it and stalls
+  // since the immutable memtable still holds the memory.
+  ASSERT_OK(Put(Key(1), DummyString(120000)));
+  std::atomic<bool> done(false);
+  std::thread writer([&]() {
+    EXPECT_OK(Put(Key(2), DummyString(1)));
+    done = true;
+  });
+  while (!stalled) {
+    env_->SleepForMicroseconds(1000);
+  }
+  env_->SleepForMicroseconds(10000);
+  ASSERT_FALSE(done);
+  ASSERT_TRUE(dbfull()->TEST_write_controler().IsStopped());
+
+  // Flushing the immutable memtable frees its memory and ends the stall
+  sleeping_task_high.WakeUp();
+  sleeping_task_high.WaitUntilDone();
+  writer.join();
+  ASSERT_TRUE(done);
+  ASSERT_FALSE(dbfull()->TEST_write_controler().IsStopped());
+  ASSERT_EQ(DummyString(120000), Get(Key(1)));
+  ASSERT_EQ(DummyString(1), Get(Key(2)));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBTest2, WriteBufferManagerCostToCache) {
+  Options options = CurrentOptions();
+  std::shared_ptr<Cache> cache = NewLRUCache(16 << 20);
+  options.write_buffer_manager.reset(new WriteBufferManager(0, cache));
+  Reopen(options);
+
+  size_t base_usage = cache->GetPinnedUsage();
+  ASSERT_OK(Put(Key(1), DummyString(1 << 20)));
+  ASSERT_GE(cache->GetPinnedUsage(), base_usage + (1 << 20));
+  ASSERT_FALSE(dbfull()->TEST_write_controler().IsStopped());
+
+  // The charge is released once the flushed memtable is freed
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_LT(cache->GetPinnedUsage(), base_usage + (1 << 20));
+}
+
 namespace {
   void ValidateKeyExistence(DB* db, const std::vector<Slice>& keys_must_exist,
     const std::vector<Slice>& keys_must_not_exist) {
@@ -1024,6 +1094,77 @@ TEST_F(DBTest2, PresetCompressionDict) {
   }
 }
 
+TEST_F(DBTest2, FlushCompressionDict) {
+  const size_t kMaxDictBytes = 4 << 10;
+  // ZSTD_MAGIC_DICTIONARY, which begins every dictionary made by ZDICT
+  const uint32_t kZSTDDictMagic = 0xEC30A437;
+  std::vector<std::pair<CompressionType, uint32_t>> configs;
+  if (Zlib_Supported()) {
+    configs.emplace_back(kZlibCompression, 0);
+  }
+  if (ZSTD_TrainDictionarySupported()) {
+    configs.emplace_back(kZSTDNotFinalCompression, 0);
+    configs.emplace_back(kZSTDNotFinalCompression, 100 * kMaxDictBytes);
+  }
+
+  for (const auto& config : configs) {
+    for (bool use_dict_for_flush : {false, true}) {
+      Options options = CurrentOptions();
+      options.compression = config.first;
+      options.compression_opts.max_dict_bytes = kMaxDictBytes;
+      options.compression_opts.zstd_max_train_bytes = config.second;
+      options.compression_opts.use_dict_for_flush = use_dict_for_flush;
+      DestroyAndReopen(options);
+
+      std::string dict;
+      rocksdb::SyncPoint::GetInstance()->SetCallBack(
+          "BuildTable:CompressionDict",
+          [&](void* arg) { dict = *reinterpret_cast<std::string*>(arg); });
+      rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+      // Small JSON-like values that only compress well together
+      Random rnd(301);
+      std::vector<std::string> values;
+      for (int i = 0; i < 1000; i++) {
+        values.push_back("{\"id\": " + ToString(i) + ", \"name\": \"" +
+                         RandomString(&rnd, 8) +
+                         "\", \"tags\": [\"alpha\", \"beta\"]}");
+        ASSERT_OK(Put(Key(i), values[i]));
+      }
+      ASSERT_OK(Flush());
+      rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+      rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+      TablePropertiesCollection props;
+      ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+      ASSERT_EQ(1U, props.size());
+      const auto& tp = *props.begin()->second;
+      ASSERT_EQ(dict.size(), tp.compression_dict_size);
+      if (!use_dict_for_flush) {
+        ASSERT_EQ(0U, dict.size());
+        continue;
+      }
+      ASSERT_GE(dict.size(), sizeof(uint32_t));
+      ASSERT_LE(dict.size(), kMaxDictBytes);
+      if (config.second > 0) {
+        // Trained by ZDICT
+        ASSERT_EQ(kZSTDDictMagic, DecodeFixed32(dict.data()));
+      } else {
+        // The raw samples, which begin with the first key, reach the last
+        // keys and fill the dictionary
+        ASSERT_NE(kZSTDDictMagic, DecodeFixed32(dict.data()));
+        ASSERT_EQ(Key(0), dict.substr(0, Key(0).size()));
+        ASSERT_NE(std::string::npos, dict.find(Key(990).substr(0, 7)));
+        ASSERT_EQ(kMaxDictBytes, dict.size());
+      }
+
+      for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(values[i], Get(Key(i)));
+      }
+    }
+  }
+}
+
 class CompactionCompressionListener : public EventListener {
  public:
   explicit CompactionCompressionListener(Options* db_options)
@@ -1119,6 +1260,165 @@ TEST_F(DBTest2, CompressionOptions) {
   }
 }
 
+TEST_F(DBTest2, ParallelCompression) {
+  CompressionType compression_type;
+  if (Snappy_Supported()) {
+    compression_type = kSnappyCompression;
+  } else if (Zlib_Supported()) {
+    compression_type = kZlibCompression;
+  } else {
+    return;
+  }
+
+  const int kNumKeys = 2000;
+  // Name and contents of the table files of the serial run
+  std::map<std::string, std::string> serial_files;
+  for (uint32_t parallel_threads : {1, 4}) {
+    Options options = CurrentOptions();
+    // Stop the clock, so that the creation time of the files is the same in
+    // both runs
+    env_->time_elapse_only_sleep_ = true;
+    env_->addon_time_.store(0);
+    options.env = env_;
+    options.compression = compression_type;
+    options.compression_opts.parallel_threads = parallel_threads;
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    table_options.verify_compression = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      values.push_back(RandomString(&rnd, 10) + std::string(90, 'x'));
+      ASSERT_OK(Put(Key(i), values[i]));
+      if (i % 500 == 499) {
+        ASSERT_OK(Flush());
+      }
+    }
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(Key(count), iter->key().ToString());
+      count++;
+    }
+    ASSERT_EQ(kNumKeys, count);
+
+    // The workers must produce the same files as inline compression.
+    std::map<std::string, std::string> files;
+    std::vector<std::string> file_names;
+    GetSstFiles(dbname_, &file_names);
+    for (const auto& file_name : file_names) {
+      ASSERT_OK(ReadFileToString(env_, dbname_ + "/" + file_name,
+                                 &files[file_name]));
+    }
+    ASSERT_FALSE(files.empty());
+    if (parallel_threads == 1) {
+      serial_files = std::move(files);
+    } else {
+      ASSERT_EQ(serial_files.size(), files.size());
+      for (const auto& file : serial_files) {
+        ASSERT_TRUE(files[file.first] == file.second) << file.first;
+      }
+    }
+  }
+  env_->time_elapse_only_sleep_ = false;
+}
+
+TEST_F(DBTest2, DirectIO) {
+#if !defined(OS_MACOSX) && !defined(OS_WIN)
+  // Keep using the direct IO files even where the file system of the test
+  // directory rejects O_DIRECT.
+  std::atomic<int> num_direct_writes(0);
+  std::atomic<int> num_direct_reads(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "NewWritableFile:O_DIRECT", [&](void* arg) {
+        int* val = static_cast<int*>(arg);
+        *val &= ~O_DIRECT;
+        num_direct_writes++;
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "NewRandomAccessFile:O_DIRECT", [&](void* arg) {
+        int* val = static_cast<int*>(arg);
+        *val &= ~O_DIRECT;
+        num_direct_reads++;
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+#endif
+
+  const int kNumKeys = 500;
+  uint64_t buffered_bytes = 0;
+  for (bool direct_io : {false, true}) {
+    Options options = CurrentOptions();
+    options.disable_auto_compactions = true;
+    options.use_direct_reads = direct_io;
+    options.use_direct_io_for_flush_and_compaction = direct_io;
+    DestroyAndReopen(options);
+    if (direct_io) {
+      // Compaction inputs are read ahead since there is no page cache.
+      ASSERT_EQ(2U << 20, dbfull()->GetDBOptions().compaction_readahead_size);
+    }
+
+    // Values of uneven sizes keep the blocks off the alignment boundaries.
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      values.push_back(RandomString(&rnd, 500 + rnd.Uniform(500)));
+      ASSERT_OK(Put(Key(i), values[i]));
+      if (i % 100 == 99) {
+        ASSERT_OK(Flush());
+      }
+    }
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+    Reopen(options);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    int count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(values[count], iter->value().ToString());
+      count++;
+    }
+    ASSERT_EQ(kNumKeys, count);
+    iter.reset();
+
+    // The padding of the last page must be cut off the table files.
+    uint64_t total_bytes = 0;
+    std::vector<std::string> files;
+    GetSstFiles(dbname_, &files);
+    for (const auto& file : files) {
+      uint64_t curr_bytes;
+      ASSERT_OK(env_->GetFileSize(dbname_ + "/" + file, &curr_bytes));
+      total_bytes += curr_bytes;
+    }
+    if (!direct_io) {
+      buffered_bytes = total_bytes;
+    } else {
+      ASSERT_EQ(buffered_bytes, total_bytes);
+    }
+  }
+#if !defined(OS_MACOSX) && !defined(OS_WIN)
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(num_direct_writes.load(), 0);
+  ASSERT_GT(num_direct_reads.load(), 0);
+#endif
+
+  Options options = CurrentOptions();
+  options.use_direct_reads = true;
+  options.allow_mmap_reads = true;
+  ASSERT_TRUE(TryReopen(options).IsNotSupported());
+}
+
 class CompactionStallTestListener : public EventListener {
  public:
   CompactionStallTestListener() : compacted_files_cnt_(0) {}
@@ -1814,8 +2114,321 @@ TEST_P(MergeOperatorPinningTest, EvictCacheBeforeMerge) {
 
   VerifyDBFromMap(true_data);
 }
+
+TEST_F(DBTest2, MultiGetBatchedLookup) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendTESTOperator();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  // Small blocks so that a batch spans several blocks, some shared by keys
+  table_options.block_size = 256;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 300;
+  Random rnd(301);
+  // Bottom level: every other key
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 20)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+  // L1: overwrites and merge operands
+  for (int i = 0; i < kNumKeys; i += 3) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 20)));
+  }
+  for (int i = 0; i < kNumKeys; i += 5) {
+    ASSERT_OK(db_->Merge(WriteOptions(), Key(i), RandomString(&rnd, 10)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  // Two overlapping L0 files with deletions and more merge operands
+  for (int i = 0; i < kNumKeys; i += 7) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < kNumKeys; i += 11) {
+    ASSERT_OK(db_->Merge(WriteOptions(), Key(i), RandomString(&rnd, 10)));
+  }
+  ASSERT_OK(Flush());
+  // Memtable
+  for (int i = 0; i < kNumKeys; i += 13) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 20)));
+  }
+  ASSERT_EQ("2,1,1", FilesPerLevel());
+
+  // Unsorted keys, some of them more than once and some out of range
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys + 20; i++) {
+    key_strs.push_back(Key(rnd.Uniform(kNumKeys + 20)));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<ColumnFamilyHandle*> cfs(keys.size(), db_->DefaultColumnFamily());
+  std::vector<std::string> values;
+  std::vector<Status> statuses =
+      db_->MultiGet(ReadOptions(), cfs, keys, &values);
+  ASSERT_EQ(keys.size(), statuses.size());
+  ASSERT_EQ(keys.size(), values.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::string value;
+    Status s = db_->Get(ReadOptions(), keys[i], &value);
+    ASSERT_EQ(s.ToString(), statuses[i].ToString());
+    if (s.ok()) {
+      ASSERT_EQ(value, values[i]);
+    }
+  }
+}
+
+TEST_F(DBTest2, MultiGetMergeOperandsAcrossFiles) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 1024;
+  DestroyAndReopen(options);
+
+  // Snapshots keep the merge operands of "key" apart, so that the compaction
+  // to L1 splits them across several files.
+  ASSERT_OK(Put("a", "va"));
+  ASSERT_OK(Put("z", "vz"));
+  ASSERT_OK(Flush());
+  std::vector<const Snapshot*> snapshots;
+  std::string expected;
+  for (int i = 0; i < 10; i++) {
+    std::string operand(1000, static_cast<char>('a' + i));
+    ASSERT_OK(db_->Merge(WriteOptions(), "key", operand));
+    expected = expected.empty() ? operand : expected + "," + operand;
+    snapshots.push_back(db_->GetSnapshot());
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  for (auto snapshot : snapshots) {
+    db_->ReleaseSnapshot(snapshot);
+  }
+
+  int num_files_ending_at_key = 0;
+  int num_files_starting_at_key = 0;
+  std::vector<LiveFileMetaData> metadata;
+  db_->GetLiveFilesMetaData(&metadata);
+  for (auto& file : metadata) {
+    ASSERT_EQ(1, file.level);
+    num_files_ending_at_key += file.largestkey == "key" ? 1 : 0;
+    num_files_starting_at_key += file.smallestkey == "key" ? 1 : 0;
+  }
+  ASSERT_GT(num_files_ending_at_key, 0);
+  ASSERT_GT(num_files_starting_at_key, 0);
+
+  std::vector<Slice> keys = {"a", "key", "z"};
+  std::vector<ColumnFamilyHandle*> cfs(keys.size(), db_->DefaultColumnFamily());
+  std::vector<std::string> values;
+  std::vector<Status> statuses =
+      db_->MultiGet(ReadOptions(), cfs, keys, &values);
+  for (auto& s : statuses) {
+    ASSERT_OK(s);
+  }
+  ASSERT_EQ("va", values[0]);
+  ASSERT_EQ(expected, values[1]);
+  ASSERT_EQ("vz", values[2]);
+  ASSERT_EQ(expected, Get("key"));
+}
+#endif  // ROCKSDB_LITE
+
+#ifndef ROCKSDB_LITE
+TEST_F(DBTest2, ConcurrentMemtableHashReps) {
+  const int kThreads = 4;
+  const int kBatches = 50;
+  const int kBatchSize = 10;
+  for (int rep = 0; rep < 2; rep++) {
+    Options options = CurrentOptions();
+    options.allow_concurrent_memtable_write = true;
+    options.enable_write_thread_adaptive_yield = true;
+    options.write_buffer_size = 1 << 20;
+    // Key(k) shares its first 7 bytes with 100 other keys, enough for the
+    // buckets of the hash link list to turn into skip lists.
+    options.prefix_extractor.reset(NewFixedPrefixTransform(7));
+    if (rep == 0) {
+      options.memtable_factory.reset(NewHashSkipListRepFactory(16));
+    } else {
+      options.memtable_factory.reset(
+          NewHashLinkListRepFactory(4, 0, 3, true, 4));
+    }
+    DestroyAndReopen(options);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int b = 0; b < kBatches; b++) {
+          WriteBatch batch;
+          for (int i = 0; i < kBatchSize; i++) {
+            int k = (b * kBatchSize + i) * kThreads + t;
+            batch.Put(Key(k), "v" + ToString(k));
+          }
+          EXPECT_OK(db_->Write(WriteOptions(), &batch));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    const int kNumKeys = kThreads * kBatches * kBatchSize;
+    for (int k = 0; k < kNumKeys; k++) {
+      ASSERT_EQ("v" + ToString(k), Get(Key(k)));
+    }
+    ReadOptions read_options;
+    read_options.total_order_seek = true;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    iter->SeekToFirst();
+    for (int k = 0; k < kNumKeys; k++) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(Key(k), iter->key().ToString());
+      iter->Next();
+    }
+    ASSERT_FALSE(iter->Valid());
+  }
+}
 #endif  // ROCKSDB_LITE
 
+TEST_F(DBTest2, MemtableInsertHintPerBatch) {
+  const int kThreads = 4;
+  const int kBatches = 20;
+  const int kBatchSize = 50;
+  for (bool concurrent : {false, true}) {
+    Options options = CurrentOptions();
+    options.allow_concurrent_memtable_write = concurrent;
+    options.enable_write_thread_adaptive_yield = concurrent;
+    options.write_buffer_size = 1 << 20;
+    DestroyAndReopen(options);
+
+    WriteOptions write_options;
+    write_options.memtable_insert_hint_per_batch = true;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&, t]() {
+        for (int b = 0; b < kBatches; b++) {
+          // Each batch writes an ascending run of keys interleaved with the
+          // runs of the other threads, and deletes the first key of the run.
+          WriteBatch batch;
+          for (int i = 0; i < kBatchSize; i++) {
+            int k = (b * kBatchSize + i) * kThreads + t;
+            batch.Put(Key(k), "v" + ToString(k));
+          }
+          batch.Delete(Key(b * kBatchSize * kThreads + t));
+          ASSERT_OK(db_->Write(write_options, &batch));
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->SeekToFirst();
+    for (int k = 0; k < kThreads * kBatches * kBatchSize; k++) {
+      if ((k / kThreads) % kBatchSize == 0) {
+        ASSERT_EQ("NOT_FOUND", Get(Key(k)));
+        continue;
+      }
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(Key(k), iter->key().ToString());
+      ASSERT_EQ("v" + ToString(k), iter->value().ToString());
+      iter->Next();
+    }
+    ASSERT_FALSE(iter->Valid());
+  }
+}
+
+TEST_F(DBTest2, AutoTunedRateLimiter) {
+  const int64_t kMaxRate = 100 << 20;
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.rate_limiter.reset(NewGenericRateLimiter(
+      kMaxRate, 100 * 1000 /* refill_period_us */, 10 /* fairness */,
+      true /* auto_tuned */));
+  options.level0_file_num_compaction_trigger = 2;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 100; j++) {
+      ASSERT_OK(Put(Key(i * 100 + j), RandomString(&rnd, 1000)));
+    }
+    ASSERT_OK(Flush());
+    dbfull()->TEST_WaitForCompact();
+  }
+  ASSERT_LT(NumTableFilesAtLevel(0), 2);
+  ASSERT_GT(options.rate_limiter->GetTotalBytesThrough(), 0);
+
+  // Compactions sample the rate, which stays within the auto-tuned range
+  HistogramData rate;
+  options.statistics->histogramData(RATE_LIMITER_BYTES_PER_SEC, &rate);
+  ASSERT_GE(rate.average, kMaxRate / 20);
+  ASSERT_LE(rate.average, kMaxRate);
+  ASSERT_LE(options.rate_limiter->GetBytesPerSecond(), kMaxRate);
+}
+
+TEST_F(DBTest2, DataBlockHashIndex) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateMaxOperator();
+  BlockBasedTableOptions table_options;
+  table_options.data_block_index_type =
+      BlockBasedTableOptions::kDataBlockBinaryAndHash;
+  // format_version 3 is needed for the hash index
+  table_options.format_version = 2;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+
+  table_options.format_version = 3;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::map<std::string, std::string> true_data;
+  const Snapshot* snapshot = nullptr;
+  std::map<std::string, std::string> snapshot_data;
+  // Only even keys are written, so that odd keys fall between the keys of a
+  // block, and several versions of a key end up in the same file.
+  const int kKeyRange = 2000;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < kKeyRange; i++) {
+      std::string key = Key(2 * static_cast<int>(rnd.Uniform(kKeyRange)));
+      std::string value = RandomString(&rnd, 10);
+      switch (rnd.Uniform(4)) {
+        case 0:
+          ASSERT_OK(Delete(key));
+          true_data.erase(key);
+          break;
+        case 1:
+          ASSERT_OK(db_->Merge(WriteOptions(), key, value));
+          if (true_data[key] < value) {
+            true_data[key] = value;
+          }
+          break;
+        default:
+          ASSERT_OK(Put(key, value));
+          true_data[key] = value;
+          break;
+      }
+    }
+    if (round == 1) {
+      snapshot = db_->GetSnapshot();
+      snapshot_data = true_data;
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  for (int i = 0; i < 2 * kKeyRange; i++) {
+    std::string key = Key(i);
+    auto it = true_data.find(key);
+    ASSERT_EQ(it == true_data.end() ? "NOT_FOUND" : it->second, Get(key));
+    it = snapshot_data.find(key);
+    ASSERT_EQ(it == snapshot_data.end() ? "NOT_FOUND" : it->second,
+              Get(key, snapshot));
+  }
+  db_->ReleaseSnapshot(snapshot);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
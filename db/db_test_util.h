@@ -227,6 +227,15 @@ class SpecialEnv : public EnvWrapper {
           return base_->Append(data);
         }
       }
+      Status PositionedAppend(const Slice& data, uint64_t offset) override {
+        env_->bytes_written_ += data.size();
+        return base_->PositionedAppend(data, offset);
+      }
+      bool UseOSBuffer() const override { return base_->UseOSBuffer(); }
+      bool UseDirectIO() const override { return base_->UseDirectIO(); }
+      size_t GetRequiredBufferAlignment() const override {
+        return base_->GetRequiredBufferAlignment();
+      }
       Status Truncate(uint64_t size) override { return base_->Truncate(size); }
       Status Close() override {
 // SyncPoint is not supported in Released Windows Mode.
@@ -371,6 +380,15 @@ class SpecialEnv : public EnvWrapper {
         *bytes_read_ += result->size();
         return s;
       }
+      virtual bool UseDirectIO() const override {
+        return target_->UseDirectIO();
+      }
+      virtual size_t GetRequiredBufferAlignment() const override {
+        return target_->GetRequiredBufferAlignment();
+      }
+      virtual Status Prefetch(uint64_t offset, size_t n) override {
+        return target_->Prefetch(offset, n);
+      }
 
      private:
       unique_ptr<RandomAccessFile> target_;
@@ -562,10 +580,12 @@ class DBTestBase : public testing::Test {
     kRowCache = 27,
     kRecycleLogFiles = 28,
     kConcurrentSkipList = 29,
-    kEnd = 30,
-    kLevelSubcompactions = 31,
-    kUniversalSubcompactions = 32,
-    kBlockBasedTableWithIndexRestartInterval = 33,
+    kBlockBasedTableWithPartitionedIndex = 30,
+    kPipelinedWrite = 31,
+    kEnd = 32,
+    kLevelSubcompactions = 33,
+    kUniversalSubcompactions = 34,
+    kBlockBasedTableWithIndexRestartInterval = 35,
   };
   int option_config_;
 
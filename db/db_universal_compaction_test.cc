@@ -564,6 +564,49 @@ TEST_P(DBTestUniversalCompactionMultiLevels, UniversalCompactionTrivialMove) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+// Tests that a compaction of L0 files spanning the whole key range is still
+// split into subcompactions
+TEST_P(DBTestUniversalCompactionMultiLevels, UniversalSubcompactionsSplitL0) {
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleUniversal;
+  options.num_levels = num_levels_;
+  options.max_subcompactions = 4;
+  options.write_buffer_size = 10 << 20;  // 10MB
+  options.target_file_size_base = 64 << 10;
+  options.disable_auto_compactions = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 2000;
+  for (int file = 0; file < 2; file++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), RandomString(&rnd, 1000)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(2, NumTableFilesAtLevel(0));
+
+  CompactRangeOptions cro;
+  cro.exclusive_manual_compaction = exclusive_manual_compaction_;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+  ASSERT_GT(NumTableFilesAtLevel(num_levels_ - 1), 1);
+
+  HistogramData subcompactions;
+  options.statistics->histogramData(NUM_SUBCOMPACTIONS_SCHEDULED,
+                                    &subcompactions);
+  ASSERT_GT(subcompactions.average, 1.0);
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(Key(count), iter->key().ToString());
+    count++;
+  }
+  ASSERT_EQ(kNumKeys, count);
+}
+
 INSTANTIATE_TEST_CASE_P(DBTestUniversalCompactionMultiLevels,
                         DBTestUniversalCompactionMultiLevels,
                         ::testing::Combine(::testing::Values(3, 20),
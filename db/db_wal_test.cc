@@ -8,7 +8,9 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "db/db_test_util.h"
+#include "db/write_batch_internal.h"
 #include "port/stack_trace.h"
+#include "rocksdb/wal_filter.h"
 #include "util/options_helper.h"
 #include "util/sync_point.h"
 
@@ -965,6 +967,219 @@ TEST_F(DBWALTest, RecoverFromCorruptedWALWithoutFlush) {
   }
 }
 
+TEST_F(DBWALTest, ParallelRecovery) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  options.disable_auto_compactions = true;
+  CreateAndReopenWithCF({"one", "two"}, options);
+
+  // Batches touching several column families, with an occasional merge
+  // that has to be replayed in log order
+  std::map<std::string, std::string> expected[3];
+  for (int i = 0; i < 3000; i++) {
+    WriteBatch batch;
+    int cf = i % 3;
+    std::string key = "key" + ToString(i % 500);
+    std::string value = ToString(i) + std::string(1000, 'x');
+    batch.Put(handles_[cf], key, value);
+    expected[cf][key] = value;
+    if (i % 7 == 0) {
+      std::string deleted = "key" + ToString((i + 250) % 500);
+      batch.Delete(handles_[(cf + 1) % 3], deleted);
+      expected[(cf + 1) % 3][deleted] = "NOT_FOUND";
+    }
+    if (i % 10 == 0) {
+      batch.Merge(handles_[0], "merge", ToString(i));
+      std::string& merged = expected[0]["merge"];
+      merged = merged.empty() ? ToString(i) : merged + "," + ToString(i);
+    }
+    ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  }
+  SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+  auto validate = [&]() {
+    ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+    for (int cf = 0; cf < 3; cf++) {
+      for (auto& kv : expected[cf]) {
+        ASSERT_EQ(kv.second, Get(cf, kv.first));
+      }
+    }
+  };
+
+  // Small memtables make the replay flush in the middle of the log
+  size_t max_insert_threads = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::RecoverLogFiles:ConcurrentInserts", [&](void* arg) {
+        max_insert_threads =
+            std::max(max_insert_threads, *reinterpret_cast<size_t*>(arg));
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  options.wal_recovery_threads = 4;
+  options.allow_concurrent_memtable_write = true;
+  options.write_buffer_size = 256 * 1024;
+  ReopenWithColumnFamilies({"default", "one", "two"}, options);
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  ASSERT_EQ(4U, max_insert_threads);
+  validate();
+  ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+
+  // The result survives another, serial, recovery
+  options.wal_recovery_threads = 1;
+  options.allow_concurrent_memtable_write = false;
+  ReopenWithColumnFamilies({"default", "one", "two"}, options);
+  validate();
+}
+
+TEST_F(DBWALTest, ParallelPointInTimeRecovery) {
+  const int jcorrupted = RecoveryTestHelper::kWALFileOffset + 2;
+  std::vector<size_t> recovered_row_counts;
+  for (int threads : {1, 4}) {
+    Options options = CurrentOptions();
+    RecoveryTestHelper::FillData(this, &options);
+    RecoveryTestHelper::CorruptWAL(this, options, /*off=*/.3, /*len%=*/.1,
+                                   jcorrupted, /*trunc=*/false);
+
+    options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+    options.wal_recovery_threads = threads;
+    options.allow_concurrent_memtable_write = true;
+    options.create_if_missing = false;
+    ASSERT_OK(TryReopen(options));
+    recovered_row_counts.push_back(RecoveryTestHelper::GetData(this));
+  }
+  // Replaying in parallel stops at the same record
+  ASSERT_GT(recovered_row_counts[0], 0);
+  ASSERT_EQ(recovered_row_counts[0], recovered_row_counts[1]);
+}
+
+TEST_F(DBWALTest, ParallelRecoveryWithSkippedRecord) {
+  // Drops one record of the log
+  class SkipRecordWalFilter : public WalFilter {
+   public:
+    explicit SkipRecordWalFilter(size_t skipped_record)
+        : skipped_record_(skipped_record), current_record_(0) {}
+
+    virtual WalProcessingOption LogRecord(
+        const WriteBatch& /*batch*/, WriteBatch* /*new_batch*/,
+        bool* /*batch_changed*/) const override {
+      return current_record_++ == skipped_record_
+                 ? WalProcessingOption::kIgnoreCurrentRecord
+                 : WalProcessingOption::kContinueProcessing;
+    }
+
+    virtual const char* Name() const override { return "SkipRecordWalFilter"; }
+
+   private:
+    const size_t skipped_record_;
+    mutable size_t current_record_;
+  };
+
+  const int kNumBatches = 1000;
+  const int kSkippedBatch = 500;
+  std::vector<SequenceNumber> recovered_sequences;
+  for (int threads : {1, 4}) {
+    Options options = CurrentOptions();
+    DestroyAndReopen(options);
+    for (int i = 0; i < kNumBatches; i++) {
+      WriteBatch batch;
+      batch.Put("a" + Key(i), ToString(i));
+      batch.Put("b" + Key(i), ToString(i));
+      ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+    }
+
+    SkipRecordWalFilter wal_filter(kSkippedBatch);
+    options.wal_filter = &wal_filter;
+    options.wal_recovery_threads = threads;
+    options.allow_concurrent_memtable_write = true;
+    Reopen(options);
+    recovered_sequences.push_back(dbfull()->GetLatestSequenceNumber());
+    for (int i = 0; i < kNumBatches; i++) {
+      std::string expected = i == kSkippedBatch ? "NOT_FOUND" : ToString(i);
+      ASSERT_EQ(expected, Get("a" + Key(i)));
+      ASSERT_EQ(expected, Get("b" + Key(i)));
+    }
+  }
+  // The batches after the skipped one take its sequence numbers
+  ASSERT_EQ(static_cast<SequenceNumber>(2 * (kNumBatches - 1)),
+            recovered_sequences[0]);
+  ASSERT_EQ(recovered_sequences[0], recovered_sequences[1]);
+}
+
+TEST_F(DBWALTest, ParallelRecoveryWithMalformedRecord) {
+  // Replaces one record of the log with a batch whose first record parses
+  // and whose second one doesn't
+  class MalformedRecordWalFilter : public WalFilter {
+   public:
+    explicit MalformedRecordWalFilter(size_t malformed_record)
+        : malformed_record_(malformed_record), current_record_(0) {}
+
+    virtual WalProcessingOption LogRecord(const WriteBatch& /*batch*/,
+                                          WriteBatch* new_batch,
+                                          bool* batch_changed) const override {
+      if (current_record_++ == malformed_record_) {
+        WriteBatch partial;
+        partial.Put("malformed", "value");
+        std::string contents = partial.Data();
+        contents.push_back(static_cast<char>(kMaxValue));
+        WriteBatchInternal::SetContents(new_batch, contents);
+        WriteBatchInternal::SetCount(new_batch, 2);
+        *batch_changed = true;
+      }
+      return WalProcessingOption::kContinueProcessing;
+    }
+
+    virtual const char* Name() const override {
+      return "MalformedRecordWalFilter";
+    }
+
+   private:
+    const size_t malformed_record_;
+    mutable size_t current_record_;
+  };
+
+  const int kNumBatches = 1000;
+  const int kMalformedBatch = 500;
+  // Without paranoid checks the error is ignored and the batches after the
+  // malformed one take the sequence number it didn't use. With them, point
+  // in time recovery stops at the malformed batch.
+  for (bool paranoid_checks : {false, true}) {
+    std::vector<SequenceNumber> recovered_sequences;
+    std::vector<std::string> recovered_data;
+    for (int threads : {1, 4}) {
+      Options options = CurrentOptions();
+      DestroyAndReopen(options);
+      for (int i = 0; i < kNumBatches; i++) {
+        WriteBatch batch;
+        batch.Put("a" + Key(i), ToString(i));
+        batch.Put("b" + Key(i), ToString(i));
+        ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+      }
+
+      MalformedRecordWalFilter wal_filter(kMalformedBatch);
+      options.wal_filter = &wal_filter;
+      options.paranoid_checks = paranoid_checks;
+      options.wal_recovery_mode = WALRecoveryMode::kPointInTimeRecovery;
+      options.wal_recovery_threads = threads;
+      options.allow_concurrent_memtable_write = true;
+      Reopen(options);
+      recovered_sequences.push_back(dbfull()->GetLatestSequenceNumber());
+      ASSERT_EQ("value", Get("malformed"));
+      std::string data;
+      for (int i = 0; i < kNumBatches; i++) {
+        data += Get("a" + Key(i)) + "," + Get("b" + Key(i)) + ";";
+      }
+      recovered_data.push_back(data);
+    }
+    if (paranoid_checks) {
+      ASSERT_EQ(static_cast<SequenceNumber>(2 * kMalformedBatch + 1),
+                recovered_sequences[0]);
+    } else {
+      ASSERT_EQ(static_cast<SequenceNumber>(2 * kNumBatches - 1),
+                recovered_sequences[0]);
+    }
+    ASSERT_EQ(recovered_sequences[0], recovered_sequences[1]);
+    ASSERT_EQ(recovered_data[0], recovered_data[1]);
+  }
+}
+
 #endif  // ROCKSDB_LITE
 
 }  // namespace rocksdb
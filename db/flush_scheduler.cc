@@ -47,6 +47,7 @@ ColumnFamilyData* FlushScheduler::TakeNextColumnFamily() {
 
 #ifndef NDEBUG
     {
+      std::lock_guard<std::mutex> lock(checking_mutex_);
       auto iter = checking_set_.find(cfd);
       assert(iter != checking_set_.end());
       checking_set_.erase(iter);
@@ -67,7 +68,12 @@ ColumnFamilyData* FlushScheduler::TakeNextColumnFamily() {
 
 bool FlushScheduler::Empty() {
   auto rv = head_.load(std::memory_order_relaxed) == nullptr;
-  assert(rv == checking_set_.empty());
+#ifndef NDEBUG
+  // With pipelined write, Empty() may race with ScheduleFlush() and miss
+  // the most recent schedules.
+  std::lock_guard<std::mutex> lock(checking_mutex_);
+  assert(rv == checking_set_.empty() || rv);
+#endif  // NDEBUG
   return rv;
 }
 
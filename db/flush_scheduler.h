@@ -28,6 +28,8 @@ class FlushScheduler {
   // Filters column families that have been dropped.
   ColumnFamilyData* TakeNextColumnFamily();
 
+  // May be called concurrently with ScheduleFlush(), in which case the
+  // most recent schedules might not be seen yet
   bool Empty();
 
   void Clear();
@@ -9,6 +9,8 @@
 
 #include "db/inlineskiplist.h"
 #include <set>
+#include <thread>
+#include <vector>
 #include "rocksdb/env.h"
 #include "util/concurrent_arena.h"
 #include "util/hash.h"
@@ -142,6 +144,85 @@ TEST_F(InlineSkipTest, InsertAndLookup) {
   }
 }
 
+// Inserts keys from several interleaved ascending runs, each with its own
+// hint, mixed with unhinted inserts, and checks the final contents.
+TEST_F(InlineSkipTest, InsertWithHint) {
+  const int kRuns = 4;
+  const int kKeysPerRun = 500;
+  Arena arena;
+  TestComparator cmp;
+  InlineSkipList<TestComparator> list(cmp, &arena);
+  std::set<Key> keys;
+  void* hints[kRuns] = {nullptr};
+  Random rnd(301);
+  for (int i = 0; i < kKeysPerRun; i++) {
+    for (int run = 0; run < kRuns; run++) {
+      // Runs are spread over disjoint key ranges, with small gaps inside
+      // each run that later unhinted inserts land in.
+      Key key = run * 1000000 + i * 10 + rnd.Uniform(5);
+      if (keys.insert(key).second) {
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        list.InsertWithHint(buf, &hints[run]);
+      }
+    }
+    Key key = rnd.Uniform(kRuns) * 1000000 + rnd.Uniform(kKeysPerRun * 10);
+    if (keys.insert(key).second) {
+      char* buf = list.AllocateKey(sizeof(Key));
+      memcpy(buf, &key, sizeof(Key));
+      list.Insert(buf);
+    }
+  }
+  for (int run = 0; run < kRuns; run++) {
+    ASSERT_TRUE(hints[run] != nullptr);
+    delete[] reinterpret_cast<char*>(hints[run]);
+  }
+
+  InlineSkipList<TestComparator>::Iterator iter(&list);
+  iter.SeekToFirst();
+  for (Key key : keys) {
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(key, Decode(iter.key()));
+    ASSERT_TRUE(list.Contains(Encode(&key)));
+    iter.Next();
+  }
+  ASSERT_TRUE(!iter.Valid());
+}
+
+// Several threads insert interleaved keys, each through its own hint.
+TEST_F(InlineSkipTest, InsertWithHintConcurrently) {
+  const int kThreads = 4;
+  const int kKeysPerThread = 2000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  InlineSkipList<TestComparator> list(cmp, &arena);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&list, t]() {
+      void* hint = nullptr;
+      for (int i = 0; i < kKeysPerThread; i++) {
+        Key key = static_cast<Key>(i) * kThreads + t;
+        char* buf = list.AllocateKey(sizeof(Key));
+        memcpy(buf, &key, sizeof(Key));
+        list.InsertWithHintConcurrently(buf, &hint);
+      }
+      delete[] reinterpret_cast<char*>(hint);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  InlineSkipList<TestComparator>::Iterator iter(&list);
+  iter.SeekToFirst();
+  for (Key key = 0; key < kThreads * kKeysPerThread; key++) {
+    ASSERT_TRUE(iter.Valid());
+    ASSERT_EQ(key, Decode(iter.key()));
+    iter.Next();
+  }
+  ASSERT_TRUE(!iter.Valid());
+}
+
 // We want to make sure that with a single writer and multiple
 // concurrent readers (with no synchronization other than when a
 // reader's iterator is created), the reader always observes all the
@@ -32,6 +32,7 @@ namespace rocksdb {
 class Mutex;
 class MemTableIterator;
 class MergeContext;
+class RangeDelAggregator;
 class InternalIterator;
 
 struct MemTableOptions {
@@ -41,6 +42,7 @@ struct MemTableOptions {
   size_t write_buffer_size;
   size_t arena_block_size;
   uint32_t memtable_prefix_bloom_bits;
+  bool memtable_whole_key_filtering;
   size_t memtable_huge_page_size;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
@@ -159,15 +161,27 @@ class MemTable {
   //        those allocated in arena.
   InternalIterator* NewIterator(const ReadOptions& read_options, Arena* arena);
 
+  // Returns an iterator over the range tombstones of this memtable, or nullptr
+  // if it has none. The keys are internal keys of type kTypeRangeDeletion and
+  // the values are the (exclusive) end keys of the ranges.
+  //
+  // The caller must ensure that the underlying MemTable remains live
+  // while the returned iterator is live.
+  InternalIterator* NewRangeTombstoneIterator(const ReadOptions& read_options);
+
   // Add an entry into memtable that maps key to value at the
   // specified sequence number and with the specified type.
   // Typically value will be empty if type==kTypeDeletion.
   //
+  // If hint is non-null, it is passed to MemTableRep::InsertWithHint for
+  // point entries; see there for its ownership.  Range deletions ignore it.
+  //
   // REQUIRES: if allow_concurrent = false, external synchronization to prevent
   // simultaneous operations on the same MemTable.
   void Add(SequenceNumber seq, ValueType type, const Slice& key,
            const Slice& value, bool allow_concurrent = false,
-           MemTablePostProcessInfo* post_process_info = nullptr);
+           MemTablePostProcessInfo* post_process_info = nullptr,
+           void** hint = nullptr);
 
   // If memtable contains a value for key, store it in *value and return true.
   // If memtable contains a deletion for key, store a NotFound() error
@@ -182,13 +196,19 @@ class MemTable {
   // returned).  Otherwise, *seq will be set to kMaxSequenceNumber.
   // On success, *s may be set to OK, NotFound, or MergeInProgress.  Any other
   // status returned indicates a corruption or other unexpected error.
+  //
+  // The range tombstones of this memtable are added to *range_del_agg before
+  // the lookup, and values covered by a tombstone in *range_del_agg are
+  // treated as deleted. range_del_agg may be nullptr to ignore range
+  // deletions.
   bool Get(const LookupKey& key, std::string* value, Status* s,
-           MergeContext* merge_context, SequenceNumber* seq);
+           MergeContext* merge_context, RangeDelAggregator* range_del_agg,
+           SequenceNumber* seq);
 
   bool Get(const LookupKey& key, std::string* value, Status* s,
-           MergeContext* merge_context) {
+           MergeContext* merge_context, RangeDelAggregator* range_del_agg) {
     SequenceNumber seq;
-    return Get(key, value, s, merge_context, &seq);
+    return Get(key, value, s, merge_context, range_del_agg, &seq);
   }
 
   // Attempts to update the new_value inplace, else does normal Add
@@ -306,6 +326,7 @@ class MemTable {
   // write anything to this MemTable().  (Ie. do not call Add() or Update()).
   void MarkImmutable() {
     table_->MarkReadOnly();
+    range_del_table_->MarkReadOnly();
     allocator_.DoneAllocating();
   }
 
@@ -345,6 +366,10 @@ class MemTable {
   ConcurrentArena arena_;
   MemTableAllocator allocator_;
   unique_ptr<MemTableRep> table_;
+  // Range tombstones are kept in their own, always totally ordered, rep so
+  // that point lookups and iterators over table_ never see them.
+  unique_ptr<MemTableRep> range_del_table_;
+  std::atomic<bool> is_range_del_table_empty_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
@@ -378,7 +403,9 @@ class MemTable {
   std::vector<port::RWMutex> locks_;
 
   const SliceTransform* const prefix_extractor_;
-  std::unique_ptr<DynamicBloom> prefix_bloom_;
+  // Holds the prefixes of the keys if prefix_extractor_ is set, and the
+  // whole user keys if memtable_whole_key_filtering is set.
+  std::unique_ptr<DynamicBloom> bloom_filter_;
 
   std::atomic<FlushStateEnum> flush_state_;
 
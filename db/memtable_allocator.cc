@@ -19,13 +19,15 @@ MemTableAllocator::MemTableAllocator(Allocator* allocator,
                                      WriteBufferManager* write_buffer_manager)
     : allocator_(allocator),
       write_buffer_manager_(write_buffer_manager),
-      bytes_allocated_(0) {}
+      bytes_allocated_(0),
+      done_allocating_(false) {}
 
-MemTableAllocator::~MemTableAllocator() { DoneAllocating(); }
+MemTableAllocator::~MemTableAllocator() { FreeMem(); }
 
 char* MemTableAllocator::Allocate(size_t bytes) {
   assert(write_buffer_manager_ != nullptr);
-  if (write_buffer_manager_->enabled()) {
+  if (write_buffer_manager_->enabled() ||
+      write_buffer_manager_->cost_to_cache()) {
     bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
     write_buffer_manager_->ReserveMem(bytes);
   }
@@ -35,7 +37,8 @@ char* MemTableAllocator::Allocate(size_t bytes) {
 char* MemTableAllocator::AllocateAligned(size_t bytes, size_t huge_page_size,
                                          Logger* logger) {
   assert(write_buffer_manager_ != nullptr);
-  if (write_buffer_manager_->enabled()) {
+  if (write_buffer_manager_->enabled() ||
+      write_buffer_manager_->cost_to_cache()) {
     bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
     write_buffer_manager_->ReserveMem(bytes);
   }
@@ -43,13 +46,26 @@ char* MemTableAllocator::AllocateAligned(size_t bytes, size_t huge_page_size,
 }
 
 void MemTableAllocator::DoneAllocating() {
-  if (write_buffer_manager_ != nullptr) {
-    if (write_buffer_manager_->enabled()) {
-      write_buffer_manager_->FreeMem(
+  if (write_buffer_manager_ != nullptr && !done_allocating_) {
+    if (write_buffer_manager_->enabled() ||
+        write_buffer_manager_->cost_to_cache()) {
+      write_buffer_manager_->ScheduleFreeMem(
           bytes_allocated_.load(std::memory_order_relaxed));
     } else {
       assert(bytes_allocated_.load(std::memory_order_relaxed) == 0);
     }
+    done_allocating_ = true;
+  }
+}
+
+void MemTableAllocator::FreeMem() {
+  if (write_buffer_manager_ != nullptr) {
+    DoneAllocating();
+    if (write_buffer_manager_->enabled() ||
+        write_buffer_manager_->cost_to_cache()) {
+      write_buffer_manager_->FreeMem(
+          bytes_allocated_.load(std::memory_order_relaxed));
+    }
     write_buffer_manager_ = nullptr;
   }
 }
@@ -33,14 +33,19 @@ class MemTableAllocator : public Allocator {
                         Logger* logger = nullptr) override;
   size_t BlockSize() const override;
 
-  // Call when we're finished allocating memory so we can free it from
-  // the write buffer's limit.
+  // Call when we're finished allocating memory so that it no longer counts
+  // towards the mutable memtable memory of the write buffer manager.
   void DoneAllocating();
 
+  // Call when the memory is about to be released to free it from the write
+  // buffer manager's limit and from the cache it is charged to.
+  void FreeMem();
+
  private:
   Allocator* allocator_;
   WriteBufferManager* write_buffer_manager_;
   std::atomic<size_t> bytes_allocated_;
+  bool done_allocating_;
 
   // No copying allowed
   MemTableAllocator(const MemTableAllocator&);
@@ -35,7 +35,7 @@ int main() {
 #include "rocksdb/options.h"
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/write_buffer_manager.h"
-#include "util/arena.h"
+#include "util/concurrent_arena.h"
 #include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/testutil.h"
@@ -47,7 +47,20 @@ using GFLAGS::SetUsageMessage;
 DEFINE_string(benchmarks, "fillrandom",
               "Comma-separated list of benchmarks to run. Options:\n"
               "\tfillrandom             -- write N random values\n"
+              "\tfillrandomconcurrent   -- like fillrandom, with N values "
+              "written by\n"
+              "\t                          --num_threads threads through "
+              "InsertConcurrently\n"
               "\tfillseq                -- write N values in sequential order\n"
+              "\tfillseqconcurrent      -- like fillseq, with N values written "
+              "by\n"
+              "\t                          --num_threads threads through "
+              "InsertConcurrently\n"
+              "\tfillclustered          -- write N values in ascending runs "
+              "of\n"
+              "\t                          --cluster_size keys starting at "
+              "random\n"
+              "\t                          positions\n"
               "\treadrandom             -- read N values in random order\n"
               "\treadseq                -- scan the DB\n"
               "\treadwrite              -- 1 thread writes while N - 1 threads "
@@ -109,7 +122,8 @@ DEFINE_int64(
 DEFINE_int32(
     num_threads, 1,
     "Number of concurrent threads to run. If the benchmark includes writes,\n"
-    "then at most one thread will be a writer");
+    "then at most one thread will be a writer, except for the *concurrent\n"
+    "benchmarks where all of them are");
 
 DEFINE_int32(num_operations, 1000000,
              "Number of operations to do for write and random read benchmarks");
@@ -121,6 +135,13 @@ DEFINE_int32(num_scans, 10,
 
 DEFINE_int32(item_size, 100, "Number of bytes each item should be");
 
+DEFINE_int32(cluster_size, 100,
+             "Number of consecutive keys in each run of fillclustered");
+
+DEFINE_bool(insert_with_hint, false,
+            "If true, writer threads insert through MemTableRep::InsertWithHint "
+            "with a hint kept per thread");
+
 DEFINE_int32(prefix_length, 8,
              "Prefix length to pass into NewFixedPrefixTransform");
 
@@ -167,12 +188,21 @@ class RandomGenerator {
   }
 };
 
-enum WriteMode { SEQUENTIAL, RANDOM, UNIQUE_RANDOM };
+enum WriteMode { SEQUENTIAL, RANDOM, UNIQUE_RANDOM, CLUSTERED };
+
+// Keys are encoded big-endian so that sequential keys are also sequential in
+// the bytewise order of the memtable.
+static void EncodeKey(char* buf, uint64_t key) {
+  for (int i = 7; i >= 0; --i) {
+    buf[i] = static_cast<char>(key & 0xff);
+    key >>= 8;
+  }
+}
 
 class KeyGenerator {
  public:
   KeyGenerator(Random64* rand, WriteMode mode, uint64_t num)
-      : rand_(rand), mode_(mode), num_(num), next_(0) {
+      : rand_(rand), mode_(mode), num_(num), next_(0), cluster_start_(0) {
     if (mode_ == UNIQUE_RANDOM) {
       // NOTE: if memory consumption of this approach becomes a concern,
       // we can either break it into pieces and only random shuffle a section
@@ -196,6 +226,11 @@ class KeyGenerator {
         return rand_->Next() % num_;
       case UNIQUE_RANDOM:
         return values_[next_++];
+      case CLUSTERED:
+        if (next_++ % FLAGS_cluster_size == 0) {
+          cluster_start_ = rand_->Next() % num_;
+        }
+        return cluster_start_ + (next_ - 1) % FLAGS_cluster_size;
     }
     assert(false);
     return std::numeric_limits<uint64_t>::max();
@@ -206,6 +241,7 @@ class KeyGenerator {
   WriteMode mode_;
   const uint64_t num_;
   uint64_t next_;
+  uint64_t cluster_start_;
   std::vector<uint64_t> values_;
 };
 
@@ -243,7 +279,10 @@ class FillBenchmarkThread : public BenchmarkThread {
                       uint64_t* bytes_written, uint64_t* bytes_read,
                       uint64_t* sequence, uint64_t num_ops, uint64_t* read_hits)
       : BenchmarkThread(table, key_gen, bytes_written, bytes_read, sequence,
-                        num_ops, read_hits) {}
+                        num_ops, read_hits),
+        hint_(nullptr) {}
+
+  ~FillBenchmarkThread() { delete[] reinterpret_cast<char*>(hint_); }
 
   void FillOne() {
     char* buf = nullptr;
@@ -253,16 +292,16 @@ class FillBenchmarkThread : public BenchmarkThread {
     KeyHandle handle = table_->Allocate(encoded_len, &buf);
     assert(buf != nullptr);
     char* p = EncodeVarint32(buf, internal_key_size);
-    auto key = key_gen_->Next();
-    EncodeFixed64(p, key);
+    auto key = NextKey();
+    EncodeKey(p, key);
     p += 8;
-    EncodeFixed64(p, ++(*sequence_));
+    EncodeFixed64(p, NextSequence());
     p += 8;
     Slice bytes = generator_.Generate(FLAGS_item_size);
     memcpy(p, bytes.data(), FLAGS_item_size);
     p += FLAGS_item_size;
     assert(p == buf + encoded_len);
-    table_->Insert(handle);
+    InsertOne(handle);
     *bytes_written_ += encoded_len;
   }
 
@@ -271,6 +310,60 @@ class FillBenchmarkThread : public BenchmarkThread {
       FillOne();
     }
   }
+
+ protected:
+  virtual uint64_t NextKey() { return key_gen_->Next(); }
+
+  virtual uint64_t NextSequence() { return ++(*sequence_); }
+
+  virtual void InsertOne(KeyHandle handle) {
+    if (FLAGS_insert_with_hint) {
+      table_->InsertWithHint(handle, &hint_);
+    } else {
+      table_->Insert(handle);
+    }
+  }
+
+  void* hint_;
+};
+
+// One of FLAGS_num_threads writers inserting at the same time. Each writer
+// has its own key generator and takes every num_threads-th key, so that the
+// writers together cover the same key space as a single FillBenchmarkThread.
+class ParallelFillBenchmarkThread : public FillBenchmarkThread {
+ public:
+  ParallelFillBenchmarkThread(MemTableRep* table, KeyGenerator* key_gen,
+                              uint64_t* bytes_written,
+                              std::atomic<uint64_t>* sequence,
+                              uint64_t num_ops, uint32_t thread_index,
+                              uint32_t num_threads)
+      : FillBenchmarkThread(table, key_gen, bytes_written, nullptr, nullptr,
+                            num_ops, nullptr),
+        shared_sequence_(sequence),
+        thread_index_(thread_index),
+        num_threads_(num_threads) {}
+
+ protected:
+  uint64_t NextKey() override {
+    return key_gen_->Next() * num_threads_ + thread_index_;
+  }
+
+  uint64_t NextSequence() override {
+    return shared_sequence_->fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  void InsertOne(KeyHandle handle) override {
+    if (FLAGS_insert_with_hint) {
+      table_->InsertWithHintConcurrently(handle, &hint_);
+    } else {
+      table_->InsertConcurrently(handle);
+    }
+  }
+
+ private:
+  std::atomic<uint64_t>* shared_sequence_;
+  const uint32_t thread_index_;
+  const uint32_t num_threads_;
 };
 
 class ConcurrentFillBenchmarkThread : public FillBenchmarkThread {
@@ -322,7 +415,8 @@ class ReadBenchmarkThread : public BenchmarkThread {
   void ReadOne() {
     std::string user_key;
     auto key = key_gen_->Next();
-    PutFixed64(&user_key, key);
+    user_key.resize(8);
+    EncodeKey(&user_key[0], key);
     LookupKey lookup_key(user_key, *sequence_);
     InternalKeyComparator internal_key_comp(BytewiseComparator());
     CallbackVerifyArgs verify_args;
@@ -486,6 +580,44 @@ class FillBenchmark : public Benchmark {
   }
 };
 
+class ParallelFillBenchmark : public Benchmark {
+ public:
+  explicit ParallelFillBenchmark(MemTableRep* table, WriteMode mode,
+                                 uint64_t* sequence)
+      : Benchmark(table, nullptr, sequence, FLAGS_num_threads), mode_(mode) {
+    num_write_ops_per_thread_ = FLAGS_num_operations / FLAGS_num_threads;
+  }
+
+  void RunThreads(std::vector<std::thread>* threads, uint64_t* bytes_written,
+                  uint64_t* bytes_read, bool write,
+                  uint64_t* read_hits) override {
+    std::atomic<uint64_t> sequence(*sequence_);
+    std::vector<std::unique_ptr<Random64>> rands;
+    std::vector<std::unique_ptr<KeyGenerator>> key_gens;
+    std::vector<uint64_t> thread_bytes_written(num_threads_, 0);
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      rands.emplace_back(new Random64(FLAGS_seed + i));
+      key_gens.emplace_back(new KeyGenerator(rands.back().get(), mode_,
+                                             num_write_ops_per_thread_));
+    }
+    for (uint32_t i = 0; i < num_threads_; ++i) {
+      threads->emplace_back(ParallelFillBenchmarkThread(
+          table_, key_gens[i].get(), &thread_bytes_written[i], &sequence,
+          num_write_ops_per_thread_, i, num_threads_));
+    }
+    for (auto& thread : *threads) {
+      thread.join();
+    }
+    for (auto b : thread_bytes_written) {
+      *bytes_written += b;
+    }
+    *sequence_ = sequence.load();
+  }
+
+ private:
+  const WriteMode mode_;
+};
+
 class ReadBenchmark : public Benchmark {
  public:
   explicit ReadBenchmark(MemTableRep* table, KeyGenerator* key_gen,
@@ -621,7 +753,7 @@ int main(int argc, char** argv) {
   rocksdb::InternalKeyComparator internal_key_comp(
       rocksdb::BytewiseComparator());
   rocksdb::MemTable::KeyComparator key_comp(internal_key_comp);
-  rocksdb::Arena arena;
+  rocksdb::ConcurrentArena arena;
   rocksdb::WriteBufferManager wb(FLAGS_write_buffer_size);
   rocksdb::MemTableAllocator memtable_allocator(&arena, &wb);
   uint64_t sequence;
@@ -652,12 +784,32 @@ int main(int argc, char** argv) {
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("fillclustered")) {
+      memtablerep.reset(createMemtableRep());
+      key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::CLUSTERED,
+                                              FLAGS_num_operations));
+      benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
+                                                 key_gen.get(), &sequence));
     } else if (name == rocksdb::Slice("fillrandom")) {
       memtablerep.reset(createMemtableRep());
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::UNIQUE_RANDOM,
                                               FLAGS_num_operations));
       benchmark.reset(new rocksdb::FillBenchmark(memtablerep.get(),
                                                  key_gen.get(), &sequence));
+    } else if (name == rocksdb::Slice("fillseqconcurrent") ||
+               name == rocksdb::Slice("fillrandomconcurrent")) {
+      if (!factory->IsInsertConcurrentlySupported()) {
+        std::cout << "WARNING: skipping " << name.ToString() << ", "
+                  << factory->Name() << " doesn't support concurrent inserts"
+                  << std::endl;
+        continue;
+      }
+      memtablerep.reset(createMemtableRep());
+      benchmark.reset(new rocksdb::ParallelFillBenchmark(
+          memtablerep.get(),
+          name == rocksdb::Slice("fillseqconcurrent") ? rocksdb::SEQUENTIAL
+                                                      : rocksdb::RANDOM,
+          &sequence));
     } else if (name == rocksdb::Slice("readrandom")) {
       key_gen.reset(new rocksdb::KeyGenerator(&rng, rocksdb::RANDOM,
                                               FLAGS_num_operations));
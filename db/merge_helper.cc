@@ -9,6 +9,7 @@
 #include <string>
 
 #include "db/dbformat.h"
+#include "db/range_del_aggregator.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
@@ -76,7 +77,8 @@ Status MergeHelper::TimedFullMerge(const MergeOperator* merge_operator,
 //       keys_[i] corresponds to operands_[i] for each i.
 Status MergeHelper::MergeUntil(InternalIterator* iter,
                                const SequenceNumber stop_before,
-                               const bool at_bottom) {
+                               const bool at_bottom,
+                               RangeDelAggregator* range_del_agg) {
   // Get a copy of the internal key, before it's invalidated by iter->Next()
   // Also maintain the list of merge operands seen.
   assert(HasOperator());
@@ -127,8 +129,13 @@ Status MergeHelper::MergeUntil(InternalIterator* iter,
     // At this point we are guaranteed that we need to process this key.
 
     assert(IsValueType(ikey.type));
-    if (ikey.type != kTypeMerge) {
-      if (ikey.type != kTypeValue && ikey.type != kTypeDeletion) {
+    // A range tombstone covering this entry also covers the older entries of
+    // this snapshot stripe, so it terminates the merge like a Delete.
+    const bool range_deleted =
+        range_del_agg != nullptr && range_del_agg->ShouldDelete(ikey);
+    if (ikey.type != kTypeMerge || range_deleted) {
+      if (!range_deleted && ikey.type != kTypeValue &&
+          ikey.type != kTypeDeletion) {
         // Merges operands can only be used with puts and deletions, single
         // deletions are not supported.
         assert(false);
@@ -155,7 +162,8 @@ Status MergeHelper::MergeUntil(InternalIterator* iter,
       // (almost) silently dropping the put/delete. That's probably not what we
       // want.
       const Slice val = iter->value();
-      const Slice* val_ptr = (kTypeValue == ikey.type) ? &val : nullptr;
+      const Slice* val_ptr =
+          (kTypeValue == ikey.type && !range_deleted) ? &val : nullptr;
       std::string merge_result;
       s = TimedFullMerge(user_merge_operator_, ikey.user_key, val_ptr,
                          merge_context_.GetOperands(), &merge_result, logger_,
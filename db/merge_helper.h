@@ -25,6 +25,7 @@ class Logger;
 class MergeOperator;
 class Statistics;
 class InternalIterator;
+class RangeDelAggregator;
 
 class MergeHelper {
  public:
@@ -66,6 +67,7 @@ class MergeHelper {
   // Merge entries until we hit
   //     - a corrupted key
   //     - a Put/Delete,
+  //     - an entry covered by a range tombstone of range_del_agg,
   //     - a different user key,
   //     - a specific sequence number (snapshot boundary),
   //  or - the end of iteration
@@ -75,6 +77,8 @@ class MergeHelper {
   //                   0 means no restriction
   // at_bottom:   (IN) true if the iterator covers the bottem level, which means
   //                   we could reach the start of the history of this user key.
+  // range_del_agg: (IN) the range tombstones of the input, or nullptr. An
+  //                     entry covered by one of them is treated like a Delete.
   //
   // Returns one of the following statuses:
   // - OK: Entries were successfully merged.
@@ -86,7 +90,8 @@ class MergeHelper {
   // REQUIRED: The first key in the input is not corrupted.
   Status MergeUntil(InternalIterator* iter,
                     const SequenceNumber stop_before = 0,
-                    const bool at_bottom = false);
+                    const bool at_bottom = false,
+                    RangeDelAggregator* range_del_agg = nullptr);
 
   // Filters a merge operand using the compaction filter specified
   // in the constructor. Returns true if the operand should be filtered out.
@@ -0,0 +1,170 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/range_del_aggregator.h"
+
+#include <algorithm>
+
+#include "db/version_edit.h"
+#include "table/internal_iterator.h"
+#include "table/table_builder.h"
+
+namespace rocksdb {
+
+RangeDelAggregator::RangeDelAggregator(
+    const InternalKeyComparator& icmp,
+    const std::vector<SequenceNumber>& snapshots)
+    : icmp_(icmp), upper_bound_(kMaxSequenceNumber), num_tombstones_(0) {
+  InitStripes(snapshots);
+}
+
+RangeDelAggregator::RangeDelAggregator(const InternalKeyComparator& icmp,
+                                       SequenceNumber snapshot)
+    : icmp_(icmp), upper_bound_(snapshot), num_tombstones_(0) {
+  InitStripes({} /* snapshots */);
+}
+
+void RangeDelAggregator::InitStripes(
+    const std::vector<SequenceNumber>& snapshots) {
+  stl_wrappers::LessOfComparator less(icmp_.user_comparator());
+  for (auto snapshot : snapshots) {
+    stripe_map_.emplace(snapshot, TombstoneMap(less));
+  }
+  // Data newer than any snapshot falls in this final stripe
+  stripe_map_.emplace(kMaxSequenceNumber, TombstoneMap(less));
+}
+
+bool RangeDelAggregator::ShouldDelete(const Slice& internal_key) {
+  if (num_tombstones_ == 0) {
+    return false;
+  }
+  ParsedInternalKey parsed;
+  if (!ParseInternalKey(internal_key, &parsed)) {
+    assert(false);
+    return false;
+  }
+  return ShouldDelete(parsed);
+}
+
+bool RangeDelAggregator::ShouldDelete(const ParsedInternalKey& parsed) {
+  assert(IsValueType(parsed.type));
+  if (num_tombstones_ == 0) {
+    return false;
+  }
+  const Comparator* ucmp = icmp_.user_comparator();
+  const auto& tombstone_map = GetTombstoneMap(parsed.sequence);
+  for (const auto& start_key_and_tombstone : tombstone_map) {
+    if (ucmp->Compare(start_key_and_tombstone.first, parsed.user_key) > 0) {
+      // The remaining tombstones start after the key.
+      break;
+    }
+    const auto& tombstone = start_key_and_tombstone.second;
+    if (parsed.sequence < tombstone.seq &&
+        ucmp->Compare(parsed.user_key, tombstone.end_key) < 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+Status RangeDelAggregator::AddTombstones(
+    std::unique_ptr<InternalIterator> input) {
+  if (input == nullptr) {
+    return Status::OK();
+  }
+  for (input->SeekToFirst(); input->Valid(); input->Next()) {
+    ParsedInternalKey parsed_key;
+    if (!ParseInternalKey(input->key(), &parsed_key)) {
+      return Status::Corruption("Unable to parse range tombstone InternalKey");
+    }
+    RangeTombstone tombstone(parsed_key, input->value());
+    if (tombstone.seq_ > upper_bound_) {
+      continue;
+    }
+    auto& tombstone_map = GetTombstoneMap(tombstone.seq_);
+    tombstone_map.emplace(
+        tombstone.start_key_.ToString(),
+        TombstoneValue{tombstone.end_key_.ToString(), tombstone.seq_});
+    ++num_tombstones_;
+  }
+  return input->status();
+}
+
+RangeDelAggregator::TombstoneMap& RangeDelAggregator::GetTombstoneMap(
+    SequenceNumber seq) {
+  // The stripe includes seqnum for the snapshot above and excludes seqnum for
+  // the snapshot below.
+  auto iter = stripe_map_.lower_bound(seq);
+  assert(iter != stripe_map_.end());
+  return iter->second;
+}
+
+void RangeDelAggregator::AddToBuilder(TableBuilder* builder,
+                                      const Slice* lower_bound,
+                                      const Slice* upper_bound,
+                                      FileMetaData* meta,
+                                      bool bottommost_level) {
+  const Comparator* ucmp = icmp_.user_comparator();
+  auto stripe_map_iter = stripe_map_.begin();
+  assert(stripe_map_iter != stripe_map_.end());
+  if (bottommost_level) {
+    // The oldest stripe's tombstones are only needed to cover keys of the
+    // same stripe, which the compaction has already dropped.
+    ++stripe_map_iter;
+  }
+
+  // The order in which tombstones are written is insignificant since the read
+  // path sorts them again.
+  for (; stripe_map_iter != stripe_map_.end(); ++stripe_map_iter) {
+    for (const auto& start_key_and_tombstone : stripe_map_iter->second) {
+      RangeTombstone tombstone(start_key_and_tombstone.first,
+                               start_key_and_tombstone.second.end_key,
+                               start_key_and_tombstone.second.seq);
+      if (upper_bound != nullptr &&
+          ucmp->Compare(*upper_bound, tombstone.start_key_) <= 0) {
+        // This and the following tombstones start at or after upper_bound, so
+        // they belong to the next file.
+        break;
+      }
+      if (lower_bound != nullptr &&
+          ucmp->Compare(tombstone.end_key_, *lower_bound) <= 0) {
+        // Already written to the previous file.
+        continue;
+      }
+
+      auto ikey_and_end_key = tombstone.Serialize();
+      builder->Add(ikey_and_end_key.first.Encode(), ikey_and_end_key.second);
+      InternalKey smallest_candidate = std::move(ikey_and_end_key.first);
+      if (lower_bound != nullptr &&
+          ucmp->Compare(smallest_candidate.user_key(), *lower_bound) <= 0) {
+        // Truncate at lower_bound so that the files look key-space
+        // partitioned. The lowest seqnum makes this file's smallest key sort
+        // after the previous file's largest key; the read path only looks at
+        // the user key when picking files.
+        smallest_candidate = InternalKey(*lower_bound, 0, kTypeRangeDeletion);
+      }
+      if (meta->smallest.size() == 0 ||
+          icmp_.Compare(smallest_candidate, meta->smallest) < 0) {
+        meta->smallest = std::move(smallest_candidate);
+      }
+      InternalKey largest_candidate = tombstone.SerializeEndKey();
+      if (upper_bound != nullptr &&
+          ucmp->Compare(*upper_bound, largest_candidate.user_key()) <= 0) {
+        // Truncate at upper_bound. The highest seqnum makes this file's
+        // largest key sort before the next file's smallest key.
+        largest_candidate =
+            InternalKey(*upper_bound, kMaxSequenceNumber, kTypeRangeDeletion);
+      }
+      if (meta->largest.size() == 0 ||
+          icmp_.Compare(meta->largest, largest_candidate) < 0) {
+        meta->largest = std::move(largest_candidate);
+      }
+      meta->smallest_seqno = std::min(meta->smallest_seqno, tombstone.seq_);
+      meta->largest_seqno = std::max(meta->largest_seqno, tombstone.seq_);
+    }
+  }
+}
+
+}  // namespace rocksdb
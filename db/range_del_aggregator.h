@@ -0,0 +1,94 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "util/kv_map.h"
+
+namespace rocksdb {
+
+class InternalIterator;
+class TableBuilder;
+struct FileMetaData;
+
+// A RangeDelAggregator collects the range tombstones seen by a read, flush or
+// compaction and answers whether a point key is covered by one of them.
+//
+// Flush and compaction need to preserve every key that is visible to some
+// snapshot, so their tombstones are bucketed into the snapshot stripes formed
+// by the snapshot list. A key is only deleted by tombstones of its own stripe
+// that are newer than the key. Reads use a single stripe and ignore the
+// tombstones that are newer than the read's snapshot.
+//
+// The aggregator copies the tombstones it is given, so the iterators passed
+// to AddTombstones() do not need to outlive it.
+//
+// Not thread-safe.
+class RangeDelAggregator {
+ public:
+  // Used by flush and compaction. snapshots must be sorted in ascending order.
+  RangeDelAggregator(const InternalKeyComparator& icmp,
+                     const std::vector<SequenceNumber>& snapshots);
+
+  // Used by reads. Tombstones newer than snapshot are ignored.
+  RangeDelAggregator(const InternalKeyComparator& icmp,
+                     SequenceNumber snapshot);
+
+  // Returns whether the key should be deleted, which is the case when it is
+  // covered by a range tombstone residing in the same snapshot stripe.
+  bool ShouldDelete(const ParsedInternalKey& parsed);
+  bool ShouldDelete(const Slice& internal_key);
+
+  // Adds the range tombstones yielded by input. The keys of input are
+  // internal keys of type kTypeRangeDeletion and the values are the end keys
+  // of the ranges. input may be nullptr, in which case nothing is added.
+  Status AddTombstones(std::unique_ptr<InternalIterator> input);
+
+  // Writes the tombstones that overlap [lower_bound, upper_bound) to builder
+  // and extends the key range and sequence number range of meta to cover
+  // them. A nullptr bound means the corresponding side is unbounded. The
+  // file's key range is truncated at the bounds so that the output files of
+  // a compaction stay key-space partitioned.
+  //
+  // At the bottommost level, the tombstones of the oldest stripe have already
+  // dropped all the keys they cover and are not written.
+  void AddToBuilder(TableBuilder* builder, const Slice* lower_bound,
+                    const Slice* upper_bound, FileMetaData* meta,
+                    bool bottommost_level = false);
+
+  bool IsEmpty() const { return num_tombstones_ == 0; }
+
+ private:
+  struct TombstoneValue {
+    std::string end_key;
+    SequenceNumber seq;
+  };
+  // Tombstones of a stripe keyed by their (user) start key.
+  typedef std::multimap<std::string, TombstoneValue,
+                        stl_wrappers::LessOfComparator>
+      TombstoneMap;
+  // Maps the largest sequence number of a stripe to its tombstones.
+  typedef std::map<SequenceNumber, TombstoneMap> StripeMap;
+
+  void InitStripes(const std::vector<SequenceNumber>& snapshots);
+  TombstoneMap& GetTombstoneMap(SequenceNumber seq);
+
+  const InternalKeyComparator icmp_;
+  // Tombstones with a larger sequence number are not visible to this
+  // aggregator.
+  const SequenceNumber upper_bound_;
+  StripeMap stripe_map_;
+  size_t num_tombstones_;
+};
+
+}  // namespace rocksdb
@@ -378,7 +378,9 @@ class Repairer {
       ScopedArenaIterator iter(mem->NewIterator(ro, &arena));
       status = BuildTable(
           dbname_, env_, *cfd->ioptions(), *cfd->GetLatestMutableCFOptions(),
-          env_options_, table_cache_, iter.get(), &meta,
+          env_options_, table_cache_, iter.get(),
+          std::unique_ptr<InternalIterator>(mem->NewRangeTombstoneIterator(ro)),
+          &meta,
           cfd->internal_comparator(), cfd->int_tbl_prop_collector_factories(),
           cfd->GetID(), cfd->GetName(), {}, kMaxSequenceNumber, kNoCompression,
           CompressionOptions(), false, nullptr /* internal_stats */,
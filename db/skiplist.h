@@ -56,6 +56,11 @@ class SkipList {
   // REQUIRES: nothing that compares equal to key is currently in the list.
   void Insert(const Key& key);
 
+  // Like Insert, but external synchronization is not required.  Calls to
+  // InsertConcurrently may overlap with each other and with reads, but not
+  // with Insert.
+  void InsertConcurrently(const Key& key);
+
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const Key& key) const;
 
@@ -107,6 +112,8 @@ class SkipList {
   };
 
  private:
+  enum MaxPossibleHeightEnum : uint16_t { kMaxPossibleHeight = 32 };
+
   const uint16_t kMaxHeight_;
   const uint16_t kBranching_;
   const uint32_t kScaledInverseBranching_;
@@ -128,6 +135,10 @@ class SkipList {
   Node** prev_;
   int32_t prev_height_;
 
+  // Set by InsertConcurrently(), which doesn't maintain prev_.  Insert()
+  // then doesn't trust prev_ until it has searched the list again.
+  std::atomic<bool> prev_invalid_;
+
   inline int GetMaxHeight() const {
     return max_height_.load(std::memory_order_relaxed);
   }
@@ -149,6 +160,11 @@ class SkipList {
   // level in [0..max_height_-1], if prev is non-null.
   Node* FindLessThan(const Key& key, Node** prev = nullptr) const;
 
+  // Traverses a single level of the list, starting at before, to find
+  // the nodes that key lies between at that level.
+  void FindSpliceForLevel(const Key& key, Node* before, int level,
+                          Node** out_prev, Node** out_next) const;
+
   // Return the last node in the list.
   // Return head_ if list is empty.
   Node* FindLast() const;
@@ -190,6 +206,11 @@ struct SkipList<Key, Comparator>::Node {
     next_[n].store(x, std::memory_order_relaxed);
   }
 
+  bool CASNext(int n, Node* expected, Node* x) {
+    assert(n >= 0);
+    return next_[n].compare_exchange_strong(expected, x);
+  }
+
  private:
   // Array of length equal to the node height.  next_[0] is lowest level link.
   std::atomic<Node*> next_[1];
@@ -396,7 +417,8 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
       allocator_(allocator),
       head_(NewNode(0 /* any key will do */, max_height)),
       max_height_(1),
-      prev_height_(1) {
+      prev_height_(1),
+      prev_invalid_(false) {
   assert(max_height > 0 && kMaxHeight_ == static_cast<uint32_t>(max_height));
   assert(branching_factor > 0 &&
          kBranching_ == static_cast<uint32_t>(branching_factor));
@@ -414,8 +436,12 @@ SkipList<Key, Comparator>::SkipList(const Comparator cmp, Allocator* allocator,
 
 template<typename Key, class Comparator>
 void SkipList<Key, Comparator>::Insert(const Key& key) {
-  // fast path for sequential insertion
-  if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
+  if (prev_invalid_.load(std::memory_order_relaxed)) {
+    // Concurrent inserts may have linked taller nodes in between prev_[i]
+    // and prev_[0], so search from scratch and start over.
+    FindLessThan(key, prev_);
+    prev_invalid_.store(false, std::memory_order_relaxed);
+  } else if (!KeyIsAfterNode(key, prev_[0]->NoBarrier_Next(0)) &&
       (prev_[0] == head_ || KeyIsAfterNode(key, prev_[0]))) {
     assert(prev_[0] != head_ || (prev_height_ == 1 && GetMaxHeight() == 1));
 
@@ -464,6 +490,76 @@ void SkipList<Key, Comparator>::Insert(const Key& key) {
   prev_height_ = height;
 }
 
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::FindSpliceForLevel(const Key& key,
+                                                   Node* before, int level,
+                                                   Node** out_prev,
+                                                   Node** out_next) const {
+  while (true) {
+    Node* next = before->Next(level);
+    assert(before == head_ || next == nullptr ||
+           KeyIsAfterNode(next->key, before));
+    assert(before == head_ || KeyIsAfterNode(key, before));
+    if (!KeyIsAfterNode(key, next)) {
+      *out_prev = before;
+      *out_next = next;
+      return;
+    }
+    before = next;
+  }
+}
+
+template <typename Key, class Comparator>
+void SkipList<Key, Comparator>::InsertConcurrently(const Key& key) {
+  assert(kMaxHeight_ <= kMaxPossibleHeight);
+  if (!prev_invalid_.load(std::memory_order_relaxed)) {
+    prev_invalid_.store(true, std::memory_order_relaxed);
+  }
+
+  int height = RandomHeight();
+  // Raising max_height_ before the node is linked is fine, readers drop down
+  // from the nullptr links of head_ the same as in Insert().
+  int max_height = GetMaxHeight();
+  while (height > max_height) {
+    if (max_height_.compare_exchange_weak(max_height, height)) {
+      max_height = height;
+      break;
+    }
+  }
+
+  // prev[i] and next[i] are the nodes key lies between at level i.  They are
+  // found top-down, each level starting from the predecessor one level up.
+  Node* prev[kMaxPossibleHeight];
+  Node* next[kMaxPossibleHeight];
+  Node* before = head_;
+  for (int level = max_height - 1; level >= 0; --level) {
+    Node* after;
+    FindSpliceForLevel(key, before, level, &before, &after);
+    if (level < height) {
+      prev[level] = before;
+      next[level] = after;
+    }
+  }
+
+  // Our data structure does not allow duplicate insertion
+  assert(next[0] == nullptr || !Equal(key, next[0]->key));
+
+  Node* x = NewNode(key, height);
+  // Link from the bottom up so that the node is in the list at level 0, and
+  // so found by readers, before any taller link points at it.  A failed CAS
+  // means another insert got in between prev[i] and next[i]; since nodes are
+  // never removed, the splice can be recomputed starting from prev[i].
+  for (int i = 0; i < height; i++) {
+    while (true) {
+      x->NoBarrier_SetNext(i, next[i]);
+      if (prev[i]->CASNext(i, next[i], x)) {
+        break;
+      }
+      FindSpliceForLevel(key, prev[i], i, &prev[i], &next[i]);
+    }
+  }
+}
+
 template<typename Key, class Comparator>
 bool SkipList<Key, Comparator>::Contains(const Key& key) const {
   Node* x = FindGreaterOrEqual(key);
@@ -9,8 +9,11 @@
 
 #include "db/skiplist.h"
 #include <set>
+#include <thread>
+#include <vector>
 #include "rocksdb/env.h"
 #include "util/arena.h"
+#include "util/concurrent_arena.h"
 #include "util/hash.h"
 #include "util/random.h"
 #include "util/testharness.h"
@@ -370,6 +373,68 @@ TEST_F(SkipTest, Concurrent3) { RunConcurrent(3); }
 TEST_F(SkipTest, Concurrent4) { RunConcurrent(4); }
 TEST_F(SkipTest, Concurrent5) { RunConcurrent(5); }
 
+TEST_F(SkipTest, InsertConcurrently) {
+  const int kThreads = 4;
+  const int kKeysPerThread = 2000;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  SkipList<Key, TestComparator> list(cmp, &arena);
+
+  // A few sequential inserts first, so that the concurrent ones below have
+  // to invalidate the state Insert() keeps for them
+  for (Key k = 0; k < 10; k++) {
+    list.Insert(k * kThreads * kKeysPerThread);
+  }
+
+  std::vector<std::set<Key>> inserted(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      Random rnd(t + 1);
+      for (int i = 0; i < kKeysPerThread; i++) {
+        // Keys of the threads interleave and are never equal to each other
+        // or to the sequential keys, which are multiples of 10
+        Key k = (static_cast<Key>(rnd.Uniform(10 * kKeysPerThread)) * kThreads +
+                 t) * 10 + 1 + i % 9;
+        if (inserted[t].insert(k).second) {
+          list.InsertConcurrently(k);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  // Sequential inserts after concurrent ones must not rely on stale state
+  list.Insert(10);
+  list.Insert(20);
+
+  SkipList<Key, TestComparator>::Iterator iter(&list);
+  iter.SeekToFirst();
+  ASSERT_TRUE(iter.Valid());
+  Key prev = iter.key();
+  size_t count = 1;
+  for (iter.Next(); iter.Valid(); iter.Next()) {
+    ASSERT_LT(prev, iter.key());
+    ASSERT_TRUE(list.Contains(iter.key()));
+    prev = iter.key();
+    count++;
+  }
+  size_t expected_count = 12;
+  for (auto& keys : inserted) {
+    expected_count += keys.size();
+    for (Key k : keys) {
+      ASSERT_TRUE(list.Contains(k));
+    }
+  }
+  ASSERT_EQ(expected_count, count);
+  ASSERT_TRUE(list.Contains(10));
+  ASSERT_TRUE(list.Contains(20));
+  for (Key k = 0; k < 10; k++) {
+    ASSERT_TRUE(list.Contains(k * kThreads * kKeysPerThread));
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
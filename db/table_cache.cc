@@ -9,8 +9,11 @@
 
 #include "db/table_cache.h"
 
+#include <algorithm>
+
 #include "db/dbformat.h"
 #include "db/filename.h"
+#include "db/range_del_aggregator.h"
 #include "db/version_edit.h"
 
 #include "rocksdb/statistics.h"
@@ -19,6 +22,7 @@
 #include "table/table_builder.h"
 #include "table/table_reader.h"
 #include "table/get_context.h"
+#include "util/autovector.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 #include "util/perf_context_imp.h"
@@ -51,6 +55,10 @@ static Slice GetSliceForFileNumber(const uint64_t* file_number) {
                sizeof(*file_number));
 }
 
+// The readahead of a compaction input file starts at this size and grows
+// up to compaction_readahead_size while the file is read sequentially
+const size_t kInitCompactionReadaheadSize = 64 * 1024;
+
 #ifndef ROCKSDB_LITE
 
 void AppendVarint64(IterKey* key, uint64_t v) {
@@ -87,19 +95,21 @@ void TableCache::ReleaseHandle(Cache::Handle* handle) {
 Status TableCache::GetTableReader(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
-    bool sequential_mode, size_t readahead, bool record_read_stats,
-    HistogramImpl* file_read_hist, unique_ptr<TableReader>* table_reader,
+    bool sequential_mode, size_t readahead, size_t initial_readahead,
+    bool record_read_stats, HistogramImpl* file_read_hist,
+    unique_ptr<TableReader>* table_reader,
     bool skip_filters, int level, bool prefetch_index_and_filter_in_cache) {
   std::string fname =
       TableFileName(ioptions_.db_paths, fd.GetNumber(), fd.GetPathId());
   unique_ptr<RandomAccessFile> file;
   Status s = ioptions_.env->NewRandomAccessFile(fname, &file, env_options);
 
-  if (readahead > 0) {
-    file = NewReadaheadRandomAccessFile(std::move(file), readahead);
-  }
   RecordTick(ioptions_.statistics, NO_FILE_OPENS);
   if (s.ok()) {
+    if (readahead > 0) {
+      file = NewReadaheadRandomAccessFile(std::move(file), readahead,
+                                          initial_readahead);
+    }
     if (!sequential_mode && ioptions_.advise_random_on_open) {
       file->Hint(RandomAccessFile::RANDOM);
     }
@@ -147,8 +157,9 @@ Status TableCache::FindTable(const EnvOptions& env_options,
     unique_ptr<TableReader> table_reader;
     s = GetTableReader(env_options, internal_comparator, fd,
                        false /* sequential mode */, 0 /* readahead */,
-                       record_read_stats, file_read_hist, &table_reader,
-                       skip_filters, level, prefetch_index_and_filter_in_cache);
+                       0 /* initial_readahead */, record_read_stats,
+                       file_read_hist, &table_reader, skip_filters, level,
+                       prefetch_index_and_filter_in_cache);
     if (!s.ok()) {
       assert(table_reader == nullptr);
       RecordTick(ioptions_.statistics, NO_FILE_ERRORS);
@@ -170,7 +181,8 @@ InternalIterator* TableCache::NewIterator(
     const ReadOptions& options, const EnvOptions& env_options,
     const InternalKeyComparator& icomparator, const FileDescriptor& fd,
     TableReader** table_reader_ptr, HistogramImpl* file_read_hist,
-    bool for_compaction, Arena* arena, bool skip_filters, int level) {
+    bool for_compaction, Arena* arena, bool skip_filters, int level,
+    RangeDelAggregator* range_del_agg) {
   PERF_TIMER_GUARD(new_table_iterator_nanos);
 
   if (table_reader_ptr != nullptr) {
@@ -181,10 +193,12 @@ InternalIterator* TableCache::NewIterator(
   Cache::Handle* handle = nullptr;
 
   size_t readahead = 0;
+  size_t initial_readahead = 0;
   bool create_new_table_reader = false;
   if (for_compaction) {
     if (ioptions_.new_table_reader_for_compaction_inputs) {
       readahead = ioptions_.compaction_readahead_size;
+      initial_readahead = kInitCompactionReadaheadSize;
       create_new_table_reader = true;
     }
   } else {
@@ -196,8 +210,8 @@ InternalIterator* TableCache::NewIterator(
     unique_ptr<TableReader> table_reader_unique_ptr;
     Status s = GetTableReader(
         env_options, icomparator, fd, true /* sequential_mode */, readahead,
-        !for_compaction /* record stats */, nullptr, &table_reader_unique_ptr,
-        false /* skip_filters */, level);
+        initial_readahead, !for_compaction /* record stats */, nullptr,
+        &table_reader_unique_ptr, false /* skip_filters */, level);
     if (!s.ok()) {
       return NewErrorInternalIterator(s, arena);
     }
@@ -216,6 +230,20 @@ InternalIterator* TableCache::NewIterator(
     }
   }
 
+  if (range_del_agg != nullptr) {
+    std::unique_ptr<InternalIterator> range_del_iter(
+        table_reader->NewRangeTombstoneIterator(options));
+    Status s = range_del_agg->AddTombstones(std::move(range_del_iter));
+    if (!s.ok()) {
+      if (create_new_table_reader) {
+        delete table_reader;
+      } else if (handle != nullptr) {
+        ReleaseHandle(handle);
+      }
+      return NewErrorInternalIterator(s, arena);
+    }
+  }
+
   InternalIterator* result =
       table_reader->NewIterator(options, arena, skip_filters);
 
@@ -245,6 +273,8 @@ Status TableCache::Get(const ReadOptions& options,
   Status s;
   Cache::Handle* handle = nullptr;
   std::string* row_cache_entry = nullptr;
+  bool done = false;
+  RangeDelAggregator* range_del_agg = get_context->range_del_agg();
 
 #ifndef ROCKSDB_LITE
   IterKey row_cache_key;
@@ -252,7 +282,10 @@ Status TableCache::Get(const ReadOptions& options,
 
   // Check row cache if enabled. Since row cache does not currently store
   // sequence numbers, we cannot use it if we need to fetch the sequence.
-  if (ioptions_.row_cache && !get_context->NeedToReadSequence()) {
+  // The cached results account for the range tombstones of this file only,
+  // so the row cache is bypassed once tombstones of newer data apply.
+  if (ioptions_.row_cache && !get_context->NeedToReadSequence() &&
+      (range_del_agg == nullptr || range_del_agg->IsEmpty())) {
     uint64_t fd_number = fd.GetNumber();
     auto user_key = ExtractUserKey(k);
     // We use the user key as cache key instead of the internal key,
@@ -277,12 +310,17 @@ Status TableCache::Get(const ReadOptions& options,
       replayGetContextLog(*found_row_cache_entry, user_key, get_context);
       ioptions_.row_cache->Release(row_handle);
       RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
-      return Status::OK();
+      done = true;
+      if (range_del_agg == nullptr ||
+          get_context->State() != GetContext::kMerge) {
+        return Status::OK();
+      }
+      // Older files still need the tombstones of this file.
+    } else {
+      // Not found, setting up the replay log.
+      RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
+      row_cache_entry = &row_cache_entry_buffer;
     }
-
-    // Not found, setting up the replay log.
-    RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
-    row_cache_entry = &row_cache_entry_buffer;
   }
 #endif  // ROCKSDB_LITE
 
@@ -295,18 +333,29 @@ Status TableCache::Get(const ReadOptions& options,
       t = GetTableReaderFromHandle(handle);
     }
   }
+  if (s.ok() && range_del_agg != nullptr) {
+    std::unique_ptr<InternalIterator> range_del_iter(
+        t->NewRangeTombstoneIterator(options));
+    s = range_del_agg->AddTombstones(std::move(range_del_iter));
+  }
   if (s.ok()) {
-    get_context->SetReplayLog(row_cache_entry);  // nullptr if no cache.
-    s = t->Get(options, k, get_context, skip_filters);
-    get_context->SetReplayLog(nullptr);
+    if (!done) {
+      get_context->SetReplayLog(row_cache_entry);  // nullptr if no cache.
+      s = t->Get(options, k, get_context, skip_filters);
+      get_context->SetReplayLog(nullptr);
+    }
+  } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+    // Couldn't find Table or its tombstones in cache but treat as kFound if
+    // no_io set
     if (handle != nullptr) {
       ReleaseHandle(handle);
     }
-  } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
-    // Couldn't find Table in cache but treat as kFound if no_io set
     get_context->MarkKeyMayExist();
     return Status::OK();
   }
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
 
 #ifndef ROCKSDB_LITE
   // Put the replay log in row cache only if something was found.
@@ -322,6 +371,83 @@ Status TableCache::Get(const ReadOptions& options,
   return s;
 }
 
+void TableCache::MultiGet(const ReadOptions& options,
+                          const InternalKeyComparator& internal_comparator,
+                          const FileDescriptor& fd,
+                          const std::vector<Slice>& keys,
+                          const std::vector<GetContext*>& get_contexts,
+                          std::vector<Status>* statuses,
+                          HistogramImpl* file_read_hist, bool skip_filters,
+                          int level) {
+  assert(keys.size() == get_contexts.size());
+  statuses->assign(keys.size(), Status::OK());
+
+#ifndef ROCKSDB_LITE
+  // The row cache is keyed per user key, so serve the batch one key at a
+  // time to keep its hit/fill logic in a single place.
+  if (ioptions_.row_cache) {
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*statuses)[i] = Get(options, internal_comparator, fd, keys[i],
+                           get_contexts[i], file_read_hist, skip_filters,
+                           level);
+    }
+    return;
+  }
+#endif  // ROCKSDB_LITE
+
+  TableReader* t = fd.table_reader;
+  Status s;
+  Cache::Handle* handle = nullptr;
+  if (!t) {
+    s = FindTable(env_options_, internal_comparator, fd, &handle,
+                  options.read_tier == kBlockCacheTier /* no_io */,
+                  true /* record_read_stats */, file_read_hist, skip_filters,
+                  level);
+    if (s.ok()) {
+      t = GetTableReaderFromHandle(handle);
+    }
+  }
+  if (s.ok()) {
+    // The keys of a batch usually share one RangeDelAggregator, so read the
+    // range tombstones of this file once per distinct aggregator rather
+    // than once per key.
+    autovector<RangeDelAggregator*, 1> seen_aggs;
+    for (auto* get_context : get_contexts) {
+      RangeDelAggregator* range_del_agg = get_context->range_del_agg();
+      if (range_del_agg == nullptr ||
+          std::find(seen_aggs.begin(), seen_aggs.end(), range_del_agg) !=
+              seen_aggs.end()) {
+        continue;
+      }
+      seen_aggs.push_back(range_del_agg);
+      std::unique_ptr<InternalIterator> range_del_iter(
+          t->NewRangeTombstoneIterator(options));
+      if (range_del_iter == nullptr) {
+        // The table has no range tombstones.
+        break;
+      }
+      s = range_del_agg->AddTombstones(std::move(range_del_iter));
+      if (!s.ok()) {
+        break;
+      }
+    }
+  }
+  if (s.ok()) {
+    t->MultiGet(options, keys, get_contexts, statuses, skip_filters);
+  } else if (options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+    // Couldn't find Table or its tombstones in cache but treat as kFound if
+    // no_io set
+    for (auto* get_context : get_contexts) {
+      get_context->MarkKeyMayExist();
+    }
+  } else {
+    statuses->assign(keys.size(), s);
+  }
+  if (handle != nullptr) {
+    ReleaseHandle(handle);
+  }
+}
+
 Status TableCache::GetTableProperties(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
@@ -347,6 +473,27 @@ Status TableCache::GetTableProperties(
   return s;
 }
 
+Status TableCache::ApproximateKeyAnchors(
+    const EnvOptions& env_options,
+    const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
+    size_t max_anchors, std::vector<std::string>* anchors) {
+  auto table_reader = fd.table_reader;
+  if (table_reader) {
+    return table_reader->ApproximateKeyAnchors(max_anchors, anchors);
+  }
+
+  Cache::Handle* table_handle = nullptr;
+  Status s = FindTable(env_options, internal_comparator, fd, &table_handle);
+  if (!s.ok()) {
+    return s;
+  }
+  assert(table_handle);
+  auto table = GetTableReaderFromHandle(table_handle);
+  s = table->ApproximateKeyAnchors(max_anchors, anchors);
+  ReleaseHandle(table_handle);
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator,
@@ -30,6 +30,7 @@ struct FileDescriptor;
 class GetContext;
 class HistogramImpl;
 class InternalIterator;
+class RangeDelAggregator;
 
 class TableCache {
  public:
@@ -46,16 +47,20 @@ class TableCache {
   // returned iterator is live.
   // @param skip_filters Disables loading/accessing the filter block
   // @param level The level this table is at, -1 for "not set / don't know"
+  // @param range_del_agg If non-nullptr, the range tombstones of the file are
+  //    added to it before the iterator is returned
   InternalIterator* NewIterator(
       const ReadOptions& options, const EnvOptions& toptions,
       const InternalKeyComparator& internal_comparator,
       const FileDescriptor& file_fd, TableReader** table_reader_ptr = nullptr,
       HistogramImpl* file_read_hist = nullptr, bool for_compaction = false,
-      Arena* arena = nullptr, bool skip_filters = false, int level = -1);
+      Arena* arena = nullptr, bool skip_filters = false, int level = -1,
+      RangeDelAggregator* range_del_agg = nullptr);
 
   // If a seek to internal key "k" in specified file finds an entry,
   // call (*handle_result)(arg, found_key, found_value) repeatedly until
-  // it returns false.
+  // it returns false. If get_context has a RangeDelAggregator, the range
+  // tombstones of the file are added to it first.
   // @param skip_filters Disables loading/accessing the filter block
   // @param level The level this table is at, -1 for "not set / don't know"
   Status Get(const ReadOptions& options,
@@ -64,6 +69,18 @@ class TableCache {
              GetContext* get_context, HistogramImpl* file_read_hist = nullptr,
              bool skip_filters = false, int level = -1);
 
+  // Batched version of Get(). Looks up every key of `keys` (sorted internal
+  // keys) in the specified file, storing the result of keys[i] in
+  // get_contexts[i] and its status in (*statuses)[i]. The table is located
+  // only once for the whole batch.
+  void MultiGet(const ReadOptions& options,
+                const InternalKeyComparator& internal_comparator,
+                const FileDescriptor& file_fd, const std::vector<Slice>& keys,
+                const std::vector<GetContext*>& get_contexts,
+                std::vector<Status>* statuses,
+                HistogramImpl* file_read_hist = nullptr,
+                bool skip_filters = false, int level = -1);
+
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
@@ -97,6 +114,13 @@ class TableCache {
                             std::shared_ptr<const TableProperties>* properties,
                             bool no_io = false);
 
+  // Appends to *anchors up to max_anchors keys that split the file into
+  // pieces of similar size. See TableReader::ApproximateKeyAnchors().
+  Status ApproximateKeyAnchors(const EnvOptions& toptions,
+                               const InternalKeyComparator& internal_comparator,
+                               const FileDescriptor& fd, size_t max_anchors,
+                               std::vector<std::string>* anchors);
+
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
   size_t GetMemoryUsageByTableReader(
@@ -108,11 +132,14 @@ class TableCache {
   void ReleaseHandle(Cache::Handle* handle);
 
  private:
-  // Build a table reader
+  // Build a table reader. With initial_readahead > 0, the readahead starts
+  // at that size and grows up to readahead while the file is read
+  // sequentially.
   Status GetTableReader(const EnvOptions& env_options,
                         const InternalKeyComparator& internal_comparator,
                         const FileDescriptor& fd, bool sequential_mode,
-                        size_t readahead, bool record_read_stats,
+                        size_t readahead, size_t initial_readahead,
+                        bool record_read_stats,
                         HistogramImpl* file_read_hist,
                         unique_ptr<TableReader>* table_reader,
                         bool skip_filters = false, int level = -1,
@@ -14,6 +14,7 @@
 #include "util/event_logger.h"
 #include "util/sync_point.h"
 #include "rocksdb/slice.h"
+#include "rocksdb/table_properties.h"
 
 namespace rocksdb {
 
@@ -43,6 +44,7 @@ enum Tag {
 enum CustomTag {
   kTerminate = 1,  // The end of customized fields
   kNeedCompaction = 2,
+  kTableStats = 3,
   kPathId = 65,
 };
 // If this bit for the custom tag is set, opening DB should fail if
@@ -54,6 +56,13 @@ uint64_t PackFileNumberAndPathId(uint64_t number, uint64_t path_id) {
   return number | (path_id * (kFileNumberMask + 1));
 }
 
+void FileMetaData::SetTableStats(const TableProperties& props) {
+  num_entries = props.num_entries;
+  num_deletions = GetDeletedKeys(props.user_collected_properties);
+  raw_key_size = props.raw_key_size;
+  raw_value_size = props.raw_value_size;
+}
+
 void VersionEdit::Clear() {
   comparator_.clear();
   max_level_ = 0;
@@ -76,7 +85,7 @@ void VersionEdit::Clear() {
   column_family_name_.clear();
 }
 
-bool VersionEdit::EncodeTo(std::string* dst) const {
+bool VersionEdit::EncodeTo(std::string* dst, bool with_table_stats) const {
   if (has_comparator_) {
     PutVarint32(dst, kComparator);
     PutLengthPrefixedSlice(dst, comparator_);
@@ -108,7 +117,8 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
       return false;
     }
     bool has_customized_fields = false;
-    if (f.marked_for_compaction) {
+    const bool write_table_stats = with_table_stats && f.num_entries > 0;
+    if (f.marked_for_compaction || write_table_stats) {
       PutVarint32(dst, kNewFile4);
       has_customized_fields = true;
     } else if (f.fd.GetPathId() == 0) {
@@ -153,6 +163,8 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
       //   tag kPathId: 1 byte as path_id
       //   tag kNeedCompaction:
       //        now only can take one char value 1 indicating need-compaction
+      //   tag kTableStats: varint64 num_entries, num_deletions, raw_key_size
+      //        and raw_value_size of the table
       //
       if (f.fd.GetPathId() != 0) {
         PutVarint32(dst, CustomTag::kPathId);
@@ -164,6 +176,13 @@ bool VersionEdit::EncodeTo(std::string* dst) const {
         char p = static_cast<char>(1);
         PutLengthPrefixedSlice(dst, Slice(&p, 1));
       }
+      if (write_table_stats) {
+        PutVarint32(dst, CustomTag::kTableStats);
+        std::string stats;
+        PutVarint64Varint64(&stats, f.num_entries, f.num_deletions);
+        PutVarint64Varint64(&stats, f.raw_key_size, f.raw_value_size);
+        PutLengthPrefixedSlice(dst, stats);
+      }
       TEST_SYNC_POINT_CALLBACK("VersionEdit::EncodeTo:NewFile4:CustomizeFields",
                                dst);
 
@@ -251,6 +270,14 @@ const char* VersionEdit::DecodeNewFile4From(Slice* input) {
           }
           f.marked_for_compaction = (field[0] == 1);
           break;
+        case kTableStats:
+          if (!GetVarint64(&field, &f.num_entries) ||
+              !GetVarint64(&field, &f.num_deletions) ||
+              !GetVarint64(&field, &f.raw_key_size) ||
+              !GetVarint64(&field, &f.raw_value_size)) {
+            return "table_stats field wrong size";
+          }
+          break;
         default:
           if ((custom_tag & kCustomTagNonSafeIgnoreMask) != 0) {
             // Should not proceed if cannot understand it
@@ -21,6 +21,7 @@
 namespace rocksdb {
 
 class VersionSet;
+struct TableProperties;
 
 const uint64_t kFileNumberMask = 0x3FFFFFFFFFFFFFFF;
 
@@ -105,6 +106,11 @@ struct FileMetaData {
         init_stats_from_file(false),
         marked_for_compaction(false) {}
 
+  // Takes the data-entry stats from the properties of the table, so that
+  // they're recorded along with the file in the MANIFEST and needn't be
+  // read from the file when the DB is opened.
+  void SetTableStats(const TableProperties& props);
+
   // REQUIRED: Keys must be given to the function in sorted order (it expects
   // the last key to be the largest).
   void UpdateBoundaries(const Slice& key, SequenceNumber seqno) {
@@ -196,9 +202,18 @@ class VersionEdit {
     new_files_.emplace_back(level, std::move(f));
   }
 
+  // Add the file described by f, which may be the metadata of a live file
+  // being moved to another level. Only what is recorded in the MANIFEST is
+  // taken from f: the new file starts unreferenced, not being compacted and
+  // with no table reader.
   void AddFile(int level, const FileMetaData& f) {
     assert(f.smallest_seqno <= f.largest_seqno);
     new_files_.emplace_back(level, f);
+    FileMetaData& added = new_files_.back().second;
+    added.refs = 0;
+    added.being_compacted = false;
+    added.table_reader_handle = nullptr;
+    added.fd.table_reader = nullptr;
   }
 
   // Delete the specified "file" from the specified "level".
@@ -234,8 +249,10 @@ class VersionEdit {
     is_column_family_drop_ = true;
   }
 
-  // return true on success.
-  bool EncodeTo(std::string* dst) const;
+  // return true on success. The stats of the new files are only written
+  // with with_table_stats (DBOptions::skip_table_open_on_db_open), so that
+  // the other DBs keep a MANIFEST that older releases can read.
+  bool EncodeTo(std::string* dst, bool with_table_stats = false) const;
   Status DecodeFrom(const Slice& src);
 
   const char* DecodeNewFile4From(Slice* input);
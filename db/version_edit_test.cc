@@ -82,6 +82,59 @@ TEST_F(VersionEditTest, EncodeDecodeNewFile4) {
   ASSERT_EQ(0, new_files[2].second.fd.GetPathId());
 }
 
+TEST_F(VersionEditTest, EncodeDecodeTableStats) {
+  static const uint64_t kBig = 1ull << 50;
+
+  VersionEdit edit;
+  FileMetaData f;
+  f.fd = FileDescriptor(300, 0, 100);
+  f.smallest = InternalKey("foo", kBig + 500, kTypeValue);
+  f.largest = InternalKey("zoo", kBig + 600, kTypeDeletion);
+  f.smallest_seqno = kBig + 500;
+  f.largest_seqno = kBig + 600;
+  f.num_entries = 1000;
+  f.num_deletions = 10;
+  f.raw_key_size = kBig + 1;
+  f.raw_value_size = kBig + 2;
+  edit.AddFile(3, f);
+  // No stats
+  edit.AddFile(4, 301, 0, 100, InternalKey("foo", kBig + 501, kTypeValue),
+               InternalKey("zoo", kBig + 601, kTypeDeletion), kBig + 501,
+               kBig + 601, false);
+  TestEncodeDecode(edit);
+
+  // Without with_table_stats, the files are written in the older formats,
+  // which don't carry the stats
+  int num_new_file4 = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "VersionEdit::EncodeTo:NewFile4:CustomizeFields",
+      [&](void* arg) { num_new_file4++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  std::string encoded;
+  edit.EncodeTo(&encoded);
+  ASSERT_EQ(0, num_new_file4);
+  VersionEdit parsed_no_stats;
+  ASSERT_OK(parsed_no_stats.DecodeFrom(encoded));
+  ASSERT_EQ(0U, parsed_no_stats.GetNewFiles()[0].second.num_entries);
+
+  encoded.clear();
+  edit.EncodeTo(&encoded, true /* with_table_stats */);
+  ASSERT_EQ(1, num_new_file4);
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  VersionEdit parsed;
+  Status s = parsed.DecodeFrom(encoded);
+  ASSERT_TRUE(s.ok()) << s.ToString();
+  auto& new_files = parsed.GetNewFiles();
+  ASSERT_EQ(1000U, new_files[0].second.num_entries);
+  ASSERT_EQ(10U, new_files[0].second.num_deletions);
+  ASSERT_EQ(kBig + 1, new_files[0].second.raw_key_size);
+  ASSERT_EQ(kBig + 2, new_files[0].second.raw_value_size);
+  ASSERT_TRUE(!new_files[0].second.init_stats_from_file);
+  ASSERT_EQ(0U, new_files[1].second.num_entries);
+  ASSERT_EQ(0U, new_files[1].second.raw_value_size);
+}
+
 TEST_F(VersionEditTest, ForwardCompatibleNewFile4) {
   static const uint64_t kBig = 1ull << 50;
   VersionEdit edit;
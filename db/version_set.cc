@@ -493,7 +493,8 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
                          const EnvOptions& env_options,
                          const InternalKeyComparator& icomparator,
                          HistogramImpl* file_read_hist, bool for_compaction,
-                         bool prefix_enabled, bool skip_filters, int level)
+                         bool prefix_enabled, bool skip_filters, int level,
+                         RangeDelAggregator* range_del_agg)
       : TwoLevelIteratorState(prefix_enabled),
         table_cache_(table_cache),
         read_options_(read_options),
@@ -502,7 +503,8 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
         file_read_hist_(file_read_hist),
         for_compaction_(for_compaction),
         skip_filters_(skip_filters),
-        level_(level) {}
+        level_(level),
+        range_del_agg_(range_del_agg) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& meta_handle) override {
     if (meta_handle.size() != sizeof(FileDescriptor)) {
@@ -514,7 +516,8 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
       return table_cache_->NewIterator(
           read_options_, env_options_, icomparator_, *fd,
           nullptr /* don't need reference to table*/, file_read_hist_,
-          for_compaction_, nullptr /* arena */, skip_filters_, level_);
+          for_compaction_, nullptr /* arena */, skip_filters_, level_,
+          range_del_agg_);
     }
   }
 
@@ -531,6 +534,7 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
   bool for_compaction_;
   bool skip_filters_;
   int level_;
+  RangeDelAggregator* range_del_agg_;
 };
 
 // A wrapper of version builder which references the current version in
@@ -797,7 +801,8 @@ double VersionStorageInfo::GetEstimatedCompressionRatioAtLevel(
 
 void Version::AddIterators(const ReadOptions& read_options,
                            const EnvOptions& soptions,
-                           MergeIteratorBuilder* merge_iter_builder) {
+                           MergeIteratorBuilder* merge_iter_builder,
+                           RangeDelAggregator* range_del_agg) {
   assert(storage_info_.finalized_);
 
   if (storage_info_.num_non_empty_levels() == 0) {
@@ -813,7 +818,7 @@ void Version::AddIterators(const ReadOptions& read_options,
     merge_iter_builder->AddIterator(cfd_->table_cache()->NewIterator(
         read_options, soptions, cfd_->internal_comparator(), file.fd, nullptr,
         cfd_->internal_stats()->GetFileReadHist(0), false, arena,
-        false /* skip_filters */, 0 /* level */));
+        false /* skip_filters */, 0 /* level */, range_del_agg));
   }
 
   // For levels > 0, we can use a concatenating iterator that sequentially
@@ -828,7 +833,7 @@ void Version::AddIterators(const ReadOptions& read_options,
                                  cfd_->internal_stats()->GetFileReadHist(level),
                                  false /* for_compaction */,
                                  cfd_->ioptions()->prefix_extractor != nullptr,
-                                 IsFilterSkipped(level), level);
+                                 IsFilterSkipped(level), level, range_del_agg);
       mem = arena->AllocateAligned(sizeof(LevelFileNumIterator));
       auto* first_level_iter = new (mem) LevelFileNumIterator(
           cfd_->internal_comparator(), &storage_info_.LevelFilesBrief(level));
@@ -906,7 +911,8 @@ Version::Version(ColumnFamilyData* column_family_data, VersionSet* vset,
 
 void Version::Get(const ReadOptions& read_options, const LookupKey& k,
                   std::string* value, Status* status,
-                  MergeContext* merge_context, bool* value_found,
+                  MergeContext* merge_context,
+                  RangeDelAggregator* range_del_agg, bool* value_found,
                   bool* key_exists, SequenceNumber* seq) {
   Slice ikey = k.internal_key();
   Slice user_key = k.user_key();
@@ -923,7 +929,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       user_comparator(), merge_operator_, info_log_, db_statistics_,
       status->ok() ? GetContext::kNotFound : GetContext::kMerge, user_key,
       value, value_found, merge_context, this->env_, seq,
-      merge_operator_ ? &pinned_iters_mgr : nullptr);
+      merge_operator_ ? &pinned_iters_mgr : nullptr, range_del_agg);
 
   // Pin blocks that we read to hold merge operands
   if (merge_operator_) {
@@ -992,6 +998,207 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
   }
 }
 
+void Version::MultiGet(const ReadOptions& read_options,
+                       std::vector<MultiGetKey>* keys) {
+  PinnedIteratorsManager pinned_iters_mgr;
+  // Pin blocks that we read to hold merge operands
+  if (merge_operator_) {
+    pinned_iters_mgr.StartPinning();
+  }
+
+  std::vector<GetContext> get_contexts;
+  get_contexts.reserve(keys->size());
+  for (auto& key : *keys) {
+    assert(key.status->ok() || key.status->IsMergeInProgress());
+    get_contexts.emplace_back(
+        user_comparator(), merge_operator_, info_log_, db_statistics_,
+        key.status->ok() ? GetContext::kNotFound : GetContext::kMerge,
+        key.lkey->user_key(), key.value, nullptr, key.merge_context, env_,
+        nullptr, merge_operator_ ? &pinned_iters_mgr : nullptr,
+        key.range_del_agg);
+  }
+
+  // done[i] is set once (*keys)[i] has its final status
+  std::vector<bool> done(keys->size(), false);
+  std::vector<size_t> pending(keys->size());
+  for (size_t i = 0; i < pending.size(); ++i) {
+    pending[i] = i;
+  }
+
+  // The sub-batch of keys that is probed against a single file
+  std::vector<size_t> batch_index;
+  std::vector<Slice> batch_keys;
+  std::vector<GetContext*> batch_contexts;
+  std::vector<Status> batch_statuses;
+
+  auto probe_file = [&](FdWithKeyRange* f, int level, bool last_in_level) {
+    if (batch_keys.empty()) {
+      return;
+    }
+    table_cache_->MultiGet(read_options, *internal_comparator(), f->fd,
+                           batch_keys, batch_contexts, &batch_statuses,
+                           cfd_->internal_stats()->GetFileReadHist(level),
+                           IsFilterSkipped(level, last_in_level), level);
+    for (size_t j = 0; j < batch_index.size(); ++j) {
+      size_t i = batch_index[j];
+      Status* status = (*keys)[i].status;
+      if (!batch_statuses[j].ok()) {
+        *status = batch_statuses[j];
+        done[i] = true;
+        continue;
+      }
+      switch (get_contexts[i].State()) {
+        case GetContext::kNotFound:
+        case GetContext::kMerge:
+          // Keep searching in other files
+          break;
+        case GetContext::kFound:
+          if (level == 0) {
+            RecordTick(db_statistics_, GET_HIT_L0);
+          } else if (level == 1) {
+            RecordTick(db_statistics_, GET_HIT_L1);
+          } else {
+            RecordTick(db_statistics_, GET_HIT_L2_AND_UP);
+          }
+          *status = Status::OK();
+          done[i] = true;
+          break;
+        case GetContext::kDeleted:
+          // Use empty error message for speed
+          *status = Status::NotFound();
+          done[i] = true;
+          break;
+        case GetContext::kCorrupt:
+          *status = Status::Corruption("corrupted key for ",
+                                       (*keys)[i].lkey->user_key());
+          done[i] = true;
+          break;
+      }
+    }
+    batch_index.clear();
+    batch_keys.clear();
+    batch_contexts.clear();
+  };
+  auto add_to_batch = [&](size_t i) {
+    batch_index.push_back(i);
+    batch_keys.push_back((*keys)[i].lkey->internal_key());
+    batch_contexts.push_back(&get_contexts[i]);
+  };
+
+  const Comparator* ucmp = user_comparator();
+  for (int level = 0;
+       level < storage_info_.num_non_empty_levels_ && !pending.empty();
+       ++level) {
+    LevelFilesBrief& file_level = storage_info_.level_files_brief_[level];
+    if (file_level.num_files == 0) {
+      continue;
+    }
+
+    if (level == 0) {
+      // Level-0 files may overlap, so probe them newest first and stop
+      // looking for a key as soon as one of them has its final result.
+      for (size_t fi = 0; fi < file_level.num_files; ++fi) {
+        FdWithKeyRange* f = &file_level.files[fi];
+        for (size_t i : pending) {
+          Slice user_key = (*keys)[i].lkey->user_key();
+          if (!done[i] &&
+              ucmp->Compare(user_key, ExtractUserKey(f->smallest_key)) >= 0 &&
+              ucmp->Compare(user_key, ExtractUserKey(f->largest_key)) <= 0) {
+            add_to_batch(i);
+          }
+        }
+        probe_file(f, level, fi + 1 == file_level.num_files);
+      }
+    } else {
+      // Files are sorted and disjoint. Since the keys are sorted too, walk
+      // both in step and only binary search the files to the right of the
+      // file found for the previous key.
+      uint32_t file_index = 0;
+      size_t p = 0;
+      while (p < pending.size()) {
+        file_index = static_cast<uint32_t>(FindFileInRange(
+            *internal_comparator(), file_level,
+            (*keys)[pending[p]].lkey->internal_key(), file_index,
+            static_cast<uint32_t>(file_level.num_files)));
+        if (file_index >= file_level.num_files) {
+          break;
+        }
+        FdWithKeyRange* f = &file_level.files[file_index];
+        const size_t first_in_file = p;
+        for (; p < pending.size(); ++p) {
+          size_t i = pending[p];
+          if (internal_comparator()->Compare(
+                  f->largest_key, (*keys)[i].lkey->internal_key()) < 0) {
+            // This key and all keys after it are beyond this file
+            break;
+          }
+          if (ucmp->Compare((*keys)[i].lkey->user_key(),
+                            ExtractUserKey(f->smallest_key)) >= 0) {
+            add_to_batch(i);
+          }
+        }
+        probe_file(f, level, true /* last_in_level */);
+
+        // The older entries of the largest user key of the file may continue
+        // in the next files of the level, as FilePicker knows: keep looking
+        // there for the keys that are still unresolved.
+        Slice boundary_key = ExtractUserKey(f->largest_key);
+        for (uint32_t next_index = file_index + 1;
+             next_index < file_level.num_files; ++next_index) {
+          FdWithKeyRange* next = &file_level.files[next_index];
+          if (ucmp->Compare(boundary_key, ExtractUserKey(next->smallest_key)) !=
+              0) {
+            break;
+          }
+          for (size_t q = first_in_file; q < p; ++q) {
+            size_t i = pending[q];
+            if (!done[i] &&
+                ucmp->Compare((*keys)[i].lkey->user_key(), boundary_key) == 0) {
+              add_to_batch(i);
+            }
+          }
+          if (batch_keys.empty()) {
+            break;
+          }
+          probe_file(next, level, true /* last_in_level */);
+          if (ucmp->Compare(ExtractUserKey(next->largest_key), boundary_key) !=
+              0) {
+            break;
+          }
+        }
+      }
+    }
+
+    // Drop the keys that are resolved before visiting the next level
+    size_t num_pending = 0;
+    for (size_t i : pending) {
+      if (!done[i]) {
+        pending[num_pending++] = i;
+      }
+    }
+    pending.resize(num_pending);
+  }
+
+  for (size_t i : pending) {
+    MultiGetKey& key = (*keys)[i];
+    if (GetContext::kMerge == get_contexts[i].State()) {
+      if (!merge_operator_) {
+        *key.status = Status::InvalidArgument(
+            "merge_operator is not properly initialized.");
+        continue;
+      }
+      // merge_operands are in saver and we hit the beginning of the key
+      // history do a final merge of nullptr and operands;
+      *key.status = MergeHelper::TimedFullMerge(
+          merge_operator_, key.lkey->user_key(), nullptr,
+          key.merge_context->GetOperands(), key.value, info_log_,
+          db_statistics_, env_);
+    } else {
+      *key.status = Status::NotFound();  // Use an empty error message for speed
+    }
+  }
+}
+
 bool Version::IsFilterSkipped(int level, bool is_file_last_in_level) {
   // Reaching the bottom level implies misses at all upper levels, so we'll
   // skip checking the filters when we predict a hit.
@@ -1025,6 +1232,11 @@ bool Version::MaybeInitializeFileMetaData(FileMetaData* file_meta) {
       file_meta->compensated_file_size > 0) {
     return false;
   }
+  if (file_meta->num_entries > 0) {
+    // The stats were recorded in the MANIFEST along with the file
+    file_meta->init_stats_from_file = true;
+    return true;
+  }
   std::shared_ptr<const TableProperties> tp;
   Status s = GetTableProperties(&tp, file_meta);
   file_meta->init_stats_from_file = true;
@@ -1086,13 +1298,15 @@ void Version::UpdateAccumulatedStats(bool update_stats) {
          level < storage_info_.num_levels_ && init_count < kMaxInitCount;
          ++level) {
       for (auto* file_meta : storage_info_.files_[level]) {
+        // when the table reader is pinned (with option "max_open_files" -1)
+        // or the stats came with the MANIFEST, MaybeInitializeFileMetaData()
+        // won't incur any I/O cost.
+        bool free_init = file_meta->fd.table_reader != nullptr ||
+                         file_meta->num_entries > 0;
         if (MaybeInitializeFileMetaData(file_meta)) {
           // each FileMeta will be initialized only once.
           storage_info_.UpdateAccumulatedStats(file_meta);
-          // when option "max_open_files" is -1, all the file metadata has
-          // already been read, so MaybeInitializeFileMetaData() won't incur
-          // any I/O cost.
-          if (vset_->db_options_->max_open_files == -1) {
+          if (free_init) {
             continue;
           }
           if (++init_count >= kMaxInitCount) {
@@ -1277,6 +1491,13 @@ void VersionStorageInfo::ComputeCompactionScore(
       if (compaction_style_ == kCompactionStyleFIFO) {
         score = static_cast<double>(total_size) /
                 mutable_cf_options.compaction_options_fifo.max_table_files_size;
+        if (mutable_cf_options.compaction_options_fifo.allow_compaction) {
+          // Small files may be merged before the size limit is reached
+          score = std::max(
+              static_cast<double>(num_sorted_runs) /
+                  mutable_cf_options.level0_file_num_compaction_trigger,
+              score);
+        }
       } else {
         score = static_cast<double>(num_sorted_runs) /
                 mutable_cf_options.level0_file_num_compaction_trigger;
@@ -2308,7 +2529,7 @@ Status VersionSet::LogAndApply(ColumnFamilyData* column_family_data,
     if (s.ok()) {
       for (auto& e : batch_edits) {
         std::string record;
-        if (!e->EncodeTo(&record)) {
+        if (!e->EncodeTo(&record, db_options_->skip_table_open_on_db_open)) {
           s = Status::Corruption(
               "Unable to Encode VersionEdit:" + e->DebugString(true));
           break;
@@ -2502,7 +2723,7 @@ Status VersionSet::Recover(
   {
     unique_ptr<SequentialFile> manifest_file;
     s = env_->NewSequentialFile(manifest_filename, &manifest_file,
-                                env_options_);
+                                env_->OptimizeForManifestRead(env_options_));
     if (!s.ok()) {
       return s;
     }
@@ -2712,7 +2933,8 @@ Status VersionSet::Recover(
       assert(builders_iter != builders.end());
       auto* builder = builders_iter->second->version_builder();
 
-      if (db_options_->max_open_files == -1) {
+      if (db_options_->max_open_files == -1 &&
+          !db_options_->skip_table_open_on_db_open) {
         // unlimited table cache. Pre-load table handle now.
         // Need to do it out of the mutex.
         builder->LoadTableHandlers(
@@ -2925,7 +3147,8 @@ Status VersionSet::DumpManifest(Options& options, std::string& dscname,
   Status s;
   {
     unique_ptr<SequentialFile> file;
-    s = options.env->NewSequentialFile(dscname, &file, env_options_);
+    s = options.env->NewSequentialFile(
+        dscname, &file, options.env->OptimizeForManifestRead(env_options_));
     if (!s.ok()) {
       return s;
     }
@@ -3161,15 +3384,13 @@ Status VersionSet::WriteSnapshot(log::Writer* log) {
       for (int level = 0; level < cfd->NumberLevels(); level++) {
         for (const auto& f :
              cfd->current()->storage_info()->LevelFiles(level)) {
-          edit.AddFile(level, f->fd.GetNumber(), f->fd.GetPathId(),
-                       f->fd.GetFileSize(), f->smallest, f->largest,
-                       f->smallest_seqno, f->largest_seqno,
-                       f->marked_for_compaction);
+          edit.AddFile(level, *f);
         }
       }
       edit.SetLogNumber(cfd->GetLogNumber());
       std::string record;
-      if (!edit.EncodeTo(&record)) {
+      // Carry the stats of the files over to the new MANIFEST
+      if (!edit.EncodeTo(&record, db_options_->skip_table_open_on_db_open)) {
         return Status::Corruption(
             "Unable to Encode VersionEdit:" + edit.DebugString(true));
       }
@@ -3329,7 +3550,8 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
   }
 }
 
-InternalIterator* VersionSet::MakeInputIterator(const Compaction* c) {
+InternalIterator* VersionSet::MakeInputIterator(
+    const Compaction* c, RangeDelAggregator* range_del_agg) {
   auto cfd = c->column_family_data();
   ReadOptions read_options;
   read_options.verify_checksums =
@@ -3357,7 +3579,8 @@ InternalIterator* VersionSet::MakeInputIterator(const Compaction* c) {
               cfd->internal_comparator(), flevel->files[i].fd, nullptr,
               nullptr, /* no per level latency histogram*/
               true /* for_compaction */, nullptr /* arena */,
-              false /* skip_filters */, (int)which /* level */);
+              false /* skip_filters */, (int)which /* level */,
+              range_del_agg);
         }
       } else {
         // Create concatenating iterator for the files from this level
@@ -3367,7 +3590,8 @@ InternalIterator* VersionSet::MakeInputIterator(const Compaction* c) {
                 cfd->internal_comparator(),
                 nullptr /* no per level latency histogram */,
                 true /* for_compaction */, false /* prefix enabled */,
-                false /* skip_filters */, (int)which /* level */),
+                false /* skip_filters */, (int)which /* level */,
+                range_del_agg),
             new LevelFileNumIterator(cfd->internal_comparator(),
                                      c->input_levels(which)));
       }
@@ -57,6 +57,7 @@ class Version;
 class VersionSet;
 class WriteBufferManager;
 class MergeContext;
+class RangeDelAggregator;
 class ColumnFamilySet;
 class TableCache;
 class MergeIteratorBuilder;
@@ -418,17 +419,32 @@ class VersionStorageInfo {
   void operator=(const VersionStorageInfo&) = delete;
 };
 
+// One key of a batched lookup, see Version::MultiGet().
+struct MultiGetKey {
+  const LookupKey* lkey;
+  std::string* value;
+  Status* status;
+  MergeContext* merge_context;
+  RangeDelAggregator* range_del_agg;
+};
+
 class Version {
  public:
   // Append to *iters a sequence of iterators that will
   // yield the contents of this Version when merged together.
+  // The range tombstones of a file are added to *range_del_agg when its
+  // iterator is opened; files of levels > 0 are opened lazily, once the
+  // iteration reaches them.
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
   void AddIterators(const ReadOptions&, const EnvOptions& soptions,
-                    MergeIteratorBuilder* merger_iter_builder);
+                    MergeIteratorBuilder* merger_iter_builder,
+                    RangeDelAggregator* range_del_agg);
 
   // Lookup the value for key.  If found, store it in *val and
   // return OK.  Else return a non-OK status.
   // Uses *operands to store merge_operator operations to apply later.
+  // The range tombstones of the visited files are added to *range_del_agg,
+  // and values covered by a tombstone in it are treated as deleted.
   //
   // If the ReadOptions.read_tier is set to do a read-only fetch, then
   // *value_found will be set to false if it cannot be determined whether
@@ -444,8 +460,23 @@ class Version {
   // REQUIRES: lock is not held
   void Get(const ReadOptions&, const LookupKey& key, std::string* val,
            Status* status, MergeContext* merge_context,
-           bool* value_found = nullptr, bool* key_exists = nullptr,
-           SequenceNumber* seq = nullptr);
+           RangeDelAggregator* range_del_agg, bool* value_found = nullptr,
+           bool* key_exists = nullptr, SequenceNumber* seq = nullptr);
+
+  // Batched version of Get(). Looks up all of *keys against the files of this
+  // version. Every level is visited once for the whole batch: keys are
+  // grouped by the file that may contain them and each file is probed once
+  // for its group through TableCache::MultiGet().
+  //
+  // The keys must be sorted in ascending user key order and share the same
+  // snapshot. For each key the semantics of *value, *status, *merge_context
+  // and *range_del_agg are the same as for Get(). The keys may share one
+  // *range_del_agg: the files are visited newest first for the whole batch,
+  // so a file another key has added tombstones from either doesn't overlap
+  // a pending key or was probed for it as well.
+  //
+  // REQUIRES: lock is not held
+  void MultiGet(const ReadOptions&, std::vector<MultiGetKey>* keys);
 
   // Loads some stats information from files. Call without mutex held. It needs
   // to be called before applying the version to the version set.
@@ -685,8 +716,11 @@ class VersionSet {
   }
 
   // Create an iterator that reads over the compaction inputs for "*c".
+  // The range tombstones of the input files are added to *range_del_agg as
+  // the files are opened.
   // The caller should delete the iterator when no longer needed.
-  InternalIterator* MakeInputIterator(const Compaction* c);
+  InternalIterator* MakeInputIterator(const Compaction* c,
+                                      RangeDelAggregator* range_del_agg);
 
   // Add all files listed in any live version to *live.
   void AddLiveFiles(std::vector<FileDescriptor>* live_list);
@@ -34,7 +34,7 @@ class WalManager {
  public:
   WalManager(const DBOptions& db_options, const EnvOptions& env_options)
       : db_options_(db_options),
-        env_options_(env_options),
+        env_options_(db_options.env->OptimizeForLogRead(env_options)),
         env_(db_options.env),
         purge_wal_files_last_run_(0) {}
 
@@ -75,7 +75,8 @@ class WalManager {
 
   // ------- state from DBImpl ------
   const DBOptions& db_options_;
-  const EnvOptions& env_options_;
+  // Only used to read log files
+  const EnvOptions env_options_;
   Env* env_;
 
   // ------- WalManager state -------
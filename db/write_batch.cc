@@ -15,10 +15,12 @@
 //    kTypeValue varstring varstring
 //    kTypeDeletion varstring
 //    kTypeSingleDeletion varstring
+//    kTypeRangeDeletion varstring varstring
 //    kTypeMerge varstring varstring
 //    kTypeColumnFamilyValue varint32 varstring varstring
 //    kTypeColumnFamilyDeletion varint32 varstring varstring
 //    kTypeColumnFamilySingleDeletion varint32 varstring varstring
+//    kTypeColumnFamilyRangeDeletion varint32 varstring varstring
 //    kTypeColumnFamilyMerge varint32 varstring varstring
 //    kTypeBeginPrepareXID varstring
 //    kTypeEndPrepareXID
@@ -64,6 +66,7 @@ enum ContentFlags : uint32_t {
   HAS_END_PREPARE = 1 << 6,
   HAS_COMMIT = 1 << 7,
   HAS_ROLLBACK = 1 << 8,
+  HAS_DELETE_RANGE = 1 << 9,
 };
 
 struct BatchContentClassifier : public WriteBatch::Handler {
@@ -84,6 +87,11 @@ struct BatchContentClassifier : public WriteBatch::Handler {
     return Status::OK();
   }
 
+  Status DeleteRangeCF(uint32_t, const Slice&, const Slice&) override {
+    content_flags |= ContentFlags::HAS_DELETE_RANGE;
+    return Status::OK();
+  }
+
   Status MergeCF(uint32_t, const Slice&, const Slice&) override {
     content_flags |= ContentFlags::HAS_MERGE;
     return Status::OK();
@@ -219,6 +227,10 @@ bool WriteBatch::HasSingleDelete() const {
   return (ComputeContentFlags() & ContentFlags::HAS_SINGLE_DELETE) != 0;
 }
 
+bool WriteBatch::HasDeleteRange() const {
+  return (ComputeContentFlags() & ContentFlags::HAS_DELETE_RANGE) != 0;
+}
+
 bool WriteBatch::HasMerge() const {
   return (ComputeContentFlags() & ContentFlags::HAS_MERGE) != 0;
 }
@@ -287,6 +299,18 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
         return Status::Corruption("bad WriteBatch Delete");
       }
       break;
+    case kTypeColumnFamilyRangeDeletion:
+      if (!GetVarint32(input, column_family)) {
+        return Status::Corruption("bad WriteBatch DeleteRange");
+      }
+    // intentional fallthrough
+    case kTypeRangeDeletion:
+      // for range delete, "key" is begin_key, "value" is end_key
+      if (!GetLengthPrefixedSlice(input, key) ||
+          !GetLengthPrefixedSlice(input, value)) {
+        return Status::Corruption("bad WriteBatch DeleteRange");
+      }
+      break;
     case kTypeColumnFamilyMerge:
       if (!GetVarint32(input, column_family)) {
         return Status::Corruption("bad WriteBatch Merge");
@@ -370,6 +394,13 @@ Status WriteBatch::Iterate(Handler* handler) const {
         s = handler->SingleDeleteCF(column_family, key);
         found++;
         break;
+      case kTypeColumnFamilyRangeDeletion:
+      case kTypeRangeDeletion:
+        assert(content_flags_.load(std::memory_order_relaxed) &
+               (ContentFlags::DEFERRED | ContentFlags::HAS_DELETE_RANGE));
+        s = handler->DeleteRangeCF(column_family, key, value);
+        found++;
+        break;
       case kTypeColumnFamilyMerge:
       case kTypeMerge:
         assert(content_flags_.load(std::memory_order_relaxed) &
@@ -598,6 +629,29 @@ void WriteBatch::SingleDelete(ColumnFamilyHandle* column_family,
   WriteBatchInternal::SingleDelete(this, GetColumnFamilyID(column_family), key);
 }
 
+void WriteBatchInternal::DeleteRange(WriteBatch* b, uint32_t column_family_id,
+                                     const Slice& begin_key,
+                                     const Slice& end_key) {
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeRangeDeletion));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyRangeDeletion));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, begin_key);
+  PutLengthPrefixedSlice(&b->rep_, end_key);
+  b->content_flags_.store(b->content_flags_.load(std::memory_order_relaxed) |
+                              ContentFlags::HAS_DELETE_RANGE,
+                          std::memory_order_relaxed);
+}
+
+void WriteBatch::DeleteRange(ColumnFamilyHandle* column_family,
+                             const Slice& begin_key, const Slice& end_key) {
+  WriteBatchInternal::DeleteRange(this, GetColumnFamilyID(column_family),
+                                  begin_key, end_key);
+}
+
 void WriteBatchInternal::Merge(WriteBatch* b, uint32_t column_family_id,
                                const Slice& key, const Slice& value) {
   WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
@@ -699,6 +753,11 @@ class MemTableInserter : public WriteBatch::Handler {
   MemPostInfoMap mem_post_info_map_;
   // current recovered transaction we are rebuilding (recovery)
   WriteBatch* rebuilding_trx_;
+  // whether inserts of the current batch pass a hint to the memtable
+  bool hint_per_batch_;
+  // insert hints of the current batch, one per memtable
+  typedef std::map<MemTable*, void*> HintMap;
+  HintMap hint_map_;
 
   // cf_mems should not be shared with concurrent inserters
   MemTableInserter(SequenceNumber sequence, ColumnFamilyMemTables* cf_mems,
@@ -716,12 +775,27 @@ class MemTableInserter : public WriteBatch::Handler {
         db_(reinterpret_cast<DBImpl*>(db)),
         concurrent_memtable_writes_(concurrent_memtable_writes),
         has_valid_writes_(has_valid_writes),
-        rebuilding_trx_(nullptr) {
+        rebuilding_trx_(nullptr),
+        hint_per_batch_(false) {
     assert(cf_mems_);
   }
 
+  ~MemTableInserter() { ClearHints(); }
+
   void set_log_number_ref(uint64_t log) { log_number_ref_ = log; }
 
+  void set_hint_per_batch(bool hint_per_batch) {
+    hint_per_batch_ = hint_per_batch;
+  }
+
+  // Releases the insert hints; call at the end of each batch.
+  void ClearHints() {
+    for (auto& pair : hint_map_) {
+      delete[] reinterpret_cast<char*>(pair.second);
+    }
+    hint_map_.clear();
+  }
+
   SequenceNumber get_final_sequence() { return sequence_; }
 
   void PostProcess() {
@@ -787,7 +861,7 @@ class MemTableInserter : public WriteBatch::Handler {
     auto* moptions = mem->GetMemTableOptions();
     if (!moptions->inplace_update_support) {
       mem->Add(sequence_, kTypeValue, key, value, concurrent_memtable_writes_,
-               get_post_process_info(mem));
+               get_post_process_info(mem), get_hint(mem));
     } else if (moptions->inplace_callback == nullptr) {
       assert(!concurrent_memtable_writes_);
       mem->Update(sequence_, key, value);
@@ -839,7 +913,7 @@ class MemTableInserter : public WriteBatch::Handler {
                     ValueType delete_type) {
     MemTable* mem = cf_mems_->GetMemTable();
     mem->Add(sequence_, delete_type, key, Slice(), concurrent_memtable_writes_,
-             get_post_process_info(mem));
+             get_post_process_info(mem), get_hint(mem));
     sequence_++;
     CheckMemtableFull();
     return Status::OK();
@@ -877,6 +951,31 @@ class MemTableInserter : public WriteBatch::Handler {
     return DeleteImpl(column_family_id, key, kTypeSingleDeletion);
   }
 
+  virtual Status DeleteRangeCF(uint32_t column_family_id,
+                               const Slice& begin_key,
+                               const Slice& end_key) override {
+    if (rebuilding_trx_ != nullptr) {
+      WriteBatchInternal::DeleteRange(rebuilding_trx_, column_family_id,
+                                      begin_key, end_key);
+      return Status::OK();
+    }
+
+    Status seek_status;
+    if (!SeekToColumnFamily(column_family_id, &seek_status)) {
+      ++sequence_;
+      return seek_status;
+    }
+
+    // The memtable keeps range tombstones apart from point keys; the end key
+    // is stored as the entry's value.
+    MemTable* mem = cf_mems_->GetMemTable();
+    mem->Add(sequence_, kTypeRangeDeletion, begin_key, end_key,
+             concurrent_memtable_writes_, get_post_process_info(mem));
+    sequence_++;
+    CheckMemtableFull();
+    return Status::OK();
+  }
+
   virtual Status MergeCF(uint32_t column_family_id, const Slice& key,
                          const Slice& value) override {
     assert(!concurrent_memtable_writes_);
@@ -1077,6 +1176,13 @@ class MemTableInserter : public WriteBatch::Handler {
     }
     return &mem_post_info_map_[mem];
   }
+
+  void** get_hint(MemTable* mem) {
+    if (!hint_per_batch_) {
+      return nullptr;
+    }
+    return &hint_map_[mem];
+  }
 };
 
 // This function can only be called in these conditions:
@@ -1098,7 +1204,9 @@ Status WriteBatchInternal::InsertInto(
       continue;
     }
     inserter.set_log_number_ref(w->log_ref);
+    inserter.set_hint_per_batch(w->hint_per_batch);
     w->status = w->batch->Iterate(&inserter);
+    inserter.ClearHints();
     if (!w->status.ok()) {
       return w->status;
     }
@@ -1118,6 +1226,7 @@ Status WriteBatchInternal::InsertInto(WriteThread::Writer* writer,
                             concurrent_memtable_writes);
   assert(writer->ShouldWriteToMemtable());
   inserter.set_log_number_ref(writer->log_ref);
+  inserter.set_hint_per_batch(writer->hint_per_batch);
   Status s = writer->batch->Iterate(&inserter);
   if (concurrent_memtable_writes) {
     inserter.PostProcess();
@@ -103,6 +103,39 @@ uint64_t WriteController::GetDelay(Env* env, uint64_t num_bytes) {
   return sleep_amount;
 }
 
+// Like GetDelay(), only gets the time once every kRateSampleBytes to keep the
+// cost low inside the DB mutex.
+void WriteController::RecordWrite(Env* env, uint64_t num_bytes) {
+  const uint64_t kMicrosPerSecond = 1000000;
+  const uint64_t kRateSampleBytes = 1024U * 1024U;
+  // Weight of the latest sample in the estimate.
+  const double kSampleWeight = 0.25;
+
+  rate_sample_bytes_ += num_bytes;
+  if (rate_sample_bytes_ < kRateSampleBytes) {
+    return;
+  }
+  auto time_now = env->NowMicros();
+  if (rate_sample_start_time_ == 0 || time_now <= rate_sample_start_time_) {
+    // The first sample only starts the clock.
+    rate_sample_start_time_ = time_now;
+    rate_sample_bytes_ = 0;
+    return;
+  }
+  double sample_rate = static_cast<double>(rate_sample_bytes_) *
+                       kMicrosPerSecond /
+                       (time_now - rate_sample_start_time_);
+  if (estimated_write_rate_ == 0) {
+    estimated_write_rate_ = static_cast<uint64_t>(sample_rate);
+  } else {
+    estimated_write_rate_ = static_cast<uint64_t>(
+        estimated_write_rate_ * (1 - kSampleWeight) +
+        sample_rate * kSampleWeight);
+  }
+  rate_sample_start_time_ = time_now;
+  rate_sample_bytes_ = 0;
+}
+
 StopWriteToken::~StopWriteToken() {
   assert(controller_->total_stopped_ >= 1);
   --controller_->total_stopped_;
@@ -25,7 +25,10 @@ class WriteController {
         total_delayed_(0),
         total_compaction_pressure_(0),
         bytes_left_(0),
-        last_refill_time_(0) {
+        last_refill_time_(0),
+        rate_sample_bytes_(0),
+        rate_sample_start_time_(0),
+        estimated_write_rate_(0) {
     set_delayed_write_rate(_delayed_write_rate);
   }
   ~WriteController() = default;
@@ -62,6 +65,13 @@ class WriteController {
   }
   uint64_t delayed_write_rate() const { return delayed_write_rate_; }
 
+  // Account num_bytes put into the DB in the estimate of the write rate.
+  // Prerequisite: DB mutex held.
+  void RecordWrite(Env* env, uint64_t num_bytes);
+  // Smoothed rate, in bytes per second, of the writes accounted with
+  // RecordWrite(), or 0 until enough of them were seen.
+  uint64_t estimated_write_rate() const { return estimated_write_rate_; }
+
  private:
   friend class WriteControllerToken;
   friend class StopWriteToken;
@@ -74,6 +84,9 @@ class WriteController {
   uint64_t bytes_left_;
   uint64_t last_refill_time_;
   uint64_t delayed_write_rate_;
+  uint64_t rate_sample_bytes_;
+  uint64_t rate_sample_start_time_;
+  uint64_t estimated_write_rate_;
 };
 
 class WriteControllerToken {
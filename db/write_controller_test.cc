@@ -41,6 +41,28 @@ TEST_F(WriteControllerTest, ChangeDelayRateTest) {
             controller.GetDelay(&env, 20000000u));
 }
 
+TEST_F(WriteControllerTest, EstimatedWriteRate) {
+  TimeSetEnv env;
+  WriteController controller(10000000u);
+  const uint64_t kMB = 1024u * 1024u;
+
+  // The first sample only starts the clock
+  controller.RecordWrite(&env, kMB);
+  ASSERT_EQ(0u, controller.estimated_write_rate());
+
+  // 1MB in one second, written in two pieces
+  env.now_micros_ += 1000000;
+  controller.RecordWrite(&env, kMB / 2);
+  ASSERT_EQ(0u, controller.estimated_write_rate());
+  controller.RecordWrite(&env, kMB / 2);
+  ASSERT_EQ(kMB, controller.estimated_write_rate());
+
+  // 4MB in the next second moves the estimate a quarter of the way
+  env.now_micros_ += 1000000;
+  controller.RecordWrite(&env, 4 * kMB);
+  ASSERT_EQ(kMB + 3 * kMB / 4, controller.estimated_write_rate());
+}
+
 TEST_F(WriteControllerTest, SanityTest) {
   WriteController controller(10000000u);
   auto stop_token_1 = controller.GetStopToken();
@@ -13,10 +13,14 @@
 
 namespace rocksdb {
 
-WriteThread::WriteThread(uint64_t max_yield_usec, uint64_t slow_yield_usec)
+WriteThread::WriteThread(uint64_t max_yield_usec, uint64_t slow_yield_usec,
+                         bool enable_pipelined_write)
     : max_yield_usec_(max_yield_usec),
       slow_yield_usec_(slow_yield_usec),
-      newest_writer_(nullptr) {}
+      enable_pipelined_write_(enable_pipelined_write),
+      newest_writer_(nullptr),
+      newest_memtable_writer_(nullptr),
+      last_sequence_(0) {}
 
 uint8_t WriteThread::BlockingAwaitState(Writer* w, uint8_t goal_mask) {
   // We're going to block.  Lazily create the mutex.  We guarantee
@@ -182,14 +186,15 @@ void WriteThread::SetState(Writer* w, uint8_t new_state) {
   }
 }
 
-void WriteThread::LinkOne(Writer* w, bool* linked_as_leader) {
+void WriteThread::LinkOne(Writer* w, std::atomic<Writer*>* newest_writer,
+                          bool* linked_as_leader) {
   assert(w->state == STATE_INIT);
 
-  Writer* writers = newest_writer_.load(std::memory_order_relaxed);
+  Writer* writers = newest_writer->load(std::memory_order_relaxed);
   while (true) {
     w->link_older = writers;
-    if (newest_writer_.compare_exchange_strong(writers, w)) {
-      if (writers == nullptr) {
+    if (newest_writer->compare_exchange_strong(writers, w)) {
+      if (writers == nullptr && newest_writer == &newest_writer_) {
         // this isn't part of the WriteThread machinery, but helps with
         // debugging and is checked by an assert in WriteImpl
         w->state.store(STATE_GROUP_LEADER, std::memory_order_relaxed);
@@ -200,6 +205,29 @@ void WriteThread::LinkOne(Writer* w, bool* linked_as_leader) {
   }
 }
 
+bool WriteThread::LinkGroup(const autovector<Writer*>& writers) {
+  assert(!writers.empty());
+
+  // Reset link_newer so that CreateMissingNewerLinks recreates the links
+  // within the memtable writer queue.
+  Writer* older = nullptr;
+  for (auto w : writers) {
+    w->link_older = older;
+    w->link_newer = nullptr;
+    older = w;
+  }
+
+  Writer* first = writers.front();
+  Writer* last = writers.back();
+  Writer* newest = newest_memtable_writer_.load(std::memory_order_relaxed);
+  while (true) {
+    first->link_older = newest;
+    if (newest_memtable_writer_.compare_exchange_strong(newest, last)) {
+      return newest == nullptr;
+    }
+  }
+}
+
 void WriteThread::CreateMissingNewerLinks(Writer* head) {
   while (true) {
     Writer* next = head->link_older;
@@ -217,13 +245,13 @@ void WriteThread::JoinBatchGroup(Writer* w) {
 
   assert(w->batch != nullptr);
   bool linked_as_leader;
-  LinkOne(w, &linked_as_leader);
+  LinkOne(w, &newest_writer_, &linked_as_leader);
 
   TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:Wait", w);
 
   if (!linked_as_leader) {
-    AwaitState(w,
-               STATE_GROUP_LEADER | STATE_PARALLEL_FOLLOWER | STATE_COMPLETED,
+    AwaitState(w, STATE_GROUP_LEADER | STATE_MEMTABLE_WRITER_LEADER |
+                      STATE_PARALLEL_FOLLOWER | STATE_COMPLETED,
                &ctx);
     TEST_SYNC_POINT_CALLBACK("WriteThread::JoinBatchGroup:DoneWaiting", w);
   }
@@ -364,7 +392,11 @@ void WriteThread::EarlyExitParallelGroup(Writer* w) {
 
   assert(w->state == STATE_PARALLEL_FOLLOWER);
   assert(pg->status.ok());
-  ExitAsBatchGroupLeader(pg->leader, pg->last_writer, pg->status);
+  if (enable_pipelined_write_) {
+    ExitAsMemTableWriter(pg->leader, pg->last_writer, pg->status);
+  } else {
+    ExitAsBatchGroupLeader(pg->leader, pg->last_writer, pg->status);
+  }
   assert(w->status.ok());
   assert(w->state == STATE_COMPLETED);
   SetState(pg->leader, STATE_COMPLETED);
@@ -372,11 +404,172 @@ void WriteThread::EarlyExitParallelGroup(Writer* w) {
 
 void WriteThread::ExitAsBatchGroupLeader(Writer* leader, Writer* last_writer,
                                          Status status) {
+  static AdaptationContext ctx("ExitAsBatchGroupLeader");
+
   assert(leader->link_older == nullptr);
 
+  if (!enable_pipelined_write_) {
+    CompleteBatchGroup(leader, last_writer, status, &newest_writer_,
+                       STATE_GROUP_LEADER);
+    return;
+  }
+
+  // Remember the members before any of them is completed and returns.
+  // EnterAsBatchGroupLeader created the links from leader to last_writer.
+  autovector<Writer*> writers;
+  for (Writer* w = leader;; w = w->link_newer) {
+    writers.push_back(w);
+    if (w == last_writer) {
+      break;
+    }
+  }
+
+  // Tricky. A dummy Writer takes the place of the group in the
+  // newest_writer_ list until the group has been linked to the memtable
+  // writer queue. Otherwise the next leader could run ahead and link its
+  // own group to that queue first, or a completed member could return
+  // and rejoin the list at an address we still compare against.
+  Writer dummy;
   Writer* head = newest_writer_.load(std::memory_order_acquire);
   if (head != last_writer ||
+      !newest_writer_.compare_exchange_strong(head, &dummy)) {
+    // See CompleteBatchGroup for why the failed CAS needs no retry
+    assert(head != last_writer);
+    CreateMissingNewerLinks(head);
+    assert(last_writer->link_newer->link_older == last_writer);
+    last_writer->link_newer->link_older = &dummy;
+    dummy.link_newer = last_writer->link_newer;
+  }
+
+  // Complete the writers that are done and hand the others over to the
+  // memtable writer queue
+  autovector<Writer*> memtable_writers;
+  bool leader_done = true;
+  for (auto w : writers) {
+    w->status = status;
+    if (status.ok() && w->ShouldWriteToMemtable()) {
+      memtable_writers.push_back(w);
+      if (w == leader) {
+        leader_done = false;
+      }
+    } else if (w != leader) {
+      SetState(w, STATE_COMPLETED);
+    }
+  }
+  if (!memtable_writers.empty() && LinkGroup(memtable_writers)) {
+    SetState(memtable_writers.front(), STATE_MEMTABLE_WRITER_LEADER);
+  }
+
+  // Unlink the dummy and wake up the next leader (if any)
+  head = newest_writer_.load(std::memory_order_acquire);
+  if (head != &dummy ||
       !newest_writer_.compare_exchange_strong(head, nullptr)) {
+    CreateMissingNewerLinks(head);
+    Writer* next_leader = dummy.link_newer;
+    assert(next_leader != nullptr && next_leader->link_older == &dummy);
+    next_leader->link_older = nullptr;
+    SetState(next_leader, STATE_GROUP_LEADER);
+  }
+
+  if (leader_done) {
+    SetState(leader, STATE_COMPLETED);
+  }
+  AwaitState(leader, STATE_MEMTABLE_WRITER_LEADER | STATE_PARALLEL_FOLLOWER |
+                         STATE_COMPLETED,
+             &ctx);
+}
+
+void WriteThread::EnterAsMemTableWriter(
+    Writer* leader, WriteThread::Writer** last_writer,
+    autovector<WriteThread::Writer*>* write_group) {
+  assert(enable_pipelined_write_);
+  assert(leader->link_older == nullptr);
+  assert(leader->batch != nullptr);
+
+  size_t size = WriteBatchInternal::ByteSize(leader->batch);
+  write_group->push_back(leader);
+
+  // Same group size limit as EnterAsBatchGroupLeader
+  size_t max_size = 1 << 20;
+  if (size <= (128 << 10)) {
+    max_size = size + (128 << 10);
+  }
+
+  *last_writer = leader;
+
+  Writer* newest_writer =
+      newest_memtable_writer_.load(std::memory_order_acquire);
+  CreateMissingNewerLinks(newest_writer);
+
+  Writer* w = leader;
+  while (w != newest_writer) {
+    w = w->link_newer;
+
+    if (w->batch == nullptr) {
+      // WaitForMemTableWriters is waiting for the writers before it
+      break;
+    }
+
+    auto batch_size = WriteBatchInternal::ByteSize(w->batch);
+    if (size + batch_size > max_size) {
+      break;
+    }
+
+    size += batch_size;
+    write_group->push_back(w);
+    *last_writer = w;
+  }
+}
+
+void WriteThread::LaunchParallelMemTableWriters(ParallelGroup* pg) {
+  assert(enable_pipelined_write_);
+
+  pg->leader->parallel_group = pg;
+
+  Writer* w = pg->leader;
+  while (w != pg->last_writer) {
+    w = w->link_newer;
+    w->parallel_group = pg;
+    SetState(w, STATE_PARALLEL_FOLLOWER);
+  }
+}
+
+void WriteThread::ExitAsMemTableWriter(Writer* leader, Writer* last_writer,
+                                       Status status) {
+  assert(enable_pipelined_write_);
+  assert(leader->link_older == nullptr);
+  CompleteBatchGroup(leader, last_writer, status, &newest_memtable_writer_,
+                     STATE_MEMTABLE_WRITER_LEADER);
+}
+
+void WriteThread::WaitForMemTableWriters() {
+  static AdaptationContext ctx("WaitForMemTableWriters");
+
+  assert(enable_pipelined_write_);
+  if (newest_memtable_writer_.load(std::memory_order_acquire) == nullptr) {
+    return;
+  }
+  // Queue up behind the pending memtable writers.  Once we are the leader
+  // nobody else can be linked, since only the batch group leader links
+  // writers to this queue.
+  Writer w;
+  bool linked_as_leader;
+  LinkOne(&w, &newest_memtable_writer_, &linked_as_leader);
+  if (!linked_as_leader) {
+    AwaitState(&w, STATE_MEMTABLE_WRITER_LEADER, &ctx);
+  }
+  newest_memtable_writer_.store(nullptr, std::memory_order_release);
+}
+
+void WriteThread::CompleteBatchGroup(Writer* leader, Writer* last_writer,
+                                     Status status,
+                                     std::atomic<Writer*>* newest_writer,
+                                     uint8_t next_leader_state) {
+  assert(leader->link_older == nullptr);
+
+  Writer* head = newest_writer->load(std::memory_order_acquire);
+  if (head != last_writer ||
+      !newest_writer->compare_exchange_strong(head, nullptr)) {
     // Either w wasn't the head during the load(), or it was the head
     // during the load() but somebody else pushed onto the list before
     // we did the compare_exchange_strong (causing it to fail).  In the
@@ -401,7 +594,7 @@ void WriteThread::ExitAsBatchGroupLeader(Writer* leader, Writer* last_writer,
     // nullptr when they enqueued (we were definitely enqueued before them
     // and are still in the list).  That means leader handoff occurs when
     // we call MarkJoined
-    SetState(last_writer->link_newer, STATE_GROUP_LEADER);
+    SetState(last_writer->link_newer, next_leader_state);
   }
   // else nobody else was waiting, although there might already be a new
   // leader now
@@ -423,18 +616,26 @@ void WriteThread::EnterUnbatched(Writer* w, InstrumentedMutex* mu) {
 
   assert(w->batch == nullptr);
   bool linked_as_leader;
-  LinkOne(w, &linked_as_leader);
+  LinkOne(w, &newest_writer_, &linked_as_leader);
   if (!linked_as_leader) {
     mu->Unlock();
     TEST_SYNC_POINT("WriteThread::EnterUnbatched:Wait");
     AwaitState(w, STATE_GROUP_LEADER, &ctx);
     mu->Lock();
   }
+  if (enable_pipelined_write_) {
+    // Unbatched writers switch memtables or assign sequence numbers of
+    // their own, so the writes already handed over to the memtable writer
+    // queue have to be finished first.
+    mu->Unlock();
+    WaitForMemTableWriters();
+    mu->Lock();
+  }
 }
 
 void WriteThread::ExitUnbatched(Writer* w) {
   Status dummy_status;
-  ExitAsBatchGroupLeader(w, w, dummy_status);
+  CompleteBatchGroup(w, w, dummy_status, &newest_writer_, STATE_GROUP_LEADER);
 }
 
 }  // namespace rocksdb
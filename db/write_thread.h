@@ -61,6 +61,14 @@ class WriteThread {
     // A state indicating that the thread may be waiting using StateMutex()
     // and StateCondVar()
     STATE_LOCKED_WAITING = 16,
+
+    // Pipelined write only.  The state used to inform a Writer whose batch
+    // has been written to the WAL that it has become the leader of the
+    // memtable writer queue, and it should now build a memtable writer
+    // group with EnterAsMemTableWriter.  Members of that group are then
+    // either completed by ExitAsMemTableWriter or moved to
+    // STATE_PARALLEL_FOLLOWER by LaunchParallelMemTableWriters.
+    STATE_MEMTABLE_WRITER_LEADER = 32,
   };
 
   struct Writer;
@@ -81,6 +89,7 @@ class WriteThread {
     bool sync;
     bool disableWAL;
     bool disable_memtable;
+    bool hint_per_batch;  // use a memtable insert hint for this batch
     uint64_t log_used;  // log number that this batch was inserted into
     uint64_t log_ref;   // log number that memtable insert should reference
     bool in_batch_group;
@@ -101,6 +110,7 @@ class WriteThread {
           sync(false),
           disableWAL(false),
           disable_memtable(false),
+          hint_per_batch(false),
           log_used(0),
           log_ref(0),
           in_batch_group(false),
@@ -180,7 +190,8 @@ class WriteThread {
     }
   };
 
-  WriteThread(uint64_t max_yield_usec, uint64_t slow_yield_usec);
+  WriteThread(uint64_t max_yield_usec, uint64_t slow_yield_usec,
+              bool enable_pipelined_write = false);
 
   // IMPORTANT: None of the methods in this class rely on the db mutex
   // for correctness. All of the methods except JoinBatchGroup and
@@ -194,7 +205,9 @@ class WriteThread {
   // STATE_GROUP_LEADER.  If w has been made part of a sequential batch
   // group and the leader has performed the write, returns STATE_DONE.
   // If w has been made part of a parallel batch group and is responsible
-  // for updating the memtable, returns STATE_PARALLEL_FOLLOWER.
+  // for updating the memtable, returns STATE_PARALLEL_FOLLOWER.  With
+  // pipelined write, may also return STATE_MEMTABLE_WRITER_LEADER once the
+  // WAL write of w's group is done.
   //
   // The db mutex SHOULD NOT be held when calling this function, because
   // it will block.
@@ -236,14 +249,65 @@ class WriteThread {
   // Unlinks the Writer-s in a batch group, wakes up the non-leaders,
   // and wakes up the next leader (if any).
   //
+  // With pipelined write, the Writer-s that still have to insert into the
+  // memtable are moved to the memtable writer queue instead of being woken
+  // up, and the call returns once the leader itself has reached
+  // STATE_MEMTABLE_WRITER_LEADER, STATE_PARALLEL_FOLLOWER or
+  // STATE_COMPLETED.  A non-ok status completes the whole group.
+  //
   // Writer* leader:         From EnterAsBatchGroupLeader
   // Writer* last_writer:    Value of out-param of EnterAsBatchGroupLeader
   // Status status:          Status of write operation
   void ExitAsBatchGroupLeader(Writer* leader, Writer* last_writer,
                               Status status);
 
+  // Pipelined write only.  Constructs a memtable writer group led by
+  // leader, which is in STATE_MEMTABLE_WRITER_LEADER.  The members already
+  // have their Writer::sequence assigned and have been written to the WAL.
+  //
+  // Writer* leader:         Writer that is STATE_MEMTABLE_WRITER_LEADER
+  // Writer** last_writer:   Out-param that identifies the last follower
+  // autovector<Writer*>* write_group: Out-param of group members
+  void EnterAsMemTableWriter(Writer* leader, Writer** last_writer,
+                             autovector<WriteThread::Writer*>* write_group);
+
+  // Pipelined write only.  Causes the non-leader members of a memtable
+  // writer group to return STATE_PARALLEL_FOLLOWER, keeping the sequence
+  // numbers they were given by their batch group leader.  The parallel
+  // group is then finished with CompleteParallelWorker and
+  // EarlyExitParallelGroup or ExitAsMemTableWriter, as for a parallel
+  // batch group.
+  void LaunchParallelMemTableWriters(ParallelGroup* pg);
+
+  // Pipelined write only.  Unlinks the Writer-s in a memtable writer
+  // group, completes the non-leaders and wakes up the next memtable writer
+  // leader (if any).  The caller must have published the group's sequence
+  // numbers before calling this, so that sequence numbers become visible
+  // in order.
+  void ExitAsMemTableWriter(Writer* leader, Writer* last_writer,
+                            Status status);
+
+  // Pipelined write only.  Waits until all the writers already linked to
+  // the memtable writer queue have finished.  The caller must be the
+  // leader of the batch group queue (or have entered it unbatched), so
+  // that no more writers can be handed over meanwhile.
+  void WaitForMemTableWriters();
+
+  // Pipelined write only.  Raises the last sequence number handed out to a
+  // batch group to sequence if it is smaller, and returns it.  Since
+  // sequence numbers are published only after the memtable insert, the
+  // batch group leader can't allocate them from VersionSet::LastSequence()
+  // alone.  Must only be called by the batch group leader.
+  SequenceNumber UpdateLastSequence(SequenceNumber sequence) {
+    if (sequence > last_sequence_) {
+      last_sequence_ = sequence;
+    }
+    return last_sequence_;
+  }
+
   // Waits for all preceding writers (unlocking mu while waiting), then
-  // registers w as the currently proceeding writer.
+  // registers w as the currently proceeding writer.  With pipelined write,
+  // also waits for their memtable inserts to finish.
   //
   // Writer* w:              A Writer not eligible for batching
   // InstrumentedMutex* mu:  The db mutex, to unlock while waiting
@@ -265,10 +329,23 @@ class WriteThread {
   uint64_t max_yield_usec_;
   uint64_t slow_yield_usec_;
 
+  // Whether the WAL write and the memtable insert are done by separate
+  // queues, see DBOptions::enable_pipelined_write
+  const bool enable_pipelined_write_;
+
   // Points to the newest pending Writer.  Only leader can remove
   // elements, adding can be done lock-free by anybody
   std::atomic<Writer*> newest_writer_;
 
+  // Pipelined write only.  Points to the newest Writer waiting for its
+  // memtable insert.  Writers are added by batch group leaders in WAL
+  // order and removed by the memtable writer leader.
+  std::atomic<Writer*> newest_memtable_writer_;
+
+  // Pipelined write only.  The last sequence number allocated by a batch
+  // group leader
+  SequenceNumber last_sequence_;
+
   // Waits for w->state & goal_mask using w->StateMutex().  Returns
   // the state that satisfies goal_mask.
   uint8_t BlockingAwaitState(Writer* w, uint8_t goal_mask);
@@ -281,14 +358,27 @@ class WriteThread {
 
   void SetState(Writer* w, uint8_t new_state);
 
-  // Links w into the newest_writer_ list. Sets *linked_as_leader to
+  // Links w into the newest_writer list. Sets *linked_as_leader to
   // true if w was linked directly into the leader position.  Safe to
   // call from multiple threads without external locking.
-  void LinkOne(Writer* w, bool* linked_as_leader);
+  void LinkOne(Writer* w, std::atomic<Writer*>* newest_writer,
+               bool* linked_as_leader);
+
+  // Links the Writer-s of a batch group that still have to write to the
+  // memtable into the newest_memtable_writer_ list, preserving their
+  // order.  Returns true if the first of them became the leader.
+  bool LinkGroup(const autovector<Writer*>& writers);
 
   // Computes any missing link_newer links.  Should not be called
   // concurrently with itself.
   void CreateMissingNewerLinks(Writer* head);
+
+  // Unlinks leader..last_writer from the newest_writer list, moves the
+  // next writer (if any) to next_leader_state and completes the
+  // non-leaders with status.
+  void CompleteBatchGroup(Writer* leader, Writer* last_writer, Status status,
+                          std::atomic<Writer*>* newest_writer,
+                          uint8_t next_leader_state);
 };
 
 }  // namespace rocksdb
@@ -34,12 +34,32 @@ class Cache;
 // Create a new cache with a fixed size capacity. The cache is sharded
 // to 2^num_shard_bits shards, by hash of the key. The total capacity
 // is divided and evenly assigned to each shard.
+//
+// The parameter high_pri_pool_ratio is the fraction of each shard's capacity
+// reserved for entries inserted with Cache::Priority::HIGH. High priority
+// entries are evicted only after all evictable low priority entries are gone
+// or once they overflow the pool. With the default ratio 0 all entries share
+// a single LRU list regardless of their priority. Returns nullptr if the
+// ratio is not within [0, 1].
 extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
                                           int num_shard_bits = 6,
-                                          bool strict_capacity_limit = false);
+                                          bool strict_capacity_limit = false,
+                                          double high_pri_pool_ratio = 0.0);
+
+// Similar to NewLRUCache, but create a cache based on the CLOCK algorithm.
+// Cache hits only bump an atomic reference count and set a usage bit instead
+// of moving the entry in a LRU list under the shard mutex, which scales
+// better with many concurrent readers. Entry priorities are ignored.
+extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
+                                            int num_shard_bits = 6,
+                                            bool strict_capacity_limit = false);
 
 class Cache {
  public:
+  // Depending on implementation, cache entries with high priority could be
+  // less likely to get evicted than low priority entries.
+  enum class Priority { HIGH, LOW };
+
   Cache() {}
 
   // Destroys all existing entries by calling the "deleter"
@@ -66,9 +86,13 @@ class Cache {
   //
   // When the inserted entry is no longer needed, the key and
   // value will be passed to "deleter".
+  //
+  // The priority is a hint on how long the entry should be retained, see
+  // Priority.
   virtual Status Insert(const Slice& key, void* value, size_t charge,
                         void (*deleter)(const Slice& key, void* value),
-                        Handle** handle = nullptr) = 0;
+                        Handle** handle = nullptr,
+                        Priority priority = Priority::LOW) = 0;
 
   // If the cache has no mapping for "key", returns nullptr.
   //
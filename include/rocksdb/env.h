@@ -355,6 +355,25 @@ class Env {
   virtual EnvOptions OptimizeForManifestWrite(const EnvOptions& env_options)
       const;
 
+  // OptimizeForLogRead will create a new EnvOptions object that is a copy of
+  // the EnvOptions in the parameters, but is optimized for reading log files.
+  // Default implementation turns off direct reads.
+  virtual EnvOptions OptimizeForLogRead(const EnvOptions& env_options) const;
+
+  // OptimizeForManifestRead will create a new EnvOptions object that is a
+  // copy of the EnvOptions in the parameters, but is optimized for reading
+  // manifest files. Default implementation turns off direct reads.
+  virtual EnvOptions OptimizeForManifestRead(const EnvOptions& env_options)
+      const;
+
+  // OptimizeForCompactionTableWrite will create a new EnvOptions object that
+  // is a copy of the EnvOptions in the parameters, but is optimized for
+  // writing the table files of flushes and compactions. Default
+  // implementation turns on direct writes if
+  // db_options.use_direct_io_for_flush_and_compaction is set.
+  virtual EnvOptions OptimizeForCompactionTableWrite(
+      const EnvOptions& env_options, const DBOptions& db_options) const;
+
   // Returns the status of all threads that belong to the current Env.
   virtual Status GetThreadList(std::vector<ThreadStatus>* thread_list) {
     return Status::NotSupported("Not supported.");
@@ -447,6 +466,15 @@ class RandomAccessFile {
   // layer
   virtual void EnableReadAhead() {}
 
+  // Indicates the upper layers if the current RandomAccessFile
+  // implementation uses direct IO. Reads of such a file should then use
+  // offsets, sizes and buffers aligned to GetRequiredBufferAlignment().
+  virtual bool UseDirectIO() const { return false; }
+
+  // Alignment of the offsets, sizes and buffers of reads when UseDirectIO()
+  // returns true.
+  virtual size_t GetRequiredBufferAlignment() const { return 4 * 1024; }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
@@ -471,6 +499,14 @@ class RandomAccessFile {
 
   virtual void Hint(AccessPattern pattern) {}
 
+  // Starts reading [offset, offset + n) of the file in the background, so
+  // that later reads of that range don't have to wait for the device. It
+  // needn't wait for the data, although it may block while it issues the
+  // reads, and it has no effect on the result of Read().
+  virtual Status Prefetch(uint64_t offset, size_t n) {
+    return Status::NotSupported("Prefetch not supported.");
+  }
+
   // Remove any kind of caching of data from the offset to offset+length
   // of this file. If the length is 0, then it refers to the end of file.
   // If the system is not caching the file contents, then this is a noop.
@@ -68,6 +68,10 @@ enum class CompactionReason {
   kUniversalSortedRunNum,
   // [FIFO] total size > max_table_files_size
   kFIFOMaxSize,
+  // [FIFO] merging small files to reduce the number of files
+  kFIFOReduceNumFiles,
+  // [FIFO] files with creation time < (current_time - ttl)
+  kFIFOTtl,
   // Manual compaction
   kManualCompaction,
   // DB::SuggestCompactRange() marked files for compaction
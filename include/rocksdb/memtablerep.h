@@ -83,6 +83,18 @@ class MemTableRep {
   // collection, and no concurrent modifications to the table in progress
   virtual void Insert(KeyHandle handle) = 0;
 
+  // Same as Insert(), but also takes a hint of the insert location.  If *hint
+  // is nullptr, a new hint is stored in it; otherwise the hint is updated to
+  // the last insert location.  A hint speeds up inserts of keys that land
+  // close to each other, such as the mostly ascending keys of one write
+  // batch.  The hint is allocated with new char[] and owned by the caller,
+  // who must release it with delete[].  Only the skip list rep makes use of
+  // hints; other reps fall back to Insert().
+  virtual void InsertWithHint(KeyHandle handle, void** hint) {
+    // Ignore the hint by default.
+    Insert(handle);
+  }
+
   // Like Insert(handle), but may be called concurrent with other calls
   // to InsertConcurrently for other handles
   virtual void InsertConcurrently(KeyHandle handle) {
@@ -93,6 +105,14 @@ class MemTableRep {
 #endif
   }
 
+  // Like InsertWithHint(handle, hint), but may be called concurrent with
+  // other calls to InsertConcurrently or InsertWithHintConcurrently.  A hint
+  // must not be shared between threads.
+  virtual void InsertWithHintConcurrently(KeyHandle handle, void** hint) {
+    // Ignore the hint by default.
+    InsertConcurrently(handle);
+  }
+
   // Returns true iff an entry that compares equal to key is in the collection.
   virtual bool Contains(const char* key) const = 0;
 
@@ -133,7 +133,28 @@ struct CompactionOptionsFIFO {
   // Default: 1GB
   uint64_t max_table_files_size;
 
-  CompactionOptionsFIFO() : max_table_files_size(1 * 1024 * 1024 * 1024) {}
+  // If greater than 0, table files whose oldest data was written more than
+  // ttl seconds ago are deleted, whatever the total size of the table files.
+  // The age is taken from the "rocksdb.creation.time" table property, so
+  // files written by older versions never expire. Expiry is checked whenever
+  // a compaction is considered, e.g. after every flush.
+  // Requires max_open_files = -1, so that the table properties are always
+  // in memory.
+  // Default: 0 (disabled)
+  uint64_t ttl;
+
+  // If true, while the total size of the table files is below
+  // max_table_files_size, at least level0_file_num_compaction_trigger of the
+  // newest small table files are merged into a single file, to cut the number
+  // of files a read has to look into. Only files about the size of a flush
+  // (write_buffer_size) are merged.
+  // Default: false
+  bool allow_compaction;
+
+  CompactionOptionsFIFO()
+      : max_table_files_size(1 * 1024 * 1024 * 1024),
+        ttl(0),
+        allow_compaction(false) {}
 };
 
 // Compression options for different compression algorithms like Zlib
@@ -150,14 +171,49 @@ struct CompressionOptions {
   // A value of 0 indicates the feature is disabled.
   // Default: 0.
   uint32_t max_dict_bytes;
+  // Maximum size of the training data passed to ZSTD's dictionary trainer.
+  // When nonzero and the output is ZSTD-compressed, up to this many bytes
+  // are sampled instead of max_dict_bytes, and ZSTD trains a dictionary of
+  // at most max_dict_bytes from them rather than using the samples as the
+  // dictionary as they are. Trained dictionaries hold the most useful
+  // repetitions of many small values, e.g. JSON documents, and come with
+  // entropy tables that ZSTD otherwise rebuilds for every block.
+  // Has no effect unless max_dict_bytes is nonzero. Requires ZSTD v1.1.3+.
+  // Default: 0.
+  uint32_t zstd_max_train_bytes;
+  // Number of threads that compress the data blocks of a block-based table
+  // file. With a value above 1, the flush or compaction thread hands the
+  // finished data blocks to that many worker threads per output file and
+  // writes them out in order once they are compressed. This helps when
+  // compression, e.g. zlib or ZSTD at a high level, is the bottleneck of
+  // flushes and compactions. Tables using a hash or partitioned index, or a
+  // block-based filter, are still compressed inline.
+  // Default: 1.
+  uint32_t parallel_threads;
+  // If true, flushes (and recovery and repair, which also write table files
+  // from memtables) compress their output with a dictionary as well. It is
+  // made from samples of the whole memtable, which costs one more pass over
+  // it before the file is written. Has no effect unless max_dict_bytes is
+  // nonzero.
+  // Default: false.
+  bool use_dict_for_flush;
 
   CompressionOptions()
-      : window_bits(-14), level(-1), strategy(0), max_dict_bytes(0) {}
+      : window_bits(-14),
+        level(-1),
+        strategy(0),
+        max_dict_bytes(0),
+        zstd_max_train_bytes(0),
+        parallel_threads(1),
+        use_dict_for_flush(false) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes)
       : window_bits(wbits),
         level(_lev),
         strategy(_strategy),
-        max_dict_bytes(_max_dict_bytes) {}
+        max_dict_bytes(_max_dict_bytes),
+        zstd_max_train_bytes(0),
+        parallel_threads(1),
+        use_dict_for_flush(false) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -581,6 +637,26 @@ struct ColumnFamilyOptions {
   // Default: 256GB
   uint64_t hard_pending_compaction_bytes_limit;
 
+  // If true, writes are slowed down gradually as the column family approaches
+  // the point where they would be delayed, instead of running at full speed
+  // until level0_slowdown_writes_trigger or
+  // soft_pending_compaction_bytes_limit is hit. The pressure grows from 0 to 1
+  // as the number of level-0 files goes from the point where compaction is
+  // sped up to level0_slowdown_writes_trigger, or as the estimated pending
+  // compaction bytes go from half of soft_pending_compaction_bytes_limit to
+  // the limit. While there is pressure:
+  // * the write rate limit moves from the measured write rate (or
+  //   delayed_write_rate, if higher) down to delayed_write_rate, so that the
+  //   delay kicks in at the rate it would start at anyway;
+  // * new memtables are allowed to grow up to (1 + pressure) times
+  //   write_buffer_size before they are flushed, so fewer and larger level-0
+  //   files are written.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool adaptive_write_pacing;
+
   // DEPRECATED -- this options is no longer used
   unsigned int rate_limit_delay_max_milliseconds;
 
@@ -736,8 +812,9 @@ struct ColumnFamilyOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
 
-  // if prefix_extractor is set and memtable_prefix_bloom_size_ratio is not 0,
-  // create prefix bloom for memtable with the size of
+  // if prefix_extractor is set or memtable_whole_key_filtering is true, and
+  // memtable_prefix_bloom_size_ratio is not 0, create bloom filter for
+  // memtable with the size of
   // write_buffer_size * memtable_prefix_bloom_size_ratio.
   // If it is larger than 0.25, it is santinized to 0.25.
   //
@@ -746,6 +823,16 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   double memtable_prefix_bloom_size_ratio;
 
+  // If true, the memtable bloom filter also records whole user keys, so that
+  // point lookups skip the memtable search for keys the memtable doesn't
+  // contain, with or without a prefix_extractor. The filter is sized by
+  // memtable_prefix_bloom_size_ratio and is not created if it is 0.
+  //
+  // Default: false (disable)
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_whole_key_filtering;
+
   // Page size for huge page for the arena used by the memtable. If <=0, it
   // won't allocate from huge page but from malloc.
   // Users are responsible to reserve huge pages for it to be allocated. For
@@ -1112,6 +1199,20 @@ struct DBOptions {
   // Default: false
   bool allow_mmap_writes;
 
+  // Use O_DIRECT for reading table files, so that data is cached only in
+  // the block cache and not a second time in the OS page cache. WAL and
+  // MANIFEST reads are not affected. Cannot be combined with
+  // allow_mmap_reads. When set and compaction_readahead_size is 0, the
+  // readahead of compaction inputs defaults to 2MB.
+  // Default: false
+  bool use_direct_reads;
+
+  // Use O_DIRECT for writing the table files of flushes and compactions.
+  // WAL and MANIFEST writes are not affected. Cannot be combined with
+  // allow_mmap_writes.
+  // Default: false
+  bool use_direct_io_for_flush_and_compaction;
+
   // If false, fallocate() calls are bypassed
   bool allow_fallocate;
 
@@ -1185,6 +1286,12 @@ struct DBOptions {
   // running RocksDB on spinning disks, you should set this to at least 2MB.
   // That way RocksDB's compaction is doing sequential instead of random reads.
   //
+  // The readahead of each input file starts at 64KB and doubles up to this
+  // size while the file is read sequentially, so this bounds the memory of
+  // the readahead buffers to this size per input file. Once the readahead
+  // grows, the next window is also prefetched in the background while the
+  // current one is merged, unless the file uses direct IO.
+  //
   // When non-zero, we also force new_table_reader_for_compaction_inputs to
   // true.
   //
@@ -1287,6 +1394,18 @@ struct DBOptions {
   // Default: false
   bool enable_write_thread_adaptive_yield;
 
+  // If true, the WAL write and the memtable insert of a write batch group
+  // are pipelined: as soon as a group has been appended to the WAL, the
+  // next group may start its WAL write while the previous one is still
+  // being inserted into the memtable. Memtable inserts (and the visibility
+  // of their sequence numbers) still happen in the order of the WAL.
+  // This mostly helps write throughput when WAL writes are slow, e.g. with
+  // WriteOptions::sync, and can be combined with
+  // allow_concurrent_memtable_write.
+  //
+  // Default: false
+  bool enable_pipelined_write;
+
   // The maximum number of microseconds that a write operation will use
   // a yielding spin loop to coordinate with other write threads before
   // blocking on a mutex.  (Assuming write_thread_slow_yield_usec is
@@ -1356,6 +1475,28 @@ struct DBOptions {
   //
   // DEFAULT: false
   bool avoid_flush_during_recovery;
+
+  // Number of threads replaying the WAL on DB::Open. If greater than 1, each
+  // log file is read and checksummed on a background thread while its
+  // records are inserted into the memtables, and, if
+  // allow_concurrent_memtable_write is set, up to this many threads insert
+  // write batches concurrently. Batches with merges or prepared transactions
+  // are still inserted one at a time, in log order.
+  //
+  // DEFAULT: 1
+  int wal_recovery_threads;
+
+  // If true, DB::Open doesn't open the table files even when max_open_files
+  // is -1: TableCache opens each of them on its first access and keeps it
+  // open. The data-entry stats of newly written table files (see
+  // skip_stats_update_on_db_open) are also recorded in the MANIFEST, so that
+  // Open doesn't need to read them from the files either. This makes opening
+  // a DB with many table files on slow storage much faster. It doesn't work
+  // with the TTL of FIFO compaction, nor with a read-only DB opened in fully
+  // compacted mode.
+  //
+  // DEFAULT: false
+  bool skip_table_open_on_db_open;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1556,11 +1697,20 @@ struct WriteOptions {
   // Default: false
   bool ignore_missing_column_families;
 
+  // If true, the memtable inserts of this write batch remember the last
+  // insert position in each memtable and start the next insert from there
+  // instead of from the head of the skip list.  This speeds up batches
+  // whose keys are sorted or clustered, and costs a few extra comparisons
+  // otherwise.  Only the skip list memtable uses the hint.
+  // Default: false
+  bool memtable_insert_hint_per_batch;
+
   WriteOptions()
       : sync(false),
         disableWAL(false),
         timeout_hint_us(0),
-        ignore_missing_column_families(false) {}
+        ignore_missing_column_families(false),
+        memtable_insert_hint_per_batch(false) {}
 };
 
 // Options that control flush operations
@@ -113,6 +113,13 @@ struct PerfContext {
   uint64_t bloom_sst_hit_count;
   // total number of SST table bloom misses
   uint64_t bloom_sst_miss_count;
+  // total number of bytes of data blocks prefetched by iterators scanning
+  // a table file
+  uint64_t block_prefetch_bytes;
+  // total number of data blocks an iterator moved to that it had prefetched
+  uint64_t block_prefetch_hit_count;
+  // total number of prefetched bytes the iterators never moved to
+  uint64_t block_prefetch_wasted_bytes;
 };
 
 #if defined(NPERF_CONTEXT) || defined(IOS_CROSS_COMPILE)
@@ -36,6 +36,15 @@ class RateLimiter {
   // Total # of requests that go though rate limiter
   virtual int64_t GetTotalRequests(
       const Env::IOPriority pri = Env::IO_TOTAL) const = 0;
+
+  // The rate currently enforced, in bytes per second
+  virtual int64_t GetBytesPerSecond() const = 0;
+
+  // Called by the DBs using this rate limiter when their compaction falls
+  // behind, i.e. when they speed it up because of level-0 files or pending
+  // compaction bytes. An auto-tuned rate limiter doesn't lower its rate while
+  // these reports keep coming. Ignored by default.
+  virtual void ReportCompactionPressure() {}
 };
 
 // Create a RateLimiter object, which can be shared among RocksDB instances to
@@ -56,9 +65,21 @@ class RateLimiter {
 // continuouly. This fairness parameter grants low-pri requests permission by
 // 1/fairness chance even though high-pri requests exist to avoid starvation.
 // You should be good by leaving it at default 10.
+// @auto_tuned: Enables dynamic adjustment of the rate within
+// [min_rate_bytes_per_sec, rate_bytes_per_sec], starting from the middle of
+// that range. Every 100 refill periods, the rate is raised by 5% if requests
+// had to wait for a refill in more than 90% of the periods, and lowered by 5%
+// if they had to wait in less than 50% of them (down to the minimum at once
+// if they never had to). A DB behind on compaction keeps the rate from being
+// lowered, and raises it as soon as half of the periods were drained.
+// SetBytesPerSecond() then sets the maximum of the range.
+// @min_rate_bytes_per_sec: The lower end of the auto-tuned range. If 0, it is
+// rate_bytes_per_sec / 20.
 extern RateLimiter* NewGenericRateLimiter(
     int64_t rate_bytes_per_sec,
     int64_t refill_period_us = 100 * 1000,
-    int32_t fairness = 10);
+    int32_t fairness = 10,
+    bool auto_tuned = false,
+    int64_t min_rate_bytes_per_sec = 0);
 
 }  // namespace rocksdb
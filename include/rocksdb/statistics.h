@@ -192,6 +192,13 @@ enum Tickers : uint32_t {
   ROW_CACHE_HIT,
   ROW_CACHE_MISS,
 
+  // Decisions of adaptive_write_pacing: number of times the paced write rate
+  // was lowered or raised, and number of memtables allowed to grow beyond
+  // write_buffer_size.
+  WRITE_PACING_RATE_DECREASES,
+  WRITE_PACING_RATE_INCREASES,
+  WRITE_PACING_FLUSH_TRIGGER_RAISED,
+
   TICKER_ENUM_MAX
 };
 
@@ -284,6 +291,10 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {FILTER_OPERATION_TOTAL_TIME, "rocksdb.filter.operation.time.nanos"},
     {ROW_CACHE_HIT, "rocksdb.row.cache.hit"},
     {ROW_CACHE_MISS, "rocksdb.row.cache.miss"},
+    {WRITE_PACING_RATE_DECREASES, "rocksdb.write.pacing.rate.decreases"},
+    {WRITE_PACING_RATE_INCREASES, "rocksdb.write.pacing.rate.increases"},
+    {WRITE_PACING_FLUSH_TRIGGER_RAISED,
+     "rocksdb.write.pacing.flush.trigger.raised"},
 };
 
 /**
@@ -331,6 +342,10 @@ enum Histograms : uint32_t {
   COMPRESSION_TIMES_NANOS,
   DECOMPRESSION_TIMES_NANOS,
 
+  // The rate allowed by DBOptions::rate_limiter, sampled at the start of each
+  // compaction. It moves over time if the rate limiter is auto-tuned.
+  RATE_LIMITER_BYTES_PER_SEC,
+
   HISTOGRAM_ENUM_MAX,  // TODO(ldemailly): enforce HistogramsNameMap match
 };
 
@@ -365,6 +380,7 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {BYTES_DECOMPRESSED, "rocksdb.bytes.decompressed"},
     {COMPRESSION_TIMES_NANOS, "rocksdb.compression.times.nanos"},
     {DECOMPRESSION_TIMES_NANOS, "rocksdb.decompression.times.nanos"},
+    {RATE_LIMITER_BYTES_PER_SEC, "rocksdb.rate.limiter.bytes.per.sec"},
 };
 
 struct HistogramData {
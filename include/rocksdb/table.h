@@ -80,6 +80,13 @@ struct BlockBasedTableOptions {
     // The hash index, if enabled, will do the hash lookup when
     // `Options.prefix_extractor` is provided.
     kHashSearch,
+
+    // A two-level index: the index entries are cut into partitions of about
+    // `block_size` bytes, and a small top-level index points to the
+    // partitions. Only the top-level index is loaded when the table is
+    // opened; the partitions are read through the block cache on demand, like
+    // data blocks.
+    kTwoLevelIndexSearch,
   };
 
   IndexType index_type = kBinarySearch;
@@ -88,6 +95,39 @@ struct BlockBasedTableOptions {
   // it will behave as if hash_index_allow_collision=true.
   bool hash_index_allow_collision = true;
 
+  // The index type that will be used inside each data block.
+  enum DataBlockIndexType : char {
+    // Binary search over the restart points of the block.
+    kDataBlockBinarySearch = 0,
+
+    // In addition, append to each data block a hash map from user keys to
+    // the restart interval holding them, which point lookups use instead of
+    // the binary search. Lookups fall back to the binary search for keys
+    // whose bucket is shared by several restart intervals, and for blocks
+    // with more than 253 restart intervals, which are built without the map.
+    // Requires format_version >= 3 and a user comparator that only considers
+    // byte-wise identical keys equal, such as BytewiseComparator(); other
+    // comparators silently get kDataBlockBinarySearch.
+    kDataBlockBinaryAndHash = 1,
+  };
+
+  DataBlockIndexType data_block_index_type = kDataBlockBinarySearch;
+
+  // Number of distinct user keys per bucket of the data block hash map.
+  // Lower values make collisions rarer at the cost of bigger blocks. Only
+  // used with kDataBlockBinaryAndHash.
+  double data_block_hash_table_util_ratio = 0.75;
+
+  // If true, store the first 8 bytes of the user key of each restart point
+  // of a data block next to its restart array. Seeks within the block then
+  // compare these prefixes, several at a time with SSE4.2 or AVX2 when the
+  // library is built for them, and only compare whole keys at the restart
+  // points that share the prefix of the target. Costs 8 bytes per restart
+  // point.
+  // Requires format_version >= 3 and BytewiseComparator(); tables for other
+  // comparators are silently built without the prefixes.
+  bool data_block_restart_key_prefixes = false;
+
   // Use the specified checksum type. Newly created table files will be
   // protected with this checksum type. Old table files will still be readable,
   // even though they have different checksum type.
@@ -147,6 +187,14 @@ struct BlockBasedTableOptions {
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
 
+  // Partition the full filter along the partitions of the index, so that
+  // only the filter partition covering a key needs to be in memory to check
+  // it. Like the index partitions, the filter partitions are read through the
+  // block cache; without a block cache they are not used at all.
+  // Requires index_type to be kTwoLevelIndexSearch and a filter_policy that
+  // builds full filters.
+  bool partition_filters = false;
+
   // If true, block will not be explicitly flushed to disk during building
   // a SstTable. Instead, buffer in WritableFileWriter will take
   // care of the flushing when it is full.
@@ -166,7 +214,7 @@ struct BlockBasedTableOptions {
   // algorithms.
   bool verify_compression = false;
 
-  // We currently have three versions:
+  // We currently have four versions:
   // 0 -- This version is currently written out by all RocksDB's versions by
   // default.  Can be read by really old RocksDB's. Doesn't support changing
   // checksum (default is CRC32).
@@ -178,9 +226,26 @@ struct BlockBasedTableOptions {
   // encode compressed blocks with LZ4, BZip2 and Zlib compression. If you
   // don't plan to run RocksDB before version 3.10, you should probably use
   // this.
+  // 3 -- Can only be read by RocksDB releases that contain the data block
+  // hash index; all earlier releases refuse to open these files. Allows data
+  // blocks to carry the hash index of data_block_index_type =
+  // kDataBlockBinaryAndHash and the key prefixes of
+  // data_block_restart_key_prefixes. Don't use it while you may still need
+  // to downgrade.
   // This option only affects newly written tables. When reading exising tables,
   // the information about version is read from the footer.
   uint32_t format_version = 2;
+
+  // An iterator that moves through adjacent data blocks of a table file
+  // starts prefetching the blocks ahead of it with
+  // RandomAccessFile::Prefetch(), so that the reads of a long scan overlap
+  // instead of waiting for the device one block at a time. The prefetched
+  // window starts at 8KB and doubles each time the iterator gets close to
+  // its end, up to max_auto_readahead_size. A seek elsewhere starts over.
+  // Iterators with ReadOptions::readahead_size set don't prefetch since their
+  // reads are already large.
+  // Set to 0 to disable.
+  size_t max_auto_readahead_size = 256 * 1024;
 };
 
 // Table Properties that are specific to block-based table properties.
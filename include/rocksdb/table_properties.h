@@ -45,10 +45,13 @@ struct TablePropertiesNames {
   static const std::string kMergeOperator;
   static const std::string kPropertyCollectors;
   static const std::string kCompression;
+  static const std::string kCompressionDictSize;
+  static const std::string kCreationTime;
 };
 
 extern const std::string kPropertiesBlock;
 extern const std::string kCompressionDictBlock;
+extern const std::string kRangeDelBlock;
 
 enum EntryType {
   kEntryPut,
@@ -134,6 +137,9 @@ struct TableProperties {
   uint64_t index_size = 0;
   // the size of filter block.
   uint64_t filter_size = 0;
+  // the size of the dictionary the data blocks were compressed with, or 0 if
+  // there is none.
+  uint64_t compression_dict_size = 0;
   // total raw key size
   uint64_t raw_key_size = 0;
   // total raw value size
@@ -150,6 +156,10 @@ struct TableProperties {
   // by column_family_name.
   uint64_t column_family_id =
       rocksdb::TablePropertiesCollectorFactory::Context::kUnknownColumnFamily;
+  // The time, in seconds since the epoch, when the oldest data of this table
+  // was written: the flush time for a flushed table, the earliest creation
+  // time of the inputs for a compaction output. 0 if unknown.
+  uint64_t creation_time = 0;
 
   // Name of the column family with which this SST file is associated.
   // If column family is unknown, `column_family_name` will be an empty string.
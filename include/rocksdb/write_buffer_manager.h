@@ -14,46 +14,96 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
+#include "rocksdb/cache.h"
 
 namespace rocksdb {
 
 class WriteBufferManager {
  public:
-  // _buffer_size = 0 indicates no limit. Memory won't be tracked,
-  // memory_usage() won't be valid and ShouldFlush() will always return true.
-  explicit WriteBufferManager(size_t _buffer_size)
-      : buffer_size_(_buffer_size), memory_used_(0) {}
+  // _buffer_size = 0 indicates no limit. Memory won't be tracked unless
+  // cache is set, memory_usage() won't be valid and ShouldFlush() will
+  // always return false.
+  //
+  // cache: if not nullptr, the memory allocated by the memtables is charged
+  // to the cache as dummy entries, so that a single cache capacity bounds
+  // the memory of both the block cache and the memtables.
+  //
+  // allow_stall: if true, ShouldStall() returns true once the memory of all
+  // the memtables, mutable and immutable, reaches _buffer_size, and the DBs
+  // using this manager stop writes until flushes bring it back under the
+  // limit.
+  explicit WriteBufferManager(size_t _buffer_size,
+                              std::shared_ptr<Cache> cache = {},
+                              bool allow_stall = false);
 
-  ~WriteBufferManager() {}
+  ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
-  // Only valid if enabled()
+  bool cost_to_cache() const { return cache_rep_ != nullptr; }
+
+  // Memory of all the memtables not yet freed, including immutable ones
+  // waiting to be flushed. Only valid if enabled() or cost_to_cache()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
   }
+  // Memory of the memtables still accepting writes. Only valid if enabled()
+  // or cost_to_cache()
+  size_t mutable_memtable_memory_usage() const {
+    return memory_active_.load(std::memory_order_relaxed);
+  }
   size_t buffer_size() const { return buffer_size_; }
 
   // Should only be called from write thread
   bool ShouldFlush() const {
-    return enabled() && memory_usage() >= buffer_size();
+    return enabled() && mutable_memtable_memory_usage() >= buffer_size();
+  }
+
+  // Should only be called from write thread
+  bool ShouldStall() const {
+    return allow_stall_ && enabled() && memory_usage() >= buffer_size();
   }
 
   // Should only be called from write thread
   void ReserveMem(size_t mem) {
-    if (enabled()) {
+    if (cache_rep_ != nullptr) {
+      ReserveMemWithCache(mem);
+    } else if (enabled()) {
       memory_used_.fetch_add(mem, std::memory_order_relaxed);
     }
+    if (enabled() || cache_rep_ != nullptr) {
+      memory_active_.fetch_add(mem, std::memory_order_relaxed);
+    }
+  }
+  // Called when a memtable becomes immutable. Its memory is still counted
+  // by memory_usage() until FreeMem() is called.
+  void ScheduleFreeMem(size_t mem) {
+    if (enabled() || cache_rep_ != nullptr) {
+      memory_active_.fetch_sub(mem, std::memory_order_relaxed);
+    }
   }
   void FreeMem(size_t mem) {
-    if (enabled()) {
+    if (cache_rep_ != nullptr) {
+      FreeMemWithCache(mem);
+    } else if (enabled()) {
       memory_used_.fetch_sub(mem, std::memory_order_relaxed);
     }
   }
 
  private:
+  static const size_t kSizeDummyEntry;
+
   const size_t buffer_size_;
+  const bool allow_stall_;
   std::atomic<size_t> memory_used_;
+  std::atomic<size_t> memory_active_;
+
+  struct CacheRep;
+  std::unique_ptr<CacheRep> cache_rep_;
+
+  void ReserveMemWithCache(size_t mem);
+  void FreeMemWithCache(size_t mem);
 
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
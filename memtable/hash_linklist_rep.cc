@@ -16,6 +16,7 @@
 #include "port/port.h"
 #include "util/histogram.h"
 #include "util/murmurhash.h"
+#include "util/mutexlock.h"
 #include "db/memtable.h"
 #include "db/skiplist.h"
 
@@ -26,6 +27,9 @@ typedef const char* Key;
 typedef SkipList<Key, const MemTableRep::KeyComparator&> MemtableSkipList;
 typedef std::atomic<void*> Pointer;
 
+// Upper bound on the number of locks striped over the buckets
+const size_t kMaxBucketLocks = 1024;
+
 // A data structure used as the header of a link list of a hash bucket.
 struct BucketHeader {
   Pointer next;
@@ -42,9 +46,10 @@ struct BucketHeader {
     return num_entries.load(std::memory_order_relaxed);
   }
 
-  // REQUIRES: called from single-threaded Insert()
+  // REQUIRES: called from single-threaded Insert(), or from
+  // InsertConcurrently() with the bucket's lock held
   void IncNumEntries() {
-    // Only one thread can do write at one time. No need to do atomic
+    // Only one thread can write to a bucket at one time. No need to do atomic
     // incremental. Update it with relaxed load and store.
     num_entries.store(GetNumEntries() + 1, std::memory_order_relaxed);
   }
@@ -159,6 +164,11 @@ struct Node {
 // when the utilization of buckets is relatively low. If we use case 3 for
 // single entry bucket, we will need to waste 12 bytes for every entry,
 // which can be significant decrease of memory utilization.
+//
+// InsertConcurrently() makes a bucket go from case 1 to case 2 with a CAS on
+// the bucket pointer. A bucket is never empty again after that, so all other
+// changes to it are made by the same code as Insert(), with a lock striped
+// over the buckets held to keep one writer per bucket.
 class HashLinkListRep : public MemTableRep {
  public:
   HashLinkListRep(const MemTableRep::KeyComparator& compare,
@@ -172,6 +182,8 @@ class HashLinkListRep : public MemTableRep {
 
   virtual void Insert(KeyHandle handle) override;
 
+  virtual void InsertConcurrently(KeyHandle handle) override;
+
   virtual bool Contains(const char* key) const override;
 
   virtual size_t ApproximateMemoryUsage() override;
@@ -196,6 +208,11 @@ class HashLinkListRep : public MemTableRep {
   // the same transform.
   Pointer* buckets_;
 
+  // Bucket i is locked by bucket_locks_[i % num_bucket_locks_] for
+  // concurrent inserts into a non-empty bucket.
+  size_t num_bucket_locks_;
+  SpinMutex* bucket_locks_;
+
   const uint32_t threshold_use_skiplist_;
 
   // The user-supplied transform whose domain is the user keys.
@@ -209,6 +226,9 @@ class HashLinkListRep : public MemTableRep {
 
   bool LinkListContains(Node* head, const Slice& key) const;
 
+  // Inserts x into bucket hash, which only one thread may write at a time.
+  void InsertIntoBucket(Node* x, const Slice& internal_key, size_t hash);
+
   SkipListBucketHeader* GetSkipListBucketHeader(Pointer* first_next_pointer)
       const;
 
@@ -491,6 +511,10 @@ HashLinkListRep::HashLinkListRep(const MemTableRep::KeyComparator& compare,
   for (size_t i = 0; i < bucket_size_; ++i) {
     buckets_[i].store(nullptr, std::memory_order_relaxed);
   }
+
+  num_bucket_locks_ = std::min(bucket_size_, kMaxBucketLocks);
+  mem = allocator_->AllocateAligned(sizeof(SpinMutex) * num_bucket_locks_);
+  bucket_locks_ = new (mem) SpinMutex[num_bucket_locks_];
 }
 
 HashLinkListRep::~HashLinkListRep() {
@@ -550,9 +574,36 @@ void HashLinkListRep::Insert(KeyHandle handle) {
   assert(!Contains(x->key));
   Slice internal_key = GetLengthPrefixedSlice(x->key);
   auto transformed = GetPrefix(internal_key);
-  auto& bucket = buckets_[GetHash(transformed)];
+  InsertIntoBucket(x, internal_key, GetHash(transformed));
+}
+
+void HashLinkListRep::InsertConcurrently(KeyHandle handle) {
+  Node* x = static_cast<Node*>(handle);
+  Slice internal_key = GetLengthPrefixedSlice(x->key);
+  auto transformed = GetPrefix(internal_key);
+  size_t hash = GetHash(transformed);
+  auto& bucket = buckets_[hash];
+
+  // Case 1. empty bucket. The node becomes the bucket without any lock.
+  x->NoBarrier_SetNext(nullptr);
+  void* expected = nullptr;
+  if (bucket.load(std::memory_order_relaxed) == nullptr &&
+      bucket.compare_exchange_strong(expected, x, std::memory_order_release,
+                                     std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::lock_guard<SpinMutex> guard(bucket_locks_[hash % num_bucket_locks_]);
+  InsertIntoBucket(x, internal_key, hash);
+}
+
+void HashLinkListRep::InsertIntoBucket(Node* x, const Slice& internal_key,
+                                       size_t hash) {
+  auto& bucket = buckets_[hash];
+  // Acquire so that a node installed by a lock-free case 1 insert of
+  // InsertConcurrently() is fully visible.
   Pointer* first_next_pointer =
-      static_cast<Pointer*>(bucket.load(std::memory_order_relaxed));
+      static_cast<Pointer*>(bucket.load(std::memory_order_acquire));
 
   if (first_next_pointer == nullptr) {
     // Case 1. empty bucket
@@ -583,8 +634,8 @@ void HashLinkListRep::Insert(KeyHandle handle) {
       assert(header->GetNumEntries() > threshold_use_skiplist_);
       auto* skip_list_bucket_header =
           reinterpret_cast<SkipListBucketHeader*>(header);
-      // Only one thread can execute Insert() at one time. No need to do atomic
-      // incremental.
+      // Only one thread can write to the bucket at one time. No need to do
+      // atomic incremental.
       skip_list_bucket_header->Counting_header.IncNumEntries();
       skip_list_bucket_header->skip_list.Insert(x->key);
       return;
@@ -597,7 +648,7 @@ void HashLinkListRep::Insert(KeyHandle handle) {
     Info(logger_, "HashLinkedList bucket %" ROCKSDB_PRIszt
                   " has more than %d "
                   "entries. Key to insert: %s",
-         GetHash(transformed), header->GetNumEntries(),
+         hash, header->GetNumEntries(),
          GetLengthPrefixedSlice(x->key).ToString(true).c_str());
   }
 
@@ -30,6 +30,8 @@ class HashSkipListRep : public MemTableRep {
 
   virtual void Insert(KeyHandle handle) override;
 
+  virtual void InsertConcurrently(KeyHandle handle) override;
+
   virtual bool Contains(const char* key) const override;
 
   virtual size_t ApproximateMemoryUsage() override;
@@ -76,7 +78,7 @@ class HashSkipListRep : public MemTableRep {
     return GetBucket(GetHash(slice));
   }
   // Get a bucket from buckets_. If the bucket hasn't been initialized yet,
-  // initialize it before returning.
+  // initialize it before returning. Safe to call concurrently.
   Bucket* GetInitializedBucket(const Slice& transformed);
 
   class Iterator : public MemTableRep::Iterator {
@@ -251,9 +253,14 @@ HashSkipListRep::Bucket* HashSkipListRep::GetInitializedBucket(
   auto bucket = GetBucket(hash);
   if (bucket == nullptr) {
     auto addr = allocator_->AllocateAligned(sizeof(Bucket));
-    bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
-                               skiplist_branching_factor_);
-    buckets_[hash].store(bucket, std::memory_order_release);
+    auto new_bucket = new (addr) Bucket(compare_, allocator_, skiplist_height_,
+                                        skiplist_branching_factor_);
+    // A concurrent insert may have installed a bucket first, in which case
+    // we use that one and the memory of ours is wasted in the allocator.
+    if (buckets_[hash].compare_exchange_strong(bucket, new_bucket,
+                                               std::memory_order_acq_rel)) {
+      bucket = new_bucket;
+    }
   }
   return bucket;
 }
@@ -266,6 +273,13 @@ void HashSkipListRep::Insert(KeyHandle handle) {
   bucket->Insert(key);
 }
 
+void HashSkipListRep::InsertConcurrently(KeyHandle handle) {
+  auto* key = static_cast<char*>(handle);
+  auto transformed = transform_->Transform(UserKey(key));
+  auto bucket = GetInitializedBucket(transformed);
+  bucket->InsertConcurrently(key);
+}
+
 bool HashSkipListRep::Contains(const char* key) const {
   auto transformed = transform_->Transform(UserKey(key));
   auto bucket = GetBucket(transformed);
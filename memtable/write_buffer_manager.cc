@@ -0,0 +1,132 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "rocksdb/write_buffer_manager.h"
+
+#include <mutex>
+#include <vector>
+#include "util/coding.h"
+
+namespace rocksdb {
+namespace {
+const size_t kCacheKeyPrefixSize = 8;
+
+void DeleteDummyEntry(const Slice& key, void* value) {}
+}  // namespace
+
+const size_t WriteBufferManager::kSizeDummyEntry = 256 * 1024;
+
+struct WriteBufferManager::CacheRep {
+  std::shared_ptr<Cache> cache_;
+  std::mutex cache_mutex_;
+  std::atomic<size_t> cache_allocated_size_;
+  // The dummy entries are keyed by a prefix unique to this manager followed
+  // by their index in dummy_handles_. An entry the cache refused is kept as
+  // nullptr so that the indexes stay in step with cache_allocated_size_.
+  char cache_key_[kCacheKeyPrefixSize + kMaxVarint64Length];
+  std::vector<Cache::Handle*> dummy_handles_;
+
+  explicit CacheRep(std::shared_ptr<Cache> cache)
+      : cache_(cache), cache_allocated_size_(0) {
+    EncodeFixed64(cache_key_, cache_->NewId());
+  }
+
+  Slice GetKey(size_t index) {
+    char* end = EncodeVarint64(cache_key_ + kCacheKeyPrefixSize, index);
+    return Slice(cache_key_, static_cast<size_t>(end - cache_key_));
+  }
+
+  // REQUIRES: cache_mutex_ is held
+  void AddDummyEntry() {
+    Cache::Handle* handle = nullptr;
+    Status s = cache_->Insert(GetKey(dummy_handles_.size()), nullptr,
+                              kSizeDummyEntry, &DeleteDummyEntry, &handle);
+    dummy_handles_.push_back(s.ok() ? handle : nullptr);
+    cache_allocated_size_.fetch_add(kSizeDummyEntry,
+                                    std::memory_order_relaxed);
+  }
+
+  // REQUIRES: cache_mutex_ is held
+  void RemoveDummyEntry() {
+    assert(!dummy_handles_.empty());
+    Cache::Handle* handle = dummy_handles_.back();
+    if (handle != nullptr) {
+      cache_->Erase(GetKey(dummy_handles_.size() - 1));
+      cache_->Release(handle);
+    }
+    dummy_handles_.pop_back();
+    cache_allocated_size_.fetch_sub(kSizeDummyEntry,
+                                    std::memory_order_relaxed);
+  }
+};
+
+WriteBufferManager::WriteBufferManager(size_t _buffer_size,
+                                       std::shared_ptr<Cache> cache,
+                                       bool allow_stall)
+    : buffer_size_(_buffer_size),
+      allow_stall_(allow_stall),
+      memory_used_(0),
+      memory_active_(0),
+      cache_rep_(nullptr) {
+  if (cache) {
+    cache_rep_.reset(new CacheRep(cache));
+  }
+}
+
+WriteBufferManager::~WriteBufferManager() {
+  if (cache_rep_) {
+    std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
+    while (!cache_rep_->dummy_handles_.empty()) {
+      cache_rep_->RemoveDummyEntry();
+    }
+  }
+}
+
+void WriteBufferManager::ReserveMemWithCache(size_t mem) {
+  assert(cache_rep_ != nullptr);
+  size_t new_mem_used =
+      memory_used_.fetch_add(mem, std::memory_order_relaxed) + mem;
+  if (new_mem_used <= cache_rep_->cache_allocated_size_.load(
+                          std::memory_order_relaxed)) {
+    // Already charged to the cache; this is the common case since memtables
+    // allocate in much smaller pieces than a dummy entry.
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
+  while (memory_used_.load(std::memory_order_relaxed) >
+         cache_rep_->cache_allocated_size_.load(std::memory_order_relaxed)) {
+    cache_rep_->AddDummyEntry();
+  }
+}
+
+void WriteBufferManager::FreeMemWithCache(size_t mem) {
+  assert(cache_rep_ != nullptr);
+  size_t new_mem_used =
+      memory_used_.fetch_sub(mem, std::memory_order_relaxed) - mem;
+  // Shrink the memory charged to the cache only once the usage falls below
+  // 3/4 of it, so that memtables coming and going around the same size
+  // don't insert and erase dummy entries over and over.
+  if (new_mem_used >= cache_rep_->cache_allocated_size_.load(
+                          std::memory_order_relaxed) /
+                          4 * 3) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(cache_rep_->cache_mutex_);
+  while (true) {
+    size_t allocated =
+        cache_rep_->cache_allocated_size_.load(std::memory_order_relaxed);
+    new_mem_used = memory_used_.load(std::memory_order_relaxed);
+    if (new_mem_used >= allocated / 4 * 3 ||
+        allocated - kSizeDummyEntry <= new_mem_used) {
+      break;
+    }
+    cache_rep_->RemoveDummyEntry();
+  }
+}
+}  // namespace rocksdb
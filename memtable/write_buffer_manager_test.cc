@@ -0,0 +1,142 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "rocksdb/write_buffer_manager.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class WriteBufferManagerTest : public testing::Test {};
+
+const size_t kSizeDummyEntry = 256 * 1024;
+
+TEST_F(WriteBufferManagerTest, ShouldFlush) {
+  // A write buffer manager of size 10MB
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(10 * 1024 * 1024));
+
+  wbf->ReserveMem(8 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  wbf->ReserveMem(3 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldFlush());
+  // Stalls are not allowed by default
+  ASSERT_FALSE(wbf->ShouldStall());
+  // The memory of an immutable memtable no longer triggers flushes
+  wbf->ScheduleFreeMem(2 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldFlush());
+  ASSERT_EQ(11 * 1024 * 1024, wbf->memory_usage());
+  wbf->FreeMem(2 * 1024 * 1024);
+  ASSERT_EQ(9 * 1024 * 1024, wbf->memory_usage());
+}
+
+TEST_F(WriteBufferManagerTest, ShouldStall) {
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(10 * 1024 * 1024, nullptr, true));
+
+  wbf->ReserveMem(8 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldStall());
+  wbf->ReserveMem(2 * 1024 * 1024);
+  ASSERT_TRUE(wbf->ShouldStall());
+  // Switching the memtable doesn't end the stall; freeing its memory does
+  wbf->ScheduleFreeMem(1024);
+  ASSERT_TRUE(wbf->ShouldStall());
+  wbf->FreeMem(1024);
+  ASSERT_FALSE(wbf->ShouldStall());
+
+  // An unlimited manager never stalls
+  wbf.reset(new WriteBufferManager(0, nullptr, true));
+  wbf->ReserveMem(10 * 1024 * 1024);
+  ASSERT_FALSE(wbf->ShouldStall());
+}
+
+TEST_F(WriteBufferManagerTest, CacheCost) {
+  const size_t kMB = 1024 * 1024;
+  // 1GB cache
+  std::shared_ptr<Cache> cache = NewLRUCache(1024 * kMB, 4);
+  // A write buffer manager of size 50MB
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(50 * kMB, cache));
+  ASSERT_TRUE(wbf->cost_to_cache());
+
+  // The charge is the usage rounded up to a multiple of the dummy entry size
+  wbf->ReserveMem(1 * kMB + 1);
+  ASSERT_GE(cache->GetPinnedUsage(), 1 * kMB + kSizeDummyEntry);
+  ASSERT_LT(cache->GetPinnedUsage(), 1 * kMB + kSizeDummyEntry + 10000);
+
+  wbf->ReserveMem(2 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 3 * kMB + kSizeDummyEntry);
+  ASSERT_LT(cache->GetPinnedUsage(), 3 * kMB + kSizeDummyEntry + 10000);
+
+  wbf->ReserveMem(20 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 23 * kMB + kSizeDummyEntry);
+  ASSERT_LT(cache->GetPinnedUsage(), 23 * kMB + kSizeDummyEntry + 10000);
+
+  // Freeing 2MB leaves the usage above 3/4 of the charge, which stays
+  wbf->ScheduleFreeMem(2 * kMB);
+  wbf->FreeMem(2 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 23 * kMB + kSizeDummyEntry);
+  ASSERT_LT(cache->GetPinnedUsage(), 23 * kMB + kSizeDummyEntry + 10000);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  wbf->ReserveMem(30 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 51 * kMB + kSizeDummyEntry);
+  ASSERT_LT(cache->GetPinnedUsage(), 51 * kMB + kSizeDummyEntry + 10000);
+  ASSERT_TRUE(wbf->ShouldFlush());
+
+  // 31MB is used after freeing 20MB, less than 3/4 of the charge. The charge
+  // shrinks until the usage is 3/4 of it again.
+  wbf->ScheduleFreeMem(20 * kMB);
+  wbf->FreeMem(20 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 41 * kMB);
+  ASSERT_LT(cache->GetPinnedUsage(), 41 * kMB + kSizeDummyEntry + 10000);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // Destroying the write buffer manager releases all the charge
+  wbf.reset();
+  ASSERT_LT(cache->GetPinnedUsage(), 10000);
+  ASSERT_LT(cache->GetUsage(), 10000);
+}
+
+TEST_F(WriteBufferManagerTest, NoCapCacheCost) {
+  const size_t kMB = 1024 * 1024;
+  // 1GB cache
+  std::shared_ptr<Cache> cache = NewLRUCache(1024 * kMB, 4);
+  // A write buffer manager of size 0 still charges the cache
+  std::unique_ptr<WriteBufferManager> wbf(new WriteBufferManager(0, cache));
+  wbf->ReserveMem(10 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 10 * kMB);
+  ASSERT_LT(cache->GetPinnedUsage(), 10 * kMB + 10000);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  wbf->FreeMem(9 * kMB);
+  ASSERT_GE(cache->GetPinnedUsage(), 1 * kMB);
+  ASSERT_LT(cache->GetPinnedUsage(), 1 * kMB + 2 * kSizeDummyEntry);
+}
+
+TEST_F(WriteBufferManagerTest, CacheFull) {
+  // A cache too small to hold the charge with a strict capacity limit. The
+  // refused dummy entries must not break the accounting.
+  std::shared_ptr<Cache> cache =
+      NewLRUCache(kSizeDummyEntry * 2, 0, true /* strict_capacity_limit */);
+  std::unique_ptr<WriteBufferManager> wbf(
+      new WriteBufferManager(0, cache));
+  wbf->ReserveMem(4 * kSizeDummyEntry);
+  ASSERT_LE(cache->GetPinnedUsage(), 2 * kSizeDummyEntry);
+  wbf->FreeMem(4 * kSizeDummyEntry);
+  // One dummy entry is kept to avoid churn on the next reservation
+  ASSERT_LE(cache->GetPinnedUsage(), kSizeDummyEntry);
+  wbf->ReserveMem(kSizeDummyEntry);
+  ASSERT_GE(cache->GetPinnedUsage(), kSizeDummyEntry);
+}
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
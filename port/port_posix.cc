@@ -14,6 +14,9 @@
 #include <cpuid.h>
 #endif
 #include <errno.h>
+#ifdef OS_LINUX
+#include <sched.h>
+#endif
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
@@ -136,9 +139,12 @@ void RWMutex::ReadUnlock() { PthreadCall("read unlock", pthread_rwlock_unlock(&m
 void RWMutex::WriteUnlock() { PthreadCall("write unlock", pthread_rwlock_unlock(&mu_)); }
 
 int PhysicalCoreID() {
-#if defined(__i386__) || defined(__x86_64__)
-  // if you ever find that this function is hot on Linux, you can go from
-  // ~200 nanos to ~20 nanos by adding the machinery to use __vdso_getcpu
+#if defined(OS_LINUX)
+  // sched_getcpu() goes through the vDSO, which takes ~20 nanos instead of
+  // the ~200 nanos of cpuid. Per-core data structures call this on every
+  // update.
+  return sched_getcpu();
+#elif defined(__i386__) || defined(__x86_64__)
   unsigned eax, ebx = 0, ecx, edx;
   __get_cpuid(1, &eax, &ebx, &ecx, &edx);
   return ebx >> 24;
@@ -152,6 +158,16 @@ void InitOnce(OnceType* once, void (*initializer)()) {
   PthreadCall("once", pthread_once(once, initializer));
 }
 
+void* cacheline_aligned_alloc(size_t size) {
+  void* m;
+  if (posix_memalign(&m, CACHE_LINE_SIZE, size) != 0) {
+    return nullptr;
+  }
+  return m;
+}
+
+void cacheline_aligned_free(void* memblock) { free(memblock); }
+
 void Crash(const std::string& srcfile, int srcline) {
   fprintf(stdout, "Crashing at %s:%d\n", srcfile.c_str(), srcline);
   fflush(stdout);
@@ -227,6 +227,14 @@ extern void InitOnce(OnceType* once, void (*initializer)());
 
 #define CACHE_LINE_SIZE 64U
 
+inline void* cacheline_aligned_alloc(size_t size) {
+  return _aligned_malloc(size, CACHE_LINE_SIZE);
+}
+
+inline void cacheline_aligned_free(void* memblock) { _aligned_free(memblock); }
+
+#define ALIGN_AS(n) __declspec(align(n))
+
 static inline void AsmVolatilePause() {
 #if defined(_M_IX86) || defined(_M_X64)
   YieldProcessor();
@@ -35,6 +35,7 @@ LIB_SOURCES =                                                   \
   db/memtable_list.cc                                           \
   db/merge_helper.cc                                            \
   db/merge_operator.cc                                          \
+  db/range_del_aggregator.cc                                    \
   db/repair.cc                                                  \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
@@ -54,6 +55,7 @@ LIB_SOURCES =                                                   \
   memtable/hash_skiplist_rep.cc                                 \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
+  memtable/write_buffer_manager.cc                              \
   port/stack_trace.cc                                           \
   port/port_posix.cc                                            \
   table/adaptive_table_factory.cc                               \
@@ -68,19 +70,23 @@ LIB_SOURCES =                                                   \
   table/cuckoo_table_builder.cc                                 \
   table/cuckoo_table_factory.cc                                 \
   table/cuckoo_table_reader.cc                                  \
+  table/data_block_hash_index.cc                                \
   table/flush_block_policy.cc                                   \
   table/format.cc                                               \
   table/full_filter_block.cc                                    \
   table/get_context.cc                                          \
+  table/index_builder.cc                                        \
   table/iterator.cc                                             \
   table/merger.cc                                               \
   table/meta_blocks.cc                                          \
+  table/partitioned_filter_block.cc                             \
   table/sst_file_writer.cc                                      \
   table/plain_table_builder.cc                                  \
   table/plain_table_factory.cc                                  \
   table/plain_table_index.cc                                    \
   table/plain_table_key_coding.cc                               \
   table/plain_table_reader.cc                                   \
+  table/restart_key_prefixes.cc                                 \
   table/persistent_cache_helper.cc                              \
   table/table_properties.cc                                     \
   table/two_level_iterator.cc                                   \
@@ -88,6 +94,7 @@ LIB_SOURCES =                                                   \
   util/arena.cc                                                 \
   util/bloom.cc                                                 \
   util/build_version.cc                                         \
+  util/clock_cache.cc                                           \
   util/coding.cc                                                \
   util/comparator.cc                                            \
   util/compaction_job_stats_impl.cc                             \
@@ -226,6 +233,7 @@ MAIN_SOURCES =                                                    \
   db/db_tailing_iter_test.cc                                            \
   db/db_universal_compaction_test.cc                                    \
   db/db_wal_test.cc                                                     \
+  db/db_range_del_test.cc                                               \
   db/db_table_properties_test.cc                                        \
   db/deletefile_test.cc                                                 \
   db/fault_injection_test.cc                                            \
@@ -251,6 +259,7 @@ MAIN_SOURCES =                                                    \
   db/write_batch_test.cc                                                \
   db/write_controller_test.cc                                           \
   db/write_callback_test.cc                                             \
+  memtable/write_buffer_manager_test.cc                                 \
   table/block_based_filter_block_test.cc                                \
   table/block_test.cc                                                   \
   table/cuckoo_table_builder_test.cc                                    \
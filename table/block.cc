@@ -160,6 +160,44 @@ void BlockIter::Seek(const Slice& target) {
   }
 }
 
+bool BlockIter::SeekForGet(const Slice& target) {
+  if (data_block_hash_index_ == nullptr) {
+    Seek(target);
+    return true;
+  }
+  uint8_t entry = data_block_hash_index_->Lookup(ExtractUserKey(target));
+  if (entry == kCollision) {
+    Seek(target);
+    return true;
+  }
+
+  PERF_TIMER_GUARD(block_seek_nanos);
+  if (entry == kNoEntry) {
+    // The user key is not in this block, but its successors may only start
+    // in the next block. Scanning the last restart interval tells.
+    entry = static_cast<uint8_t>(num_restarts_ - 1);
+  } else if (entry >= num_restarts_) {
+    CorruptionError();
+    return true;
+  }
+  // All the keys of the block with the user key of target are in this
+  // restart interval, so the first key >= target is either there or is the
+  // first key of a greater user key.
+  SeekToRestartPoint(entry);
+  while (true) {
+    if (!ParseNextKey()) {
+      // The end of the block: the next block may still have the key.
+      return true;
+    }
+    if (Compare(key_.GetKey(), target) >= 0) {
+      break;
+    }
+  }
+  // A different user key here means that target is between two keys of this
+  // block, or that the lookup hit the bucket of another user key.
+  return ExtractUserKey(key_.GetKey()) == ExtractUserKey(target);
+}
+
 void BlockIter::SeekToFirst() {
   if (data_ == nullptr) {  // Not init yet
     return;
@@ -229,6 +267,18 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
                   uint32_t* index) {
   assert(left <= right);
 
+  if (restart_key_prefixes_ != nullptr) {
+    // The restart points with a smaller key prefix than target are before
+    // it and those with a greater one after it, so only the ones that share
+    // its prefix are left to compare.
+    uint32_t lower, upper;
+    FindRestartKeyPrefixRange(restart_key_prefixes_, left, right,
+                              RestartKeyPrefix(ExtractUserKey(target)),
+                              &lower, &upper);
+    right = upper > left ? upper - 1 : left;
+    left = lower > left ? lower - 1 : left;
+  }
+
   while (left < right) {
     uint32_t mid = (left + right + 1) / 2;
     uint32_t region_offset = GetRestartPoint(mid);
@@ -341,19 +391,39 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
 
 uint32_t Block::NumRestarts() const {
   assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+         ~(kDataBlockHashIndexFlag | kRestartKeyPrefixesFlag);
 }
 
 Block::Block(BlockContents&& contents)
     : contents_(std::move(contents)),
       data_(contents_.data.data()),
-      size_(contents_.data.size()) {
+      size_(contents_.data.size()),
+      restart_key_prefixes_(nullptr) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
   } else {
-    restart_offset_ =
-        static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
-    if (restart_offset_ > size_ - sizeof(uint32_t)) {
+    // Offset in data_ of the end of the restart array
+    uint32_t restarts_end = static_cast<uint32_t>(size_) - sizeof(uint32_t);
+    const uint32_t flags = DecodeFixed32(data_ + restarts_end);
+    if ((flags & kDataBlockHashIndexFlag) &&
+        !data_block_hash_index_.Initialize(data_, restarts_end,
+                                           &restarts_end)) {
+      size_ = 0;
+      return;
+    }
+    if (flags & kRestartKeyPrefixesFlag) {
+      const uint64_t prefixes_size =
+          static_cast<uint64_t>(NumRestarts()) * sizeof(uint64_t);
+      if (prefixes_size > restarts_end) {
+        size_ = 0;
+        return;
+      }
+      restarts_end -= static_cast<uint32_t>(prefixes_size);
+      restart_key_prefixes_ = data_ + restarts_end;
+    }
+    restart_offset_ = restarts_end - NumRestarts() * sizeof(uint32_t);
+    if (restart_offset_ > restarts_end) {
       // The size is too small for NumRestarts() and therefore
       // restart_offset_ wrapped around.
       size_ = 0;
@@ -382,13 +452,17 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
   } else {
     BlockPrefixIndex* prefix_index_ptr =
         total_order_seek ? nullptr : prefix_index_.get();
+    const DataBlockHashIndex* data_block_hash_index_ptr =
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr;
 
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                       prefix_index_ptr);
+                       prefix_index_ptr, data_block_hash_index_ptr,
+                       restart_key_prefixes_);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
-                           prefix_index_ptr);
+                           prefix_index_ptr, data_block_hash_index_ptr,
+                           restart_key_prefixes_);
     }
   }
 
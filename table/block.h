@@ -21,7 +21,9 @@
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "table/block_prefix_index.h"
+#include "table/data_block_hash_index.h"
 #include "table/internal_iterator.h"
+#include "table/restart_key_prefixes.h"
 
 #include "format.h"
 
@@ -82,6 +84,10 @@ class Block {
   size_t size_;                 // contents_.data.size()
   uint32_t restart_offset_;     // Offset in data_ of restart array
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
+  // Hash index stored in the block, if it is a data block that has one.
+  DataBlockHashIndex data_block_hash_index_;
+  // Restart key prefixes stored in the block, or nullptr.
+  const char* restart_key_prefixes_;
 
   // No copying allowed
   Block(const Block&);
@@ -99,17 +105,24 @@ class BlockIter : public InternalIterator {
         restart_index_(0),
         status_(Status::OK()),
         prefix_index_(nullptr),
+        data_block_hash_index_(nullptr),
+        restart_key_prefixes_(nullptr),
         key_pinned_(false) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
-            uint32_t num_restarts, BlockPrefixIndex* prefix_index)
+            uint32_t num_restarts, BlockPrefixIndex* prefix_index,
+            const DataBlockHashIndex* data_block_hash_index = nullptr,
+            const char* restart_key_prefixes = nullptr)
       : BlockIter() {
-    Initialize(comparator, data, restarts, num_restarts, prefix_index);
+    Initialize(comparator, data, restarts, num_restarts, prefix_index,
+               data_block_hash_index, restart_key_prefixes);
   }
 
   void Initialize(const Comparator* comparator, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
-                  BlockPrefixIndex* prefix_index) {
+                  BlockPrefixIndex* prefix_index,
+                  const DataBlockHashIndex* data_block_hash_index = nullptr,
+                  const char* restart_key_prefixes = nullptr) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
 
@@ -120,6 +133,8 @@ class BlockIter : public InternalIterator {
     current_ = restarts_;
     restart_index_ = num_restarts_;
     prefix_index_ = prefix_index;
+    data_block_hash_index_ = data_block_hash_index;
+    restart_key_prefixes_ = restart_key_prefixes;
   }
 
   void SetStatus(Status s) {
@@ -143,6 +158,13 @@ class BlockIter : public InternalIterator {
 
   virtual void Seek(const Slice& target) override;
 
+  // Position at the same entry as Seek(target) for a point lookup of the
+  // internal key target, going through the hash index of the block if it has
+  // one. Returns false if the index shows that neither this block nor any
+  // later block of the table contains the user key of target; the position
+  // of the iterator is then unspecified.
+  bool SeekForGet(const Slice& target);
+
   virtual void SeekToFirst() override;
 
   virtual void SeekToLast() override;
@@ -177,6 +199,9 @@ class BlockIter : public InternalIterator {
   Slice value_;
   Status status_;
   BlockPrefixIndex* prefix_index_;
+  const DataBlockHashIndex* data_block_hash_index_;
+  // RestartKeyPrefix() of the user key at each restart point, or nullptr
+  const char* restart_key_prefixes_;
   bool key_pinned_;
 
   struct CachedPrevEntry {
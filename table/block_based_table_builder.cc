@@ -13,9 +13,11 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -37,249 +39,39 @@
 #include "table/block_based_table_factory.h"
 #include "table/full_filter_block.h"
 #include "table/format.h"
+#include "table/index_builder.h"
 #include "table/meta_blocks.h"
+#include "table/partitioned_filter_block.h"
 #include "table/table_builder.h"
 
 #include "util/string_util.h"
 #include "util/coding.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/xxhash.h"
 
 namespace rocksdb {
 
-extern const std::string kHashIndexPrefixesBlock;
-extern const std::string kHashIndexPrefixesMetadataBlock;
-
-typedef BlockBasedTableOptions::IndexType IndexType;
-
-// The interface for building index.
-// Instruction for adding a new concrete IndexBuilder:
-//  1. Create a subclass instantiated from IndexBuilder.
-//  2. Add a new entry associated with that subclass in TableOptions::IndexType.
-//  3. Add a create function for the new subclass in CreateIndexBuilder.
-// Note: we can devise more advanced design to simplify the process for adding
-// new subclass, which will, on the other hand, increase the code complexity and
-// catch unwanted attention from readers. Given that we won't add/change
-// indexes frequently, it makes sense to just embrace a more straightforward
-// design that just works.
-class IndexBuilder {
- public:
-  // Index builder will construct a set of blocks which contain:
-  //  1. One primary index block.
-  //  2. (Optional) a set of metablocks that contains the metadata of the
-  //     primary index.
-  struct IndexBlocks {
-    Slice index_block_contents;
-    std::unordered_map<std::string, Slice> meta_blocks;
-  };
-  explicit IndexBuilder(const Comparator* comparator)
-      : comparator_(comparator) {}
-
-  virtual ~IndexBuilder() {}
-
-  // Add a new index entry to index block.
-  // To allow further optimization, we provide `last_key_in_current_block` and
-  // `first_key_in_next_block`, based on which the specific implementation can
-  // determine the best index key to be used for the index block.
-  // @last_key_in_current_block: this parameter maybe overridden with the value
-  //                             "substitute key".
-  // @first_key_in_next_block: it will be nullptr if the entry being added is
-  //                           the last one in the table
-  //
-  // REQUIRES: Finish() has not yet been called.
-  virtual void AddIndexEntry(std::string* last_key_in_current_block,
-                             const Slice* first_key_in_next_block,
-                             const BlockHandle& block_handle) = 0;
-
-  // This method will be called whenever a key is added. The subclasses may
-  // override OnKeyAdded() if they need to collect additional information.
-  virtual void OnKeyAdded(const Slice& key) {}
-
-  // Inform the index builder that all entries has been written. Block builder
-  // may therefore perform any operation required for block finalization.
-  //
-  // REQUIRES: Finish() has not yet been called.
-  virtual Status Finish(IndexBlocks* index_blocks) = 0;
-
-  // Get the estimated size for index block.
-  virtual size_t EstimatedSize() const = 0;
-
- protected:
-  const Comparator* comparator_;
-};
-
-// This index builder builds space-efficient index block.
-//
-// Optimizations:
-//  1. Made block's `block_restart_interval` to be 1, which will avoid linear
-//     search when doing index lookup (can be disabled by setting
-//     index_block_restart_interval).
-//  2. Shorten the key length for index block. Other than honestly using the
-//     last key in the data block as the index key, we instead find a shortest
-//     substitute key that serves the same function.
-class ShortenedIndexBuilder : public IndexBuilder {
- public:
-  explicit ShortenedIndexBuilder(const Comparator* comparator,
-                                 int index_block_restart_interval)
-      : IndexBuilder(comparator),
-        index_block_builder_(index_block_restart_interval) {}
-
-  virtual void AddIndexEntry(std::string* last_key_in_current_block,
-                             const Slice* first_key_in_next_block,
-                             const BlockHandle& block_handle) override {
-    if (first_key_in_next_block != nullptr) {
-      comparator_->FindShortestSeparator(last_key_in_current_block,
-                                         *first_key_in_next_block);
-    } else {
-      comparator_->FindShortSuccessor(last_key_in_current_block);
-    }
-
-    std::string handle_encoding;
-    block_handle.EncodeTo(&handle_encoding);
-    index_block_builder_.Add(*last_key_in_current_block, handle_encoding);
-  }
-
-  virtual Status Finish(IndexBlocks* index_blocks) override {
-    index_blocks->index_block_contents = index_block_builder_.Finish();
-    return Status::OK();
-  }
-
-  virtual size_t EstimatedSize() const override {
-    return index_block_builder_.CurrentSizeEstimate();
-  }
-
- private:
-  BlockBuilder index_block_builder_;
-};
-
-// HashIndexBuilder contains a binary-searchable primary index and the
-// metadata for secondary hash index construction.
-// The metadata for hash index consists two parts:
-//  - a metablock that compactly contains a sequence of prefixes. All prefixes
-//    are stored consectively without any metadata (like, prefix sizes) being
-//    stored, which is kept in the other metablock.
-//  - a metablock contains the metadata of the prefixes, including prefix size,
-//    restart index and number of block it spans. The format looks like:
-//
-// +-----------------+---------------------------+---------------------+ <=prefix 1
-// | length: 4 bytes | restart interval: 4 bytes | num-blocks: 4 bytes |
-// +-----------------+---------------------------+---------------------+ <=prefix 2
-// | length: 4 bytes | restart interval: 4 bytes | num-blocks: 4 bytes |
-// +-----------------+---------------------------+---------------------+
-// |                                                                   |
-// | ....                                                              |
-// |                                                                   |
-// +-----------------+---------------------------+---------------------+ <=prefix n
-// | length: 4 bytes | restart interval: 4 bytes | num-blocks: 4 bytes |
-// +-----------------+---------------------------+---------------------+
-//
-// The reason of separating these two metablocks is to enable the efficiently
-// reuse the first metablock during hash index construction without unnecessary
-// data copy or small heap allocations for prefixes.
-class HashIndexBuilder : public IndexBuilder {
- public:
-  explicit HashIndexBuilder(const Comparator* comparator,
-                            const SliceTransform* hash_key_extractor,
-                            int index_block_restart_interval)
-      : IndexBuilder(comparator),
-        primary_index_builder_(comparator, index_block_restart_interval),
-        hash_key_extractor_(hash_key_extractor) {}
-
-  virtual void AddIndexEntry(std::string* last_key_in_current_block,
-                             const Slice* first_key_in_next_block,
-                             const BlockHandle& block_handle) override {
-    ++current_restart_index_;
-    primary_index_builder_.AddIndexEntry(last_key_in_current_block,
-                                        first_key_in_next_block, block_handle);
-  }
-
-  virtual void OnKeyAdded(const Slice& key) override {
-    auto key_prefix = hash_key_extractor_->Transform(key);
-    bool is_first_entry = pending_block_num_ == 0;
-
-    // Keys may share the prefix
-    if (is_first_entry || pending_entry_prefix_ != key_prefix) {
-      if (!is_first_entry) {
-        FlushPendingPrefix();
-      }
-
-      // need a hard copy otherwise the underlying data changes all the time.
-      // TODO(kailiu) ToString() is expensive. We may speed up can avoid data
-      // copy.
-      pending_entry_prefix_ = key_prefix.ToString();
-      pending_block_num_ = 1;
-      pending_entry_index_ = static_cast<uint32_t>(current_restart_index_);
-    } else {
-      // entry number increments when keys share the prefix reside in
-      // different data blocks.
-      auto last_restart_index = pending_entry_index_ + pending_block_num_ - 1;
-      assert(last_restart_index <= current_restart_index_);
-      if (last_restart_index != current_restart_index_) {
-        ++pending_block_num_;
-      }
-    }
-  }
-
-  virtual Status Finish(IndexBlocks* index_blocks) override {
-    FlushPendingPrefix();
-    primary_index_builder_.Finish(index_blocks);
-    index_blocks->meta_blocks.insert(
-        {kHashIndexPrefixesBlock.c_str(), prefix_block_});
-    index_blocks->meta_blocks.insert(
-        {kHashIndexPrefixesMetadataBlock.c_str(), prefix_meta_block_});
-    return Status::OK();
-  }
-
-  virtual size_t EstimatedSize() const override {
-    return primary_index_builder_.EstimatedSize() + prefix_block_.size() +
-           prefix_meta_block_.size();
-  }
-
- private:
-  void FlushPendingPrefix() {
-    prefix_block_.append(pending_entry_prefix_.data(),
-                         pending_entry_prefix_.size());
-    PutVarint32Varint32Varint32(
-        &prefix_meta_block_,
-        static_cast<uint32_t>(pending_entry_prefix_.size()),
-        pending_entry_index_, pending_block_num_);
-  }
-
-  ShortenedIndexBuilder primary_index_builder_;
-  const SliceTransform* hash_key_extractor_;
-
-  // stores a sequence of prefixes
-  std::string prefix_block_;
-  // stores the metadata of prefixes
-  std::string prefix_meta_block_;
-
-  // The following 3 variables keeps unflushed prefix and its metadata.
-  // The details of block_num and entry_index can be found in
-  // "block_hash_index.{h,cc}"
-  uint32_t pending_block_num_ = 0;
-  uint32_t pending_entry_index_ = 0;
-  std::string pending_entry_prefix_;
-
-  uint64_t current_restart_index_ = 0;
-};
-
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
 // Create a index builder based on its type.
 IndexBuilder* CreateIndexBuilder(IndexType type, const Comparator* comparator,
                                  const SliceTransform* prefix_extractor,
-                                 int index_block_restart_interval) {
+                                 const BlockBasedTableOptions& table_opt) {
   switch (type) {
     case BlockBasedTableOptions::kBinarySearch: {
       return new ShortenedIndexBuilder(comparator,
-                                       index_block_restart_interval);
+                                       table_opt.index_block_restart_interval);
     }
     case BlockBasedTableOptions::kHashSearch: {
       return new HashIndexBuilder(comparator, prefix_extractor,
-                                  index_block_restart_interval);
+                                  table_opt.index_block_restart_interval);
+    }
+    case BlockBasedTableOptions::kTwoLevelIndexSearch: {
+      return new PartitionedIndexBuilder(comparator, table_opt);
     }
     default: {
       assert(!"Do not recognize the index type ");
@@ -291,15 +83,23 @@ IndexBuilder* CreateIndexBuilder(IndexType type, const Comparator* comparator,
   return nullptr;
 }
 
-// Create a index builder based on its type.
-FilterBlockBuilder* CreateFilterBlockBuilder(const ImmutableCFOptions& opt,
-    const BlockBasedTableOptions& table_opt) {
+// Create a filter block builder based on its type.
+// p_index_builder is the index builder of a two-level index whose partitions
+// the filter follows, or nullptr for a filter that is not partitioned.
+FilterBlockBuilder* CreateFilterBlockBuilder(
+    const ImmutableCFOptions& opt, const BlockBasedTableOptions& table_opt,
+    PartitionedIndexBuilder* const p_index_builder) {
   if (table_opt.filter_policy == nullptr) return nullptr;
 
   FilterBitsBuilder* filter_bits_builder =
       table_opt.filter_policy->GetFilterBitsBuilder();
   if (filter_bits_builder == nullptr) {
     return new BlockBasedFilterBlockBuilder(opt.prefix_extractor, table_opt);
+  } else if (p_index_builder != nullptr) {
+    return new PartitionedFilterBlockBuilder(
+        opt.prefix_extractor, table_opt.whole_key_filtering,
+        filter_bits_builder, table_opt.index_block_restart_interval,
+        p_index_builder);
   } else {
     return new FullFilterBlockBuilder(opt.prefix_extractor,
                                       table_opt.whole_key_filtering,
@@ -307,6 +107,29 @@ FilterBlockBuilder* CreateFilterBlockBuilder(const ImmutableCFOptions& opt,
   }
 }
 
+// The data block hash index maps hashes of the bytes of user keys, so it is
+// only built for format versions that know about it and for comparators that
+// never consider keys with different bytes equal.
+BlockBasedTableOptions::DataBlockIndexType GetDataBlockIndexType(
+    const BlockBasedTableOptions& table_opt,
+    const Comparator* user_comparator) {
+  if (table_opt.format_version < 3 ||
+      (user_comparator != BytewiseComparator() &&
+       user_comparator != ReverseBytewiseComparator())) {
+    return BlockBasedTableOptions::kDataBlockBinarySearch;
+  }
+  return table_opt.data_block_index_type;
+}
+
+// The restart key prefixes order keys by their bytes, which only matches the
+// order of BytewiseComparator().
+bool UseRestartKeyPrefixes(const BlockBasedTableOptions& table_opt,
+                           const Comparator* user_comparator) {
+  return table_opt.data_block_restart_key_prefixes &&
+         table_opt.format_version >= 3 &&
+         user_comparator == BytewiseComparator();
+}
+
 bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
   // Check to see if compressed less than 12.5%
   return compressed_size < raw_size - (raw_size / 8u);
@@ -455,6 +278,47 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   bool prefix_filtering_;
 };
 
+// State of the worker threads that compress the data blocks when
+// CompressionOptions::parallel_threads > 1. The builder's thread hands each
+// finished data block to the workers and writes the compressed blocks to the
+// file in their original order, so the block handles, index entries and
+// checksums are the same as with inline compression.
+struct BlockBasedTableBuilder::ParallelCompressionRep {
+  struct BlockRep {
+    std::string raw;
+    std::string compressed_output;
+    Slice contents;  // Points into raw or compressed_output
+    CompressionType type = kNoCompression;
+    Status status;
+    // The index entry of the block is made from its last key and the first
+    // key of the next block once its handle is known.
+    std::string last_key;
+    std::string first_key_in_next_block;
+    bool has_next_block = false;
+    bool done = false;  // Protected by mu
+  };
+
+  explicit ParallelCompressionRep(uint32_t parallel_threads)
+      : work_cv(&mu), done_cv(&mu), max_inflight(2 * parallel_threads) {}
+
+  port::Mutex mu;
+  port::CondVar work_cv;  // Signaled when a block is queued or on shutdown
+  port::CondVar done_cv;  // Signaled when a block has been compressed
+  // Blocks that no worker has picked up yet. Protected by mu.
+  std::deque<BlockRep*> work_queue;
+  bool shutdown = false;  // Protected by mu
+
+  // Blocks handed to the workers and not written yet, in file order. Only
+  // accessed by the builder's thread.
+  std::deque<std::unique_ptr<BlockRep>> inflight;
+  uint64_t inflight_raw_bytes = 0;
+  // The builder's thread waits for the oldest block once more than this many
+  // blocks are in flight, which bounds the memory held by the queue.
+  const size_t max_inflight;
+
+  std::vector<std::thread> workers;
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const BlockBasedTableOptions table_options;
@@ -463,9 +327,14 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t offset = 0;
   Status status;
   BlockBuilder data_block;
+  // Range tombstones are stored apart from the point keys, in a meta block.
+  // They are not added in key order, so the block uses no delta encoding.
+  BlockBuilder range_del_block;
 
   InternalKeySliceTransform internal_prefix_transform;
   std::unique_ptr<IndexBuilder> index_builder;
+  // index_builder, if the filter is partitioned along its partitions.
+  PartitionedIndexBuilder* p_index_builder = nullptr;
 
   std::string last_key;
   const CompressionType compression_type;
@@ -488,6 +357,9 @@ struct BlockBasedTableBuilder::Rep {
 
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  // Set while data blocks are compressed on worker threads.
+  std::unique_ptr<ParallelCompressionRep> pc_rep;
+
   Rep(const ImmutableCFOptions& _ioptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -503,22 +375,36 @@ struct BlockBasedTableBuilder::Rep {
         internal_comparator(icomparator),
         file(f),
         data_block(table_options.block_restart_interval,
-                   table_options.use_delta_encoding),
+                   table_options.use_delta_encoding,
+                   GetDataBlockIndexType(table_options,
+                                         icomparator.user_comparator()),
+                   table_options.data_block_hash_table_util_ratio,
+                   UseRestartKeyPrefixes(table_options,
+                                         icomparator.user_comparator())),
+        range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(_ioptions.prefix_extractor),
         index_builder(
             CreateIndexBuilder(table_options.index_type, &internal_comparator,
                                &this->internal_prefix_transform,
-                               table_options.index_block_restart_interval)),
+                               table_options)),
         compression_type(_compression_type),
         compression_opts(_compression_opts),
         compression_dict(_compression_dict),
-        filter_block(skip_filters ? nullptr : CreateFilterBlockBuilder(
-                                                  _ioptions, table_options)),
         flush_block_policy(
             table_options.flush_block_policy_factory->NewFlushBlockPolicy(
                 table_options, data_block)),
         column_family_id(_column_family_id),
         column_family_name(_column_family_name) {
+    if (table_options.partition_filters &&
+        table_options.index_type ==
+            BlockBasedTableOptions::kTwoLevelIndexSearch) {
+      p_index_builder =
+          static_cast<PartitionedIndexBuilder*>(index_builder.get());
+    }
+    if (!skip_filters) {
+      filter_block.reset(
+          CreateFilterBlockBuilder(_ioptions, table_options, p_index_builder));
+    }
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
       table_properties_collectors.emplace_back(
           collector_factories->CreateIntTblPropCollector(column_family_id));
@@ -540,7 +426,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
     const CompressionType compression_type,
     const CompressionOptions& compression_opts,
     const std::string* compression_dict, const bool skip_filters,
-    const std::string& column_family_name) {
+    const std::string& column_family_name, const uint64_t creation_time) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -556,6 +442,7 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
                  int_tbl_prop_collector_factories, column_family_id, file,
                  compression_type, compression_opts, compression_dict,
                  skip_filters, column_family_name);
+  rep_->props.creation_time = creation_time;
 
   if (rep_->filter_block != nullptr) {
     rep_->filter_block->StartBlock(0);
@@ -566,6 +453,17 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
         &rep_->compressed_cache_key_prefix[0],
         &rep_->compressed_cache_key_prefix_size);
   }
+  // The index and filter builders of the other configurations track the
+  // data block that keys are added to, or its file offset, so they need the
+  // blocks to be written as soon as they are cut.
+  if (compression_opts.parallel_threads > 1 &&
+      compression_type != kNoCompression &&
+      sanitized_table_options.index_type ==
+          BlockBasedTableOptions::kBinarySearch &&
+      (rep_->filter_block == nullptr ||
+       !rep_->filter_block->IsBlockBased())) {
+    StartParallelCompression();
+  }
 }
 
 BlockBasedTableBuilder::~BlockBasedTableBuilder() {
@@ -577,25 +475,40 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
   Rep* r = rep_;
   assert(!r->closed);
   if (!ok()) return;
-  if (r->props.num_entries > 0) {
+  if (ExtractValueType(key) == kTypeRangeDeletion) {
+    r->range_del_block.Add(key, value);
+    r->props.num_entries++;
+    r->props.raw_key_size += key.size();
+    r->props.raw_value_size += value.size();
+    NotifyCollectTableCollectorsOnAdd(key, value, r->offset,
+                                      r->table_properties_collectors,
+                                      r->ioptions.info_log);
+    return;
+  }
+  if (!r->last_key.empty()) {
     assert(r->internal_comparator.Compare(key, Slice(r->last_key)) > 0);
   }
 
   auto should_flush = r->flush_block_policy->Update(key, value);
   if (should_flush) {
     assert(!r->data_block.empty());
-    Flush();
-
-    // Add item to index block.
-    // We do not emit the index entry for a block until we have seen the
-    // first key for the next data block.  This allows us to use shorter
-    // keys in the index block.  For example, consider a block boundary
-    // between the keys "the quick brown fox" and "the who".  We can use
-    // "the r" as the key for the index block entry since it is >= all
-    // entries in the first block and < all entries in subsequent
-    // blocks.
-    if (ok()) {
-      r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
+    if (r->pc_rep != nullptr) {
+      // The index entry is added once the compressed block is written.
+      EnqueueDataBlock(&key);
+    } else {
+      Flush();
+
+      // Add item to index block.
+      // We do not emit the index entry for a block until we have seen the
+      // first key for the next data block.  This allows us to use shorter
+      // keys in the index block.  For example, consider a block boundary
+      // between the keys "the quick brown fox" and "the who".  We can use
+      // "the r" as the key for the index block entry since it is >= all
+      // entries in the first block and < all entries in subsequent
+      // blocks.
+      if (ok()) {
+        r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
+      }
     }
   }
 
@@ -620,6 +533,10 @@ void BlockBasedTableBuilder::Flush() {
   assert(!r->closed);
   if (!ok()) return;
   if (r->data_block.empty()) return;
+  if (r->pc_rep != nullptr) {
+    EnqueueDataBlock(nullptr /* no next data block */);
+    return;
+  }
   WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
   if (ok() && !r->table_options.skip_table_builder_flush) {
     r->status = r->file->Flush();
@@ -648,10 +565,29 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   assert(ok());
   Rep* r = rep_;
 
-  auto type = r->compression_type;
   Slice block_contents;
+  CompressionType type;
+  Status compression_status;
+  CompressAndVerifyBlock(raw_block_contents, is_data_block,
+                         &r->compressed_output, &block_contents, &type,
+                         &compression_status);
+  if (!compression_status.ok()) {
+    r->status = compression_status;
+  }
+
+  WriteRawBlock(block_contents, type, handle);
+  r->compressed_output.clear();
+}
+
+void BlockBasedTableBuilder::CompressAndVerifyBlock(
+    const Slice& raw_block_contents, bool is_data_block,
+    std::string* compressed_output, Slice* block_contents,
+    CompressionType* type, Status* out_status) {
+  const Rep* r = rep_;
+
+  *type = r->compression_type;
   bool abort_compression = false;
-  
+
   StopWatchNano timer(r->ioptions.env,
     ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics));
 
@@ -661,19 +597,19 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
       compression_dict = *r->compression_dict;
     }
 
-    block_contents = CompressBlock(raw_block_contents, r->compression_opts,
-                                   &type, r->table_options.format_version,
-                                   compression_dict, &r->compressed_output);
+    *block_contents = CompressBlock(raw_block_contents, r->compression_opts,
+                                    type, r->table_options.format_version,
+                                    compression_dict, compressed_output);
 
     // Some of the compression algorithms are known to be unreliable. If
     // the verify_compression flag is set then try to de-compress the
     // compressed data and compare to the input.
-    if (type != kNoCompression && r->table_options.verify_compression) {
+    if (*type != kNoCompression && r->table_options.verify_compression) {
       // Retrieve the uncompressed contents into a new buffer
       BlockContents contents;
       Status stat = UncompressBlockContentsForCompressionType(
-          block_contents.data(), block_contents.size(), &contents,
-          r->table_options.format_version, compression_dict, type,
+          block_contents->data(), block_contents->size(), &contents,
+          r->table_options.format_version, compression_dict, *type,
           r->ioptions);
 
       if (stat.ok()) {
@@ -683,12 +619,12 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
           abort_compression = true;
           Log(InfoLogLevel::ERROR_LEVEL, r->ioptions.info_log,
               "Decompressed block did not match raw block");
-          r->status =
+          *out_status =
               Status::Corruption("Decompressed block did not match raw block");
         }
       } else {
         // Decompression reported an error. abort.
-        r->status = Status::Corruption("Could not decompress");
+        *out_status = Status::Corruption("Could not decompress");
         abort_compression = true;
       }
     }
@@ -701,21 +637,130 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   // verification.
   if (abort_compression) {
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
-    block_contents = raw_block_contents;
+    *type = kNoCompression;
+    *block_contents = raw_block_contents;
   }
-  else if (type != kNoCompression &&
-            ShouldReportDetailedTime(r->ioptions.env, 
+  else if (*type != kNoCompression &&
+            ShouldReportDetailedTime(r->ioptions.env,
               r->ioptions.statistics)) {
-    MeasureTime(r->ioptions.statistics, COMPRESSION_TIMES_NANOS, 
+    MeasureTime(r->ioptions.statistics, COMPRESSION_TIMES_NANOS,
       timer.ElapsedNanos());
-    MeasureTime(r->ioptions.statistics, BYTES_COMPRESSED, 
+    MeasureTime(r->ioptions.statistics, BYTES_COMPRESSED,
       raw_block_contents.size());
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_COMPRESSED);
   }
+}
 
-  WriteRawBlock(block_contents, type, handle);
-  r->compressed_output.clear();
+void BlockBasedTableBuilder::StartParallelCompression() {
+  Rep* r = rep_;
+  r->pc_rep.reset(
+      new ParallelCompressionRep(r->compression_opts.parallel_threads));
+  for (uint32_t i = 0; i < r->compression_opts.parallel_threads; i++) {
+    r->pc_rep->workers.emplace_back([this] { BGWorkCompression(); });
+  }
+}
+
+void BlockBasedTableBuilder::StopParallelCompression() {
+  ParallelCompressionRep* pc = rep_->pc_rep.get();
+  {
+    MutexLock l(&pc->mu);
+    pc->shutdown = true;
+    pc->work_cv.SignalAll();
+  }
+  for (auto& worker : pc->workers) {
+    worker.join();
+  }
+  pc->workers.clear();
+}
+
+void BlockBasedTableBuilder::BGWorkCompression() {
+  ParallelCompressionRep* pc = rep_->pc_rep.get();
+  while (true) {
+    ParallelCompressionRep::BlockRep* block;
+    {
+      MutexLock l(&pc->mu);
+      while (pc->work_queue.empty() && !pc->shutdown) {
+        pc->work_cv.Wait();
+      }
+      if (pc->work_queue.empty()) {
+        return;
+      }
+      block = pc->work_queue.front();
+      pc->work_queue.pop_front();
+    }
+
+    CompressAndVerifyBlock(block->raw, true /* is_data_block */,
+                           &block->compressed_output, &block->contents,
+                           &block->type, &block->status);
+
+    MutexLock l(&pc->mu);
+    block->done = true;
+    pc->done_cv.SignalAll();
+  }
+}
+
+void BlockBasedTableBuilder::EnqueueDataBlock(
+    const Slice* first_key_in_next_block) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+
+  std::unique_ptr<ParallelCompressionRep::BlockRep> block(
+      new ParallelCompressionRep::BlockRep);
+  block->raw = r->data_block.Finish().ToString();
+  r->data_block.Reset();
+  block->last_key = r->last_key;
+  if (first_key_in_next_block != nullptr) {
+    block->first_key_in_next_block = first_key_in_next_block->ToString();
+    block->has_next_block = true;
+  }
+  pc->inflight_raw_bytes += block->raw.size();
+  {
+    MutexLock l(&pc->mu);
+    pc->work_queue.push_back(block.get());
+    pc->work_cv.Signal();
+  }
+  pc->inflight.push_back(std::move(block));
+
+  WriteCompressedBlocks(pc->max_inflight);
+}
+
+void BlockBasedTableBuilder::WriteCompressedBlocks(size_t max_inflight) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  while (!pc->inflight.empty()) {
+    ParallelCompressionRep::BlockRep* block = pc->inflight.front().get();
+    {
+      MutexLock l(&pc->mu);
+      while (!block->done) {
+        if (pc->inflight.size() <= max_inflight) {
+          return;
+        }
+        pc->done_cv.Wait();
+      }
+    }
+
+    // Same steps as WriteBlock() and Flush() take for an inline block.
+    if (ok()) {
+      if (!block->status.ok()) {
+        r->status = block->status;
+      }
+      WriteRawBlock(block->contents, block->type, &r->pending_handle);
+      if (ok() && !r->table_options.skip_table_builder_flush) {
+        r->status = r->file->Flush();
+      }
+      r->props.data_size = r->offset;
+      ++r->props.num_data_blocks;
+      if (ok()) {
+        Slice first_key_in_next_block(block->first_key_in_next_block);
+        r->index_builder->AddIndexEntry(
+            &block->last_key,
+            block->has_next_block ? &first_key_in_next_block : nullptr,
+            r->pending_handle);
+      }
+    }
+    pc->inflight_raw_bytes -= block->raw.size();
+    pc->inflight.pop_front();
+  }
 }
 
 void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
@@ -813,37 +858,51 @@ Status BlockBasedTableBuilder::Finish() {
   Rep* r = rep_;
   bool empty_data_block = r->data_block.empty();
   Flush();
+  if (r->pc_rep != nullptr) {
+    // Also adds the index entry of the last data block
+    WriteCompressedBlocks(0 /* max_inflight */);
+    StopParallelCompression();
+  }
   assert(!r->closed);
   r->closed = true;
 
   BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle,
       compression_dict_block_handle;
-  // Write filter block
-  if (ok() && r->filter_block != nullptr) {
-    auto filter_contents = r->filter_block->Finish();
-    r->props.filter_size = filter_contents.size();
-    WriteRawBlock(filter_contents, kNoCompression, &filter_block_handle);
-  }
-
   // To make sure properties block is able to keep the accurate size of index
   // block, we will finish writing all index entries here and flush them
-  // to storage after metaindex block is written.
-  if (ok() && !empty_data_block) {
+  // to storage after metaindex block is written. This also cuts the last
+  // index partition, which a partitioned filter follows, so it comes before
+  // the filter is finished.
+  if (ok() && !empty_data_block && r->pc_rep == nullptr) {
     r->index_builder->AddIndexEntry(
         &r->last_key, nullptr /* no next data block */, r->pending_handle);
   }
 
+  // Write filter block. A partitioned filter hands out its partitions one at
+  // a time; the block written last is the top-level block that the metaindex
+  // points to.
+  if (ok() && r->filter_block != nullptr) {
+    Status s = Status::Incomplete();
+    while (s.IsIncomplete()) {
+      Slice filter_content = r->filter_block->Finish(filter_block_handle, &s);
+      assert(s.ok() || s.IsIncomplete());
+      r->props.filter_size += filter_content.size();
+      WriteRawBlock(filter_content, kNoCompression, &filter_block_handle);
+    }
+  }
+
   IndexBuilder::IndexBlocks index_blocks;
-  auto s = r->index_builder->Finish(&index_blocks);
-  if (!s.ok()) {
-    return s;
+  auto index_builder_status = r->index_builder->Finish(&index_blocks);
+  if (!index_builder_status.ok() && !index_builder_status.IsIncomplete()) {
+    return index_builder_status;
   }
 
   // Write meta blocks and metaindex block with the following order.
   //    1. [meta block: filter]
-  //    2. [other meta blocks]
-  //    3. [meta block: properties]
-  //    4. [metaindex block]
+  //    2. [meta block: range deletion tombstones]
+  //    3. [other meta blocks]
+  //    4. [meta block: properties]
+  //    5. [metaindex block]
   // write meta blocks
   MetaIndexBuilder meta_index_builder;
   for (const auto& item : index_blocks.meta_blocks) {
@@ -860,12 +919,22 @@ Status BlockBasedTableBuilder::Finish() {
       if (r->filter_block->IsBlockBased()) {
         key = BlockBasedTable::kFilterBlockPrefix;
       } else {
-        key = BlockBasedTable::kFullFilterBlockPrefix;
+        key = r->p_index_builder != nullptr
+                  ? BlockBasedTable::kPartitionedFilterBlockPrefix
+                  : BlockBasedTable::kFullFilterBlockPrefix;
       }
       key.append(r->table_options.filter_policy->Name());
       meta_index_builder.Add(key, filter_block_handle);
     }
 
+    // Write the range deletion block, if any.
+    if (!r->range_del_block.empty()) {
+      BlockHandle range_del_block_handle;
+      WriteRawBlock(r->range_del_block.Finish(), kNoCompression,
+                    &range_del_block_handle);
+      meta_index_builder.Add(kRangeDelBlock, range_del_block_handle);
+    }
+
     // Write properties and compression dictionary blocks.
     {
       PropertyBlockBuilder property_block_builder;
@@ -882,6 +951,9 @@ Status BlockBasedTableBuilder::Finish() {
                                          ? r->ioptions.merge_operator->Name()
                                          : "nullptr";
       r->props.compression_name = CompressionTypeToString(r->compression_type);
+      if (r->compression_dict != nullptr) {
+        r->props.compression_dict_size = r->compression_dict->size();
+      }
 
       std::string property_collectors_names = "[";
       property_collectors_names = "[";
@@ -929,6 +1001,18 @@ Status BlockBasedTableBuilder::Finish() {
                   &metaindex_block_handle);
     WriteBlock(index_blocks.index_block_contents, &index_block_handle,
                false /* is_data_block */);
+    // A partitioned index hands out its partitions one at a time. The block
+    // written last is the top-level index, which the footer points to.
+    while (ok() && index_builder_status.IsIncomplete()) {
+      index_builder_status =
+          r->index_builder->Finish(&index_blocks, index_block_handle);
+      if (!index_builder_status.ok() && !index_builder_status.IsIncomplete()) {
+        r->status = index_builder_status;
+        break;
+      }
+      WriteBlock(index_blocks.index_block_contents, &index_block_handle,
+                 false /* is_data_block */);
+    }
   }
 
   // Write footer
@@ -964,6 +1048,9 @@ Status BlockBasedTableBuilder::Finish() {
 void BlockBasedTableBuilder::Abandon() {
   Rep* r = rep_;
   assert(!r->closed);
+  if (r->pc_rep != nullptr) {
+    StopParallelCompression();
+  }
   r->closed = true;
 }
 
@@ -972,6 +1059,11 @@ uint64_t BlockBasedTableBuilder::NumEntries() const {
 }
 
 uint64_t BlockBasedTableBuilder::FileSize() const {
+  // Counts the blocks still being compressed at their raw size, which keeps
+  // output files from overshooting their target size.
+  if (rep_->pc_rep != nullptr) {
+    return rep_->offset + rep_->pc_rep->inflight_raw_bytes;
+  }
   return rep_->offset;
 }
 
@@ -997,4 +1089,6 @@ TableProperties BlockBasedTableBuilder::GetTableProperties() const {
 
 const std::string BlockBasedTable::kFilterBlockPrefix = "filter.";
 const std::string BlockBasedTable::kFullFilterBlockPrefix = "fullfilter.";
+const std::string BlockBasedTable::kPartitionedFilterBlockPrefix =
+    "partitionedfilter.";
 }  // namespace rocksdb
@@ -46,7 +46,7 @@ class BlockBasedTableBuilder : public TableBuilder {
       const CompressionType compression_type,
       const CompressionOptions& compression_opts,
       const std::string* compression_dict, const bool skip_filters,
-      const std::string& column_family_name);
+      const std::string& column_family_name, const uint64_t creation_time = 0);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~BlockBasedTableBuilder();
@@ -94,10 +94,31 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WriteBlock(const Slice& block_contents, BlockHandle* handle,
                   bool is_data_block);
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle);
+  // Compresses raw_block_contents with the table's compression type, falling
+  // back to the raw contents if compression does not pay off or fails
+  // verification. Only reads the immutable parts of rep_, so the
+  // compression workers may call it concurrently.
+  void CompressAndVerifyBlock(const Slice& raw_block_contents,
+                              bool is_data_block,
+                              std::string* compressed_output,
+                              Slice* block_contents, CompressionType* type,
+                              Status* out_status);
   Status InsertBlockInCache(const Slice& block_contents,
                             const CompressionType type,
                             const BlockHandle* handle);
+
+  // Parallel compression of data blocks, see ParallelCompressionRep.
+  void StartParallelCompression();
+  void StopParallelCompression();
+  void BGWorkCompression();
+  // Hands the current data block to the compression workers.
+  void EnqueueDataBlock(const Slice* first_key_in_next_block);
+  // Writes the compressed blocks in file order, waiting for the workers
+  // until no more than max_inflight blocks are outstanding.
+  void WriteCompressedBlocks(size_t max_inflight);
+
   struct Rep;
+  struct ParallelCompressionRep;
   class BlockBasedTablePropertiesCollectorFactory;
   class BlockBasedTablePropertiesCollector;
   Rep* rep_;
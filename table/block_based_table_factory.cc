@@ -70,7 +70,8 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.compression_opts,
       table_builder_options.compression_dict,
       table_builder_options.skip_filters,
-      table_builder_options.column_family_name);
+      table_builder_options.column_family_name,
+      table_builder_options.creation_time);
 
   return table_builder;
 }
@@ -94,11 +95,34 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Enable pin_l0_filter_and_index_blocks_in_cache, "
         ", but block cache is disabled");
   }
+  if (table_options_.partition_filters &&
+      table_options_.index_type !=
+          BlockBasedTableOptions::kTwoLevelIndexSearch) {
+    return Status::InvalidArgument(
+        "Enable partition_filters, but index_type is not "
+        "kTwoLevelIndexSearch");
+  }
   if (!BlockBasedTableSupportedVersion(table_options_.format_version)) {
     return Status::InvalidArgument(
         "Unsupported BlockBasedTable format_version. Please check "
         "include/rocksdb/table.h for more info");
   }
+  if (table_options_.data_block_index_type ==
+      BlockBasedTableOptions::kDataBlockBinaryAndHash) {
+    if (table_options_.format_version < 3) {
+      return Status::InvalidArgument(
+          "Enable data block hash index, but format_version < 3");
+    }
+    if (table_options_.data_block_hash_table_util_ratio <= 0) {
+      return Status::InvalidArgument(
+          "data_block_hash_table_util_ratio should be greater than 0");
+    }
+  }
+  if (table_options_.data_block_restart_key_prefixes &&
+      table_options_.format_version < 3) {
+    return Status::InvalidArgument(
+        "Enable data_block_restart_key_prefixes, but format_version < 3");
+  }
   return Status::OK();
 }
 
@@ -125,6 +149,15 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  hash_index_allow_collision: %d\n",
            table_options_.hash_index_allow_collision);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_index_type: %d\n",
+           table_options_.data_block_index_type);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %f\n",
+           table_options_.data_block_hash_table_util_ratio);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_restart_key_prefixes: %d\n",
+           table_options_.data_block_restart_key_prefixes);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  checksum: %d\n",
            table_options_.checksum);
   ret.append(buffer);
@@ -167,12 +200,19 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  whole_key_filtering: %d\n",
            table_options_.whole_key_filtering);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  partition_filters: %d\n",
+           table_options_.partition_filters);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  skip_table_builder_flush: %d\n",
            table_options_.skip_table_builder_flush);
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "  max_auto_readahead_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.max_auto_readahead_size);
+  ret.append(buffer);
   return ret;
 }
 
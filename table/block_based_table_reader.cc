@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based_table_reader.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 
@@ -31,6 +32,7 @@
 #include "table/filter_block.h"
 #include "table/format.h"
 #include "table/full_filter_block.h"
+#include "table/partitioned_filter_block.h"
 #include "table/get_context.h"
 #include "table/internal_iterator.h"
 #include "table/meta_blocks.h"
@@ -146,9 +148,12 @@ class BlockBasedTable::IndexReader {
 
   // Create an iterator for index access.
   // An iter is passed in, if it is not null, update this one and return it
-  // If it is null, create a new Iterator
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool total_order_seek = true) = 0;
+  // If it is null, create a new Iterator. An index that cannot be iterated
+  // with a BlockIter may ignore iter and return a new Iterator anyway.
+  // read_options is used by the indexes that read blocks on demand.
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool total_order_seek = true,
+      const ReadOptions& read_options = ReadOptions()) = 0;
 
   // The size of the index.
   virtual size_t size() const = 0;
@@ -194,8 +199,9 @@ class BinarySearchIndexReader : public IndexReader {
     return s;
   }
 
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool dont_care = true) override {
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool dont_care = true,
+      const ReadOptions& read_options = ReadOptions()) override {
     return index_block_->NewIterator(comparator_, iter, true);
   }
 
@@ -294,8 +300,9 @@ class HashIndexReader : public IndexReader {
     return Status::OK();
   }
 
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool total_order_seek = true) override {
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool total_order_seek = true,
+      const ReadOptions& read_options = ReadOptions()) override {
     return index_block_->NewIterator(comparator_, iter, total_order_seek);
   }
 
@@ -324,28 +331,66 @@ class HashIndexReader : public IndexReader {
   BlockContents prefixes_contents_;
 };
 
+// Index that is partitioned into index blocks of about block_size. Only the
+// top-level index, which points to the partitions, is held by the reader.
+// The partitions are read through the block cache on demand, like data
+// blocks, so the iterator is a two-level iterator over them.
+class PartitionIndexReader : public IndexReader {
+ public:
+  // Read the top-level index from the file and create an instance for
+  // `PartitionIndexReader`.
+  // On success, index_reader will be populated; otherwise it will remain
+  // unmodified.
+  static Status Create(BlockBasedTable* table, RandomAccessFileReader* file,
+                       const Footer& footer, const BlockHandle& index_handle,
+                       const ImmutableCFOptions& ioptions,
+                       const Comparator* comparator, IndexReader** index_reader,
+                       const PersistentCacheOptions& cache_options) {
+    std::unique_ptr<Block> index_block;
+    auto s = ReadBlockFromFile(file, footer, ReadOptions(), index_handle,
+                               &index_block, ioptions, true /* decompress */,
+                               Slice() /*compression dict*/, cache_options);
+
+    if (s.ok()) {
+      *index_reader = new PartitionIndexReader(
+          table, comparator, std::move(index_block), ioptions.statistics);
+    }
+
+    return s;
+  }
+
+  // Defined after BlockEntryIteratorState, which it uses.
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool dont_care = true,
+      const ReadOptions& read_options = ReadOptions()) override;
+
+  virtual size_t size() const override { return index_block_->size(); }
+  virtual size_t usable_size() const override {
+    return index_block_->usable_size();
+  }
+
+  virtual size_t ApproximateMemoryUsage() const override {
+    assert(index_block_);
+    return index_block_->ApproximateMemoryUsage();
+  }
+
+ private:
+  PartitionIndexReader(BlockBasedTable* table, const Comparator* comparator,
+                       std::unique_ptr<Block>&& index_block, Statistics* stats)
+      : IndexReader(comparator, stats),
+        table_(table),
+        index_block_(std::move(index_block)) {
+    assert(index_block_ != nullptr);
+  }
+  // Don't own table_
+  BlockBasedTable* table_;
+  std::unique_ptr<Block> index_block_;
+};
+
 // CachableEntry represents the entries that *may* be fetched from block cache.
 //  field `value` is the item we want to get.
 //  field `cache_handle` is the cache handle to the block cache. If the value
 //    was not read from cache, `cache_handle` will be nullptr.
-template <class TValue>
-struct BlockBasedTable::CachableEntry {
-  CachableEntry(TValue* _value, Cache::Handle* _cache_handle)
-      : value(_value), cache_handle(_cache_handle) {}
-  CachableEntry() : CachableEntry(nullptr, nullptr) {}
-  void Release(Cache* cache) {
-    if (cache_handle) {
-      cache->Release(cache_handle);
-      value = nullptr;
-      cache_handle = nullptr;
-    }
-  }
-  bool IsSet() const { return cache_handle != nullptr; }
-
-  TValue* value = nullptr;
-  // if the entry is from the cache, cache_handle will be populated.
-  Cache::Handle* cache_handle = nullptr;
-};
 
 struct BlockBasedTable::Rep {
   Rep(const ImmutableCFOptions& _ioptions, const EnvOptions& _env_options,
@@ -389,6 +434,7 @@ struct BlockBasedTable::Rep {
     kNoFilter,
     kFullFilter,
     kBlockFilter,
+    kPartitionedFilter,
   };
   FilterType filter_type;
   BlockHandle filter_handle;
@@ -399,6 +445,9 @@ struct BlockBasedTable::Rep {
   // is easier because the Slice member depends on the continued existence of
   // another member ("allocation").
   std::unique_ptr<const BlockContents> compression_dict_block;
+  // Handle of the range deletion meta block, or a null handle if the table
+  // has no range tombstones.
+  BlockHandle range_del_handle = BlockHandle::NullBlockHandle();
   BlockBasedTableOptions::IndexType index_type;
   bool hash_index_allow_collision;
   bool whole_key_filtering;
@@ -559,14 +608,19 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
 
   // Find filter handle and filter type
   if (rep->filter_policy) {
-    for (auto prefix : {kFullFilterBlockPrefix, kFilterBlockPrefix}) {
+    for (auto prefix : {kFullFilterBlockPrefix, kFilterBlockPrefix,
+                        kPartitionedFilterBlockPrefix}) {
       std::string filter_block_key = prefix;
       filter_block_key.append(rep->filter_policy->Name());
       if (FindMetaBlock(meta_iter.get(), filter_block_key, &rep->filter_handle)
               .ok()) {
-        rep->filter_type = (prefix == kFullFilterBlockPrefix)
-                               ? Rep::FilterType::kFullFilter
-                               : Rep::FilterType::kBlockFilter;
+        if (prefix == kFullFilterBlockPrefix) {
+          rep->filter_type = Rep::FilterType::kFullFilter;
+        } else if (prefix == kFilterBlockPrefix) {
+          rep->filter_type = Rep::FilterType::kBlockFilter;
+        } else {
+          rep->filter_type = Rep::FilterType::kPartitionedFilter;
+        }
         break;
       }
     }
@@ -625,6 +679,22 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
     }
   }
 
+  // Find the range deletion meta block. Its contents are read lazily, like a
+  // data block, when the tombstones are needed. Unlike the blocks above it
+  // cannot be skipped on error, since that would resurrect deleted keys.
+  bool found_range_del_block;
+  s = SeekToRangeDelBlock(meta_iter.get(), &found_range_del_block);
+  if (s.ok() && found_range_del_block) {
+    Slice handle_value = meta_iter->value();
+    s = rep->range_del_handle.DecodeFrom(&handle_value);
+  }
+  if (!s.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, rep->ioptions.info_log,
+        "Encountered error while reading range deletion block handle: %s",
+        s.ToString().c_str());
+    return s;
+  }
+
   // Determine whether whole key filtering is supported.
   if (rep->table_properties) {
     rep->whole_key_filtering &=
@@ -685,7 +755,8 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
 
       // Set filter block
       if (rep->filter_policy) {
-        rep->filter.reset(ReadFilter(rep));
+        rep->filter.reset(
+            new_table->ReadFilter(rep->filter_handle, false /* partition */));
       }
     } else {
       delete index_reader;
@@ -767,7 +838,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ImmutableCFOptions &ioptions, const ReadOptions& read_options,
     BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
-    const Slice& compression_dict) {
+    const Slice& compression_dict, bool is_index) {
   Status s;
   Block* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
@@ -775,9 +846,10 @@ Status BlockBasedTable::GetDataBlockFromCache(
 
   // Lookup uncompressed cache first
   if (block_cache != nullptr) {
-    block->cache_handle =
-        GetEntryFromCache(block_cache, block_cache_key, BLOCK_CACHE_DATA_MISS,
-                          BLOCK_CACHE_DATA_HIT, statistics);
+    block->cache_handle = GetEntryFromCache(
+        block_cache, block_cache_key,
+        is_index ? BLOCK_CACHE_INDEX_MISS : BLOCK_CACHE_DATA_MISS,
+        is_index ? BLOCK_CACHE_INDEX_HIT : BLOCK_CACHE_DATA_HIT, statistics);
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
@@ -823,7 +895,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
         read_options.fill_cache) {
       s = block_cache->Insert(
           block_cache_key, block->value, block->value->usable_size(),
-          &DeleteCachedEntry<Block>, &(block->cache_handle));
+          &DeleteCachedEntry<Block>, &(block->cache_handle),
+          is_index ? Cache::Priority::HIGH : Cache::Priority::LOW);
       if (s.ok()) {
         RecordTick(statistics, BLOCK_CACHE_ADD);
       } else {
@@ -844,7 +917,7 @@ Status BlockBasedTable::PutDataBlockToCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, const ImmutableCFOptions &ioptions,
     CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-    const Slice& compression_dict) {
+    const Slice& compression_dict, bool is_index) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -888,14 +961,19 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
-    s = block_cache->Insert(block_cache_key, block->value,
-                            block->value->usable_size(),
-                            &DeleteCachedEntry<Block>, &(block->cache_handle));
+    s = block_cache->Insert(
+        block_cache_key, block->value, block->value->usable_size(),
+        &DeleteCachedEntry<Block>, &(block->cache_handle),
+        is_index ? Cache::Priority::HIGH : Cache::Priority::LOW);
     if (s.ok()) {
       assert(block->cache_handle != nullptr);
       RecordTick(statistics, BLOCK_CACHE_ADD);
       RecordTick(statistics, BLOCK_CACHE_BYTES_WRITE,
                  block->value->usable_size());
+      if (is_index) {
+        RecordTick(statistics, BLOCK_CACHE_INDEX_BYTES_INSERT,
+                   block->value->usable_size());
+      }
       assert(reinterpret_cast<Block*>(
                  block_cache->Value(block->cache_handle)) == block->value);
     } else {
@@ -908,7 +986,9 @@ Status BlockBasedTable::PutDataBlockToCache(
   return s;
 }
 
-FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
+FilterBlockReader* BlockBasedTable::ReadFilter(
+    const BlockHandle& filter_handle, const bool is_a_filter_partition) const {
+  Rep* rep = rep_;
   // TODO: We might want to unify with ReadBlockFromFile() if we start
   // requiring checksum verification in Table::Open.
   if (rep->filter_type == Rep::FilterType::kNoFilter) {
@@ -916,7 +996,7 @@ FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
   }
   BlockContents block;
   if (!ReadBlockContents(rep->file.get(), rep->footer, ReadOptions(),
-                         rep->filter_handle, &block, rep->ioptions,
+                         filter_handle, &block, rep->ioptions,
                          false /* decompress */, Slice() /*compression dict*/,
                          rep->persistent_cache_options)
            .ok()) {
@@ -926,12 +1006,19 @@ FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
 
   assert(rep->filter_policy);
 
-  if (rep->filter_type == Rep::FilterType::kBlockFilter) {
+  auto filter_type = rep->filter_type;
+  if (filter_type == Rep::FilterType::kPartitionedFilter &&
+      is_a_filter_partition) {
+    // Every partition of a partitioned filter is a regular full filter.
+    filter_type = Rep::FilterType::kFullFilter;
+  }
+
+  if (filter_type == Rep::FilterType::kBlockFilter) {
     return new BlockBasedFilterBlockReader(
         rep->prefix_filtering ? rep->ioptions.prefix_extractor : nullptr,
         rep->table_options, rep->whole_key_filtering, std::move(block),
         rep->ioptions.statistics);
-  } else if (rep->filter_type == Rep::FilterType::kFullFilter) {
+  } else if (filter_type == Rep::FilterType::kFullFilter) {
     auto filter_bits_reader =
         rep->filter_policy->GetFilterBitsReader(block.data);
     if (filter_bits_reader != nullptr) {
@@ -940,21 +1027,38 @@ FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
           rep->whole_key_filtering, std::move(block), filter_bits_reader,
           rep->ioptions.statistics);
     }
+  } else if (filter_type == Rep::FilterType::kPartitionedFilter) {
+    return new PartitionedFilterBlockReader(
+        rep->prefix_filtering ? rep->ioptions.prefix_extractor : nullptr,
+        rep->whole_key_filtering, std::move(block), this,
+        &rep->internal_comparator, rep->ioptions.statistics,
+        rep->table_options.block_cache.get(),
+        Slice(rep->cache_key_prefix, rep->cache_key_prefix_size));
   }
 
   // filter_type is either kNoFilter (exited the function at the first if),
-  // kBlockFilter or kFullFilter. there is no way for the execution to come here
+  // kBlockFilter, kFullFilter or kPartitionedFilter. there is no way for the
+  // execution to come here
   assert(false);
   return nullptr;
 }
 
 BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
-                                                          bool no_io) const {
+    bool no_io) const {
+  const BlockHandle& filter_blk_handle = rep_->filter_handle;
+  const bool is_a_filter_partition = false;
+  return GetFilter(filter_blk_handle, is_a_filter_partition, no_io);
+}
+
+BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
+    const BlockHandle& filter_blk_handle, const bool is_a_filter_partition,
+    bool no_io) const {
   // If cache_index_and_filter_blocks is false, filter should be pre-populated.
   // We will return rep_->filter anyway. rep_->filter can be nullptr if filter
   // read fails at Open() time. We don't want to reload again since it will
   // most probably fail again.
-  if (!rep_->table_options.cache_index_and_filter_blocks) {
+  if (!is_a_filter_partition &&
+      !rep_->table_options.cache_index_and_filter_blocks) {
     return {rep_->filter.get(), nullptr /* cache handle */};
   }
 
@@ -965,16 +1069,18 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
   }
 
   // we have a pinned filter block
-  if (rep_->filter_entry.IsSet()) {
+  if (!is_a_filter_partition && rep_->filter_entry.IsSet()) {
     return rep_->filter_entry;
   }
 
   PERF_TIMER_GUARD(read_filter_block_nanos);
 
-  // Fetching from the cache
+  // Fetching from the cache. The top-level filter block is cached under the
+  // handle of the metaindex block, and a filter partition under its own.
   char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
   auto key = GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
-                         rep_->footer.metaindex_handle(),
+                         is_a_filter_partition ? filter_blk_handle
+                                               : rep_->footer.metaindex_handle(),
                          cache_key);
 
   Statistics* statistics = rep_->ioptions.statistics;
@@ -990,11 +1096,14 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
     // Do not invoke any io.
     return CachableEntry<FilterBlockReader>();
   } else {
-    filter = ReadFilter(rep_);
+    filter = ReadFilter(filter_blk_handle, is_a_filter_partition);
     if (filter != nullptr) {
       assert(filter->size() > 0);
+      // Filter and index blocks are inserted with high priority so that, if
+      // the cache has a high-pri pool, scans do not push them out.
       Status s = block_cache->Insert(key, filter, filter->size(),
-                                     &DeleteCachedFilterEntry, &cache_handle);
+                                     &DeleteCachedFilterEntry, &cache_handle,
+                                     Cache::Priority::HIGH);
       if (s.ok()) {
         RecordTick(statistics, BLOCK_CACHE_ADD);
         RecordTick(statistics, BLOCK_CACHE_BYTES_WRITE, filter->size());
@@ -1016,12 +1125,12 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
   // index reader has already been pre-populated.
   if (rep_->index_reader) {
     return rep_->index_reader->NewIterator(
-        input_iter, read_options.total_order_seek);
+        input_iter, read_options.total_order_seek, read_options);
   }
   // we have a pinned index block
   if (rep_->index_entry.IsSet()) {
-    return rep_->index_entry.value->NewIterator(input_iter,
-                                                read_options.total_order_seek);
+    return rep_->index_entry.value->NewIterator(
+        input_iter, read_options.total_order_seek, read_options);
   }
 
   PERF_TIMER_GUARD(read_index_block_nanos);
@@ -1057,7 +1166,8 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
     if (s.ok()) {
       assert(index_reader != nullptr);
       s = block_cache->Insert(key, index_reader, index_reader->usable_size(),
-                              &DeleteCachedIndexEntry, &cache_handle);
+                              &DeleteCachedIndexEntry, &cache_handle,
+                              Cache::Priority::HIGH);
     }
 
     if (s.ok()) {
@@ -1083,7 +1193,7 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 
   assert(cache_handle);
   auto* iter = index_reader->NewIterator(
-      input_iter, read_options.total_order_seek);
+      input_iter, read_options.total_order_seek, read_options);
 
   // the caller would like to take ownership of the index block
   // don't call RegisterCleanup() in this case, the caller will take care of it
@@ -1102,7 +1212,7 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 // If input_iter is not null, update this iter and return it
 InternalIterator* BlockBasedTable::NewDataBlockIterator(
     Rep* rep, const ReadOptions& ro, const Slice& index_value,
-    BlockIter* input_iter) {
+    BlockIter* input_iter, bool is_index) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
   const bool no_io = (ro.read_tier == kBlockCacheTier);
@@ -1126,8 +1236,9 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
     }
   }
 
+  // Index partitions are never compressed with the dictionary.
   Slice compression_dict;
-  if (rep->compression_dict_block) {
+  if (rep->compression_dict_block && !is_index) {
     compression_dict = rep->compression_dict_block->data;
   }
   // If either block cache is enabled, we'll try to read from it.
@@ -1152,7 +1263,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
     s = GetDataBlockFromCache(
         key, ckey, block_cache, block_cache_compressed, rep->ioptions, ro, &block,
-        rep->table_options.format_version, compression_dict);
+        rep->table_options.format_version, compression_dict, is_index);
 
     if (block.value == nullptr && !no_io && ro.fill_cache) {
       std::unique_ptr<Block> raw_block;
@@ -1168,7 +1279,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
         s = PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
                                 ro, rep->ioptions, &block, raw_block.release(),
                                 rep->table_options.format_version,
-                                compression_dict);
+                                compression_dict, is_index);
       }
     }
   }
@@ -1215,18 +1326,41 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
   return iter;
 }
 
+namespace {
+const size_t kInitReadaheadSize = 8 * 1024;
+// Number of adjacent data blocks an iterator moves through before it starts
+// prefetching, so that point lookups and short scans don't read ahead
+const int kMinSequentialBlocksForReadahead = 2;
+}  // namespace
+
 class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
  public:
   BlockEntryIteratorState(BlockBasedTable* table,
-                          const ReadOptions& read_options, bool skip_filters)
+                          const ReadOptions& read_options, bool skip_filters,
+                          bool is_index = false)
       : TwoLevelIteratorState(table->rep_->ioptions.prefix_extractor !=
                               nullptr),
         table_(table),
         read_options_(read_options),
-        skip_filters_(skip_filters) {}
+        skip_filters_(skip_filters),
+        is_index_(is_index),
+        max_readahead_size_(
+            is_index || read_options.readahead_size > 0
+                ? 0
+                : table->rep_->table_options.max_auto_readahead_size),
+        readahead_size_(std::min(kInitReadaheadSize, max_readahead_size_)),
+        num_sequential_blocks_(0),
+        prev_block_end_(port::kMaxUint64),
+        readahead_limit_(0) {}
+
+  ~BlockEntryIteratorState() { ResetReadahead(); }
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
-    return NewDataBlockIterator(table_->rep_, read_options_, index_value);
+    if (max_readahead_size_ > 0) {
+      MaybeReadahead(index_value);
+    }
+    return NewDataBlockIterator(table_->rep_, read_options_, index_value,
+                                nullptr, is_index_);
   }
 
   bool PrefixMayMatch(const Slice& internal_key) override {
@@ -1237,12 +1371,93 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   }
 
  private:
+  // Prefetches the data blocks after the one in index_value while the
+  // iterator moves through adjacent blocks. A new window is requested once
+  // less than half of the current one is left ahead of the iterator, and the
+  // window doubles each time up to max_readahead_size_. Prefetch() may block
+  // while it issues the reads, so it is called once per window rather than
+  // once per block.
+  void MaybeReadahead(const Slice& index_value) {
+    BlockHandle handle;
+    Slice input = index_value;
+    if (!handle.DecodeFrom(&input).ok()) {
+      return;
+    }
+    const uint64_t block_end =
+        handle.offset() + handle.size() + kBlockTrailerSize;
+    if (handle.offset() == prev_block_end_) {
+      num_sequential_blocks_++;
+      if (block_end <= readahead_limit_) {
+        PERF_COUNTER_ADD(block_prefetch_hit_count, 1);
+      }
+    } else {
+      ResetReadahead();
+    }
+    prev_block_end_ = block_end;
+
+    if (num_sequential_blocks_ < kMinSequentialBlocksForReadahead ||
+        readahead_limit_ >= block_end + readahead_size_ / 2) {
+      return;
+    }
+    // Data blocks come before all the meta blocks of the file
+    const uint64_t data_end = table_->rep_->footer.metaindex_handle().offset();
+    const uint64_t start = std::max(block_end, readahead_limit_);
+    const uint64_t end = std::min(block_end + readahead_size_, data_end);
+    if (start >= end) {
+      return;
+    }
+    Status s = table_->rep_->file->Prefetch(start, end - start);
+    if (!s.ok()) {
+      // Not supported by the file, e.g. with direct IO
+      max_readahead_size_ = 0;
+      return;
+    }
+    PERF_COUNTER_ADD(block_prefetch_bytes, end - start);
+    readahead_limit_ = end;
+    readahead_size_ = std::min(readahead_size_ * 2, max_readahead_size_);
+  }
+
+  // Starts over from the smallest window, accounting the bytes of the
+  // current window the iterator didn't reach
+  void ResetReadahead() {
+    if (readahead_limit_ > prev_block_end_) {
+      PERF_COUNTER_ADD(block_prefetch_wasted_bytes,
+                       readahead_limit_ - prev_block_end_);
+    }
+    readahead_size_ = std::min(kInitReadaheadSize, max_readahead_size_);
+    num_sequential_blocks_ = 0;
+    readahead_limit_ = 0;
+  }
+
   // Don't own table_
   BlockBasedTable* table_;
   const ReadOptions read_options_;
   bool skip_filters_;
+  // true if the secondary iterators are over index partitions
+  bool is_index_;
+  // 0 if the iterator doesn't prefetch
+  size_t max_readahead_size_;
+  size_t readahead_size_;
+  int num_sequential_blocks_;
+  // End of the last data block the iterator moved to, including its trailer
+  uint64_t prev_block_end_;
+  // End of the range prefetched so far
+  uint64_t readahead_limit_;
 };
 
+InternalIterator* PartitionIndexReader::NewIterator(
+    BlockIter* iter, bool dont_care, const ReadOptions& read_options) {
+  // Filters are checked before the index is searched, and the partitions are
+  // always searched in total order.
+  ReadOptions partition_read_options = read_options;
+  partition_read_options.total_order_seek = true;
+  return NewTwoLevelIterator(
+      new BlockBasedTable::BlockEntryIteratorState(
+          table_, partition_read_options, true /* skip_filters */,
+          true /* is_index */),
+      index_block_->NewIterator(comparator_, nullptr, true));
+}
+
 // This will be broken if the user specifies an unusual implementation
 // of Options.comparator, or if the user specifies an unusual
 // definition of prefixes in BlockBasedTableOptions.filter_policy.
@@ -1283,7 +1498,8 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
   FilterBlockReader* filter = filter_entry.value;
   if (filter != nullptr) {
     if (!filter->IsBlockBased()) {
-      may_match = filter->PrefixMayMatch(prefix);
+      may_match = filter->PrefixMayMatch(prefix, kNotValid, true /* no_io */,
+                                         &internal_prefix);
     } else {
       // Then, try find it within each block
       unique_ptr<InternalIterator> iiter(NewIndexIterator(no_io_read_options));
@@ -1347,6 +1563,16 @@ InternalIterator* BlockBasedTable::NewIterator(const ReadOptions& read_options,
       NewIndexIterator(read_options), arena);
 }
 
+InternalIterator* BlockBasedTable::NewRangeTombstoneIterator(
+    const ReadOptions& read_options) {
+  if (rep_->range_del_handle.IsNull()) {
+    return nullptr;
+  }
+  std::string str;
+  rep_->range_del_handle.EncodeTo(&str);
+  return NewDataBlockIterator(rep_, read_options, Slice(str));
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(const ReadOptions& read_options,
                                             FilterBlockReader* filter,
                                             const Slice& internal_key) const {
@@ -1354,13 +1580,15 @@ bool BlockBasedTable::FullFilterKeyMayMatch(const ReadOptions& read_options,
     return true;
   }
   Slice user_key = ExtractUserKey(internal_key);
+  const bool no_io = read_options.read_tier == kBlockCacheTier;
   if (filter->whole_key_filtering()) {
-    return filter->KeyMayMatch(user_key);
+    return filter->KeyMayMatch(user_key, kNotValid, no_io, &internal_key);
   }
   if (!read_options.total_order_seek && rep_->ioptions.prefix_extractor &&
       rep_->ioptions.prefix_extractor->InDomain(user_key) &&
       !filter->PrefixMayMatch(
-          rep_->ioptions.prefix_extractor->Transform(user_key))) {
+          rep_->ioptions.prefix_extractor->Transform(user_key), kNotValid,
+          no_io, &internal_key)) {
     return false;
   }
   return true;
@@ -1380,87 +1608,263 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   if (!FullFilterKeyMayMatch(read_options, filter, key)) {
     RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
   } else {
-    BlockIter iiter;
-    NewIndexIterator(read_options, &iiter);
+    BlockIter iiter_on_stack;
+    auto iiter = NewIndexIterator(read_options, &iiter_on_stack);
+    std::unique_ptr<InternalIterator> iiter_unique_ptr;
+    if (iiter != &iiter_on_stack) {
+      iiter_unique_ptr.reset(iiter);
+    }
+    iiter->Seek(key);
+    s = GetFromDataBlocks(read_options, key, get_context, filter, iiter);
+  }
 
-    PinnedIteratorsManager* pinned_iters_mgr = get_context->pinned_iters_mgr();
-    bool pin_blocks = pinned_iters_mgr && pinned_iters_mgr->PinningEnabled();
-    BlockIter* biter = nullptr;
+  // if rep_->filter_entry is not set, we should call Release(); otherwise
+  // don't call, in this case we have a local copy in rep_->filter_entry,
+  // it's pinned to the cache and will be released in the destructor
+  if (!rep_->filter_entry.IsSet()) {
+    filter_entry.Release(rep_->table_options.block_cache.get());
+  }
+  return s;
+}
+
+Status BlockBasedTable::GetFromDataBlocks(const ReadOptions& read_options,
+                                          const Slice& key,
+                                          GetContext* get_context,
+                                          FilterBlockReader* filter,
+                                          InternalIterator* iiter) {
+  Status s;
+  PinnedIteratorsManager* pinned_iters_mgr = get_context->pinned_iters_mgr();
+  bool pin_blocks = pinned_iters_mgr && pinned_iters_mgr->PinningEnabled();
+  BlockIter* biter = nullptr;
 
-    bool done = false;
-    for (iiter.Seek(key); iiter.Valid() && !done; iiter.Next()) {
-      Slice handle_value = iiter.value();
+  bool done = false;
+  for (; iiter->Valid() && !done; iiter->Next()) {
+    Slice handle_value = iiter->value();
 
-      BlockHandle handle;
-      bool not_exist_in_filter =
-          filter != nullptr && filter->IsBlockBased() == true &&
-          handle.DecodeFrom(&handle_value).ok() &&
-          !filter->KeyMayMatch(ExtractUserKey(key), handle.offset());
-
-      if (not_exist_in_filter) {
-        // Not found
-        // TODO: think about interaction with Merge. If a user key cannot
-        // cross one data block, we should be fine.
-        RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
-        break;
+    BlockHandle handle;
+    bool not_exist_in_filter =
+        filter != nullptr && filter->IsBlockBased() == true &&
+        handle.DecodeFrom(&handle_value).ok() &&
+        !filter->KeyMayMatch(ExtractUserKey(key), handle.offset());
+
+    if (not_exist_in_filter) {
+      // Not found
+      // TODO: think about interaction with Merge. If a user key cannot
+      // cross one data block, we should be fine.
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      break;
+    } else {
+      BlockIter stack_biter;
+      if (pin_blocks) {
+        // We need to create the BlockIter on heap because we may need to
+        // pin it if we encounterd merge operands
+        biter = static_cast<BlockIter*>(
+            NewDataBlockIterator(rep_, read_options, iiter->value()));
       } else {
-        BlockIter stack_biter;
-        if (pin_blocks) {
-          // We need to create the BlockIter on heap because we may need to
-          // pin it if we encounterd merge operands
-          biter = static_cast<BlockIter*>(
-              NewDataBlockIterator(rep_, read_options, iiter.value()));
-        } else {
-          biter = &stack_biter;
-          NewDataBlockIterator(rep_, read_options, iiter.value(), biter);
+        biter = &stack_biter;
+        NewDataBlockIterator(rep_, read_options, iiter->value(), biter);
+      }
+
+      if (read_options.read_tier == kBlockCacheTier &&
+          biter->status().IsIncomplete()) {
+        // couldn't get block from block_cache
+        // Update Saver.state to Found because we are only looking for whether
+        // we can guarantee the key is not there when "no_io" is set
+        get_context->MarkKeyMayExist();
+        break;
+      }
+      if (!biter->status().ok()) {
+        s = biter->status();
+        break;
+      }
+
+      // Call the *saver function on each entry/block until it returns false
+      if (!biter->SeekForGet(key)) {
+        done = true;
+      }
+      for (; !done && biter->Valid(); biter->Next()) {
+        ParsedInternalKey parsed_key;
+        if (!ParseInternalKey(biter->key(), &parsed_key)) {
+          s = Status::Corruption(Slice());
         }
 
-        if (read_options.read_tier == kBlockCacheTier &&
-            biter->status().IsIncomplete()) {
-          // couldn't get block from block_cache
-          // Update Saver.state to Found because we are only looking for whether
-          // we can guarantee the key is not there when "no_io" is set
-          get_context->MarkKeyMayExist();
+        if (!get_context->SaveValue(parsed_key, biter->value(), pin_blocks)) {
+          done = true;
           break;
         }
-        if (!biter->status().ok()) {
-          s = biter->status();
-          break;
+      }
+      s = biter->status();
+
+      if (pin_blocks) {
+        if (get_context->State() == GetContext::kMerge) {
+          // Pin blocks as long as we are merging
+          pinned_iters_mgr->PinIteratorIfNeeded(biter);
+        } else {
+          delete biter;
         }
+        biter = nullptr;
+      } else {
+        // biter is on stack, Nothing to clean
+      }
+    }
+  }
+  if (pin_blocks && biter != nullptr) {
+    delete biter;
+  }
+  if (s.ok()) {
+    s = iiter->status();
+    if (read_options.read_tier == kBlockCacheTier && s.IsIncomplete()) {
+      // The index, or a partition of it, is not in the block cache
+      get_context->MarkKeyMayExist();
+    }
+  }
+  return s;
+}
+
+void BlockBasedTable::MultiGet(const ReadOptions& read_options,
+                               const std::vector<Slice>& keys,
+                               const std::vector<GetContext*>& get_contexts,
+                               std::vector<Status>* statuses,
+                               bool skip_filters) {
+  assert(keys.size() == get_contexts.size());
+  statuses->assign(keys.size(), Status::OK());
+  if (keys.empty()) {
+    return;
+  }
+
+  CachableEntry<FilterBlockReader> filter_entry;
+  if (!skip_filters) {
+    filter_entry = GetFilter(read_options.read_tier == kBlockCacheTier);
+  }
+  FilterBlockReader* filter = filter_entry.value;
+
+  BlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(read_options, &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // First pass: probe the filters and the index for every key. The index
+  // value (the encoded handle of the data block) is copied out since, with a
+  // partitioned index, it does not outlive the current index partition. An
+  // empty handle means there is nothing to read.
+  std::vector<std::string> block_handles(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    if (!FullFilterKeyMayMatch(read_options, filter, keys[i])) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      continue;
+    }
+    iiter->Seek(keys[i]);
+    if (!iiter->Valid()) {
+      (*statuses)[i] = iiter->status();
+      continue;
+    }
+    Slice handle_value = iiter->value();
+    BlockHandle handle;
+    Slice handle_input = handle_value;
+    if (filter != nullptr && filter->IsBlockBased() == true &&
+        handle.DecodeFrom(&handle_input).ok() &&
+        !filter->KeyMayMatch(ExtractUserKey(keys[i]), handle.offset())) {
+      RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
+      continue;
+    }
+    block_handles[i] = handle_value.ToString();
+  }
+
+  // Second pass: since the keys are sorted, keys that live in the same data
+  // block are adjacent. Read every distinct block only once and look up all
+  // of its keys in it.
+  PinnedIteratorsManager* pinned_iters_mgr = get_contexts[0]->pinned_iters_mgr();
+  bool pin_blocks = pinned_iters_mgr && pinned_iters_mgr->PinningEnabled();
+  size_t group_start = 0;
+  while (group_start < keys.size()) {
+    const std::string& group_handle = block_handles[group_start];
+    if (group_handle.empty()) {
+      ++group_start;
+      continue;
+    }
+    size_t group_end = group_start + 1;
+    while (group_end < keys.size() &&
+           (block_handles[group_end].empty() ||
+            block_handles[group_end] == group_handle)) {
+      ++group_end;
+    }
+
+    BlockIter stack_biter;
+    BlockIter* biter;
+    if (pin_blocks) {
+      // The block may need to be pinned if any key of the group is merging
+      biter = static_cast<BlockIter*>(
+          NewDataBlockIterator(rep_, read_options, group_handle));
+    } else {
+      biter = &stack_biter;
+      NewDataBlockIterator(rep_, read_options, group_handle, biter);
+    }
+
+    bool pin_biter = false;
+    for (size_t i = group_start; i < group_end; ++i) {
+      if (block_handles[i].empty()) {
+        continue;
+      }
+      GetContext* get_context = get_contexts[i];
+      if (read_options.read_tier == kBlockCacheTier &&
+          biter->status().IsIncomplete()) {
+        // couldn't get block from block_cache
+        get_context->MarkKeyMayExist();
+        continue;
+      }
+      if (!biter->status().ok()) {
+        (*statuses)[i] = biter->status();
+        continue;
+      }
 
-        // Call the *saver function on each entry/block until it returns false
-        for (biter->Seek(key); biter->Valid(); biter->Next()) {
-          ParsedInternalKey parsed_key;
-          if (!ParseInternalKey(biter->key(), &parsed_key)) {
-            s = Status::Corruption(Slice());
-          }
-
-          if (!get_context->SaveValue(parsed_key, biter->value(), pin_blocks)) {
-            done = true;
-            break;
-          }
+      bool done = false;
+      for (biter->Seek(keys[i]); biter->Valid(); biter->Next()) {
+        ParsedInternalKey parsed_key;
+        if (!ParseInternalKey(biter->key(), &parsed_key)) {
+          (*statuses)[i] = Status::Corruption(Slice());
         }
-        s = biter->status();
 
-        if (pin_blocks) {
-          if (get_context->State() == GetContext::kMerge) {
-            // Pin blocks as long as we are merging
-            pinned_iters_mgr->PinIteratorIfNeeded(biter);
-          } else {
-            delete biter;
-          }
-          biter = nullptr;
-        } else {
-          // biter is on stack, Nothing to clean
+        if (!get_context->SaveValue(parsed_key, biter->value(), pin_blocks)) {
+          done = true;
+          break;
         }
       }
+      Status s = biter->status();
+
+      if (s.ok() && !done) {
+        // The entries of this key continue past the end of the data block.
+        // Resume the regular lookup from the next index entry.
+        BlockIter next_iiter_on_stack;
+        auto next_iiter = NewIndexIterator(read_options, &next_iiter_on_stack);
+        std::unique_ptr<InternalIterator> next_iiter_unique_ptr;
+        if (next_iiter != &next_iiter_on_stack) {
+          next_iiter_unique_ptr.reset(next_iiter);
+        }
+        next_iiter->Seek(keys[i]);
+        if (next_iiter->Valid()) {
+          next_iiter->Next();
+        }
+        s = GetFromDataBlocks(read_options, keys[i], get_context, filter,
+                              next_iiter);
+      }
+      (*statuses)[i] = s;
+
+      if (pin_blocks && get_context->State() == GetContext::kMerge) {
+        pin_biter = true;
+      }
     }
-    if (pin_blocks && biter != nullptr) {
-      delete biter;
-    }
-    if (s.ok()) {
-      s = iiter.status();
+
+    if (pin_blocks) {
+      if (pin_biter) {
+        // Pin blocks as long as we are merging
+        pinned_iters_mgr->PinIteratorIfNeeded(biter);
+      } else {
+        delete biter;
+      }
     }
+    group_start = group_end;
   }
 
   // if rep_->filter_entry is not set, we should call Release(); otherwise
@@ -1469,7 +1873,6 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   if (!rep_->filter_entry.IsSet()) {
     filter_entry.Release(rep_->table_options.block_cache.get());
   }
-  return s;
 }
 
 Status BlockBasedTable::Prefetch(const Slice* const begin,
@@ -1480,22 +1883,26 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
     return Status::InvalidArgument(*begin, *end);
   }
 
-  BlockIter iiter;
-  NewIndexIterator(ReadOptions(), &iiter);
+  BlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(ReadOptions(), &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
 
-  if (!iiter.status().ok()) {
+  if (!iiter->status().ok()) {
     // error opening index iterator
-    return iiter.status();
+    return iiter->status();
   }
 
   // indicates if we are on the last page that need to be pre-fetched
   bool prefetching_boundary_page = false;
 
-  for (begin ? iiter.Seek(*begin) : iiter.SeekToFirst(); iiter.Valid();
-       iiter.Next()) {
-    Slice block_handle = iiter.value();
+  for (begin ? iiter->Seek(*begin) : iiter->SeekToFirst(); iiter->Valid();
+       iiter->Next()) {
+    Slice block_handle = iiter->value();
 
-    if (end && comparator.Compare(iiter.key(), *end) >= 0) {
+    if (end && comparator.Compare(iiter->key(), *end) >= 0) {
       if (prefetching_boundary_page) {
         break;
       }
@@ -1618,6 +2025,11 @@ Status BlockBasedTable::CreateIndexReader(
           comparator, footer.index_handle(), meta_index_iter, index_reader,
           rep_->hash_index_allow_collision, rep_->persistent_cache_options);
     }
+    case BlockBasedTableOptions::kTwoLevelIndexSearch: {
+      return PartitionIndexReader::Create(
+          this, file, footer, footer.index_handle(), rep_->ioptions,
+          comparator, index_reader, rep_->persistent_cache_options);
+    }
     default: {
       std::string error_message =
           "Unrecognized index type: " + ToString(rep_->index_type);
@@ -1659,6 +2071,34 @@ uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key) {
   return result;
 }
 
+Status BlockBasedTable::ApproximateKeyAnchors(
+    size_t max_anchors, std::vector<std::string>* anchors) {
+  if (max_anchors == 0) {
+    return Status::OK();
+  }
+  unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
+  // The index has one entry per data block, so counting them first lets us
+  // pick every n-th block boundary in a second pass.
+  size_t num_blocks = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    ++num_blocks;
+  }
+  if (!index_iter->status().ok()) {
+    return index_iter->status();
+  }
+  size_t step = (num_blocks + max_anchors - 1) / max_anchors;
+  if (step == 0) {
+    return Status::OK();
+  }
+  size_t i = 0;
+  for (index_iter->SeekToFirst(); index_iter->Valid(); index_iter->Next()) {
+    if (++i % step == 0) {
+      anchors->push_back(index_iter->key().ToString());
+    }
+  }
+  return index_iter->status();
+}
+
 bool BlockBasedTable::TEST_filter_block_preloaded() const {
   return rep_->filter != nullptr;
 }
@@ -13,7 +13,9 @@
 #include <memory>
 #include <utility>
 #include <string>
+#include <vector>
 
+#include "rocksdb/cache.h"
 #include "rocksdb/options.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/statistics.h"
@@ -33,6 +35,7 @@ class Cache;
 class FilterBlockReader;
 class BlockBasedFilterBlockReader;
 class FullFilterBlockReader;
+class PartitionedFilterBlockReader;
 class Footer;
 class InternalKeyComparator;
 class Iterator;
@@ -45,6 +48,7 @@ struct EnvOptions;
 struct ReadOptions;
 class GetContext;
 class InternalIterator;
+class PartitionIndexReader;
 
 using std::unique_ptr;
 
@@ -55,6 +59,7 @@ class BlockBasedTable : public TableReader {
  public:
   static const std::string kFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
+  static const std::string kPartitionedFilterBlockPrefix;
   // The longest prefix of the cache key used to identify blocks.
   // For Posix files the unique ID is three varints.
   static const size_t kMaxCacheKeyPrefixSize = kMaxVarint64Length * 3 + 1;
@@ -93,10 +98,24 @@ class BlockBasedTable : public TableReader {
   InternalIterator* NewIterator(const ReadOptions&, Arena* arena = nullptr,
                                 bool skip_filters = false) override;
 
+  // Returns an iterator over the range deletion meta block, or nullptr if
+  // the table has no range tombstones. The block is read through the block
+  // cache like a data block.
+  InternalIterator* NewRangeTombstoneIterator(
+      const ReadOptions& read_options) override;
+
   // @param skip_filters Disables loading/accessing the filter block
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context, bool skip_filters = false) override;
 
+  // Batched lookup. Filters and the index are probed for all keys up front
+  // and every distinct data block is read at most once for the whole batch.
+  // @param skip_filters Disables loading/accessing the filter block
+  void MultiGet(const ReadOptions& readOptions, const std::vector<Slice>& keys,
+                const std::vector<GetContext*>& get_contexts,
+                std::vector<Status>* statuses,
+                bool skip_filters = false) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
@@ -110,6 +129,11 @@ class BlockBasedTable : public TableReader {
   // be close to the file length.
   uint64_t ApproximateOffsetOf(const Slice& key) override;
 
+  // Samples the anchors from the last keys of the data blocks, as listed in
+  // the index.
+  Status ApproximateKeyAnchors(size_t max_anchors,
+                               std::vector<std::string>* anchors) override;
+
   // Returns true if the block for the specified key is in cache.
   // REQUIRES: key is in this table && block cache enabled
   bool TEST_KeyInCache(const ReadOptions& options, const Slice& key);
@@ -140,7 +164,23 @@ class BlockBasedTable : public TableReader {
 
  private:
   template <class TValue>
-  struct CachableEntry;
+  struct CachableEntry {
+    CachableEntry(TValue* _value, Cache::Handle* _cache_handle)
+        : value(_value), cache_handle(_cache_handle) {}
+    CachableEntry() : CachableEntry(nullptr, nullptr) {}
+    void Release(Cache* cache) {
+      if (cache_handle) {
+        cache->Release(cache_handle);
+        value = nullptr;
+        cache_handle = nullptr;
+      }
+    }
+    bool IsSet() const { return cache_handle != nullptr; }
+
+    TValue* value = nullptr;
+    // if the entry is from the cache, cache_handle will be populated.
+    Cache::Handle* cache_handle = nullptr;
+  };
 
   struct Rep;
   Rep* rep_;
@@ -148,18 +188,26 @@ class BlockBasedTable : public TableReader {
 
   class BlockEntryIteratorState;
   // input_iter: if it is not null, update this one and return it as Iterator
+  // is_index: the block is an index partition rather than a data block
   static InternalIterator* NewDataBlockIterator(
       Rep* rep, const ReadOptions& ro, const Slice& index_value,
-      BlockIter* input_iter = nullptr);
+      BlockIter* input_iter = nullptr, bool is_index = false);
 
   // For the following two functions:
   // if `no_io == true`, we will not try to read filter/index from sst file
   // were they not present in cache yet.
   CachableEntry<FilterBlockReader> GetFilter(bool no_io = false) const;
+  // Returns the filter block at filter_blk_handle. A partition of a
+  // partitioned filter is only ever read through the block cache, so
+  // nullptr is returned for it if there is no block cache.
+  CachableEntry<FilterBlockReader> GetFilter(
+      const BlockHandle& filter_blk_handle, const bool is_a_filter_partition,
+      bool no_io) const;
 
   // Get the iterator from the index reader.
   // If input_iter is not set, return new Iterator
-  // If input_iter is set, update it and return it as Iterator
+  // If input_iter is set, update it and return it as Iterator. A partitioned
+  // index may still return a new Iterator, which the caller then owns.
   //
   // Note: ErrorIterator with Status::Incomplete shall be returned if all the
   // following conditions are met:
@@ -171,18 +219,27 @@ class BlockBasedTable : public TableReader {
       const ReadOptions& read_options, BlockIter* input_iter = nullptr,
       CachableEntry<IndexReader>* index_entry = nullptr);
 
+  // Feeds the entries of `key` to get_context, reading data blocks starting
+  // at the current position of *iiter, until get_context has a final result
+  // or the index is exhausted.
+  Status GetFromDataBlocks(const ReadOptions& read_options, const Slice& key,
+                           GetContext* get_context, FilterBlockReader* filter,
+                           InternalIterator* iiter);
+
   // Read block cache from block caches (if set): block_cache and
   // block_cache_compressed.
   // On success, Status::OK with be returned and @block will be populated with
   // pointer to the block as well as its block handle.
   // @param compression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param is_index The block is an index partition, which is accounted to the
+  //    index block cache statistics.
   static Status GetDataBlockFromCache(
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ImmutableCFOptions &ioptions, const ReadOptions& read_options,
       BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
-      const Slice& compression_dict);
+      const Slice& compression_dict, bool is_index = false);
 
   // Put a raw block (maybe compressed) to the corresponding block caches.
   // This method will perform decompression against raw_block if needed and then
@@ -194,18 +251,22 @@ class BlockBasedTable : public TableReader {
   // responsible for releasing its memory if error occurs.
   // @param compression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param is_index The block is an index partition, which is inserted with
+  //    high priority.
   static Status PutDataBlockToCache(
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, const ImmutableCFOptions &ioptions,
       CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-      const Slice& compression_dict);
+      const Slice& compression_dict, bool is_index = false);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
   // May not make such a call if filter policy says that key is not present.
   friend class TableCache;
   friend class BlockBasedTableBuilder;
+  friend class PartitionIndexReader;
+  friend class PartitionedFilterBlockReader;
 
   void ReadMeta(const Footer& footer);
 
@@ -219,14 +280,15 @@ class BlockBasedTable : public TableReader {
 
   bool FullFilterKeyMayMatch(const ReadOptions& read_options,
                              FilterBlockReader* filter,
-                             const Slice& user_key) const;
+                             const Slice& internal_key) const;
 
   // Read the meta block from sst.
   static Status ReadMetaBlock(Rep* rep, std::unique_ptr<Block>* meta_block,
                               std::unique_ptr<InternalIterator>* iter);
 
   // Create the filter from the filter block.
-  static FilterBlockReader* ReadFilter(Rep* rep);
+  FilterBlockReader* ReadFilter(const BlockHandle& filter_handle,
+                                const bool is_a_filter_partition) const;
 
   static void SetupCacheKeyPrefix(Rep* rep, uint64_t file_size);
 
@@ -30,6 +30,9 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// A data block may also have restart key prefixes and a hash index between
+// the restart array and num_restarts; see table/restart_key_prefixes.h and
+// table/data_block_hash_index.h.
 
 #include "table/block_builder.h"
 
@@ -41,13 +44,21 @@
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+BlockBuilder::BlockBuilder(
+    int block_restart_interval, bool use_delta_encoding,
+    BlockBasedTableOptions::DataBlockIndexType index_type,
+    double data_block_hash_table_util_ratio, bool use_restart_key_prefixes)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
+      use_restart_key_prefixes_(use_restart_key_prefixes),
       restarts_(),
       counter_(0),
       finished_(false) {
   assert(block_restart_interval_ >= 1);
+  if (index_type == BlockBasedTableOptions::kDataBlockBinaryAndHash) {
+    data_block_hash_index_builder_.Initialize(
+        data_block_hash_table_util_ratio);
+  }
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
 }
@@ -56,10 +67,12 @@ void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.clear();
   restarts_.push_back(0);       // First restart point is at offset 0
+  restart_key_prefixes_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  data_block_hash_index_builder_.Reset();
 }
 
 size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
@@ -82,7 +95,19 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  if (use_restart_key_prefixes_ &&
+      restart_key_prefixes_.size() == restarts_.size()) {
+    for (uint64_t prefix : restart_key_prefixes_) {
+      PutFixed64(&buffer_, prefix);
+    }
+    num_restarts |= kRestartKeyPrefixesFlag;
+  }
+  if (data_block_hash_index_builder_.Valid()) {
+    data_block_hash_index_builder_.Finish(&buffer_);
+    num_restarts |= kDataBlockHashIndexFlag;
+  }
+  PutFixed32(&buffer_, num_restarts);
   finished_ = true;
   return Slice(buffer_);
 }
@@ -112,6 +137,11 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
     last_key_.assign(key.data(), key.size());
   }
 
+  if (use_restart_key_prefixes_ && counter_ == 0) {
+    restart_key_prefixes_.push_back(RestartKeyPrefix(ExtractUserKey(key)));
+    estimate_ += sizeof(uint64_t);
+  }
+
   const size_t non_shared = key.size() - shared;
   const size_t curr_size = buffer_.size();
 
@@ -124,6 +154,11 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   buffer_.append(key.data() + shared, non_shared);
   buffer_.append(value.data(), value.size());
 
+  if (data_block_hash_index_builder_.Valid()) {
+    data_block_hash_index_builder_.Add(ExtractUserKey(key),
+                                       restarts_.size() - 1);
+  }
+
   counter_++;
   estimate_ += buffer_.size() - curr_size;
 }
@@ -12,6 +12,9 @@
 
 #include <stdint.h>
 #include "rocksdb/slice.h"
+#include "rocksdb/table.h"
+#include "table/data_block_hash_index.h"
+#include "table/restart_key_prefixes.h"
 
 namespace rocksdb {
 
@@ -20,8 +23,16 @@ class BlockBuilder {
   BlockBuilder(const BlockBuilder&) = delete;
   void operator=(const BlockBuilder&) = delete;
 
+  // If index_type is kDataBlockBinaryAndHash, the keys must be internal keys
+  // and the block is finished with a hash index of their user keys. So is it
+  // if use_restart_key_prefixes is true, for the prefixes of the user keys at
+  // the restart points.
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        BlockBasedTableOptions::DataBlockIndexType index_type =
+                            BlockBasedTableOptions::kDataBlockBinarySearch,
+                        double data_block_hash_table_util_ratio = 0.75,
+                        bool use_restart_key_prefixes = false);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -37,7 +48,9 @@ class BlockBuilder {
 
   // Returns an estimate of the current (uncompressed) size of the block
   // we are building.
-  inline size_t CurrentSizeEstimate() const { return estimate_; }
+  inline size_t CurrentSizeEstimate() const {
+    return estimate_ + data_block_hash_index_builder_.EstimateSize();
+  }
 
   // Returns an estimated block size after appending key and value.
   size_t EstimateSizeAfterKV(const Slice& key, const Slice& value) const;
@@ -50,13 +63,17 @@ class BlockBuilder {
  private:
   const int          block_restart_interval_;
   const bool         use_delta_encoding_;
+  const bool         use_restart_key_prefixes_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  // RestartKeyPrefix() of the user key at each restart point
+  std::vector<uint64_t> restart_key_prefixes_;
   size_t                estimate_;
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
   std::string           last_key_;
+  DataBlockHashIndexBuilder data_block_hash_index_builder_;
 };
 
 }  // namespace rocksdb
@@ -4,6 +4,7 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 //
 #include <stdio.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -18,6 +19,7 @@
 #include "table/block.h"
 #include "table/block_builder.h"
 #include "table/format.h"
+#include "table/restart_key_prefixes.h"
 #include "util/random.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
@@ -216,6 +218,194 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+TEST_F(BlockTest, DataBlockHashIndex) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  Random rnd(301);
+
+  // Only the even user keys are in the block, with up to 3 versions each.
+  const int kNumUserKeys = 400;
+  std::vector<std::string> keys;
+  for (int i = 0; i < kNumUserKeys; i += 2) {
+    char user_key[20];
+    snprintf(user_key, sizeof(user_key), "key%06d", i);
+    SequenceNumber seq = 100;
+    for (int v = rnd.Uniform(3); v >= 0; v--) {
+      keys.push_back(InternalKey(user_key, seq, kTypeValue).Encode().ToString());
+      seq -= 1 + rnd.Uniform(10);
+    }
+  }
+
+  BlockBuilder builder(4 /* block_restart_interval */,
+                       true /* use_delta_encoding */,
+                       BlockBasedTableOptions::kDataBlockBinaryAndHash);
+  for (const auto& key : keys) {
+    builder.Add(key, "value");
+  }
+  Slice rawblock = builder.Finish();
+  ASSERT_TRUE(DecodeFixed32(rawblock.data() + rawblock.size() -
+                            sizeof(uint32_t)) &
+              kDataBlockHashIndexFlag);
+
+  BlockContents contents;
+  contents.data = rawblock;
+  contents.cachable = false;
+  Block reader(std::move(contents));
+  ASSERT_GT(reader.size(), 0U);
+
+  std::unique_ptr<InternalIterator> seek_iter(reader.NewIterator(&icmp));
+  std::unique_ptr<InternalIterator> get_iter(reader.NewIterator(&icmp));
+  BlockIter* get_biter = static_cast<BlockIter*>(get_iter.get());
+  for (int i = 0; i <= kNumUserKeys; i++) {
+    char user_key[20];
+    snprintf(user_key, sizeof(user_key), "key%06d", i);
+    for (SequenceNumber seq : {kMaxSequenceNumber, SequenceNumber{95},
+                               SequenceNumber{50}}) {
+      InternalKey target(user_key, seq, kTypeValue);
+      seek_iter->Seek(target.Encode());
+      if (get_biter->SeekForGet(target.Encode())) {
+        ASSERT_EQ(seek_iter->Valid(), get_iter->Valid());
+        if (seek_iter->Valid()) {
+          ASSERT_EQ(seek_iter->key().ToString(), get_iter->key().ToString());
+        }
+      } else {
+        // No version of the key is old enough for seq, and a greater key
+        // ends the lookup.
+        ASSERT_TRUE(seek_iter->Valid());
+        ASSERT_NE(user_key, ExtractUserKey(seek_iter->key()).ToString());
+      }
+    }
+  }
+
+  // A block with too many restart intervals is built without the hash index.
+  builder.Reset();
+  for (int i = 0; i < 300; i++) {
+    char user_key[20];
+    snprintf(user_key, sizeof(user_key), "key%06d", i);
+    for (int j = 0; j < 4; j++) {
+      builder.Add(InternalKey(user_key, 100 - j, kTypeValue).Encode(), "value");
+    }
+  }
+  rawblock = builder.Finish();
+  ASSERT_FALSE(DecodeFixed32(rawblock.data() + rawblock.size() -
+                             sizeof(uint32_t)) &
+               kDataBlockHashIndexFlag);
+  BlockContents large_contents;
+  large_contents.data = rawblock;
+  large_contents.cachable = false;
+  Block large_reader(std::move(large_contents));
+  std::unique_ptr<InternalIterator> large_iter(
+      large_reader.NewIterator(&icmp));
+  InternalKey target("key000123", 98, kTypeValue);
+  ASSERT_TRUE(static_cast<BlockIter*>(large_iter.get())
+                  ->SeekForGet(target.Encode()));
+  ASSERT_TRUE(large_iter->Valid());
+  ASSERT_EQ(target.Encode().ToString(), large_iter->key().ToString());
+}
+
+TEST_F(BlockTest, RestartKeyPrefix) {
+  ASSERT_EQ(0x6162000000000000ULL, RestartKeyPrefix("ab"));
+  ASSERT_EQ(0x0102030405060708ULL,
+            RestartKeyPrefix("\x01\x02\x03\x04\x05\x06\x07\x08\x09"));
+  ASSERT_LT(RestartKeyPrefix("a"), RestartKeyPrefix("a\x01"));
+  ASSERT_LT(RestartKeyPrefix("\x7f"), RestartKeyPrefix("\x80"));
+
+  Random rnd(301);
+  for (int iter = 0; iter < 1000; iter++) {
+    // Few distinct values, with and without the sign bit, so that there are
+    // runs of equal prefixes.
+    std::vector<uint64_t> values(1 + rnd.Uniform(200));
+    for (auto& value : values) {
+      value = rnd.Uniform(8) + (rnd.OneIn(2) ? (1ULL << 63) : 0);
+    }
+    std::sort(values.begin(), values.end());
+    std::string prefixes;
+    for (uint64_t value : values) {
+      PutFixed64(&prefixes, value);
+    }
+
+    uint32_t left = rnd.Uniform(static_cast<int>(values.size()));
+    uint32_t right =
+        left + rnd.Uniform(static_cast<int>(values.size() - left));
+    uint64_t target = rnd.Uniform(9) + (rnd.OneIn(2) ? (1ULL << 63) : 0);
+    uint32_t lower, upper;
+    FindRestartKeyPrefixRange(prefixes.data(), left, right, target, &lower,
+                              &upper);
+    auto begin = values.begin() + left;
+    auto end = values.begin() + right + 1;
+    ASSERT_EQ(
+        static_cast<uint32_t>(std::lower_bound(begin, end, target) -
+                              values.begin()),
+        lower);
+    ASSERT_EQ(
+        static_cast<uint32_t>(std::upper_bound(begin, end, target) -
+                              values.begin()),
+        upper);
+  }
+}
+
+TEST_F(BlockTest, RestartKeyPrefixSeek) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  Random rnd(301);
+
+  // User keys of 1 to 12 bytes from a small alphabet, so that many of them
+  // are shorter than a prefix or share one.
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 2000; i++) {
+    std::string user_key;
+    for (int j = rnd.Uniform(12); j >= 0; j--) {
+      user_key.push_back(static_cast<char>('a' + rnd.Uniform(3)));
+    }
+    user_keys.push_back(user_key);
+  }
+  std::sort(user_keys.begin(), user_keys.end());
+  user_keys.erase(std::unique(user_keys.begin(), user_keys.end()),
+                  user_keys.end());
+
+  BlockBuilder plain_builder(4 /* block_restart_interval */);
+  BlockBuilder prefix_builder(4 /* block_restart_interval */,
+                              true /* use_delta_encoding */,
+                              BlockBasedTableOptions::kDataBlockBinarySearch,
+                              0.75 /* data_block_hash_table_util_ratio */,
+                              true /* use_restart_key_prefixes */);
+  for (size_t i = 0; i < user_keys.size(); i += 2) {
+    InternalKey key(user_keys[i], 100, kTypeValue);
+    plain_builder.Add(key.Encode(), "value");
+    prefix_builder.Add(key.Encode(), "value");
+  }
+  Slice rawblock = prefix_builder.Finish();
+  ASSERT_TRUE(DecodeFixed32(rawblock.data() + rawblock.size() -
+                            sizeof(uint32_t)) &
+              kRestartKeyPrefixesFlag);
+
+  BlockContents plain_contents;
+  plain_contents.data = plain_builder.Finish();
+  plain_contents.cachable = false;
+  Block plain_reader(std::move(plain_contents));
+  BlockContents prefix_contents;
+  prefix_contents.data = rawblock;
+  prefix_contents.cachable = false;
+  Block prefix_reader(std::move(prefix_contents));
+  ASSERT_EQ(plain_reader.NumRestarts(), prefix_reader.NumRestarts());
+
+  std::unique_ptr<InternalIterator> plain_iter(
+      plain_reader.NewIterator(&icmp));
+  std::unique_ptr<InternalIterator> prefix_iter(
+      prefix_reader.NewIterator(&icmp));
+  // Half of the user keys are missing from the blocks.
+  for (const auto& user_key : user_keys) {
+    for (SequenceNumber seq : {SequenceNumber{200}, SequenceNumber{50}}) {
+      InternalKey target(user_key, seq, kTypeValue);
+      plain_iter->Seek(target.Encode());
+      prefix_iter->Seek(target.Encode());
+      ASSERT_EQ(plain_iter->Valid(), prefix_iter->Valid());
+      if (plain_iter->Valid()) {
+        ASSERT_EQ(plain_iter->key().ToString(),
+                  prefix_iter->key().ToString());
+      }
+    }
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char **argv) {
@@ -0,0 +1,87 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/data_block_hash_index.h"
+
+#include <assert.h>
+
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+void DataBlockHashIndexBuilder::Add(const Slice& user_key,
+                                    size_t restart_index) {
+  assert(Valid());
+  if (restart_index > kMaxRestartSupportedByHashIndex) {
+    valid_ = false;
+    return;
+  }
+  std::pair<uint32_t, uint8_t> entry(GetSliceHash(user_key),
+                                     static_cast<uint8_t>(restart_index));
+  // Versions of the same user key follow each other.
+  if (hash_and_restart_pairs_.empty() ||
+      hash_and_restart_pairs_.back() != entry) {
+    hash_and_restart_pairs_.push_back(entry);
+  }
+}
+
+uint32_t DataBlockHashIndexBuilder::NumBuckets() const {
+  uint32_t num_buckets = static_cast<uint32_t>(
+      static_cast<double>(hash_and_restart_pairs_.size()) / util_ratio_);
+  // An odd number of buckets spreads the hash values better.
+  return num_buckets | 1;
+}
+
+size_t DataBlockHashIndexBuilder::EstimateSize() const {
+  if (!Valid()) {
+    return 0;
+  }
+  return NumBuckets() + sizeof(uint32_t);
+}
+
+void DataBlockHashIndexBuilder::Finish(std::string* buffer) {
+  assert(Valid());
+  const uint32_t num_buckets = NumBuckets();
+  std::vector<uint8_t> buckets(num_buckets, kNoEntry);
+  for (const auto& entry : hash_and_restart_pairs_) {
+    uint8_t& bucket = buckets[entry.first % num_buckets];
+    if (bucket == kNoEntry) {
+      bucket = entry.second;
+    } else if (bucket != entry.second) {
+      bucket = kCollision;
+    }
+  }
+  buffer->append(reinterpret_cast<const char*>(buckets.data()), num_buckets);
+  PutFixed32(buffer, num_buckets);
+}
+
+void DataBlockHashIndexBuilder::Reset() {
+  valid_ = util_ratio_ > 0;
+  hash_and_restart_pairs_.clear();
+}
+
+bool DataBlockHashIndex::Initialize(const char* data, uint32_t map_end,
+                                    uint32_t* map_offset) {
+  if (map_end < sizeof(uint32_t)) {
+    return false;
+  }
+  uint32_t num_buckets = DecodeFixed32(data + map_end - sizeof(uint32_t));
+  if (num_buckets == 0 || num_buckets > map_end - sizeof(uint32_t)) {
+    return false;
+  }
+  *map_offset = map_end - static_cast<uint32_t>(sizeof(uint32_t)) -
+                num_buckets;
+  num_buckets_ = num_buckets;
+  buckets_ = reinterpret_cast<const uint8_t*>(data + *map_offset);
+  return true;
+}
+
+uint8_t DataBlockHashIndex::Lookup(const Slice& user_key) const {
+  assert(Valid());
+  return buckets_[GetSliceHash(user_key) % num_buckets_];
+}
+
+}  // namespace rocksdb
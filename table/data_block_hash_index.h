@@ -0,0 +1,90 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// A data block built with BlockBasedTableOptions::kDataBlockBinaryAndHash
+// carries a small hash map from user keys to the restart interval holding
+// them, so that a point lookup can go straight to that interval instead of
+// binary searching the restart array:
+//
+//    entries
+//    restarts: uint32[num_restarts]
+//    buckets: uint8[num_buckets]
+//    num_buckets: uint32
+//    num_restarts | kDataBlockHashIndexFlag: uint32
+//
+// Each bucket holds the restart index of the user keys hashed to it,
+// kNoEntry if there are none, or kCollision if they are in more than one
+// restart interval. Blocks with more than kMaxRestartSupportedByHashIndex
+// restart intervals are written without the map.
+const uint32_t kDataBlockHashIndexFlag = 1u << 31;
+const uint8_t kNoEntry = 255;
+const uint8_t kCollision = 254;
+const uint8_t kMaxRestartSupportedByHashIndex = 253;
+
+class DataBlockHashIndexBuilder {
+ public:
+  DataBlockHashIndexBuilder() : util_ratio_(0), valid_(false) {}
+
+  // Enable the builder. util_ratio is the targeted number of user keys per
+  // bucket.
+  void Initialize(double util_ratio) {
+    util_ratio_ = util_ratio;
+    valid_ = util_ratio > 0;
+  }
+
+  // Returns true if the map is enabled and can still be appended to the block
+  // being built.
+  bool Valid() const { return valid_; }
+
+  void Add(const Slice& user_key, size_t restart_index);
+
+  // Append the buckets and their count to buffer.
+  void Finish(std::string* buffer);
+
+  // Size Finish() would append to the block.
+  size_t EstimateSize() const;
+
+  void Reset();
+
+ private:
+  uint32_t NumBuckets() const;
+
+  double util_ratio_;
+  bool valid_;
+  std::vector<std::pair<uint32_t, uint8_t>> hash_and_restart_pairs_;
+};
+
+// Read side of the map: points into the contents of the block.
+class DataBlockHashIndex {
+ public:
+  DataBlockHashIndex() : num_buckets_(0), buckets_(nullptr) {}
+
+  // Parse the map that ends just before the block footer at map_end.
+  // Returns false if the map doesn't fit in the block; otherwise stores the
+  // offset where the map starts, i.e. the end of the restart array, in
+  // *map_offset.
+  bool Initialize(const char* data, uint32_t map_end, uint32_t* map_offset);
+
+  // Returns the restart index of user_key, kNoEntry or kCollision.
+  uint8_t Lookup(const Slice& user_key) const;
+
+  bool Valid() const { return buckets_ != nullptr; }
+
+ private:
+  uint32_t num_buckets_;
+  const uint8_t* buckets_;
+};
+
+}  // namespace rocksdb
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <assert.h>
 #include <memory>
 #include <stddef.h>
 #include <stdint.h>
@@ -26,6 +27,7 @@
 #include "rocksdb/options.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/status.h"
 #include "rocksdb/table.h"
 #include "util/hash.h"
 #include "format.h"
@@ -51,7 +53,18 @@ class FilterBlockBuilder {
   virtual bool IsBlockBased() = 0;                    // If is blockbased filter
   virtual void StartBlock(uint64_t block_offset) = 0;  // Start new block filter
   virtual void Add(const Slice& key) = 0;      // Add a key to current filter
-  virtual Slice Finish() = 0;                     // Generate Filter
+  Slice Finish() {                             // Generate Filter
+    const BlockHandle empty_handle;
+    Status dont_care_status;
+    auto ret = Finish(empty_handle, &dont_care_status);
+    assert(dont_care_status.ok());
+    return ret;
+  }
+  // A filter that is stored in several blocks returns them one at a time:
+  // *status is Incomplete() while more blocks follow, and the caller passes
+  // the handle of the block it has just written to the next call. The last
+  // block is returned with an OK status.
+  virtual Slice Finish(const BlockHandle& tmp, Status* status) = 0;
 
  private:
   // No copying allowed
@@ -75,10 +88,17 @@ class FilterBlockReader {
   virtual ~FilterBlockReader() {}
 
   virtual bool IsBlockBased() = 0;  // If is blockbased filter
-  virtual bool KeyMayMatch(const Slice& key,
-                           uint64_t block_offset = kNotValid) = 0;
+  // If no_io is set, the filter must not do any I/O; a partitioned filter
+  // whose partition is not in the block cache then returns true.
+  // const_ikey_ptr is the internal key that `key` (or `prefix`) is taken
+  // from; a partitioned filter needs it to find the partition to probe.
+  virtual bool KeyMayMatch(const Slice& key, uint64_t block_offset = kNotValid,
+                           const bool no_io = false,
+                           const Slice* const const_ikey_ptr = nullptr) = 0;
   virtual bool PrefixMayMatch(const Slice& prefix,
-                              uint64_t block_offset = kNotValid) = 0;
+                              uint64_t block_offset = kNotValid,
+                              const bool no_io = false,
+                              const Slice* const const_ikey_ptr = nullptr) = 0;
   virtual size_t ApproximateMemoryUsage() const = 0;
   virtual size_t size() const { return size_; }
   virtual Statistics* statistics() const { return statistics_; }
@@ -15,9 +15,9 @@ namespace rocksdb {
 FullFilterBlockBuilder::FullFilterBlockBuilder(
     const SliceTransform* prefix_extractor, bool whole_key_filtering,
     FilterBitsBuilder* filter_bits_builder)
-    : prefix_extractor_(prefix_extractor),
-      whole_key_filtering_(whole_key_filtering),
-      num_added_(0) {
+    : num_added_(0),
+      prefix_extractor_(prefix_extractor),
+      whole_key_filtering_(whole_key_filtering) {
   assert(filter_bits_builder != nullptr);
   filter_bits_builder_.reset(filter_bits_builder);
 }
@@ -44,7 +44,10 @@ inline void FullFilterBlockBuilder::AddPrefix(const Slice& key) {
   num_added_++;
 }
 
-Slice FullFilterBlockBuilder::Finish() {
+Slice FullFilterBlockBuilder::Finish(const BlockHandle& tmp,
+                                     Status* status) {
+  // In this impl we ignore BlockHandle
+  *status = Status::OK();
   if (num_added_ != 0) {
     num_added_ = 0;
     return filter_bits_builder_->Finish(&filter_data_);
@@ -72,8 +75,9 @@ FullFilterBlockReader::FullFilterBlockReader(
   block_contents_ = std::move(contents);
 }
 
-bool FullFilterBlockReader::KeyMayMatch(const Slice& key,
-    uint64_t block_offset) {
+bool FullFilterBlockReader::KeyMayMatch(
+    const Slice& key, uint64_t block_offset, const bool no_io,
+    const Slice* const const_ikey_ptr) {
   assert(block_offset == kNotValid);
   if (!whole_key_filtering_) {
     return true;
@@ -81,8 +85,9 @@ bool FullFilterBlockReader::KeyMayMatch(const Slice& key,
   return MayMatch(key);
 }
 
-bool FullFilterBlockReader::PrefixMayMatch(const Slice& prefix,
-                                           uint64_t block_offset) {
+bool FullFilterBlockReader::PrefixMayMatch(
+    const Slice& prefix, uint64_t block_offset, const bool no_io,
+    const Slice* const const_ikey_ptr) {
   assert(block_offset == kNotValid);
   if (!prefix_extractor_) {
     return true;
@@ -6,6 +6,7 @@
 #include "table/get_context.h"
 #include "db/merge_helper.h"
 #include "db/pinned_iterators_manager.h"
+#include "db/range_del_aggregator.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/statistics.h"
@@ -38,7 +39,8 @@ GetContext::GetContext(const Comparator* ucmp,
                        const Slice& user_key, std::string* ret_value,
                        bool* value_found, MergeContext* merge_context, Env* env,
                        SequenceNumber* seq,
-                       PinnedIteratorsManager* _pinned_iters_mgr)
+                       PinnedIteratorsManager* _pinned_iters_mgr,
+                       RangeDelAggregator* range_del_agg)
     : ucmp_(ucmp),
       merge_operator_(merge_operator),
       logger_(logger),
@@ -50,6 +52,7 @@ GetContext::GetContext(const Comparator* ucmp,
       merge_context_(merge_context),
       env_(env),
       seq_(seq),
+      range_del_agg_(range_del_agg),
       replay_log_(nullptr),
       pinned_iters_mgr_(_pinned_iters_mgr) {
   if (seq_) {
@@ -84,7 +87,14 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
   assert((state_ != kMerge && parsed_key.type != kTypeMerge) ||
          merge_context_ != nullptr);
   if (ucmp_->Equal(parsed_key.user_key, user_key_)) {
-    appendToReplayLog(replay_log_, parsed_key.type, value);
+    auto type = parsed_key.type;
+    if ((type == kTypeValue || type == kTypeMerge) &&
+        range_del_agg_ != nullptr && range_del_agg_->ShouldDelete(parsed_key)) {
+      type = kTypeRangeDeletion;
+    }
+    // The replay log records the outcome after applying the range tombstones,
+    // since the sequence numbers needed to apply them again are not kept.
+    appendToReplayLog(replay_log_, type, value);
 
     if (seq_ != nullptr) {
       // Set the sequence number if it is uninitialized
@@ -94,7 +104,7 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
     }
 
     // Key matches. Process it
-    switch (parsed_key.type) {
+    switch (type) {
       case kTypeValue:
         assert(state_ == kNotFound || state_ == kMerge);
         if (kNotFound == state_) {
@@ -119,6 +129,7 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
 
       case kTypeDeletion:
       case kTypeSingleDeletion:
+      case kTypeRangeDeletion:
         // TODO(noetzli): Verify correctness once merge of single-deletes
         // is supported
         assert(state_ == kNotFound || state_ == kMerge);
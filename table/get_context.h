@@ -12,6 +12,7 @@
 namespace rocksdb {
 class MergeContext;
 class PinnedIteratorsManager;
+class RangeDelAggregator;
 
 class GetContext {
  public:
@@ -28,12 +29,14 @@ class GetContext {
              const Slice& user_key, std::string* ret_value, bool* value_found,
              MergeContext* merge_context, Env* env,
              SequenceNumber* seq = nullptr,
-             PinnedIteratorsManager* _pinned_iters_mgr = nullptr);
+             PinnedIteratorsManager* _pinned_iters_mgr = nullptr,
+             RangeDelAggregator* range_del_agg = nullptr);
 
   void MarkKeyMayExist();
 
   // Records this key, value, and any meta-data (such as sequence number and
-  // state) into this GetContext.
+  // state) into this GetContext. A value or merge operand covered by a range
+  // tombstone of range_del_agg() is recorded as a deletion.
   //
   // Returns True if more keys need to be read (due to merges) or
   //         False if the complete value has been found.
@@ -48,6 +51,11 @@ class GetContext {
 
   PinnedIteratorsManager* pinned_iters_mgr() { return pinned_iters_mgr_; }
 
+  // The range tombstones that apply to this lookup, or nullptr if range
+  // deletions are ignored. The tables consulted by the lookup add their
+  // tombstones to it before their keys are saved.
+  RangeDelAggregator* range_del_agg() { return range_del_agg_; }
+
   // If a non-null string is passed, all the SaveValue calls will be
   // logged into the string. The operations can then be replayed on
   // another GetContext with replayGetContextLog.
@@ -72,6 +80,7 @@ class GetContext {
   // If a key is found, seq_ will be set to the SequenceNumber of most recent
   // write to the key or kMaxSequenceNumber if unknown
   SequenceNumber* seq_;
+  RangeDelAggregator* range_del_agg_;
   std::string* replay_log_;
   // Used to temporarily pin blocks when state_ == GetContext::kMerge
   PinnedIteratorsManager* pinned_iters_mgr_;
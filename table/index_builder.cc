@@ -0,0 +1,81 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include "table/index_builder.h"
+
+#include <string>
+#include <utility>
+
+namespace rocksdb {
+
+PartitionedIndexBuilder::PartitionedIndexBuilder(
+    const Comparator* comparator, const BlockBasedTableOptions& table_opt)
+    : IndexBuilder(comparator),
+      index_block_builder_(table_opt.index_block_restart_interval),
+      table_opt_(table_opt) {}
+
+void PartitionedIndexBuilder::AddIndexEntry(
+    std::string* last_key_in_current_block,
+    const Slice* first_key_in_next_block, const BlockHandle& block_handle) {
+  if (sub_index_builder_ == nullptr) {
+    sub_index_builder_.reset(new ShortenedIndexBuilder(
+        comparator_, table_opt_.index_block_restart_interval));
+  }
+  sub_index_builder_->AddIndexEntry(last_key_in_current_block,
+                                    first_key_in_next_block, block_handle);
+  // last_key_in_current_block now holds the substitute key, which is >= all
+  // the keys of this partition and < all the keys of the next one.
+  if (first_key_in_next_block == nullptr ||
+      sub_index_builder_->EstimatedSize() >= table_opt_.block_size) {
+    CutPartition(*last_key_in_current_block);
+  }
+}
+
+void PartitionedIndexBuilder::CutPartition(const std::string& last_key) {
+  estimated_size_ += sub_index_builder_->EstimatedSize() + kBlockTrailerSize +
+                     last_key.size() + BlockHandle::kMaxEncodedLength;
+  entries_.push_back({last_key, std::move(sub_index_builder_)});
+  partition_key_ = last_key;
+  cut_filter_block_ = true;
+}
+
+Status PartitionedIndexBuilder::Finish(
+    IndexBlocks* index_blocks, const BlockHandle& last_partition_block_handle) {
+  assert(sub_index_builder_ == nullptr);
+  if (finishing_partitions_) {
+    // The front partition was written by the caller: add it to the top-level
+    // index.
+    assert(!entries_.empty());
+    std::string handle_encoding;
+    last_partition_block_handle.EncodeTo(&handle_encoding);
+    index_block_builder_.Add(entries_.front().key, handle_encoding);
+    entries_.pop_front();
+  }
+  if (entries_.empty()) {
+    index_blocks->index_block_contents = index_block_builder_.Finish();
+    return Status::OK();
+  }
+  finishing_partitions_ = true;
+  // The contents stay valid until the entry is popped on the next call.
+  Status s = entries_.front().value->Finish(index_blocks);
+  if (!s.ok()) {
+    return s;
+  }
+  return Status::Incomplete();
+}
+
+size_t PartitionedIndexBuilder::EstimatedSize() const {
+  size_t size = estimated_size_;
+  if (sub_index_builder_ != nullptr) {
+    size += sub_index_builder_->EstimatedSize();
+  }
+  return size;
+}
+
+}  // namespace rocksdb
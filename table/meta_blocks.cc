@@ -93,6 +93,13 @@ void PropertyBlockBuilder::AddTableProperty(const TableProperties& props) {
   if (!props.compression_name.empty()) {
     Add(TablePropertiesNames::kCompression, props.compression_name);
   }
+  if (props.compression_dict_size > 0) {
+    Add(TablePropertiesNames::kCompressionDictSize,
+        props.compression_dict_size);
+  }
+  if (props.creation_time > 0) {
+    Add(TablePropertiesNames::kCreationTime, props.creation_time);
+  }
 }
 
 Slice PropertyBlockBuilder::Finish() {
@@ -193,6 +200,10 @@ Status ReadProperties(const Slice& handle_value, RandomAccessFileReader* file,
        &new_table_properties->fixed_key_len},
       {TablePropertiesNames::kColumnFamilyId,
        &new_table_properties->column_family_id},
+      {TablePropertiesNames::kCompressionDictSize,
+       &new_table_properties->compression_dict_size},
+      {TablePropertiesNames::kCreationTime,
+       &new_table_properties->creation_time},
   };
 
   std::string last_key;
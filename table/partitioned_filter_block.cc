@@ -0,0 +1,173 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/partitioned_filter_block.h"
+
+#include <utility>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/filter_policy.h"
+#include "table/block.h"
+#include "table/block_based_table_reader.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+PartitionedFilterBlockBuilder::PartitionedFilterBlockBuilder(
+    const SliceTransform* prefix_extractor, bool whole_key_filtering,
+    FilterBitsBuilder* filter_bits_builder, int index_block_restart_interval,
+    PartitionedIndexBuilder* const p_index_builder)
+    : FullFilterBlockBuilder(prefix_extractor, whole_key_filtering,
+                             filter_bits_builder),
+      index_on_filter_block_builder_(index_block_restart_interval),
+      p_index_builder_(p_index_builder) {}
+
+void PartitionedFilterBlockBuilder::Add(const Slice& key) {
+  if (p_index_builder_->ShouldCutFilterBlock()) {
+    // key is the first key of a new index partition.
+    CutAFilterBlock();
+  }
+  FullFilterBlockBuilder::Add(key);
+}
+
+void PartitionedFilterBlockBuilder::CutAFilterBlock() {
+  FilterEntry entry;
+  entry.key = p_index_builder_->GetPartitionKey();
+  entry.filter = filter_bits_builder_->Finish(&entry.data);
+  filters_.push_back(std::move(entry));
+  num_added_ = 0;
+}
+
+Slice PartitionedFilterBlockBuilder::Finish(
+    const BlockHandle& last_partition_block_handle, Status* status) {
+  if (finishing_filters_) {
+    // The front partition was written by the caller: add it to the top-level
+    // block.
+    assert(!filters_.empty());
+    std::string handle_encoding;
+    last_partition_block_handle.EncodeTo(&handle_encoding);
+    index_on_filter_block_builder_.Add(filters_.front().key, handle_encoding);
+    filters_.pop_front();
+  } else if (p_index_builder_->ShouldCutFilterBlock()) {
+    // The index has cut its last partition.
+    CutAFilterBlock();
+  }
+  if (filters_.empty()) {
+    *status = Status::OK();
+    return index_on_filter_block_builder_.Finish();
+  }
+  // The contents stay valid until the entry is popped on the next call.
+  finishing_filters_ = true;
+  *status = Status::Incomplete();
+  return filters_.front().filter;
+}
+
+PartitionedFilterBlockReader::PartitionedFilterBlockReader(
+    const SliceTransform* prefix_extractor, bool _whole_key_filtering,
+    BlockContents&& contents, const BlockBasedTable* table,
+    const InternalKeyComparator* comparator, Statistics* stats,
+    Cache* block_cache, const Slice& cache_key_prefix)
+    : FilterBlockReader(contents.data.size(), stats, _whole_key_filtering),
+      prefix_extractor_(prefix_extractor),
+      comparator_(comparator),
+      table_(table),
+      block_cache_(block_cache),
+      cache_key_prefix_(cache_key_prefix.ToString()) {
+  idx_on_fltr_blk_.reset(new Block(std::move(contents)));
+}
+
+PartitionedFilterBlockReader::~PartitionedFilterBlockReader() {
+  // The partitions reference the options of the table, so they must not
+  // outlive it in the cache.
+  if (block_cache_ == nullptr || cache_key_prefix_.empty()) {
+    return;
+  }
+  char cache_key[BlockBasedTable::kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  BlockIter biter;
+  idx_on_fltr_blk_->NewIterator(comparator_, &biter, true);
+  for (biter.SeekToFirst(); biter.Valid(); biter.Next()) {
+    Slice input = biter.value();
+    BlockHandle handle;
+    if (!handle.DecodeFrom(&input).ok()) {
+      continue;
+    }
+    auto key = BlockBasedTable::GetCacheKey(
+        cache_key_prefix_.data(), cache_key_prefix_.size(), handle, cache_key);
+    block_cache_->Erase(key);
+  }
+}
+
+bool PartitionedFilterBlockReader::KeyMayMatch(
+    const Slice& key, uint64_t block_offset, const bool no_io,
+    const Slice* const const_ikey_ptr) {
+  assert(const_ikey_ptr != nullptr);
+  assert(block_offset == kNotValid);
+  if (!whole_key_filtering_) {
+    return true;
+  }
+  return MayMatch(key, *const_ikey_ptr, false /* is_prefix */, no_io);
+}
+
+bool PartitionedFilterBlockReader::PrefixMayMatch(
+    const Slice& prefix, uint64_t block_offset, const bool no_io,
+    const Slice* const const_ikey_ptr) {
+  assert(const_ikey_ptr != nullptr);
+  assert(block_offset == kNotValid);
+  if (!prefix_extractor_) {
+    return true;
+  }
+  return MayMatch(prefix, *const_ikey_ptr, true /* is_prefix */, no_io);
+}
+
+bool PartitionedFilterBlockReader::MayMatch(const Slice& entry,
+                                            const Slice& internal_key,
+                                            bool is_prefix, bool no_io) {
+  if (size() == 0) {
+    return true;
+  }
+  BlockIter iter;
+  idx_on_fltr_blk_->NewIterator(comparator_, &iter, true);
+  iter.Seek(internal_key);
+  if (!iter.Valid()) {
+    // Past the last partition the table has no keys, unless the top-level
+    // block is corrupted.
+    return !iter.status().ok();
+  }
+  Slice handle_value = iter.value();
+  BlockHandle handle;
+  if (!handle.DecodeFrom(&handle_value).ok()) {
+    return true;
+  }
+  if (block_cache_ == nullptr) {
+    // Without a block cache, the partition is read for this lookup only.
+    if (no_io) {
+      return true;
+    }
+    std::unique_ptr<FilterBlockReader> filter_partition(
+        table_->ReadFilter(handle, true /* is_a_filter_partition */));
+    if (filter_partition == nullptr) {
+      return true;
+    }
+    return is_prefix ? filter_partition->PrefixMayMatch(entry)
+                     : filter_partition->KeyMayMatch(entry);
+  }
+  auto filter_partition =
+      table_->GetFilter(handle, true /* is_a_filter_partition */, no_io);
+  if (filter_partition.value == nullptr) {
+    // The partition is not in the cache and no_io is set.
+    return true;
+  }
+  bool may_match = is_prefix ? filter_partition.value->PrefixMayMatch(entry)
+                             : filter_partition.value->KeyMayMatch(entry);
+  filter_partition.Release(block_cache_);
+  return may_match;
+}
+
+size_t PartitionedFilterBlockReader::ApproximateMemoryUsage() const {
+  return idx_on_fltr_blk_->size();
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,116 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "db/dbformat.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/slice_transform.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "table/full_filter_block.h"
+#include "table/index_builder.h"
+
+namespace rocksdb {
+
+class BlockBasedTable;
+class Cache;
+
+// A PartitionedFilterBlockBuilder builds a full filter that is cut into
+// partitions along the partitions of a two-level index: every filter
+// partition holds the keys of the data blocks that one index partition points
+// to. The filter is stored as the partitions followed by a top-level block
+// that maps the key of every index partition to the handle of its filter
+// partition.
+//
+// Like PartitionedIndexBuilder, Finish() returns the partitions one at a time
+// with Status::Incomplete() and the top-level block last with Status::OK().
+class PartitionedFilterBlockBuilder : public FullFilterBlockBuilder {
+ public:
+  explicit PartitionedFilterBlockBuilder(
+      const SliceTransform* prefix_extractor, bool whole_key_filtering,
+      FilterBitsBuilder* filter_bits_builder, int index_block_restart_interval,
+      PartitionedIndexBuilder* const p_index_builder);
+
+  virtual ~PartitionedFilterBlockBuilder() {}
+
+  virtual void Add(const Slice& key) override;
+
+  using FilterBlockBuilder::Finish;
+  virtual Slice Finish(const BlockHandle& last_partition_block_handle,
+                       Status* status) override;
+
+ private:
+  // Finishes the filter of the current partition, keyed by the key of the
+  // index partition that was cut last.
+  void CutAFilterBlock();
+
+  // Top-level block, which maps partition keys to partition handles.
+  BlockBuilder index_on_filter_block_builder_;
+  struct FilterEntry {
+    std::string key;
+    // The buffer that backs filter.
+    std::unique_ptr<const char[]> data;
+    Slice filter;
+  };
+  // Finished partitions that are not written out yet.
+  std::deque<FilterEntry> filters_;
+  // true once Finish() has returned the first partition.
+  bool finishing_filters_ = false;
+  // Tells when to cut a partition.
+  PartitionedIndexBuilder* const p_index_builder_;
+};
+
+// A PartitionedFilterBlockReader holds the top-level block of a partitioned
+// filter. A lookup seeks the top-level block with the internal key and
+// probes the one partition that may contain it. Partitions are read through
+// the block cache, where they are cached like any other filter block. Without
+// a block cache, every lookup reads its partition from the file.
+class PartitionedFilterBlockReader : public FilterBlockReader {
+ public:
+  explicit PartitionedFilterBlockReader(const SliceTransform* prefix_extractor,
+                                        bool whole_key_filtering,
+                                        BlockContents&& contents,
+                                        const BlockBasedTable* table,
+                                        const InternalKeyComparator* comparator,
+                                        Statistics* stats, Cache* block_cache,
+                                        const Slice& cache_key_prefix);
+  virtual ~PartitionedFilterBlockReader();
+
+  virtual bool IsBlockBased() override { return false; }
+  virtual bool KeyMayMatch(
+      const Slice& key, uint64_t block_offset = kNotValid,
+      const bool no_io = false,
+      const Slice* const const_ikey_ptr = nullptr) override;
+  virtual bool PrefixMayMatch(
+      const Slice& prefix, uint64_t block_offset = kNotValid,
+      const bool no_io = false,
+      const Slice* const const_ikey_ptr = nullptr) override;
+  virtual size_t ApproximateMemoryUsage() const override;
+
+ private:
+  bool MayMatch(const Slice& entry, const Slice& internal_key, bool is_prefix,
+                bool no_io);
+
+  const SliceTransform* prefix_extractor_;
+  std::unique_ptr<Block> idx_on_fltr_blk_;
+  const InternalKeyComparator* comparator_;
+  const BlockBasedTable* table_;
+  // The partitions are erased from block_cache_ when this reader goes away,
+  // which may be after table_ is closed, so what that needs is kept here.
+  Cache* block_cache_;
+  std::string cache_key_prefix_;
+
+  // No copying allowed
+  PartitionedFilterBlockReader(const PartitionedFilterBlockReader&);
+  void operator=(const PartitionedFilterBlockReader&);
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,160 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/restart_key_prefixes.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#elif defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+#include <assert.h>
+#include <algorithm>
+#include <limits>
+
+#include "port/port.h"
+#include "util/coding.h"
+
+namespace rocksdb {
+
+uint64_t RestartKeyPrefix(const Slice& user_key) {
+  const size_t n = std::min(user_key.size(), sizeof(uint64_t));
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    prefix <<= 8;
+    if (i < n) {
+      prefix |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return prefix;
+}
+
+namespace {
+// The binary search stops once it is down to this many prefixes, which are
+// then compared all at once.
+const uint32_t kScanWindow = 8;
+
+inline uint64_t PrefixAt(const char* prefixes, uint32_t i) {
+  return DecodeFixed64(prefixes + i * sizeof(uint64_t));
+}
+
+#if defined(__AVX2__) || defined(__SSE4_2__)
+inline uint32_t CountBits(int mask) {
+  uint32_t count = 0;
+  for (; mask != 0; mask &= mask - 1) {
+    count++;
+  }
+  return count;
+}
+#endif
+
+// Sets *num_less and *num_not_greater to the number of prefixes in
+// prefixes[begin..end) that are < target and <= target.
+void CountPrefixes(const char* prefixes, uint32_t begin, uint32_t end,
+                   uint64_t target, uint32_t* num_less,
+                   uint32_t* num_not_greater) {
+  uint32_t i = begin;
+  *num_less = 0;
+  *num_not_greater = 0;
+
+  // The vector instructions compare signed integers: flipping the sign bits
+  // makes them order the prefixes as unsigned integers. The prefixes are
+  // loaded as they are stored, which needs a little-endian machine.
+#if defined(__AVX2__)
+  if (port::kLittleEndian) {
+    const __m256i sign_bits =
+        _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m256i t = _mm256_xor_si256(
+        _mm256_set1_epi64x(static_cast<int64_t>(target)), sign_bits);
+    for (; i + 4 <= end; i += 4) {
+      const __m256i v = _mm256_xor_si256(
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+              prefixes + i * sizeof(uint64_t))),
+          sign_bits);
+      const int less =
+          _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(t, v)));
+      const int greater =
+          _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, t)));
+      *num_less += CountBits(less);
+      *num_not_greater += 4 - CountBits(greater);
+    }
+  }
+#elif defined(__SSE4_2__)
+  if (port::kLittleEndian) {
+    const __m128i sign_bits =
+        _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+    const __m128i t = _mm_xor_si128(
+        _mm_set1_epi64x(static_cast<int64_t>(target)), sign_bits);
+    for (; i + 2 <= end; i += 2) {
+      const __m128i v = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+              prefixes + i * sizeof(uint64_t))),
+          sign_bits);
+      const int less = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(t, v)));
+      const int greater =
+          _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(v, t)));
+      *num_less += CountBits(less);
+      *num_not_greater += 2 - CountBits(greater);
+    }
+  }
+#endif
+
+  for (; i < end; i++) {
+    const uint64_t prefix = PrefixAt(prefixes, i);
+    if (prefix <= target) {
+      (*num_not_greater)++;
+      if (prefix < target) {
+        (*num_less)++;
+      }
+    }
+  }
+}
+}  // namespace
+
+void FindRestartKeyPrefixRange(const char* prefixes, uint32_t left,
+                               uint32_t right, uint64_t target,
+                               uint32_t* lower, uint32_t* upper) {
+  assert(left <= right);
+  const uint32_t end = right + 1;
+
+  // Binary search for a window of at most kScanWindow prefixes that holds
+  // the first one >= target, or the end of the range.
+  uint32_t begin = left;
+  uint32_t limit = end;
+  while (limit - begin > kScanWindow) {
+    const uint32_t mid = begin + (limit - begin) / 2;
+    if (PrefixAt(prefixes, mid) < target) {
+      begin = mid + 1;
+    } else {
+      limit = mid;
+    }
+  }
+  uint32_t num_less, num_not_greater;
+  CountPrefixes(prefixes, begin, limit, target, &num_less, &num_not_greater);
+  *lower = begin + num_less;
+  if (begin + num_not_greater < limit || limit == end) {
+    // The first prefix > target is in the window too, or there is none
+    *upper = begin + num_not_greater;
+    return;
+  }
+
+  // None of the prefixes of the window is greater than target: search past
+  // it for the first one that is.
+  begin = limit;
+  limit = end;
+  while (limit - begin > kScanWindow) {
+    const uint32_t mid = begin + (limit - begin) / 2;
+    if (PrefixAt(prefixes, mid) <= target) {
+      begin = mid + 1;
+    } else {
+      limit = mid;
+    }
+  }
+  CountPrefixes(prefixes, begin, limit, target, &num_less, &num_not_greater);
+  *upper = begin + num_not_greater;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,44 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+#pragma once
+
+#include <stdint.h>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// A data block built with
+// BlockBasedTableOptions::data_block_restart_key_prefixes also stores the
+// first 8 bytes of the user key of each restart point, next to the restart
+// array:
+//
+//    entries
+//    restarts: uint32[num_restarts]
+//    restart_key_prefixes: fixed64[num_restarts]
+//    (optional hash index, see table/data_block_hash_index.h)
+//    num_restarts | flags: uint32
+//
+// The prefixes are read as big-endian integers, so that comparing two of
+// them compares the bytes of the keys: a smaller prefix means a smaller key
+// under BytewiseComparator. A search of the restart points can then skip the
+// full key comparison for every restart point whose prefix differs from the
+// one of the target. The prefixes are binary searched down to a few, which
+// are compared all at once with SIMD instructions where available.
+const uint32_t kRestartKeyPrefixesFlag = 1u << 30;
+
+// Returns the first 8 bytes of user_key as a big-endian integer, padded with
+// zero bytes if the key is shorter.
+extern uint64_t RestartKeyPrefix(const Slice& user_key);
+
+// prefixes[left..right] are non-decreasing restart key prefixes. Sets
+// *lower to the first index in the range whose prefix is >= target and
+// *upper to the first one whose prefix is > target, or to right + 1 if
+// there are none.
+extern void FindRestartKeyPrefixRange(const char* prefixes, uint32_t left,
+                                      uint32_t right, uint64_t target,
+                                      uint32_t* lower, uint32_t* upper);
+
+}  // namespace rocksdb
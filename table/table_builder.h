@@ -54,7 +54,8 @@ struct TableBuilderOptions {
       CompressionType _compression_type,
       const CompressionOptions& _compression_opts,
       const std::string* _compression_dict, bool _skip_filters,
-      const std::string& _column_family_name)
+      const std::string& _column_family_name,
+      const uint64_t _creation_time = 0)
       : ioptions(_ioptions),
         internal_comparator(_internal_comparator),
         int_tbl_prop_collector_factories(_int_tbl_prop_collector_factories),
@@ -62,7 +63,8 @@ struct TableBuilderOptions {
         compression_opts(_compression_opts),
         compression_dict(_compression_dict),
         skip_filters(_skip_filters),
-        column_family_name(_column_family_name) {}
+        column_family_name(_column_family_name),
+        creation_time(_creation_time) {}
   const ImmutableCFOptions& ioptions;
   const InternalKeyComparator& internal_comparator;
   const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
@@ -73,6 +75,8 @@ struct TableBuilderOptions {
   const std::string* compression_dict;
   bool skip_filters;  // only used by BlockBasedTableBuilder
   const std::string& column_family_name;
+  // Recorded in the table properties; see TableProperties::creation_time
+  const uint64_t creation_time;
 };
 
 // TableBuilder provides the interface used to build a Table
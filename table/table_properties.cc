@@ -117,6 +117,10 @@ std::string TableProperties::ToString(
       result, "SST file compression algo",
       compression_name.empty() ? std::string("N/A") : compression_name,
       prop_delim, kv_delim);
+  AppendProperty(result, "compression dictionary size", compression_dict_size,
+                 prop_delim, kv_delim);
+  AppendProperty(result, "creation time", creation_time, prop_delim,
+                 kv_delim);
 
   return result;
 }
@@ -125,6 +129,7 @@ void TableProperties::Add(const TableProperties& tp) {
   data_size += tp.data_size;
   index_size += tp.index_size;
   filter_size += tp.filter_size;
+  compression_dict_size += tp.compression_dict_size;
   raw_key_size += tp.raw_key_size;
   raw_value_size += tp.raw_value_size;
   num_data_blocks += tp.num_data_blocks;
@@ -161,11 +166,15 @@ const std::string TablePropertiesNames::kMergeOperator =
 const std::string TablePropertiesNames::kPropertyCollectors =
     "rocksdb.property.collectors";
 const std::string TablePropertiesNames::kCompression = "rocksdb.compression";
+const std::string TablePropertiesNames::kCompressionDictSize =
+    "rocksdb.compression.dict.size";
+const std::string TablePropertiesNames::kCreationTime = "rocksdb.creation.time";
 
 extern const std::string kPropertiesBlock = "rocksdb.properties";
 // Old property block name for backward compatibility
 extern const std::string kPropertiesBlockOldName = "rocksdb.stats";
 extern const std::string kCompressionDictBlock = "rocksdb.compression_dict";
+extern const std::string kRangeDelBlock = "rocksdb.range_del";
 
 // Seek to the properties block.
 // Return true if it successfully seeks to the properties block.
@@ -183,4 +192,10 @@ Status SeekToCompressionDictBlock(InternalIterator* meta_iter, bool* is_found) {
   return SeekToMetaBlock(meta_iter, kCompressionDictBlock, is_found);
 }
 
+// Seek to the range deletion block.
+// Return true if it successfully seeks to that block.
+Status SeekToRangeDelBlock(InternalIterator* meta_iter, bool* is_found) {
+  return SeekToMetaBlock(meta_iter, kRangeDelBlock, is_found);
+}
+
 }  // namespace rocksdb
@@ -22,4 +22,9 @@ Status SeekToPropertiesBlock(InternalIterator* meta_iter, bool* is_found);
 // set to true.
 Status SeekToCompressionDictBlock(InternalIterator* meta_iter, bool* is_found);
 
+// Seek to the range deletion block.
+// If it successfully seeks to the range deletion block, "is_found" will be
+// set to true.
+Status SeekToRangeDelBlock(InternalIterator* meta_iter, bool* is_found);
+
 }  // namespace rocksdb
@@ -9,6 +9,10 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
 
 namespace rocksdb {
 
@@ -41,6 +45,15 @@ class TableReader {
                                         Arena* arena = nullptr,
                                         bool skip_filters = false) = 0;
 
+  // Returns a new iterator over the range tombstones of the table, or
+  // nullptr if the table has none or its format does not support them. The
+  // keys are internal keys of type kTypeRangeDeletion and the values are the
+  // (exclusive) end keys of the ranges.
+  virtual InternalIterator* NewRangeTombstoneIterator(
+      const ReadOptions& read_options) {
+    return nullptr;
+  }
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -49,6 +62,17 @@ class TableReader {
   // be close to the file length.
   virtual uint64_t ApproximateOffsetOf(const Slice& key) = 0;
 
+  // Appends to *anchors up to max_anchors internal keys of the table, in
+  // ascending order and spread roughly evenly over its data, so that a caller
+  // can split the key range of the table into pieces of similar size. Returns
+  // Status::NotSupported() if the table format cannot tell.
+  virtual Status ApproximateKeyAnchors(size_t max_anchors,
+                                       std::vector<std::string>* anchors) {
+    (void) max_anchors;
+    (void) anchors;
+    return Status::NotSupported("ApproximateKeyAnchors() not supported");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
@@ -75,6 +99,25 @@ class TableReader {
   virtual Status Get(const ReadOptions& readOptions, const Slice& key,
                      GetContext* get_context, bool skip_filters = false) = 0;
 
+  // Batched version of Get(). keys must be sorted in ascending order of the
+  // table's internal key comparator, and get_contexts[i] receives the result
+  // of looking up keys[i]. The status of each lookup is stored in
+  // (*statuses)[i].
+  //
+  // The default implementation calls Get() once for every key. Table formats
+  // that can share work between neighbouring keys (e.g. filter and index
+  // probes, data block reads) should override it.
+  virtual void MultiGet(const ReadOptions& readOptions,
+                        const std::vector<Slice>& keys,
+                        const std::vector<GetContext*>& get_contexts,
+                        std::vector<Status>* statuses,
+                        bool skip_filters = false) {
+    statuses->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      (*statuses)[i] = Get(readOptions, keys[i], get_contexts[i], skip_filters);
+    }
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -352,6 +352,10 @@ class TableConstructor: public Constructor {
   }
 
   uint64_t ApproximateOffsetOf(const Slice& key) const {
+    if (convert_to_internal_key_) {
+      InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+      return table_reader_->ApproximateOffsetOf(ikey.Encode());
+    }
     return table_reader_->ApproximateOffsetOf(key);
   }
 
@@ -371,6 +375,8 @@ class TableConstructor: public Constructor {
     return convert_to_internal_key_;
   }
 
+  bool ConvertToInternalKey() const { return convert_to_internal_key_; }
+
   void ResetTableReader() { table_reader_.reset(); }
 
  private:
@@ -685,7 +691,9 @@ class HarnessTest : public testing::Test {
         table_options_.format_version = args.format_version;
         options_.table_factory.reset(
             new BlockBasedTableFactory(table_options_));
-        constructor_ = new TableConstructor(options_.comparator);
+        constructor_ = new TableConstructor(options_.comparator, true);
+        internal_comparator_.reset(
+            new InternalKeyComparator(options_.comparator));
         break;
 // Plain table is not supported in ROCKSDB_LITE
 #ifndef ROCKSDB_LITE
@@ -1019,7 +1027,7 @@ TEST_F(TablePropertyTest, PrefixScanTest) {
 // This test include all the basic checks except those for index size and block
 // size, which will be conducted in separated unit tests.
 TEST_F(BlockBasedTableTest, BasicBlockBasedTableProperties) {
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
 
   c.Add("a1", "val1");
   c.Add("b2", "val2");
@@ -1041,12 +1049,13 @@ TEST_F(BlockBasedTableTest, BasicBlockBasedTableProperties) {
 
   const ImmutableCFOptions ioptions(options);
   c.Finish(options, ioptions, table_options,
-           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+           InternalKeyComparator(options.comparator), &keys, &kvmap);
 
   auto& props = *c.GetTableReader()->GetTableProperties();
   ASSERT_EQ(kvmap.size(), props.num_entries);
 
-  auto raw_key_size = kvmap.size() * 2ul;
+  // The keys are stored as internal keys
+  auto raw_key_size = kvmap.size() * 10ul;
   auto raw_value_size = kvmap.size() * 4ul;
 
   ASSERT_EQ(raw_key_size, props.raw_key_size);
@@ -1057,7 +1066,8 @@ TEST_F(BlockBasedTableTest, BasicBlockBasedTableProperties) {
   // Verify data size.
   BlockBuilder block_builder(1);
   for (const auto& item : kvmap) {
-    block_builder.Add(item.first, item.second);
+    InternalKey ikey(item.first, kMaxSequenceNumber, kTypeValue);
+    block_builder.Add(ikey.Encode(), item.second);
   }
   Slice content = block_builder.Finish();
   ASSERT_EQ(content.size() + kBlockTrailerSize, props.data_size);
@@ -1145,11 +1155,13 @@ void AssertKeysInCache(BlockBasedTable* table_reader,
                        const std::vector<std::string>& keys_in_cache,
                        const std::vector<std::string>& keys_not_in_cache) {
   for (auto key : keys_in_cache) {
-    ASSERT_TRUE(table_reader->TEST_KeyInCache(ReadOptions(), key));
+    InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+    ASSERT_TRUE(table_reader->TEST_KeyInCache(ReadOptions(), ikey.Encode()));
   }
 
   for (auto key : keys_not_in_cache) {
-    ASSERT_TRUE(!table_reader->TEST_KeyInCache(ReadOptions(), key));
+    InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+    ASSERT_TRUE(!table_reader->TEST_KeyInCache(ReadOptions(), ikey.Encode()));
   }
 }
 
@@ -1169,8 +1181,11 @@ void PrefetchRange(TableConstructor* c, Options* opt,
   // prefetch
   auto* table_reader = dynamic_cast<BlockBasedTable*>(c->GetTableReader());
   // empty string replacement is a trick so we don't crash the test
-  Slice begin(key_begin ? key_begin : "");
-  Slice end(key_end ? key_end : "");
+  InternalKey ibegin(key_begin ? key_begin : "", kMaxSequenceNumber,
+                     kTypeValue);
+  InternalKey iend(key_end ? key_end : "", kMaxSequenceNumber, kTypeValue);
+  Slice begin = ibegin.Encode();
+  Slice end = iend.Encode();
   Status s = table_reader->Prefetch(key_begin ? &begin : nullptr,
                                     key_end ? &end : nullptr);
   ASSERT_TRUE(s.code() == expected_status.code());
@@ -1185,7 +1200,7 @@ TEST_F(BlockBasedTableTest, PrefetchTest) {
   // BlockBasedTable.
   Options opt;
   unique_ptr<InternalKeyComparator> ikc;
-  ikc.reset(new test::PlainInternalKeyComparator(opt.comparator));
+  ikc.reset(new InternalKeyComparator(opt.comparator));
   opt.compression = kNoCompression;
   BlockBasedTableOptions table_options;
   table_options.block_size = 1024;
@@ -1193,7 +1208,7 @@ TEST_F(BlockBasedTableTest, PrefetchTest) {
   table_options.block_cache = NewLRUCache(16 * 1024 * 1024, 4);
   opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
 
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
   c.Add("k01", "hello");
   c.Add("k02", "hello2");
   c.Add("k03", std::string(10000, 'x'));
@@ -1266,7 +1281,7 @@ TEST_F(BlockBasedTableTest, PrefetchTest) {
 
 TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   BlockBasedTableOptions table_options;
-  for (int i = 0; i < 4; ++i) {
+  for (int i = 0; i < 5; ++i) {
     Options options;
     // Make each key/value an individual block
     table_options.block_size = 64;
@@ -1290,13 +1305,19 @@ TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
       options.prefix_extractor.reset(NewFixedPrefixTransform(4));
       break;
     case 3:
-    default:
       // Hash search index with filter policy
       table_options.index_type = BlockBasedTableOptions::kHashSearch;
       table_options.filter_policy.reset(NewBloomFilterPolicy(10));
       options.table_factory.reset(new BlockBasedTableFactory(table_options));
       options.prefix_extractor.reset(NewFixedPrefixTransform(4));
       break;
+    case 4:
+    default:
+      // Two-level index
+      table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+      options.table_factory.reset(new BlockBasedTableFactory(table_options));
+      options.prefix_extractor.reset(NewFixedPrefixTransform(4));
+      break;
     }
 
     TableConstructor c(BytewiseComparator(), true);
@@ -1348,6 +1369,240 @@ TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   }
 }
 
+TEST_F(BlockBasedTableTest, TwoLevelIndex) {
+  Options options;
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  // Small blocks, so that the index has many partitions
+  table_options.block_size = 64;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.block_cache = NewLRUCache(1024 * 1024, 0);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  TableConstructor c(BytewiseComparator());
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    c.Add(InternalKey(k, 0, kTypeValue).Encode().ToString(),
+          std::string(40, 'a' + i % 26));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+  auto props = reader->GetTableProperties();
+  ASSERT_EQ(static_cast<uint64_t>(kNumKeys), props->num_data_blocks);
+  // The top-level index alone is much smaller than the whole index.
+  ASSERT_LT(props->index_size, 64u * kNumKeys);
+
+  // Full scan, forward and backward
+  ReadOptions ro;
+  std::unique_ptr<InternalIterator> iter(reader->NewIterator(ro));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, count);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    count--;
+    ASSERT_EQ(keys[count], iter->key().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(0, count);
+
+  // Seek to every key and in between keys
+  for (int i = 0; i < kNumKeys; i += 7) {
+    iter->Seek(keys[i]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(keys[i], iter->key().ToString());
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d~", i);
+    iter->Seek(InternalKey(k, kMaxSequenceNumber, kTypeValue).Encode());
+    if (i + 1 < kNumKeys) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[i + 1], iter->key().ToString());
+    } else {
+      ASSERT_FALSE(iter->Valid());
+    }
+  }
+  iter.reset();
+
+  // Point lookups go through the index partitions as well
+  for (int i = 0; i < kNumKeys; i += 13) {
+    std::string user_key = ExtractUserKey(keys[i]).ToString();
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(), keys[i], &get_context));
+    ASSERT_EQ(GetContext::kFound, get_context.State());
+    ASSERT_EQ(kvmap[keys[i]], value);
+  }
+  {
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, "zzz", &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(
+        ReadOptions(), InternalKey("zzz", kMaxSequenceNumber, kTypeValue)
+                           .Encode(),
+        &get_context));
+    ASSERT_EQ(GetContext::kNotFound, get_context.State());
+  }
+
+  // The index partitions are cached as index blocks. Reading them again hits
+  // the block cache.
+  ASSERT_GT(options.statistics->getTickerCount(BLOCK_CACHE_INDEX_MISS), 1u);
+  uint64_t index_hit =
+      options.statistics->getTickerCount(BLOCK_CACHE_INDEX_HIT);
+  std::string user_key = ExtractUserKey(keys[0]).ToString();
+  std::string value;
+  GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                         GetContext::kNotFound, user_key, &value, nullptr,
+                         nullptr, nullptr);
+  ASSERT_OK(reader->Get(ReadOptions(), keys[0], &get_context));
+  ASSERT_EQ(GetContext::kFound, get_context.State());
+  // top-level index and partition
+  ASSERT_EQ(index_hit + 2,
+            options.statistics->getTickerCount(BLOCK_CACHE_INDEX_HIT));
+  c.ResetTableReader();
+}
+
+TEST_F(BlockBasedTableTest, PartitionedFilter) {
+  Options options;
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  // Keys sharing the first 7 bytes, "key0000" to "key0099", form a prefix.
+  options.prefix_extractor.reset(NewFixedPrefixTransform(7));
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  table_options.partition_filters = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  // Small blocks, so that the index and the filter have many partitions
+  table_options.block_size = 64;
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.block_cache = NewLRUCache(1024 * 1024, 0);
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  // Only the even keys are in the table.
+  TableConstructor c(BytewiseComparator());
+  const int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    c.Add(InternalKey(k, 0, kTypeValue).Encode().ToString(),
+          std::string(40, 'a' + i % 26));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+
+  // Every key in the table passes the filter of its partition.
+  for (int i = 0; i < kNumKeys; i += 2) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    Slice user_key(k);
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(),
+                          InternalKey(user_key, 0, kTypeValue).Encode(),
+                          &get_context));
+    ASSERT_EQ(GetContext::kFound, get_context.State());
+  }
+  ASSERT_EQ(0u, options.statistics->getTickerCount(BLOOM_FILTER_USEFUL));
+  // The filter partitions are read through the block cache.
+  ASSERT_GT(options.statistics->getTickerCount(BLOCK_CACHE_FILTER_MISS), 2u);
+
+  // Most of the keys that are not in the table are filtered out.
+  for (int i = 1; i < kNumKeys; i += 2) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    Slice user_key(k);
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(),
+                          InternalKey(user_key, 0, kTypeValue).Encode(),
+                          &get_context));
+    ASSERT_EQ(GetContext::kNotFound, get_context.State());
+  }
+  ASSERT_GT(options.statistics->getTickerCount(BLOOM_FILTER_USEFUL),
+            static_cast<uint64_t>(kNumKeys / 2 * 9 / 10));
+
+  // Every prefix in the table passes the filter.
+  auto* table_reader = dynamic_cast<BlockBasedTable*>(reader);
+  ASSERT_TRUE(table_reader != nullptr);
+  for (int i = 0; i < kNumKeys; i += 100) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%04d", i / 100);
+    ASSERT_TRUE(table_reader->PrefixMayMatch(
+        InternalKey(k, kMaxSequenceNumber, kTypeValue).Encode()));
+  }
+  ASSERT_FALSE(table_reader->PrefixMayMatch(
+      InternalKey("key0099", kMaxSequenceNumber, kTypeValue).Encode()));
+  c.ResetTableReader();
+}
+
+TEST_F(BlockBasedTableTest, PartitionedFilterWithoutBlockCache) {
+  Options options;
+  options.statistics = CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.index_type = BlockBasedTableOptions::kTwoLevelIndexSearch;
+  table_options.partition_filters = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  table_options.block_size = 64;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  ASSERT_OK(options.table_factory->SanitizeOptions(options, options));
+
+  // Only the even keys are in the table.
+  TableConstructor c(BytewiseComparator());
+  const int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    c.Add(InternalKey(k, 0, kTypeValue).Encode().ToString(), "value");
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = c.GetTableReader();
+
+  // The partitions are read from the file, and still filter.
+  for (int i = 0; i < kNumKeys; i++) {
+    char k[16];
+    snprintf(k, sizeof(k), "key%06d", i);
+    Slice user_key(k);
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(),
+                          InternalKey(user_key, 0, kTypeValue).Encode(),
+                          &get_context));
+    ASSERT_EQ(i % 2 == 0 ? GetContext::kFound : GetContext::kNotFound,
+              get_context.State());
+  }
+  ASSERT_GT(options.statistics->getTickerCount(BLOOM_FILTER_USEFUL),
+            static_cast<uint64_t>(kNumKeys / 2 * 9 / 10));
+  c.ResetTableReader();
+}
+
 TEST_F(BlockBasedTableTest, NoopTransformSeek) {
   BlockBasedTableOptions table_options;
   table_options.filter_policy.reset(NewBloomFilterPolicy(10));
@@ -1698,11 +1953,11 @@ TEST_F(BlockBasedTableTest, FilterBlockInBlockCache) {
   std::vector<std::string> keys;
   stl_wrappers::KVMap kvmap;
 
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
   c.Add("key", "value");
   const ImmutableCFOptions ioptions(options);
   c.Finish(options, ioptions, table_options,
-           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+           InternalKeyComparator(options.comparator), &keys, &kvmap);
   // preloading filter/index blocks is prohibited.
   auto* reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
   ASSERT_TRUE(!reader->TEST_filter_block_preloaded());
@@ -1971,7 +2226,7 @@ TEST_F(BlockBasedTableTest, BlockCacheLeak) {
 
   Options opt;
   unique_ptr<InternalKeyComparator> ikc;
-  ikc.reset(new test::PlainInternalKeyComparator(opt.comparator));
+  ikc.reset(new InternalKeyComparator(opt.comparator));
   opt.compression = kNoCompression;
   BlockBasedTableOptions table_options;
   table_options.block_size = 1024;
@@ -1979,7 +2234,7 @@ TEST_F(BlockBasedTableTest, BlockCacheLeak) {
   table_options.block_cache = NewLRUCache(16 * 1024 * 1024, 4);
   opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
 
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
   c.Add("k01", "hello");
   c.Add("k02", "hello2");
   c.Add("k03", std::string(10000, 'x'));
@@ -2005,7 +2260,8 @@ TEST_F(BlockBasedTableTest, BlockCacheLeak) {
   ASSERT_OK(c.Reopen(ioptions1));
   auto table_reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
   for (const std::string& key : keys) {
-    ASSERT_TRUE(table_reader->TEST_KeyInCache(ReadOptions(), key));
+    InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+    ASSERT_TRUE(table_reader->TEST_KeyInCache(ReadOptions(), ikey.Encode()));
   }
   c.ResetTableReader();
 
@@ -2016,7 +2272,8 @@ TEST_F(BlockBasedTableTest, BlockCacheLeak) {
   ASSERT_OK(c.Reopen(ioptions2));
   table_reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
   for (const std::string& key : keys) {
-    ASSERT_TRUE(!table_reader->TEST_KeyInCache(ReadOptions(), key));
+    InternalKey ikey(key, kMaxSequenceNumber, kTypeValue);
+    ASSERT_TRUE(!table_reader->TEST_KeyInCache(ReadOptions(), ikey.Encode()));
   }
   c.ResetTableReader();
 }
@@ -2079,7 +2336,7 @@ TEST_F(PlainTableTest, BasicPlainTableProperties) {
 #endif  // !ROCKSDB_LITE
 
 TEST_F(GeneralTableTest, ApproximateOffsetOfPlain) {
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
   c.Add("k01", "hello");
   c.Add("k02", "hello2");
   c.Add("k03", std::string(10000, 'x'));
@@ -2090,7 +2347,7 @@ TEST_F(GeneralTableTest, ApproximateOffsetOfPlain) {
   std::vector<std::string> keys;
   stl_wrappers::KVMap kvmap;
   Options options;
-  test::PlainInternalKeyComparator internal_comparator(options.comparator);
+  InternalKeyComparator internal_comparator(options.comparator);
   options.compression = kNoCompression;
   BlockBasedTableOptions table_options;
   table_options.block_size = 1024;
@@ -2114,7 +2371,7 @@ TEST_F(GeneralTableTest, ApproximateOffsetOfPlain) {
 
 static void DoCompressionTest(CompressionType comp) {
   Random rnd(301);
-  TableConstructor c(BytewiseComparator());
+  TableConstructor c(BytewiseComparator(), true);
   std::string tmp;
   c.Add("k01", "hello");
   c.Add("k02", test::CompressibleString(&rnd, 0.25, 10000, &tmp));
@@ -2123,7 +2380,7 @@ static void DoCompressionTest(CompressionType comp) {
   std::vector<std::string> keys;
   stl_wrappers::KVMap kvmap;
   Options options;
-  test::PlainInternalKeyComparator ikc(options.comparator);
+  InternalKeyComparator ikc(options.comparator);
   options.compression = comp;
   BlockBasedTableOptions table_options;
   table_options.block_size = 1024;
@@ -57,6 +57,7 @@
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "rocksdb/write_batch.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/histogram.h"
@@ -262,6 +263,12 @@ DEFINE_bool(enable_numa, false,
 DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
              "Number of bytes to buffer in all memtables before compacting");
 
+DEFINE_bool(cost_write_buffer_to_cache, false,
+            "Charge the memory of all memtables to the block cache");
+
+DEFINE_bool(allow_write_buffer_stall, false,
+            "Stall writes once all memtables use db_write_buffer_size bytes");
+
 DEFINE_int64(write_buffer_size, rocksdb::Options().write_buffer_size,
              "Number of bytes to buffer in memtable before compacting");
 
@@ -340,6 +347,17 @@ DEFINE_int32(universal_compression_size_percent, -1,
 DEFINE_bool(universal_allow_trivial_move, false,
             "Allow trivial move in universal compaction.");
 
+DEFINE_uint64(fifo_compaction_max_table_files_size_mb, 0,
+              "The total size limit of the table files in FIFO compaction, "
+              "in MB. 0 means the default.");
+
+DEFINE_uint64(fifo_compaction_ttl, 0,
+              "Delete the table files older than this many seconds in FIFO "
+              "compaction. Requires -open_files=-1.");
+
+DEFINE_bool(fifo_compaction_allow_compaction, false,
+            "Merge small table files in FIFO compaction.");
+
 DEFINE_int64(cache_size, -1,
              "Number of bytes to use as a cache of uncompressed"
              " data. Negative means use default settings.");
@@ -368,6 +386,20 @@ DEFINE_int32(index_block_restart_interval,
              "Number of keys between restart points "
              "for delta encoding of keys in index block.");
 
+DEFINE_bool(data_block_hash_index, false,
+            "Append a hash index of the user keys to each data block, for "
+            "point lookups. Writes tables with format_version 3.");
+
+DEFINE_double(data_block_hash_table_util_ratio,
+              rocksdb::BlockBasedTableOptions()
+                  .data_block_hash_table_util_ratio,
+              "Number of user keys per bucket of the data block hash index.");
+
+DEFINE_bool(data_block_restart_key_prefixes, false,
+            "Store the key prefixes of the restart points of data blocks, "
+            "for seeks within the blocks. Writes tables with format_version "
+            "3.");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -402,6 +434,8 @@ DEFINE_int32(bloom_bits, -1, "Bloom filter bits per key. Negative means"
 DEFINE_double(memtable_bloom_size_ratio, 0,
               "Ratio of memtable size used for bloom filter. 0 means no bloom "
               "filter.");
+DEFINE_bool(memtable_whole_key_filtering, false,
+            "Try to use whole key bloom filter in memtables.");
 DEFINE_bool(memtable_use_huge_page, false,
             "Try to use huge page in memtables.");
 
@@ -428,6 +462,11 @@ DEFINE_int32(cache_numshardbits, -1, "Number of shards for the block cache"
              " is 2 ** cache_numshardbits. Negative means use default settings."
              " This is applied only if FLAGS_cache_size is non-negative.");
 
+DEFINE_double(cache_high_pri_pool_ratio, 0.0,
+              "Ratio of block cache reserved for high priority blocks, i.e. "
+              "index and filter blocks when cache_index_and_filter_blocks "
+              "is set.");
+
 DEFINE_bool(verify_checksum, false, "Verify checksum for every block read"
             " from storage");
 
@@ -446,6 +485,10 @@ DEFINE_bool(use_fsync, false, "If true, issue fsync instead of fdatasync");
 
 DEFINE_bool(disable_wal, false, "If true, do not write WAL for write.");
 
+DEFINE_bool(memtable_insert_hint_per_batch, false,
+            "If true, memtable inserts of a write batch start from the last "
+            "insert position of the batch");
+
 DEFINE_string(wal_dir, "", "If not empty, use the given dir for WAL");
 
 DEFINE_int32(num_levels, 7, "The total number of levels");
@@ -607,6 +650,18 @@ DEFINE_int32(compression_max_dict_bytes, 0,
              "Maximum size of dictionary used to prime the compression "
              "library.");
 
+DEFINE_int32(compression_zstd_max_train_bytes, 0,
+             "Maximum size of the samples used to train the ZSTD compression "
+             "dictionary. 0 uses the raw samples as the dictionary.");
+
+DEFINE_bool(compression_use_dict_for_flush, false,
+            "Compress flush output with a dictionary sampled from the "
+            "memtable too.");
+
+DEFINE_int32(compression_parallel_threads, 1,
+             "Number of threads compressing the data blocks of each table "
+             "file written by flushes and compactions.");
+
 static bool ValidateCompressionLevel(const char* flagname, int32_t value) {
   if (value < -1 || value > 9) {
     fprintf(stderr, "Invalid value for --%s: %d, must be between -1 and 9\n",
@@ -685,6 +740,10 @@ DEFINE_uint64(soft_pending_compaction_bytes_limit, 64ull * 1024 * 1024 * 1024,
 DEFINE_uint64(hard_pending_compaction_bytes_limit, 128ull * 1024 * 1024 * 1024,
               "Stop writes if pending compaction bytes exceed this number");
 
+DEFINE_bool(adaptive_write_pacing, false,
+            "Slow down writes gradually as level-0 files and pending "
+            "compaction bytes approach the slowdown triggers");
+
 DEFINE_uint64(delayed_write_rate, 8388608u,
               "Limited bytes allowed to DB when soft_rate_limit or "
               "level0_slowdown_writes_trigger triggers");
@@ -695,6 +754,17 @@ DEFINE_bool(allow_concurrent_memtable_write, false,
 DEFINE_bool(enable_write_thread_adaptive_yield, false,
             "Use a yielding spin loop for brief writer thread waits.");
 
+DEFINE_bool(enable_pipelined_write, false,
+            "Allow the next write group to write the WAL while the previous "
+            "one is still inserting into the memtable.");
+
+DEFINE_int32(wal_recovery_threads, rocksdb::Options().wal_recovery_threads,
+             "Number of threads replaying the WAL when the DB is opened.");
+
+DEFINE_bool(skip_table_open_on_db_open, false,
+            "Open the table files on their first access instead of on "
+            "DB open.");
+
 DEFINE_uint64(
     write_thread_max_yield_usec, 100,
     "Maximum microseconds for enable_write_thread_adaptive_yield operation.");
@@ -709,6 +779,11 @@ DEFINE_int32(rate_limit_delay_max_milliseconds, 1000,
 
 DEFINE_uint64(rate_limiter_bytes_per_sec, 0, "Set options.rate_limiter value.");
 
+DEFINE_bool(rate_limiter_auto_tuned, false,
+            "Enable dynamic adjustment of rate limit according to demand for "
+            "background I/O, with --rate_limiter_bytes_per_sec as the upper "
+            "bound");
+
 DEFINE_uint64(
     benchmark_write_rate_limit, 0,
     "If non-zero, db_bench will rate-limit the writes going into RocksDB. This "
@@ -742,6 +817,14 @@ DEFINE_bool(mmap_read, rocksdb::EnvOptions().use_mmap_reads,
 DEFINE_bool(mmap_write, rocksdb::EnvOptions().use_mmap_writes,
             "Allow writes to occur via mmap-ing files");
 
+DEFINE_bool(use_direct_reads, rocksdb::Options().use_direct_reads,
+            "Use O_DIRECT for reading table files");
+
+DEFINE_bool(use_direct_io_for_flush_and_compaction,
+            rocksdb::Options().use_direct_io_for_flush_and_compaction,
+            "Use O_DIRECT for writing the table files of flushes and "
+            "compactions");
+
 DEFINE_bool(advise_random_on_open, rocksdb::Options().advise_random_on_open,
             "Advise random access on table file open");
 
@@ -837,6 +920,16 @@ DEFINE_double(cuckoo_hash_ratio, 0.9, "Hash ratio for Cuckoo SST table.");
 DEFINE_bool(use_hash_search, false, "if use kHashSearch "
             "instead of kBinarySearch. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(partition_index, false, "if use kTwoLevelIndexSearch "
+            "instead of kBinarySearch. "
+            "This is valid if only we use BlockTable");
+DEFINE_bool(partition_filters, false, "if partition the full filter along "
+            "the index partitions. This requires partition_index and "
+            "a full filter");
+DEFINE_int64(max_auto_readahead_size,
+             rocksdb::BlockBasedTableOptions().max_auto_readahead_size,
+             "Largest window of data blocks an iterator scanning a table file "
+             "prefetches ahead of itself. 0 disables it.");
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
@@ -1811,8 +1904,10 @@ class Benchmark {
       : cache_(
             FLAGS_cache_size >= 0
                 ? (FLAGS_cache_numshardbits >= 1
-                       ? NewLRUCache(FLAGS_cache_size, FLAGS_cache_numshardbits)
-                       : NewLRUCache(FLAGS_cache_size))
+                       ? NewLRUCache(FLAGS_cache_size, FLAGS_cache_numshardbits,
+                                     false, FLAGS_cache_high_pri_pool_ratio)
+                       : NewLRUCache(FLAGS_cache_size, 6, false,
+                                     FLAGS_cache_high_pri_pool_ratio))
                 : nullptr),
         compressed_cache_(FLAGS_compressed_cache_size >= 0
                               ? (FLAGS_cache_numshardbits >= 1
@@ -1977,6 +2072,8 @@ class Benchmark {
         write_options_.sync = true;
       }
       write_options_.disableWAL = FLAGS_disable_wal;
+      write_options_.memtable_insert_hint_per_batch =
+          FLAGS_memtable_insert_hint_per_batch;
 
       void (Benchmark::*method)(ThreadState*) = nullptr;
       void (Benchmark::*post_process_method)() = nullptr;
@@ -2444,6 +2541,12 @@ class Benchmark {
     options.create_missing_column_families = FLAGS_num_column_families > 1;
     options.max_open_files = FLAGS_open_files;
     options.db_write_buffer_size = FLAGS_db_write_buffer_size;
+    if (FLAGS_cost_write_buffer_to_cache || FLAGS_allow_write_buffer_stall) {
+      options.write_buffer_manager.reset(new WriteBufferManager(
+          FLAGS_db_write_buffer_size,
+          FLAGS_cost_write_buffer_to_cache ? cache_ : nullptr,
+          FLAGS_allow_write_buffer_stall));
+    }
     options.write_buffer_size = FLAGS_write_buffer_size;
     options.max_write_buffer_number = FLAGS_max_write_buffer_number;
     options.min_write_buffer_number_to_merge =
@@ -2468,6 +2571,7 @@ class Benchmark {
     }
     options.memtable_huge_page_size = FLAGS_memtable_use_huge_page ? 2048 : 0;
     options.memtable_prefix_bloom_size_ratio = FLAGS_memtable_bloom_size_ratio;
+    options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
     options.new_table_reader_for_compaction_inputs =
@@ -2570,9 +2674,15 @@ class Benchmark {
           exit(1);
         }
         block_based_options.index_type = BlockBasedTableOptions::kHashSearch;
+      } else if (FLAGS_partition_index) {
+        block_based_options.index_type =
+            BlockBasedTableOptions::kTwoLevelIndexSearch;
+        block_based_options.partition_filters = FLAGS_partition_filters;
       } else {
         block_based_options.index_type = BlockBasedTableOptions::kBinarySearch;
       }
+      block_based_options.max_auto_readahead_size =
+          static_cast<size_t>(FLAGS_max_auto_readahead_size);
       if (cache_ == nullptr) {
         block_based_options.no_block_cache = true;
       }
@@ -2590,6 +2700,17 @@ class Benchmark {
       block_based_options.skip_table_builder_flush =
           FLAGS_skip_table_builder_flush;
       block_based_options.format_version = 2;
+      if (FLAGS_data_block_hash_index) {
+        block_based_options.data_block_index_type =
+            BlockBasedTableOptions::kDataBlockBinaryAndHash;
+        block_based_options.data_block_hash_table_util_ratio =
+            FLAGS_data_block_hash_table_util_ratio;
+        block_based_options.format_version = 3;
+      }
+      if (FLAGS_data_block_restart_key_prefixes) {
+        block_based_options.data_block_restart_key_prefixes = true;
+        block_based_options.format_version = 3;
+      }
       options.table_factory.reset(
           NewBlockBasedTableFactory(block_based_options));
     }
@@ -2611,6 +2732,12 @@ class Benchmark {
     options.compression = FLAGS_compression_type_e;
     options.compression_opts.level = FLAGS_compression_level;
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
+    options.compression_opts.parallel_threads =
+        FLAGS_compression_parallel_threads;
+    options.compression_opts.zstd_max_train_bytes =
+        FLAGS_compression_zstd_max_train_bytes;
+    options.compression_opts.use_dict_for_flush =
+        FLAGS_compression_use_dict_for_flush;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
@@ -2632,11 +2759,15 @@ class Benchmark {
         FLAGS_soft_pending_compaction_bytes_limit;
     options.hard_pending_compaction_bytes_limit =
         FLAGS_hard_pending_compaction_bytes_limit;
+    options.adaptive_write_pacing = FLAGS_adaptive_write_pacing;
     options.delayed_write_rate = FLAGS_delayed_write_rate;
     options.allow_concurrent_memtable_write =
         FLAGS_allow_concurrent_memtable_write;
     options.enable_write_thread_adaptive_yield =
         FLAGS_enable_write_thread_adaptive_yield;
+    options.enable_pipelined_write = FLAGS_enable_pipelined_write;
+    options.wal_recovery_threads = FLAGS_wal_recovery_threads;
+    options.skip_table_open_on_db_open = FLAGS_skip_table_open_on_db_open;
     options.write_thread_max_yield_usec = FLAGS_write_thread_max_yield_usec;
     options.write_thread_slow_yield_usec = FLAGS_write_thread_slow_yield_usec;
     options.rate_limit_delay_max_milliseconds =
@@ -2652,6 +2783,9 @@ class Benchmark {
     options.allow_os_buffer = FLAGS_bufferedio;
     options.allow_mmap_reads = FLAGS_mmap_read;
     options.allow_mmap_writes = FLAGS_mmap_write;
+    options.use_direct_reads = FLAGS_use_direct_reads;
+    options.use_direct_io_for_flush_and_compaction =
+        FLAGS_use_direct_io_for_flush_and_compaction;
     options.advise_random_on_open = FLAGS_advise_random_on_open;
     options.access_hint_on_compaction_start = FLAGS_compaction_fadvice_e;
     options.use_adaptive_mutex = FLAGS_use_adaptive_mutex;
@@ -2692,12 +2826,20 @@ class Benchmark {
     }
     options.compaction_options_universal.allow_trivial_move =
         FLAGS_universal_allow_trivial_move;
+    if (FLAGS_fifo_compaction_max_table_files_size_mb != 0) {
+      options.compaction_options_fifo.max_table_files_size =
+          FLAGS_fifo_compaction_max_table_files_size_mb * 1024 * 1024;
+    }
+    options.compaction_options_fifo.ttl = FLAGS_fifo_compaction_ttl;
+    options.compaction_options_fifo.allow_compaction =
+        FLAGS_fifo_compaction_allow_compaction;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
     if (FLAGS_rate_limiter_bytes_per_sec > 0) {
-      options.rate_limiter.reset(
-          NewGenericRateLimiter(FLAGS_rate_limiter_bytes_per_sec));
+      options.rate_limiter.reset(NewGenericRateLimiter(
+          FLAGS_rate_limiter_bytes_per_sec, 100 * 1000 /* refill_period_us */,
+          10 /* fairness */, FLAGS_rate_limiter_auto_tuned));
     }
 
 #ifndef ROCKSDB_LITE
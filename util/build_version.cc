@@ -0,0 +1,4 @@
+#include "build_version.h"
+const char* rocksdb_build_git_sha = "rocksdb_build_git_sha:f4391e00306ba330e3c145b3097954242458c1b5";
+const char* rocksdb_build_git_date = "rocksdb_build_git_date:2026-10-17";
+const char* rocksdb_build_compile_date = __DATE__;
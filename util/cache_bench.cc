@@ -46,6 +46,8 @@ DEFINE_int32(lookup_percent, 50,
 DEFINE_int32(erase_percent, 10,
              "Ratio of erase to total workload (expressed as a percentage)");
 
+DEFINE_bool(use_clock_cache, false, "Use CLOCK cache instead of LRU cache");
+
 namespace rocksdb {
 
 class CacheBench;
@@ -130,7 +132,9 @@ struct ThreadState {
 class CacheBench {
  public:
   CacheBench() :
-      cache_(NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits)),
+      cache_(FLAGS_use_clock_cache
+                 ? NewClockCache(FLAGS_cache_size, FLAGS_num_shard_bits)
+                 : NewLRUCache(FLAGS_cache_size, FLAGS_num_shard_bits)),
       num_threads_(FLAGS_threads) {}
 
   ~CacheBench() {}
@@ -242,6 +246,8 @@ class CacheBench {
     printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
     printf("Cache size          : %" PRIu64 "\n", FLAGS_cache_size);
     printf("Num shard bits      : %d\n", FLAGS_num_shard_bits);
+    printf("Cache type          : %s\n",
+           FLAGS_use_clock_cache ? "clock" : "lru");
     printf("Max key             : %" PRIu64 "\n", FLAGS_max_key);
     printf("Populate cache      : %d\n", FLAGS_populate_cache);
     printf("Insert percentage   : %d%%\n", FLAGS_insert_percent);
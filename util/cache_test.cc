@@ -34,7 +34,10 @@ static int DecodeValue(void* v) {
   return static_cast<int>(reinterpret_cast<uintptr_t>(v));
 }
 
-class CacheTest : public testing::Test {
+const std::string kLRU = "lru";
+const std::string kClock = "clock";
+
+class CacheTest : public testing::TestWithParam<std::string> {
  public:
   static CacheTest* current_;
 
@@ -55,14 +58,26 @@ class CacheTest : public testing::Test {
   shared_ptr<Cache> cache2_;
 
   CacheTest() :
-      cache_(NewLRUCache(kCacheSize, kNumShardBits)),
-      cache2_(NewLRUCache(kCacheSize2, kNumShardBits2)) {
+      cache_(NewCache(kCacheSize, kNumShardBits, false)),
+      cache2_(NewCache(kCacheSize2, kNumShardBits2, false)) {
     current_ = this;
   }
 
   ~CacheTest() {
   }
 
+  std::shared_ptr<Cache> NewCache(size_t capacity, int num_shard_bits,
+                                  bool strict_capacity_limit) {
+    auto type = GetParam();
+    if (type == kLRU) {
+      return NewLRUCache(capacity, num_shard_bits, strict_capacity_limit);
+    }
+    if (type == kClock) {
+      return NewClockCache(capacity, num_shard_bits, strict_capacity_limit);
+    }
+    return nullptr;
+  }
+
   int Lookup(shared_ptr<Cache> cache, int key) {
     Cache::Handle* handle = cache->Lookup(EncodeKey(key));
     const int r = (handle == nullptr) ? -1 : DecodeValue(cache->Value(handle));
@@ -112,10 +127,10 @@ namespace {
 void dumbDeleter(const Slice& key, void* value) { }
 }  // namespace
 
-TEST_F(CacheTest, UsageTest) {
+TEST_P(CacheTest, UsageTest) {
   // cache is shared_ptr and will be automatically cleaned up.
   const uint64_t kCapacity = 100000;
-  auto cache = NewLRUCache(kCapacity, 8);
+  auto cache = NewCache(kCapacity, 8, false);
 
   size_t usage = 0;
   char value[10] = "abcdef";
@@ -140,10 +155,10 @@ TEST_F(CacheTest, UsageTest) {
   ASSERT_LT(kCapacity * 0.95, cache->GetUsage());
 }
 
-TEST_F(CacheTest, PinnedUsageTest) {
+TEST_P(CacheTest, PinnedUsageTest) {
   // cache is shared_ptr and will be automatically cleaned up.
   const uint64_t kCapacity = 100000;
-  auto cache = NewLRUCache(kCapacity, 8);
+  auto cache = NewCache(kCapacity, 8, false);
 
   size_t pinned_usage = 0;
   char value[10] = "abcdef";
@@ -192,7 +207,7 @@ TEST_F(CacheTest, PinnedUsageTest) {
   }
 }
 
-TEST_F(CacheTest, HitAndMiss) {
+TEST_P(CacheTest, HitAndMiss) {
   ASSERT_EQ(-1, Lookup(100));
 
   Insert(100, 101);
@@ -215,7 +230,7 @@ TEST_F(CacheTest, HitAndMiss) {
   ASSERT_EQ(101, deleted_values_[0]);
 }
 
-TEST_F(CacheTest, Erase) {
+TEST_P(CacheTest, Erase) {
   Erase(200);
   ASSERT_EQ(0U, deleted_keys_.size());
 
@@ -234,7 +249,7 @@ TEST_F(CacheTest, Erase) {
   ASSERT_EQ(1U, deleted_keys_.size());
 }
 
-TEST_F(CacheTest, EntriesArePinned) {
+TEST_P(CacheTest, EntriesArePinned) {
   Insert(100, 101);
   Cache::Handle* h1 = cache_->Lookup(EncodeKey(100));
   ASSERT_EQ(101, DecodeValue(cache_->Value(h1)));
@@ -264,7 +279,7 @@ TEST_F(CacheTest, EntriesArePinned) {
   ASSERT_EQ(0U, cache_->GetUsage());
 }
 
-TEST_F(CacheTest, EvictionPolicy) {
+TEST_P(CacheTest, EvictionPolicy) {
   Insert(100, 101);
   Insert(200, 201);
 
@@ -278,7 +293,25 @@ TEST_F(CacheTest, EvictionPolicy) {
   ASSERT_EQ(-1, Lookup(200));
 }
 
-TEST_F(CacheTest, EvictionPolicyRef) {
+TEST_P(CacheTest, EvictionOfHotEntries) {
+  // Every entry was hit several times, yet inserting one more still has to
+  // make room
+  std::shared_ptr<Cache> cache = NewCache(10, 0, false);
+  for (int i = 0; i < 10; i++) {
+    Insert(cache, i, i);
+  }
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_EQ(i, Lookup(cache, i));
+    }
+  }
+  Insert(cache, 10, 10);
+  ASSERT_EQ(10U, cache->GetUsage());
+  ASSERT_EQ(10, Lookup(cache, 10));
+  ASSERT_EQ(1U, deleted_keys_.size());
+}
+
+TEST_P(CacheTest, EvictionPolicyRef) {
   Insert(100, 101);
   Insert(101, 102);
   Insert(102, 103);
@@ -326,7 +359,66 @@ TEST_F(CacheTest, EvictionPolicyRef) {
   cache_->Release(h204);
 }
 
-TEST_F(CacheTest, ErasedHandleState) {
+TEST_P(CacheTest, HighPriorityPool) {
+  if (GetParam() != kLRU) {
+    // Only LRU cache supports a high-pri pool.
+    return;
+  }
+  // Half of the capacity is reserved for high priority entries.
+  std::shared_ptr<Cache> cache = NewLRUCache(10, 0, false, 0.5);
+  auto insert = [&](int key, Cache::Priority priority) {
+    ASSERT_OK(cache->Insert(EncodeKey(key), EncodeValue(key), 1,
+                            &CacheTest::Deleter, nullptr, priority));
+  };
+
+  for (int i = 0; i < 5; i++) {
+    insert(100 + i, Cache::Priority::HIGH);
+  }
+  // A scan of low priority entries only cycles through the low-pri pool.
+  for (int i = 0; i < 20; i++) {
+    insert(1000 + i, Cache::Priority::LOW);
+  }
+  ASSERT_EQ(10U, cache->GetUsage());
+  for (int i = 0; i < 5; i++) {
+    ASSERT_EQ(100 + i, Lookup(cache, 100 + i));
+  }
+  for (int i = 0; i < 15; i++) {
+    ASSERT_EQ(-1, Lookup(cache, 1000 + i));
+  }
+  for (int i = 15; i < 20; i++) {
+    ASSERT_EQ(1000 + i, Lookup(cache, 1000 + i));
+  }
+
+  // Overflowing the high-pri pool moves its oldest entries (100 and 101) to
+  // the low-pri pool, where they are subject to normal eviction again.
+  insert(105, Cache::Priority::HIGH);
+  insert(106, Cache::Priority::HIGH);
+  for (int i = 20; i < 40; i++) {
+    insert(1000 + i, Cache::Priority::LOW);
+  }
+  ASSERT_EQ(-1, Lookup(cache, 100));
+  ASSERT_EQ(-1, Lookup(cache, 101));
+  for (int i = 2; i < 7; i++) {
+    ASSERT_EQ(100 + i, Lookup(cache, 100 + i));
+  }
+
+  // Without a high-pri pool the priority is ignored.
+  std::shared_ptr<Cache> plain_cache = NewLRUCache(10, 0, false, 0.0);
+  ASSERT_OK(plain_cache->Insert(EncodeKey(100), EncodeValue(100), 1,
+                                &CacheTest::Deleter, nullptr,
+                                Cache::Priority::HIGH));
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(plain_cache->Insert(EncodeKey(1000 + i), EncodeValue(1000 + i),
+                                  1, &CacheTest::Deleter));
+  }
+  ASSERT_EQ(-1, Lookup(plain_cache, 100));
+
+  // Invalid ratios are rejected.
+  ASSERT_TRUE(NewLRUCache(10, 0, false, -0.1) == nullptr);
+  ASSERT_TRUE(NewLRUCache(10, 0, false, 1.1) == nullptr);
+}
+
+TEST_P(CacheTest, ErasedHandleState) {
   // insert a key and get two handles
   Insert(100, 1000);
   Cache::Handle* h1 = cache_->Lookup(EncodeKey(100));
@@ -348,7 +440,7 @@ TEST_F(CacheTest, ErasedHandleState) {
   cache_->Release(h2);
 }
 
-TEST_F(CacheTest, HeavyEntries) {
+TEST_P(CacheTest, HeavyEntries) {
   // Add a bunch of light and heavy entries and then count the combined
   // size of items still in the cache, which must be approximately the
   // same as the total capacity.
@@ -375,7 +467,7 @@ TEST_F(CacheTest, HeavyEntries) {
   ASSERT_LE(cached_weight, kCacheSize + kCacheSize/10);
 }
 
-TEST_F(CacheTest, NewId) {
+TEST_P(CacheTest, NewId) {
   uint64_t a = cache_->NewId();
   uint64_t b = cache_->NewId();
   ASSERT_NE(a, b);
@@ -397,12 +489,12 @@ void deleter(const Slice& key, void* value) {
 }
 }  // namespace
 
-TEST_F(CacheTest, SetCapacity) {
+TEST_P(CacheTest, SetCapacity) {
   // test1: increase capacity
   // lets create a cache with capacity 5,
   // then, insert 5 elements, then increase capacity
   // to 10, returned capacity should be 10, usage=5
-  std::shared_ptr<Cache> cache = NewLRUCache(5, 0);
+  std::shared_ptr<Cache> cache = NewCache(5, 0, false);
   std::vector<Cache::Handle*> handles(10);
   // Insert 5 entries, but not releasing.
   for (size_t i = 0; i < 5; i++) {
@@ -442,10 +534,10 @@ TEST_F(CacheTest, SetCapacity) {
   }
 }
 
-TEST_F(CacheTest, SetStrictCapacityLimit) {
+TEST_P(CacheTest, SetStrictCapacityLimit) {
   // test1: set the flag to false. Insert more keys than capacity. See if they
   // all go through.
-  std::shared_ptr<Cache> cache = NewLRUCache(5, 0, false);
+  std::shared_ptr<Cache> cache = NewCache(5, 0, false);
   std::vector<Cache::Handle*> handles(10);
   Status s;
   for (size_t i = 0; i < 10; i++) {
@@ -469,7 +561,7 @@ TEST_F(CacheTest, SetStrictCapacityLimit) {
   }
 
   // test3: init with flag being true.
-  std::shared_ptr<Cache> cache2 = NewLRUCache(5, 0, true);
+  std::shared_ptr<Cache> cache2 = NewCache(5, 0, true);
   for (size_t i = 0; i < 5; i++) {
     std::string key = ToString(i + 1);
     s = cache2->Insert(key, new Value(i + 1), 1, &deleter, &handles[i]);
@@ -489,11 +581,11 @@ TEST_F(CacheTest, SetStrictCapacityLimit) {
   }
 }
 
-TEST_F(CacheTest, OverCapacity) {
+TEST_P(CacheTest, OverCapacity) {
   size_t n = 10;
 
   // a LRUCache with n entries and one shard only
-  std::shared_ptr<Cache> cache = NewLRUCache(n, 0);
+  std::shared_ptr<Cache> cache = NewCache(n, 0, false);
 
   std::vector<Cache::Handle*> handles(n+1);
 
@@ -544,7 +636,7 @@ void callback(void* entry, size_t charge) {
 }
 };
 
-TEST_F(CacheTest, ApplyToAllCacheEntiresTest) {
+TEST_P(CacheTest, ApplyToAllCacheEntiresTest) {
   std::vector<std::pair<int, int>> inserted;
   callback_state.clear();
 
@@ -559,6 +651,9 @@ TEST_F(CacheTest, ApplyToAllCacheEntiresTest) {
   ASSERT_TRUE(inserted == callback_state);
 }
 
+INSTANTIATE_TEST_CASE_P(CacheTestInstance, CacheTest,
+                        testing::Values(kLRU, kClock));
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
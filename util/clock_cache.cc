@@ -0,0 +1,547 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Copyright (c) 2011 The LevelDB Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file. See the AUTHORS file for names of contributors.
+
+#include <assert.h>
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+#include "port/port.h"
+#include "util/autovector.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+#include "util/sharded_cache.h"
+
+namespace rocksdb {
+
+namespace {
+
+// CLOCK cache implementation
+//
+// Cache entries are kept in a circular list (list_) that a clock hand sweeps
+// to find eviction candidates. Every entry carries a small usage counter that
+// is incremented on each hit, up to its maximum, and decremented when the
+// clock hand passes by. An entry whose counter is already zero when the hand
+// reaches it, and which is not referenced externally, is evicted. A counter
+// rather than a single bit keeps a hot entry alive even when the hand has to
+// sweep the whole shard to find a victim. Unlike LRU, a hit does not need to
+// move the entry around in a list: it only updates the atomic flags of the
+// entry.
+//
+// The hash table that maps keys to entries is guarded by a reader-writer
+// lock per shard. Lookups take it in shared mode, so concurrent hits never
+// wait for each other. Insert, Erase and eviction take it exclusively.
+//
+// CacheHandle can be in these states:
+// 1. Not in use: the slot is on recycle_ and may be reused by Insert.
+//    (refs == 0 && in_cache == false)
+// 2. In cache and not referenced externally. Can be evicted.
+//    (refs == 0 && in_cache == true)
+// 3. In cache and referenced externally. (refs > 0 && in_cache == true)
+// 4. Erased or overwritten while referenced externally: it is no longer in
+//    the hash table and goes to state 1 on last Release.
+//    (refs > 0 && in_cache == false)
+//
+// All state transitions are done with atomic operations on flags, so Lookup
+// and Release can run without the exclusive lock. Whoever observes the
+// transition into (refs == 0 && in_cache == false) recycles the handle.
+struct CacheHandle {
+  Slice key;
+  uint32_t hash;
+  void* value;
+  size_t charge;
+  void (*deleter)(const Slice&, void* value);
+
+  // Bit 0: in-cache bit, set while the entry is referenced by the hash table.
+  // Bit 1-2: usage counter, raised on each hit and aged by the clock hand.
+  // Bit 3-31: external reference count.
+  std::atomic<uint32_t> flags;
+
+  // Storage for the key. Slots are reused, so keep the buffer around.
+  std::string key_data;
+
+  CacheHandle() : hash(0), value(nullptr), charge(0), deleter(nullptr),
+                  flags(0) {}
+
+  CacheHandle(const CacheHandle& a) { *this = a; }
+
+  CacheHandle& operator=(const CacheHandle& a) {
+    key_data = a.key_data;
+    // Point into our own copy of the key, the source slot may be reused.
+    key = a.key.data() == a.key_data.data() ? Slice(key_data) : a.key;
+    hash = a.hash;
+    value = a.value;
+    charge = a.charge;
+    deleter = a.deleter;
+    flags.store(a.flags.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    return *this;
+  }
+
+  static const uint32_t kInCacheBit = 1;
+  static const uint32_t kUsageOffset = 1;
+  static const uint32_t kOneUsage = 1 << kUsageOffset;
+  static const uint32_t kUsageMask = 3 << kUsageOffset;
+  static const uint32_t kMaxUsage = kUsageMask >> kUsageOffset;
+  static const uint32_t kRefsOffset = 3;
+  static const uint32_t kOneRef = 1 << kRefsOffset;
+
+  static bool InCache(uint32_t flags) { return flags & kInCacheBit; }
+  static bool HasUsage(uint32_t flags) { return flags & kUsageMask; }
+  static uint32_t CountRefs(uint32_t flags) { return flags >> kRefsOffset; }
+};
+
+struct CacheKeyHasher {
+  size_t operator()(const Slice& key) const {
+    return Hash(key.data(), key.size(), 0);
+  }
+};
+
+// A single shard of sharded cache.
+class ClockCacheShard : public CacheShard {
+ public:
+  ClockCacheShard();
+  virtual ~ClockCacheShard();
+
+  // Interfaces
+  virtual void SetCapacity(size_t capacity) override;
+  virtual void SetStrictCapacityLimit(bool strict_capacity_limit) override;
+  virtual Status Insert(const Slice& key, uint32_t hash, void* value,
+                        size_t charge,
+                        void (*deleter)(const Slice& key, void* value),
+                        Cache::Handle** handle,
+                        Cache::Priority priority) override;
+  virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
+  virtual void Release(Cache::Handle* handle) override;
+  virtual void Erase(const Slice& key, uint32_t hash) override;
+  virtual size_t GetUsage() const override;
+  virtual size_t GetPinnedUsage() const override;
+  virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                                      bool thread_safe) override;
+  virtual void EraseUnRefEntries() override;
+
+ private:
+  static const uint32_t kMaxRefs = (~0u) >> CacheHandle::kRefsOffset;
+
+  // Try to take an external reference to the handle, which succeeds only if
+  // it is in cache. Raises the usage counter if set_usage is true.
+  bool Ref(CacheHandle* handle, bool set_usage);
+
+  // Drop an external reference. Returns true if the handle reached state 1
+  // (not referenced and not in cache) and the caller has to recycle it.
+  bool Unref(CacheHandle* handle);
+
+  // Remove the handle from the hash table and clear its in-cache bit.
+  // Returns true if it was not referenced externally either, in which case
+  // the caller has to recycle it.
+  // REQUIRES: mutex_ held exclusively.
+  bool UnsetInCache(CacheHandle* handle);
+
+  // Evict the handle if it is in cache and not referenced, regardless of its
+  // usage counter.
+  // REQUIRES: mutex_ held exclusively.
+  bool TryEvict(CacheHandle* handle);
+
+  // Sweep the clock hand until usage_ + charge fits into capacity_ or every
+  // entry left is referenced externally. Evicted handles are appended to
+  // *deleted.
+  // REQUIRES: mutex_ held exclusively.
+  void EvictFromCache(size_t charge, autovector<CacheHandle*>* deleted);
+
+  // Return the slot of the handle to recycle_ and release its usage.
+  // REQUIRES: mutex_ held exclusively.
+  void RecycleHandle(CacheHandle* handle);
+
+  // Call the deleter of the handles. Must be called without mutex_ held.
+  // Deleters run after the slot is put on recycle_, so they are given copies
+  // of the handles.
+  static void CleanupHandles(const autovector<CacheHandle>& handles);
+
+  std::atomic<size_t> capacity_;
+  bool strict_capacity_limit_;
+
+  // Memory size for entries residing in the cache, plus entries that have
+  // been erased but are still referenced externally.
+  std::atomic<size_t> usage_;
+
+  // Memory size for entries referenced externally.
+  std::atomic<size_t> pinned_usage_;
+
+  // Guards table_, list_, recycle_ and head_. Held in shared mode by Lookup.
+  mutable port::RWMutex mutex_;
+
+  // Slots of all handles ever created. std::deque never moves elements on
+  // push_back, so handles stay valid while the list grows.
+  std::deque<CacheHandle> list_;
+
+  // Free slots in list_.
+  autovector<CacheHandle*> recycle_;
+
+  // Position of the clock hand in list_.
+  size_t head_;
+
+  std::unordered_map<Slice, CacheHandle*, CacheKeyHasher> table_;
+};
+
+ClockCacheShard::ClockCacheShard()
+    : capacity_(0),
+      strict_capacity_limit_(false),
+      usage_(0),
+      pinned_usage_(0),
+      head_(0) {}
+
+ClockCacheShard::~ClockCacheShard() {
+  for (auto& handle : list_) {
+    uint32_t flags = handle.flags.load(std::memory_order_relaxed);
+    if (CacheHandle::InCache(flags) || CacheHandle::CountRefs(flags) > 0) {
+      (*handle.deleter)(handle.key, handle.value);
+    }
+  }
+}
+
+size_t ClockCacheShard::GetUsage() const {
+  return usage_.load(std::memory_order_relaxed);
+}
+
+size_t ClockCacheShard::GetPinnedUsage() const {
+  return pinned_usage_.load(std::memory_order_relaxed);
+}
+
+void ClockCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
+                                             bool thread_safe) {
+  if (thread_safe) {
+    mutex_.ReadLock();
+  }
+  for (auto& entry : table_) {
+    callback(entry.second->value, entry.second->charge);
+  }
+  if (thread_safe) {
+    mutex_.ReadUnlock();
+  }
+}
+
+bool ClockCacheShard::Ref(CacheHandle* handle, bool set_usage) {
+  uint32_t flags = handle->flags.load(std::memory_order_relaxed);
+  uint32_t new_flags;
+  do {
+    if (!CacheHandle::InCache(flags)) {
+      return false;
+    }
+    assert(CacheHandle::CountRefs(flags) < kMaxRefs);
+    new_flags = flags + CacheHandle::kOneRef;
+    if (set_usage &&
+        (flags & CacheHandle::kUsageMask) != CacheHandle::kUsageMask) {
+      new_flags += CacheHandle::kOneUsage;
+    }
+  } while (!handle->flags.compare_exchange_weak(flags, new_flags,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed));
+  if (CacheHandle::CountRefs(flags) == 0) {
+    // No reference count before the operation.
+    pinned_usage_.fetch_add(handle->charge, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+bool ClockCacheShard::Unref(CacheHandle* handle) {
+  uint32_t flags = handle->flags.fetch_sub(CacheHandle::kOneRef,
+                                           std::memory_order_release);
+  assert(CacheHandle::CountRefs(flags) > 0);
+  if (CacheHandle::CountRefs(flags) == 1) {
+    // this is the last reference.
+    pinned_usage_.fetch_sub(handle->charge, std::memory_order_relaxed);
+    // Cleanup if it is the last reference and the handle is not in cache.
+    return !CacheHandle::InCache(flags);
+  }
+  return false;
+}
+
+bool ClockCacheShard::UnsetInCache(CacheHandle* handle) {
+  table_.erase(handle->key);
+  uint32_t flags = handle->flags.fetch_and(~CacheHandle::kInCacheBit,
+                                           std::memory_order_acq_rel);
+  assert(CacheHandle::InCache(flags));
+  return CacheHandle::CountRefs(flags) == 0;
+}
+
+bool ClockCacheShard::TryEvict(CacheHandle* handle) {
+  // Only an unreferenced entry in cache can be evicted. Lookups are excluded
+  // by mutex_, but a concurrent Release may still drop a reference, so retry
+  // until the flags are stable.
+  uint32_t flags = handle->flags.load(std::memory_order_relaxed);
+  do {
+    if (!CacheHandle::InCache(flags) || CacheHandle::CountRefs(flags) > 0) {
+      return false;
+    }
+  } while (!handle->flags.compare_exchange_weak(flags, 0,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed));
+  table_.erase(handle->key);
+  return true;
+}
+
+void ClockCacheShard::RecycleHandle(CacheHandle* handle) {
+  assert(!CacheHandle::InCache(handle->flags.load()));
+  assert(CacheHandle::CountRefs(handle->flags.load()) == 0);
+  usage_.fetch_sub(handle->charge, std::memory_order_relaxed);
+  recycle_.push_back(handle);
+}
+
+void ClockCacheShard::CleanupHandles(const autovector<CacheHandle>& handles) {
+  for (auto& handle : handles) {
+    (*handle.deleter)(handle.key, handle.value);
+  }
+}
+
+void ClockCacheShard::EvictFromCache(size_t charge,
+                                     autovector<CacheHandle*>* deleted) {
+  // Lookups are excluded while the hand sweeps, so every pass ages each
+  // entry by one: after kMaxUsage + 1 passes, only the entries referenced
+  // externally are left. A whole pass without aging or evicting anything
+  // means that point was reached earlier.
+  const size_t max_steps = (CacheHandle::kMaxUsage + 1) * list_.size();
+  size_t steps = 0;
+  size_t steps_without_progress = 0;
+  while (usage_.load(std::memory_order_relaxed) + charge >
+             capacity_.load(std::memory_order_relaxed) &&
+         steps < max_steps && steps_without_progress < list_.size()) {
+    CacheHandle* handle = &list_[head_];
+    uint32_t flags = handle->flags.load(std::memory_order_relaxed);
+    bool progress = false;
+    if (CacheHandle::InCache(flags)) {
+      if (CacheHandle::HasUsage(flags)) {
+        // Another chance: age the entry and move on. Hits are excluded by
+        // the lock and releases only touch the reference count, so the
+        // counter is still non-zero.
+        handle->flags.fetch_sub(CacheHandle::kOneUsage,
+                                std::memory_order_relaxed);
+        progress = true;
+      } else if (CacheHandle::CountRefs(flags) == 0 && TryEvict(handle)) {
+        usage_.fetch_sub(handle->charge, std::memory_order_relaxed);
+        deleted->push_back(handle);
+        progress = true;
+      }
+    }
+    head_ = (head_ + 1) % list_.size();
+    steps++;
+    steps_without_progress = progress ? 0 : steps_without_progress + 1;
+  }
+}
+
+void ClockCacheShard::SetCapacity(size_t capacity) {
+  autovector<CacheHandle*> evicted;
+  autovector<CacheHandle> to_delete;
+  {
+    WriteLock l(&mutex_);
+    capacity_.store(capacity, std::memory_order_relaxed);
+    EvictFromCache(0, &evicted);
+    for (auto* handle : evicted) {
+      to_delete.push_back(*handle);
+      recycle_.push_back(handle);
+    }
+  }
+  CleanupHandles(to_delete);
+}
+
+void ClockCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
+  WriteLock l(&mutex_);
+  strict_capacity_limit_ = strict_capacity_limit;
+}
+
+Status ClockCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
+                               size_t charge,
+                               void (*deleter)(const Slice& key, void* value),
+                               Cache::Handle** out_handle,
+                               Cache::Priority priority) {
+  autovector<CacheHandle*> evicted;
+  autovector<CacheHandle> to_delete;
+  Status s;
+  {
+    WriteLock l(&mutex_);
+    EvictFromCache(charge, &evicted);
+    for (auto* handle : evicted) {
+      to_delete.push_back(*handle);
+      recycle_.push_back(handle);
+    }
+
+    size_t pinned = pinned_usage_.load(std::memory_order_relaxed);
+    if (strict_capacity_limit_ &&
+        pinned + charge > capacity_.load(std::memory_order_relaxed)) {
+      if (out_handle == nullptr) {
+        CacheHandle tmp;
+        tmp.key = key;
+        tmp.value = value;
+        tmp.deleter = deleter;
+        to_delete.push_back(tmp);
+      } else {
+        *out_handle = nullptr;
+      }
+      s = Status::Incomplete("Insert failed due to CLOCK cache being full.");
+    } else {
+      CacheHandle* handle;
+      if (!recycle_.empty()) {
+        handle = recycle_.back();
+        recycle_.pop_back();
+      } else {
+        list_.emplace_back();
+        handle = &list_.back();
+      }
+      handle->key_data.assign(key.data(), key.size());
+      handle->key = Slice(handle->key_data);
+      handle->hash = hash;
+      handle->value = value;
+      handle->charge = charge;
+      handle->deleter = deleter;
+      uint32_t flags = CacheHandle::kInCacheBit;
+      if (out_handle != nullptr) {
+        flags += CacheHandle::kOneRef;
+        pinned_usage_.fetch_add(charge, std::memory_order_relaxed);
+      }
+      handle->flags.store(flags, std::memory_order_release);
+      usage_.fetch_add(charge, std::memory_order_relaxed);
+
+      auto iter = table_.find(handle->key);
+      if (iter != table_.end()) {
+        // Overwrite an existing entry.
+        CacheHandle* existing = iter->second;
+        if (UnsetInCache(existing)) {
+          to_delete.push_back(*existing);
+          RecycleHandle(existing);
+        }
+      }
+      table_[handle->key] = handle;
+      if (out_handle != nullptr) {
+        *out_handle = reinterpret_cast<Cache::Handle*>(handle);
+      }
+    }
+  }
+  CleanupHandles(to_delete);
+  return s;
+}
+
+Cache::Handle* ClockCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  ReadLock l(&mutex_);
+  auto iter = table_.find(key);
+  if (iter == table_.end()) {
+    return nullptr;
+  }
+  CacheHandle* handle = iter->second;
+  if (!Ref(handle, true /* set_usage */)) {
+    return nullptr;
+  }
+  return reinterpret_cast<Cache::Handle*>(handle);
+}
+
+void ClockCacheShard::Release(Cache::Handle* h) {
+  if (h == nullptr) {
+    return;
+  }
+  CacheHandle* handle = reinterpret_cast<CacheHandle*>(h);
+  autovector<CacheHandle> to_delete;
+  if (Unref(handle)) {
+    // The entry was erased or overwritten while we were holding it.
+    WriteLock l(&mutex_);
+    to_delete.push_back(*handle);
+    RecycleHandle(handle);
+  } else if (usage_.load(std::memory_order_relaxed) >
+             capacity_.load(std::memory_order_relaxed)) {
+    // The cache is over capacity because entries were pinned. Take this
+    // opportunity to evict the entry if nobody else is using it.
+    WriteLock l(&mutex_);
+    if (TryEvict(handle)) {
+      to_delete.push_back(*handle);
+      RecycleHandle(handle);
+    }
+  }
+  CleanupHandles(to_delete);
+}
+
+void ClockCacheShard::Erase(const Slice& key, uint32_t hash) {
+  autovector<CacheHandle> to_delete;
+  {
+    WriteLock l(&mutex_);
+    auto iter = table_.find(key);
+    if (iter != table_.end()) {
+      CacheHandle* handle = iter->second;
+      if (UnsetInCache(handle)) {
+        to_delete.push_back(*handle);
+        RecycleHandle(handle);
+      }
+    }
+  }
+  CleanupHandles(to_delete);
+}
+
+void ClockCacheShard::EraseUnRefEntries() {
+  autovector<CacheHandle> to_delete;
+  {
+    WriteLock l(&mutex_);
+    for (auto& handle : list_) {
+      if (CacheHandle::InCache(handle.flags.load(std::memory_order_relaxed)) &&
+          TryEvict(&handle)) {
+        to_delete.push_back(handle);
+        RecycleHandle(&handle);
+      }
+    }
+  }
+  CleanupHandles(to_delete);
+}
+
+class ClockCache : public ShardedCache {
+ public:
+  ClockCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit)
+      : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
+    int num_shards = 1 << num_shard_bits;
+    shards_ = new ClockCacheShard[num_shards];
+    SetCapacity(capacity);
+    SetStrictCapacityLimit(strict_capacity_limit);
+  }
+
+  virtual ~ClockCache() { delete[] shards_; }
+
+  virtual CacheShard* GetShard(int shard) override {
+    return reinterpret_cast<CacheShard*>(&shards_[shard]);
+  }
+
+  virtual const CacheShard* GetShard(int shard) const override {
+    return reinterpret_cast<CacheShard*>(&shards_[shard]);
+  }
+
+  virtual void* Value(Handle* handle) override {
+    return reinterpret_cast<const CacheHandle*>(handle)->value;
+  }
+
+  virtual size_t GetCharge(Handle* handle) const override {
+    return reinterpret_cast<const CacheHandle*>(handle)->charge;
+  }
+
+  virtual uint32_t GetHash(Handle* handle) const override {
+    return reinterpret_cast<const CacheHandle*>(handle)->hash;
+  }
+
+  virtual void DisownData() override { shards_ = nullptr; }
+
+ private:
+  ClockCacheShard* shards_;
+};
+
+}  // end anonymous namespace
+
+std::shared_ptr<Cache> NewClockCache(size_t capacity, int num_shard_bits,
+                                     bool strict_capacity_limit) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  return std::make_shared<ClockCache>(capacity, num_shard_bits,
+                                      strict_capacity_limit);
+}
+
+}  // namespace rocksdb
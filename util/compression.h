@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "rocksdb/options.h"
 #include "util/coding.h"
@@ -35,6 +36,9 @@
 
 #if defined(ZSTD)
 #include <zstd.h>
+#if ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+#include <zdict.h>
+#endif  // ZSTD_VERSION_NUMBER >= 10103
 #endif
 
 #if defined(XPRESS)
@@ -85,6 +89,15 @@ inline bool ZSTD_Supported() {
   return false;
 }
 
+inline bool ZSTD_TrainDictionarySupported() {
+#ifdef ZSTD
+#if ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+  return true;
+#endif
+#endif
+  return false;
+}
+
 inline bool CompressionTypeSupported(CompressionType compression_type) {
   switch (compression_type) {
     case kNoCompression:
@@ -771,4 +784,75 @@ inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
   return nullptr;
 }
 
+// Trains a ZSTD dictionary of at most max_dict_bytes from samples, which
+// holds the training samples back to back, the i-th one being
+// sample_lens[i] bytes long. Returns an empty string if training is not
+// supported or fails, e.g. when there are too few samples.
+inline std::string ZSTD_TrainDictionary(const std::string& samples,
+                                        const std::vector<size_t>& sample_lens,
+                                        size_t max_dict_bytes) {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+  if (sample_lens.empty() || max_dict_bytes == 0) {
+    return "";
+  }
+  std::string dict_data(max_dict_bytes, '\0');
+  size_t dict_len = ZDICT_trainFromBuffer(
+      &dict_data[0], max_dict_bytes, samples.data(), sample_lens.data(),
+      static_cast<unsigned>(sample_lens.size()));
+  if (ZDICT_isError(dict_len)) {
+    return "";
+  }
+  assert(dict_len <= max_dict_bytes);
+  dict_data.resize(dict_len);
+  return dict_data;
+#else
+  (void)samples;
+  (void)sample_lens;
+  (void)max_dict_bytes;
+  return "";
+#endif  // defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10103
+}
+
+// Makes the compression dictionary of a table file from samples, which
+// holds samples of 1 << sample_len_shift bytes back to back (the last one
+// may be shorter). With opts.zstd_max_train_bytes set and ZSTD output, a
+// dictionary is trained from the samples; otherwise, or if training fails,
+// the samples themselves, truncated to opts.max_dict_bytes, are the
+// dictionary.
+inline std::string FinishCompressionDict(std::string samples,
+                                         size_t sample_len_shift,
+                                         CompressionType type,
+                                         const CompressionOptions& opts) {
+  if (opts.zstd_max_train_bytes > 0 && type == kZSTDNotFinalCompression) {
+    const size_t kSampleLen = static_cast<size_t>(1) << sample_len_shift;
+    std::vector<size_t> sample_lens(samples.size() / kSampleLen, kSampleLen);
+    if (samples.size() % kSampleLen != 0) {
+      sample_lens.push_back(samples.size() % kSampleLen);
+    }
+    std::string dict =
+        ZSTD_TrainDictionary(samples, sample_lens, opts.max_dict_bytes);
+    if (!dict.empty()) {
+      return dict;
+    }
+  }
+  if (samples.size() > opts.max_dict_bytes) {
+    samples.resize(opts.max_dict_bytes);
+  }
+  return samples;
+}
+
+// Returns how many bytes to sample for the compression dictionary of a table
+// file, see FinishCompressionDict().
+inline size_t CompressionDictSampleBytes(CompressionType type,
+                                         const CompressionOptions& opts) {
+  if (opts.max_dict_bytes == 0) {
+    return 0;
+  }
+  if (opts.zstd_max_train_bytes > 0 && type == kZSTDNotFinalCompression &&
+      ZSTD_TrainDictionarySupported()) {
+    return opts.zstd_max_train_bytes;
+  }
+  return opts.max_dict_bytes;
+}
+
 }  // namespace rocksdb
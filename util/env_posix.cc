@@ -153,6 +153,7 @@ class PosixEnv : public Env {
       *result = nullptr;
       return IOError(fname, errno);
     } else if (options.use_direct_reads && !options.use_mmap_writes) {
+      fclose(f);
 #ifdef OS_MACOSX
       int flags = O_RDONLY;
 #else
@@ -163,6 +164,7 @@ class PosixEnv : public Env {
       if (fd < 0) {
         return IOError(fname, errno);
       }
+      SetFD_CLOEXEC(fd, &options);
 #ifdef OS_MACOSX
       if (fcntl(fd, F_NOCACHE, 1) == -1) {
         close(fd);
@@ -211,6 +213,7 @@ class PosixEnv : public Env {
       }
       close(fd);
     } else if (options.use_direct_reads) {
+      close(fd);
 #ifdef OS_MACOSX
       int flags = O_RDONLY;
 #else
@@ -221,6 +224,7 @@ class PosixEnv : public Env {
       if (fd < 0) {
         s = IOError(fname, errno);
       } else {
+        SetFD_CLOEXEC(fd, &options);
         std::unique_ptr<PosixDirectIORandomAccessFile> file(
             new PosixDirectIORandomAccessFile(fname, fd));
         *result = std::move(file);
@@ -265,16 +269,20 @@ class PosixEnv : public Env {
       if (options.use_mmap_writes && !forceMmapOff) {
         result->reset(new PosixMmapFile(fname, fd, page_size_, options));
       } else if (options.use_direct_writes) {
+        close(fd);
+        // No O_APPEND: the writer rewrites the partial last page at its
+        // aligned offset.
 #ifdef OS_MACOSX
-        int flags = O_WRONLY | O_APPEND | O_TRUNC | O_CREAT;
+        int flags = O_WRONLY | O_TRUNC | O_CREAT;
 #else
-        int flags = O_WRONLY | O_APPEND | O_TRUNC | O_CREAT | O_DIRECT;
+        int flags = O_WRONLY | O_TRUNC | O_CREAT | O_DIRECT;
 #endif
         TEST_SYNC_POINT_CALLBACK("NewWritableFile:O_DIRECT", &flags);
         fd = open(fname.c_str(), flags, 0644);
         if (fd < 0) {
           s = IOError(fname, errno);
         } else {
+          SetFD_CLOEXEC(fd, &options);
           std::unique_ptr<PosixDirectIOWritableFile> file(
               new PosixDirectIOWritableFile(fname, fd));
           *result = std::move(file);
@@ -37,7 +37,11 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
     StopWatch sw(env_, stats_, hist_type_,
                  (stats_ != nullptr) ? &elapsed : nullptr);
     IOSTATS_TIMER_GUARD(read_nanos);
-    s = file_->Read(offset, n, result, scratch);
+    if (file_->UseDirectIO()) {
+      s = DirectRead(offset, n, result, scratch);
+    } else {
+      s = file_->Read(offset, n, result, scratch);
+    }
     IOSTATS_ADD_IF_POSITIVE(bytes_read, result->size());
   }
   if (stats_ != nullptr && file_read_hist_ != nullptr) {
@@ -46,6 +50,30 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+// Direct IO requires the offset, the size and the buffer of a read to be
+// aligned, so read the enclosing aligned range into an aligned buffer and copy
+// out the requested bytes.
+Status RandomAccessFileReader::DirectRead(uint64_t offset, size_t n,
+                                          Slice* result, char* scratch) const {
+  const size_t alignment = file_->GetRequiredBufferAlignment();
+  const uint64_t aligned_offset = offset - (offset % alignment);
+  const size_t offset_advance = static_cast<size_t>(offset - aligned_offset);
+  const size_t size = Roundup(offset_advance + n, alignment);
+
+  AlignedBuffer buf;
+  buf.Alignment(alignment);
+  buf.AllocateNewBuffer(size);
+  Slice tmp;
+  Status s = file_->Read(aligned_offset, size, &tmp, buf.Destination());
+  size_t r = 0;
+  if (s.ok() && tmp.size() > offset_advance) {
+    r = std::min(tmp.size() - offset_advance, n);
+    memcpy(scratch, tmp.data() + offset_advance, r);
+  }
+  *result = Slice(scratch, r);
+  return s;
+}
+
 Status WritableFileWriter::Append(const Slice& data) {
   const char* src = data.data();
   size_t left = data.size();
@@ -377,16 +405,25 @@ namespace {
 class ReadaheadRandomAccessFile : public RandomAccessFile {
  public:
   ReadaheadRandomAccessFile(std::unique_ptr<RandomAccessFile>&& file,
-                            size_t readahead_size)
+                            size_t readahead_size,
+                            size_t initial_readahead_size)
       : file_(std::move(file)),
-        readahead_size_(readahead_size),
+        alignment_(file_->GetRequiredBufferAlignment()),
+        max_readahead_size_(Roundup(readahead_size, alignment_)),
+        initial_readahead_size_(
+            initial_readahead_size > 0
+                ? std::min(Roundup(initial_readahead_size, alignment_),
+                           max_readahead_size_)
+                : max_readahead_size_),
         forward_calls_(file_->ShouldForwardRawRequest()),
+        readahead_size_(initial_readahead_size_),
+        prefetch_supported_(true),
         buffer_(),
-        buffer_offset_(0),
-        buffer_len_(0) {
+        buffer_offset_(0) {
     if (!forward_calls_) {
-      buffer_.reset(new char[readahead_size_]);
-    } else if (readahead_size_ > 0) {
+      buffer_.Alignment(alignment_);
+      buffer_.AllocateNewBuffer(readahead_size_);
+    } else if (max_readahead_size_ > 0) {
       file_->EnableReadAhead();
     }
   }
@@ -397,7 +434,7 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
 
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const override {
-    if (n >= readahead_size_) {
+    if (n + alignment_ >= max_readahead_size_) {
       return file_->Read(offset, n, result, scratch);
     }
 
@@ -412,33 +449,68 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
     std::unique_lock<std::mutex> lk(lock_);
 
     size_t copied = 0;
+    const size_t buffer_len = buffer_.CurrentSize();
     // if offset between [buffer_offset_, buffer_offset_ + buffer_len>
-    if (offset >= buffer_offset_ && offset < buffer_len_ + buffer_offset_) {
+    if (offset >= buffer_offset_ && offset < buffer_len + buffer_offset_) {
       uint64_t offset_in_buffer = offset - buffer_offset_;
-      copied = std::min(buffer_len_ - static_cast<size_t>(offset_in_buffer), n);
-      memcpy(scratch, buffer_.get() + offset_in_buffer, copied);
-      if (copied == n) {
-        // fully cached
-        *result = Slice(scratch, n);
+      copied = buffer_.Read(scratch, static_cast<size_t>(offset_in_buffer), n);
+      if (copied == n || buffer_len < readahead_size_) {
+        // fully cached, or the buffer already reaches the end of the file
+        *result = Slice(scratch, copied);
         return Status::OK();
       }
     }
+
+    // Read ahead from the aligned offset at or before the first missing
+    // byte, so that the reads of a direct IO file stay aligned.
+    const uint64_t missing_offset = offset + copied;
+    const uint64_t chunk_offset = missing_offset - missing_offset % alignment_;
+    const size_t skip = static_cast<size_t>(missing_offset - chunk_offset);
+    const bool sequential =
+        buffer_len > 0 && missing_offset == buffer_offset_ + buffer_len;
+    if (initial_readahead_size_ < max_readahead_size_) {
+      // The window grows while the reads continue where the buffer ends
+      // and starts over after a jump
+      size_t new_readahead_size =
+          sequential ? std::min(readahead_size_ * 2, max_readahead_size_)
+                     : initial_readahead_size_;
+      // but always covers the rest of this read
+      new_readahead_size = std::max(
+          new_readahead_size, Roundup(skip + n - copied, alignment_));
+      if (new_readahead_size > buffer_.Capacity()) {
+        buffer_.AllocateNewBuffer(new_readahead_size);
+      }
+      readahead_size_ = new_readahead_size;
+    }
+    buffer_.Clear();
     Slice readahead_result;
-    Status s = file_->Read(offset + copied, readahead_size_, &readahead_result,
-      buffer_.get());
+    Status s = file_->Read(chunk_offset, readahead_size_, &readahead_result,
+                           buffer_.Destination());
     if (!s.ok()) {
       return s;
     }
 
-    auto left_to_copy = std::min(readahead_result.size(), n - copied);
-    memcpy(scratch + copied, readahead_result.data(), left_to_copy);
+    size_t left_to_copy = 0;
+    if (readahead_result.size() > skip) {
+      left_to_copy = std::min(readahead_result.size() - skip, n - copied);
+    }
+    memcpy(scratch + copied, readahead_result.data() + skip, left_to_copy);
     *result = Slice(scratch, copied + left_to_copy);
 
-    if (readahead_result.data() == buffer_.get()) {
-      buffer_offset_ = offset + copied;
-      buffer_len_ = readahead_result.size();
-    } else {
-      buffer_len_ = 0;
+    if (readahead_result.data() == buffer_.BufferStart()) {
+      buffer_offset_ = chunk_offset;
+      buffer_.Size(readahead_result.size());
+    }
+
+    if (sequential && initial_readahead_size_ < max_readahead_size_ &&
+        prefetch_supported_ && readahead_result.size() == readahead_size_) {
+      // Have the next window read in the background while this one is
+      // consumed
+      const size_t next_readahead_size =
+          std::min(readahead_size_ * 2, max_readahead_size_);
+      prefetch_supported_ =
+          file_->Prefetch(chunk_offset + readahead_size_, next_readahead_size)
+              .ok();
     }
 
     return Status::OK();
@@ -448,6 +520,14 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
     return file_->GetUniqueId(id, max_size);
   }
 
+  // Reads that bypass the buffer go straight to file_, so they need the same
+  // alignment.
+  virtual bool UseDirectIO() const override { return file_->UseDirectIO(); }
+
+  virtual size_t GetRequiredBufferAlignment() const override {
+    return alignment_;
+  }
+
   virtual void Hint(AccessPattern pattern) override { file_->Hint(pattern); }
 
   virtual Status InvalidateCache(size_t offset, size_t length) override {
@@ -456,20 +536,25 @@ class ReadaheadRandomAccessFile : public RandomAccessFile {
 
  private:
   std::unique_ptr<RandomAccessFile> file_;
-  size_t               readahead_size_;
+  const size_t         alignment_;
+  const size_t         max_readahead_size_;
+  const size_t         initial_readahead_size_;
   const bool           forward_calls_;
 
   mutable std::mutex   lock_;
-  mutable std::unique_ptr<char[]> buffer_;
+  // Size of the last read into buffer_
+  mutable size_t       readahead_size_;
+  mutable bool         prefetch_supported_;
+  mutable AlignedBuffer buffer_;
   mutable uint64_t     buffer_offset_;
-  mutable size_t       buffer_len_;
 };
 }  // namespace
 
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
-    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size) {
-  std::unique_ptr<RandomAccessFile> result(
-    new ReadaheadRandomAccessFile(std::move(file), readahead_size));
+    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size,
+    size_t initial_readahead_size) {
+  std::unique_ptr<RandomAccessFile> result(new ReadaheadRandomAccessFile(
+      std::move(file), readahead_size, initial_readahead_size));
   return result;
 }
 
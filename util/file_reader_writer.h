@@ -17,8 +17,15 @@ namespace rocksdb {
 class Statistics;
 class HistogramImpl;
 
+// Returns a file that reads readahead_size bytes into a buffer when a read
+// misses it. If initial_readahead_size is smaller, the buffered reads start
+// at that size and double up to readahead_size while each one continues
+// where the previous one ended; a jump starts over. While growing, the next
+// window is also prefetched with RandomAccessFile::Prefetch() so that it is
+// read in the background while the current one is consumed.
 std::unique_ptr<RandomAccessFile> NewReadaheadRandomAccessFile(
-  std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size);
+    std::unique_ptr<RandomAccessFile>&& file, size_t readahead_size,
+    size_t initial_readahead_size = 0);
 
 class SequentialFileReader {
  private:
@@ -85,7 +92,15 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  Status Prefetch(uint64_t offset, size_t n) const {
+    return file_->Prefetch(offset, n);
+  }
+
   RandomAccessFile* file() { return file_.get(); }
+
+ private:
+  Status DirectRead(uint64_t offset, size_t n, Slice* result,
+                    char* scratch) const;
 };
 
 // Use posix write to write data to a file.
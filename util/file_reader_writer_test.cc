@@ -3,6 +3,8 @@
 //  LICENSE file in the root directory of this source tree. An additional grant
 //  of patent rights can be found in the PATENTS file in the same directory.
 //
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include "util/file_reader_writer.h"
 #include "util/random.h"
@@ -125,6 +127,136 @@ TEST_F(WritableFileWriterTest, AppendStatusReturn) {
   ASSERT_NOK(writer->Append(std::string(2 * kMb, 'b')));
 }
 
+class RandomAccessFileReaderTest : public testing::Test {};
+
+TEST_F(RandomAccessFileReaderTest, DirectIOReadsAreAligned) {
+  // A direct IO file that only accepts aligned reads into aligned buffers
+  class FakeDirectRAF : public RandomAccessFile {
+   public:
+    explicit FakeDirectRAF(const std::string& data) : data_(data) {}
+
+    Status Read(uint64_t offset, size_t n, Slice* result,
+                char* scratch) const override {
+      const size_t alignment = GetRequiredBufferAlignment();
+      if (offset % alignment != 0 || n % alignment != 0 ||
+          reinterpret_cast<uintptr_t>(scratch) % alignment != 0) {
+        return Status::InvalidArgument("Unaligned read");
+      }
+      size_t r = 0;
+      if (offset < data_.size()) {
+        r = std::min(n, data_.size() - static_cast<size_t>(offset));
+        memcpy(scratch, data_.data() + offset, r);
+      }
+      *result = Slice(scratch, r);
+      return Status::OK();
+    }
+    bool UseDirectIO() const override { return true; }
+    size_t GetRequiredBufferAlignment() const override { return 512; }
+
+   private:
+    std::string data_;
+  };
+
+  Random rnd(301);
+  std::string data;
+  for (int i = 0; i < 40000; i++) {
+    data.push_back(static_cast<char>(rnd.Uniform(256)));
+  }
+  for (size_t readahead : {size_t{0}, size_t{3000}}) {
+    std::unique_ptr<RandomAccessFile> file(new FakeDirectRAF(data));
+    if (readahead > 0) {
+      file = NewReadaheadRandomAccessFile(std::move(file), readahead);
+    }
+    RandomAccessFileReader reader(std::move(file));
+    std::string scratch(4000, '\0');
+    uint64_t offset = 0;
+    while (offset < data.size() + 100) {
+      size_t n = 1 + rnd.Uniform(3999);
+      Slice result;
+      ASSERT_OK(reader.Read(offset, n, &result, &scratch[0]));
+      size_t expected_size =
+          offset < data.size()
+              ? std::min(n, data.size() - static_cast<size_t>(offset))
+              : 0;
+      ASSERT_EQ(expected_size, result.size());
+      if (expected_size > 0) {
+        ASSERT_EQ(0,
+                  memcmp(data.data() + offset, result.data(), result.size()));
+      }
+      // Mostly forward with some overlap, sometimes the same range again
+      offset += rnd.OneIn(8) ? 0 : n / 2 + rnd.Uniform(static_cast<int>(n));
+    }
+  }
+}
+
+TEST_F(RandomAccessFileReaderTest, AdaptiveReadahead) {
+  // Records the reads and prefetches that reach the file
+  class RecordingRAF : public RandomAccessFile {
+   public:
+    explicit RecordingRAF(const std::string& data) : data_(data) {}
+
+    Status Read(uint64_t offset, size_t n, Slice* result,
+                char* scratch) const override {
+      reads_.push_back(n);
+      size_t r = 0;
+      if (offset < data_.size()) {
+        r = std::min(n, data_.size() - static_cast<size_t>(offset));
+        memcpy(scratch, data_.data() + offset, r);
+      }
+      *result = Slice(scratch, r);
+      return Status::OK();
+    }
+    Status Prefetch(uint64_t offset, size_t n) override {
+      prefetches_.emplace_back(offset, n);
+      return Status::OK();
+    }
+
+    mutable std::vector<size_t> reads_;
+    std::vector<std::pair<uint64_t, size_t>> prefetches_;
+
+   private:
+    std::string data_;
+  };
+
+  const size_t kKb = 1024;
+  Random rnd(301);
+  std::string data;
+  for (size_t i = 0; i < kMb; i++) {
+    data.push_back(static_cast<char>(rnd.Uniform(256)));
+  }
+  RecordingRAF* raf = new RecordingRAF(data);
+  RandomAccessFileReader reader(NewReadaheadRandomAccessFile(
+      std::unique_ptr<RandomAccessFile>(raf), 64 * kKb, 8 * kKb));
+  std::string scratch(32 * kKb, '\0');
+  auto read = [&](uint64_t offset, size_t n) {
+    Slice result;
+    ASSERT_OK(reader.Read(offset, n, &result, &scratch[0]));
+    ASSERT_EQ(n, result.size());
+    ASSERT_EQ(0, memcmp(data.data() + offset, result.data(), n));
+  };
+
+  // The window doubles each time a sequential scan runs out of it, and the
+  // next window is prefetched meanwhile
+  for (uint64_t offset = 0; offset < 120 * kKb; offset += 4 * kKb) {
+    read(offset, 4 * kKb);
+  }
+  ASSERT_EQ(std::vector<size_t>({8 * kKb, 16 * kKb, 32 * kKb, 64 * kKb}),
+            raf->reads_);
+  ASSERT_EQ(3U, raf->prefetches_.size());
+  ASSERT_EQ(24 * kKb, raf->prefetches_[0].first);
+  ASSERT_EQ(32 * kKb, raf->prefetches_[0].second);
+  ASSERT_EQ(120 * kKb, raf->prefetches_[2].first);
+  ASSERT_EQ(64 * kKb, raf->prefetches_[2].second);
+
+  // A jump starts over from the initial window, which still covers the
+  // whole read
+  read(512 * kKb, 4 * kKb);
+  ASSERT_EQ(8 * kKb, raf->reads_.back());
+  read(700 * kKb, 20 * kKb);
+  ASSERT_EQ(20 * kKb, raf->reads_.back());
+  ASSERT_EQ(3U, raf->prefetches_.size());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -99,7 +99,7 @@ Status ReadAligned(int fd, Slice* data, const uint64_t offset,
     status =
         pread(fd, scratch + bytes_read, size - bytes_read, offset + bytes_read);
     if (status <= 0) {
-      if (errno == EINTR) {
+      if (status < 0 && errno == EINTR) {
         continue;
       }
       break;
@@ -135,18 +135,20 @@ Status ReadUnaligned(int fd, Slice* data, const uint64_t offset,
   Status s = ReadAligned(fd, &scratch_slice, aligned_off, aligned_size,
                          reinterpret_cast<char*>(aligned_scratch.get()));
 
-  // copy data upto min(size, what was read)
-  memcpy(scratch, reinterpret_cast<char*>(aligned_scratch.get()) +
-                      (offset % kSectorSize),
-         std::min(size, scratch_slice.size()));
-  *data = Slice(scratch, std::min(size, scratch_slice.size()));
+  // copy data upto min(size, what was read past offset)
+  const size_t skip = static_cast<size_t>(offset - aligned_off);
+  const size_t copy =
+      scratch_slice.size() > skip
+          ? std::min(size, scratch_slice.size() - skip)
+          : 0;
+  memcpy(scratch, reinterpret_cast<char*>(aligned_scratch.get()) + skip, copy);
+  *data = Slice(scratch, copy);
   return s;
 }
 
 Status DirectIORead(int fd, Slice* result, size_t off, size_t n,
                     char* scratch) {
-  if (IsSectorAligned(off) && IsSectorAligned(n) &&
-      IsPageAligned(result->data())) {
+  if (IsSectorAligned(off) && IsSectorAligned(n) && IsPageAligned(scratch)) {
     return ReadAligned(fd, result, off, n, scratch);
   }
   return ReadUnaligned(fd, result, off, n, scratch);
@@ -358,6 +360,19 @@ void PosixRandomAccessFile::Hint(AccessPattern pattern) {
   }
 }
 
+Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
+#ifndef OS_LINUX
+  return Status::NotSupported("Prefetch not supported.");
+#else
+  // readahead() doesn't wait for the data, but it can block while it
+  // submits the reads, e.g. when the device queue is full
+  if (readahead(fd_, static_cast<off64_t>(offset), n) == 0) {
+    return Status::OK();
+  }
+  return IOError(filename_, errno);
+#endif
+}
+
 Status PosixRandomAccessFile::InvalidateCache(size_t offset, size_t length) {
 #ifndef OS_LINUX
   return Status::OK();
@@ -693,6 +708,25 @@ Status PosixWritableFile::Append(const Slice& data) {
   return Status::OK();
 }
 
+Status PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset) {
+  const char* src = data.data();
+  size_t left = data.size();
+  while (left != 0) {
+    ssize_t done = pwrite(fd_, src, left, static_cast<off_t>(offset));
+    if (done < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return IOError(filename_, errno);
+    }
+    left -= done;
+    offset += done;
+    src += done;
+  }
+  filesize_ = offset;
+  return Status::OK();
+}
+
 Status PosixWritableFile::Close() {
   Status s;
 
@@ -824,6 +858,15 @@ Status PosixDirectIOWritableFile::PositionedAppend(const Slice& data,
   return PosixWritableFile::PositionedAppend(data, offset);
 }
 
+Status PosixDirectIOWritableFile::Truncate(uint64_t size) {
+  // Whole pages were written, so cut the zero padding of the last one.
+  if (ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+    return IOError(filename_, errno);
+  }
+  filesize_ = size;
+  return Status::OK();
+}
+
 /*
  * PosixDirectory
  */
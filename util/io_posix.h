@@ -83,6 +83,7 @@ class PosixRandomAccessFile : public RandomAccessFile {
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
   virtual void Hint(AccessPattern pattern) override;
+  virtual Status Prefetch(uint64_t offset, size_t n) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
 };
 
@@ -95,6 +96,12 @@ class PosixDirectIORandomAccessFile : public PosixRandomAccessFile {
 
   Status Read(uint64_t offset, size_t n, Slice* result,
               char* scratch) const override;
+  bool UseDirectIO() const override { return true; }
+  size_t GetRequiredBufferAlignment() const override { return 4 * 1024; }
+  // Reads bypass the page cache, so there is nothing to prefetch into
+  Status Prefetch(uint64_t offset, size_t n) override {
+    return Status::NotSupported("Prefetch not supported with direct IO.");
+  }
   virtual void Hint(AccessPattern pattern) override {}
   Status InvalidateCache(size_t offset, size_t length) override {
     return Status::OK();
@@ -121,6 +128,7 @@ class PosixWritableFile : public WritableFile {
   virtual Status Truncate(uint64_t size) override { return Status::OK(); }
   virtual Status Close() override;
   virtual Status Append(const Slice& data) override;
+  virtual Status PositionedAppend(const Slice& data, uint64_t offset) override;
   virtual Status Flush() override;
   virtual Status Sync() override;
   virtual Status Fsync() override;
@@ -144,6 +152,7 @@ class PosixDirectIOWritableFile : public PosixWritableFile {
   size_t GetRequiredBufferAlignment() const override { return 4 * 1024; }
   Status Append(const Slice& data) override;
   Status PositionedAppend(const Slice& data, uint64_t offset) override;
+  Status Truncate(uint64_t size) override;
   bool UseDirectIO() const override { return true; }
   Status InvalidateCache(size_t offset, size_t length) override {
     return Status::OK();
@@ -45,6 +45,10 @@ namespace {
 // that any successful LRUCacheShard::Lookup/LRUCacheShard::Insert have a
 // matching
 // RUCache::Release (to move into state 2) or LRUCacheShard::Erase (for state 3)
+//
+// Entries inserted with Cache::Priority::HIGH are kept in a separate
+// high-pri pool at the head of the LRU list (if the pool is enabled), so a
+// burst of low priority entries cannot push them out of the cache.
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
@@ -56,6 +60,8 @@ struct LRUHandle {
   uint32_t refs;     // a number of refs to this entry
                      // cache itself is counted as 1
   bool in_cache;     // true, if this entry is referenced by the hash table
+  bool is_high_pri;  // true, if this entry was inserted with high priority
+  bool in_high_pri_pool;  // true, if this entry is in the high-pri pool
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
   char key_data[1];  // Beginning of key
 
@@ -196,11 +202,15 @@ class LRUCacheShard : public CacheShard {
   // Set the flag to reject insertion if cache if full.
   virtual void SetStrictCapacityLimit(bool strict_capacity_limit) override;
 
+  // Set percentage of capacity reserved for high-pri cache entries.
+  void SetHighPriorityPoolRatio(double high_pri_pool_ratio);
+
   // Like Cache methods, but with an extra "hash" parameter.
   virtual Status Insert(const Slice& key, uint32_t hash, void* value,
                         size_t charge,
                         void (*deleter)(const Slice& key, void* value),
-                        Cache::Handle** handle) override;
+                        Cache::Handle** handle,
+                        Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
   virtual void Release(Cache::Handle* handle) override;
   virtual void Erase(const Slice& key, uint32_t hash) override;
@@ -227,7 +237,12 @@ class LRUCacheShard : public CacheShard {
 
  private:
   void LRU_Remove(LRUHandle* e);
-  void LRU_Append(LRUHandle* e);
+  void LRU_Insert(LRUHandle* e);
+
+  // Overflow the last entry in high-pri pool to low-pri pool until size of
+  // high-pri pool is no larger than the size specify by high_pri_pool_pct.
+  void MaintainPoolSize();
+
   // Just reduce the reference count by 1.
   // Return true if last reference
   bool Unref(LRUHandle* e);
@@ -247,6 +262,16 @@ class LRUCacheShard : public CacheShard {
   // Memory size for entries residing only in the LRU list
   size_t lru_usage_;
 
+  // Memory size for entries in high-pri pool.
+  size_t high_pri_pool_usage_;
+
+  // Ratio of capacity reserved for high priority cache entries.
+  double high_pri_pool_ratio_;
+
+  // High-pri pool size, equals to capacity * high_pri_pool_ratio.
+  // Remember the value to avoid recomputing each time.
+  double high_pri_pool_capacity_;
+
   // Whether to reject insertion if cache reaches its full capacity.
   bool strict_capacity_limit_;
 
@@ -260,13 +285,23 @@ class LRUCacheShard : public CacheShard {
   // LRU contains items which can be evicted, ie reference only by cache
   LRUHandle lru_;
 
+  // Pointer to head of low-pri pool in LRU list. Entries between lru_low_pri_
+  // and lru_ (excluding both) make up the high-pri pool.
+  LRUHandle* lru_low_pri_;
+
   HandleTable table_;
 };
 
-LRUCacheShard::LRUCacheShard() : usage_(0), lru_usage_(0) {
+LRUCacheShard::LRUCacheShard()
+    : usage_(0),
+      lru_usage_(0),
+      high_pri_pool_usage_(0),
+      high_pri_pool_ratio_(0),
+      high_pri_pool_capacity_(0) {
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
+  lru_low_pri_ = &lru_;
 }
 
 LRUCacheShard::~LRUCacheShard() {}
@@ -317,23 +352,54 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
 void LRUCacheShard::LRU_Remove(LRUHandle* e) {
   assert(e->next != nullptr);
   assert(e->prev != nullptr);
+  if (lru_low_pri_ == e) {
+    lru_low_pri_ = e->prev;
+  }
   e->next->prev = e->prev;
   e->prev->next = e->next;
   e->prev = e->next = nullptr;
   lru_usage_ -= e->charge;
+  if (e->in_high_pri_pool) {
+    assert(high_pri_pool_usage_ >= e->charge);
+    high_pri_pool_usage_ -= e->charge;
+  }
 }
 
-void LRUCacheShard::LRU_Append(LRUHandle* e) {
-  // Make "e" newest entry by inserting just before lru_
+void LRUCacheShard::LRU_Insert(LRUHandle* e) {
   assert(e->next == nullptr);
   assert(e->prev == nullptr);
-  e->next = &lru_;
-  e->prev = lru_.prev;
-  e->prev->next = e;
-  e->next->prev = e;
+  if (high_pri_pool_ratio_ > 0 && e->is_high_pri) {
+    // Insert "e" to head of LRU list.
+    e->next = &lru_;
+    e->prev = lru_.prev;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->in_high_pri_pool = true;
+    high_pri_pool_usage_ += e->charge;
+    MaintainPoolSize();
+  } else {
+    // Insert "e" to the head of low-pri pool. Note that when
+    // high_pri_pool_ratio is 0, head of low-pri pool is also head of LRU list.
+    e->next = lru_low_pri_->next;
+    e->prev = lru_low_pri_;
+    e->prev->next = e;
+    e->next->prev = e;
+    e->in_high_pri_pool = false;
+    lru_low_pri_ = e;
+  }
   lru_usage_ += e->charge;
 }
 
+void LRUCacheShard::MaintainPoolSize() {
+  while (high_pri_pool_usage_ > high_pri_pool_capacity_) {
+    // Overflow last entry in high-pri pool to low-pri pool.
+    lru_low_pri_ = lru_low_pri_->next;
+    assert(lru_low_pri_ != &lru_);
+    lru_low_pri_->in_high_pri_pool = false;
+    high_pri_pool_usage_ -= lru_low_pri_->charge;
+  }
+}
+
 void LRUCacheShard::EvictFromLRU(size_t charge,
                                  autovector<LRUHandle*>* deleted) {
   while (usage_ + charge > capacity_ && lru_.next != &lru_) {
@@ -354,6 +420,8 @@ void LRUCacheShard::SetCapacity(size_t capacity) {
   {
     MutexLock l(&mutex_);
     capacity_ = capacity;
+    high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+    MaintainPoolSize();
     EvictFromLRU(0, &last_reference_list);
   }
   // we free the entries here outside of mutex for
@@ -368,6 +436,13 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
+void LRUCacheShard::SetHighPriorityPoolRatio(double high_pri_pool_ratio) {
+  MutexLock l(&mutex_);
+  high_pri_pool_ratio_ = high_pri_pool_ratio;
+  high_pri_pool_capacity_ = capacity_ * high_pri_pool_ratio_;
+  MaintainPoolSize();
+}
+
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
   MutexLock l(&mutex_);
   LRUHandle* e = table_.Lookup(key, hash);
@@ -407,7 +482,7 @@ void LRUCacheShard::Release(Cache::Handle* handle) {
         last_reference = true;
       } else {
         // put the item on the list to be potentially freed
-        LRU_Append(e);
+        LRU_Insert(e);
       }
     }
   }
@@ -421,7 +496,7 @@ void LRUCacheShard::Release(Cache::Handle* handle) {
 Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
-                             Cache::Handle** handle) {
+                             Cache::Handle** handle, Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -440,6 +515,8 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                  : 2);  // One from LRUCache, one for the returned handle
   e->next = e->prev = nullptr;
   e->in_cache = true;
+  e->is_high_pri = (priority == Cache::Priority::HIGH);
+  e->in_high_pri_pool = false;
   memcpy(e->key_data, key.data(), key.size());
 
   {
@@ -474,7 +551,7 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
         }
       }
       if (handle == nullptr) {
-        LRU_Append(e);
+        LRU_Insert(e);
       } else {
         *handle = reinterpret_cast<Cache::Handle*>(e);
       }
@@ -518,12 +595,16 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
 
 class LRUCache : public ShardedCache {
  public:
-  LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit)
+  LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
+           double high_pri_pool_ratio)
       : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
     int num_shards = 1 << num_shard_bits;
     shards_ = new LRUCacheShard[num_shards];
     SetCapacity(capacity);
     SetStrictCapacityLimit(strict_capacity_limit);
+    for (int i = 0; i < num_shards; i++) {
+      shards_[i].SetHighPriorityPoolRatio(high_pri_pool_ratio);
+    }
   }
 
   virtual ~LRUCache() { delete[] shards_; }
@@ -557,12 +638,17 @@ class LRUCache : public ShardedCache {
 }  // end anonymous namespace
 
 std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
-                                   bool strict_capacity_limit) {
+                                   bool strict_capacity_limit,
+                                   double high_pri_pool_ratio) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
+  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+    // invalid high_pri_pool_ratio
+    return nullptr;
+  }
   return std::make_shared<LRUCache>(capacity, num_shard_bits,
-                                    strict_capacity_limit);
+                                    strict_capacity_limit, high_pri_pool_ratio);
 }
 
 }  // namespace rocksdb
@@ -72,6 +72,8 @@ void MutableCFOptions::Dump(Logger* log) const {
       arena_block_size);
   Log(log, "              memtable_prefix_bloom_ratio: %f",
       memtable_prefix_bloom_size_ratio);
+  Log(log, "             memtable_whole_key_filtering: %d",
+      memtable_whole_key_filtering);
   Log(log, " memtable_huge_page_size: %" ROCKSDB_PRIszt,
       memtable_huge_page_size);
   Log(log, "                    max_successive_merges: %" ROCKSDB_PRIszt,
@@ -82,6 +84,8 @@ void MutableCFOptions::Dump(Logger* log) const {
       soft_pending_compaction_bytes_limit);
   Log(log, "      hard_pending_compaction_bytes_limit: %" PRIu64,
       hard_pending_compaction_bytes_limit);
+  Log(log, "                    adaptive_write_pacing: %d",
+      adaptive_write_pacing);
   Log(log, "       level0_file_num_compaction_trigger: %d",
       level0_file_num_compaction_trigger);
   Log(log, "           level0_slowdown_writes_trigger: %d",
@@ -106,6 +106,7 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       hard_rate_limit(0.0),
       soft_pending_compaction_bytes_limit(64 * 1073741824ull),
       hard_pending_compaction_bytes_limit(256 * 1073741824ull),
+      adaptive_write_pacing(false),
       rate_limit_delay_max_milliseconds(1000),
       arena_block_size(0),
       disable_auto_compactions(false),
@@ -121,6 +122,7 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       inplace_update_num_locks(10000),
       inplace_callback(nullptr),
       memtable_prefix_bloom_size_ratio(0.0),
+      memtable_whole_key_filtering(false),
       memtable_huge_page_size(0),
       bloom_locality(0),
       max_successive_merges(0),
@@ -168,6 +170,7 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
           options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
           options.hard_pending_compaction_bytes_limit),
+      adaptive_write_pacing(options.adaptive_write_pacing),
       rate_limit_delay_max_milliseconds(
           options.rate_limit_delay_max_milliseconds),
       arena_block_size(options.arena_block_size),
@@ -189,6 +192,7 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       inplace_callback(options.inplace_callback),
       memtable_prefix_bloom_size_ratio(
           options.memtable_prefix_bloom_size_ratio),
+      memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       memtable_huge_page_size(options.memtable_huge_page_size),
       bloom_locality(options.bloom_locality),
       max_successive_merges(options.max_successive_merges),
@@ -242,6 +246,8 @@ DBOptions::DBOptions()
       allow_os_buffer(true),
       allow_mmap_reads(false),
       allow_mmap_writes(false),
+      use_direct_reads(false),
+      use_direct_io_for_flush_and_compaction(false),
       allow_fallocate(true),
       is_fd_close_on_exec(true),
       skip_log_error_on_recovery(false),
@@ -261,6 +267,7 @@ DBOptions::DBOptions()
       delayed_write_rate(2 * 1024U * 1024U),
       allow_concurrent_memtable_write(false),
       enable_write_thread_adaptive_yield(false),
+      enable_pipelined_write(false),
       write_thread_max_yield_usec(100),
       write_thread_slow_yield_usec(3),
       skip_stats_update_on_db_open(false),
@@ -271,7 +278,9 @@ DBOptions::DBOptions()
 #endif  // ROCKSDB_LITE
       fail_if_options_file_error(false),
       dump_malloc_stats(false),
-      avoid_flush_during_recovery(false) {
+      avoid_flush_during_recovery(false),
+      wal_recovery_threads(1),
+      skip_table_open_on_db_open(false) {
 }
 
 DBOptions::DBOptions(const Options& options)
@@ -311,6 +320,9 @@ DBOptions::DBOptions(const Options& options)
       allow_os_buffer(options.allow_os_buffer),
       allow_mmap_reads(options.allow_mmap_reads),
       allow_mmap_writes(options.allow_mmap_writes),
+      use_direct_reads(options.use_direct_reads),
+      use_direct_io_for_flush_and_compaction(
+          options.use_direct_io_for_flush_and_compaction),
       allow_fallocate(options.allow_fallocate),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       skip_log_error_on_recovery(options.skip_log_error_on_recovery),
@@ -333,6 +345,7 @@ DBOptions::DBOptions(const Options& options)
       allow_concurrent_memtable_write(options.allow_concurrent_memtable_write),
       enable_write_thread_adaptive_yield(
           options.enable_write_thread_adaptive_yield),
+      enable_pipelined_write(options.enable_pipelined_write),
       write_thread_max_yield_usec(options.write_thread_max_yield_usec),
       write_thread_slow_yield_usec(options.write_thread_slow_yield_usec),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
@@ -343,7 +356,9 @@ DBOptions::DBOptions(const Options& options)
 #endif  // ROCKSDB_LITE
       fail_if_options_file_error(options.fail_if_options_file_error),
       dump_malloc_stats(options.dump_malloc_stats),
-      avoid_flush_during_recovery(options.avoid_flush_during_recovery) {
+      avoid_flush_during_recovery(options.avoid_flush_during_recovery),
+      wal_recovery_threads(options.wal_recovery_threads),
+      skip_table_open_on_db_open(options.skip_table_open_on_db_open) {
 }
 
 static const char* const access_hints[] = {
@@ -408,6 +423,10 @@ void DBOptions::Dump(Logger* log) const {
         allow_mmap_reads);
     Header(log, "                       Options.allow_mmap_writes: %d",
         allow_mmap_writes);
+    Header(log, "                        Options.use_direct_reads: %d",
+        use_direct_reads);
+    Header(log, "  Options.use_direct_io_for_flush_and_compaction: %d",
+        use_direct_io_for_flush_and_compaction);
     Header(log, "                     Options.is_fd_close_on_exec: %d",
         is_fd_close_on_exec);
     Header(log, "                   Options.stats_dump_period_sec: %u",
@@ -454,6 +473,8 @@ void DBOptions::Dump(Logger* log) const {
            allow_concurrent_memtable_write);
     Header(log, "      Options.enable_write_thread_adaptive_yield: %d",
            enable_write_thread_adaptive_yield);
+    Header(log, "                  Options.enable_pipelined_write: %d",
+           enable_pipelined_write);
     Header(log, "             Options.write_thread_max_yield_usec: %" PRIu64,
            write_thread_max_yield_usec);
     Header(log, "            Options.write_thread_slow_yield_usec: %" PRIu64,
@@ -470,6 +491,10 @@ void DBOptions::Dump(Logger* log) const {
 #endif  // ROCKDB_LITE
     Header(log, "                    Options.avoid_flush_during_recovery: %d",
            avoid_flush_during_recovery);
+    Header(log, "                           Options.wal_recovery_threads: %d",
+           wal_recovery_threads);
+    Header(log, "                     Options.skip_table_open_on_db_open: %d",
+           skip_table_open_on_db_open);
 }  // DBOptions::Dump
 
 void ColumnFamilyOptions::Dump(Logger* log) const {
@@ -516,6 +541,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     Header(log,
         "        Options.compression_opts.max_dict_bytes: %" ROCKSDB_PRIszt,
         compression_opts.max_dict_bytes);
+    Header(log, "  Options.compression_opts.zstd_max_train_bytes: %" PRIu32,
+        compression_opts.zstd_max_train_bytes);
+    Header(log, "      Options.compression_opts.parallel_threads: %" PRIu32,
+        compression_opts.parallel_threads);
+    Header(log, "    Options.compression_opts.use_dict_for_flush: %d",
+        compression_opts.use_dict_for_flush);
     Header(log, "     Options.level0_file_num_compaction_trigger: %d",
         level0_file_num_compaction_trigger);
     Header(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -555,6 +586,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
            soft_pending_compaction_bytes_limit);
     Header(log, "  Options.hard_pending_compaction_bytes_limit: %" PRIu64,
          hard_pending_compaction_bytes_limit);
+    Header(log, "                  Options.adaptive_write_pacing: %d",
+           adaptive_write_pacing);
     Header(log, "      Options.rate_limit_delay_max_milliseconds: %u",
         rate_limit_delay_max_milliseconds);
     Header(log, "               Options.disable_auto_compactions: %d",
@@ -580,6 +613,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     Header(log,
         "Options.compaction_options_fifo.max_table_files_size: %" PRIu64,
         compaction_options_fifo.max_table_files_size);
+    Header(log, "Options.compaction_options_fifo.ttl: %" PRIu64,
+           compaction_options_fifo.ttl);
+    Header(log, "Options.compaction_options_fifo.allow_compaction: %d",
+           compaction_options_fifo.allow_compaction);
     std::string collector_names;
     for (const auto& collector_factory : table_properties_collector_factories) {
       collector_names.append(collector_factory->Name());
@@ -597,6 +634,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     // TODO: easier config for bloom (maybe based on avg key/value size)
     Header(log, "              Options.memtable_prefix_bloom_size_ratio: %f",
            memtable_prefix_bloom_size_ratio);
+    Header(log, "                  Options.memtable_whole_key_filtering: %d",
+           memtable_whole_key_filtering);
 
     Header(log, "  Options.memtable_huge_page_size: %" ROCKSDB_PRIszt,
            memtable_huge_page_size);
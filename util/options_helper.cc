@@ -357,6 +357,11 @@ bool ParseOptionHelper(char* opt_address, const OptionType& opt_type,
       return ParseEnum<BlockBasedTableOptions::IndexType>(
           block_base_table_index_type_string_map, value,
           reinterpret_cast<BlockBasedTableOptions::IndexType*>(opt_address));
+    case OptionType::kBlockBasedTableDataBlockIndexType:
+      return ParseEnum<BlockBasedTableOptions::DataBlockIndexType>(
+          block_base_table_data_block_index_type_string_map, value,
+          reinterpret_cast<BlockBasedTableOptions::DataBlockIndexType*>(
+              opt_address));
     case OptionType::kEncodingType:
       return ParseEnum<EncodingType>(
           encoding_type_string_map, value,
@@ -499,6 +504,12 @@ bool SerializeSingleOptionHelper(const char* opt_address,
           *reinterpret_cast<const BlockBasedTableOptions::IndexType*>(
               opt_address),
           value);
+    case OptionType::kBlockBasedTableDataBlockIndexType:
+      return SerializeEnum<BlockBasedTableOptions::DataBlockIndexType>(
+          block_base_table_data_block_index_type_string_map,
+          *reinterpret_cast<const BlockBasedTableOptions::DataBlockIndexType*>(
+              opt_address),
+          value);
     case OptionType::kFlushBlockPolicyFactory: {
       const auto* ptr =
           reinterpret_cast<const std::shared_ptr<FlushBlockPolicyFactory>*>(
@@ -540,6 +551,8 @@ bool ParseMemtableOptions(const std::string& name, const std::string& value,
     // deprecated
   } else if (name == "memtable_prefix_bloom_size_ratio") {
     new_options->memtable_prefix_bloom_size_ratio = ParseDouble(value);
+  } else if (name == "memtable_whole_key_filtering") {
+    new_options->memtable_whole_key_filtering = ParseBoolean(name, value);
   } else if (name == "memtable_prefix_bloom_probes") {
     // Deprecated
   } else if (name == "memtable_prefix_bloom_huge_page_tlb_size") {
@@ -572,6 +585,8 @@ bool ParseCompactionOptions(const std::string& name, const std::string& value,
     new_options->soft_pending_compaction_bytes_limit = ParseUint64(value);
   } else if (name == "hard_pending_compaction_bytes_limit") {
     new_options->hard_pending_compaction_bytes_limit = ParseUint64(value);
+  } else if (name == "adaptive_write_pacing") {
+    new_options->adaptive_write_pacing = ParseBoolean(name, value);
   } else if (name == "hard_rate_limit") {
     // Deprecated options but still leave it here to avoid older options
     // strings can be consumed.
@@ -802,43 +817,63 @@ Status ParseColumnFamilyOption(const std::string& name,
       }
       new_options->memtable_factory.reset(new_mem_factory.release());
     } else if (name == "compression_opts") {
-      size_t start = 0;
-      size_t end = value.find(':');
-      if (end == std::string::npos) {
+      // window_bits:level:strategy, optionally followed by
+      // :max_dict_bytes[:parallel_threads[:zstd_max_train_bytes
+      // [:use_dict_for_flush]]]
+      std::vector<std::string> fields = StringSplit(value, ':');
+      if (fields.size() < 3 || fields.size() > 7 || value.back() == ':') {
         return Status::InvalidArgument(
             "unable to parse the specified CF option " + name);
       }
-      new_options->compression_opts.window_bits =
-          ParseInt(value.substr(start, end - start));
-      start = end + 1;
-      end = value.find(':', start);
-      if (end == std::string::npos) {
-        return Status::InvalidArgument(
-            "unable to parse the specified CF option " + name);
+      for (const auto& field : fields) {
+        if (field.empty()) {
+          return Status::InvalidArgument(
+              "unable to parse the specified CF option " + name);
+        }
       }
-      new_options->compression_opts.level =
-          ParseInt(value.substr(start, end - start));
-      start = end + 1;
-      if (start >= value.size()) {
-        return Status::InvalidArgument(
-            "unable to parse the specified CF option " + name);
+      new_options->compression_opts.window_bits = ParseInt(fields[0]);
+      new_options->compression_opts.level = ParseInt(fields[1]);
+      new_options->compression_opts.strategy = ParseInt(fields[2]);
+      if (fields.size() > 3) {
+        new_options->compression_opts.max_dict_bytes = ParseInt(fields[3]);
+      }
+      if (fields.size() > 4) {
+        new_options->compression_opts.parallel_threads =
+            ParseUint32(fields[4]);
       }
-      end = value.find(':', start);
-      new_options->compression_opts.strategy =
-          ParseInt(value.substr(start, value.size() - start));
-      // max_dict_bytes is optional for backwards compatibility
+      if (fields.size() > 5) {
+        new_options->compression_opts.zstd_max_train_bytes =
+            ParseUint32(fields[5]);
+      }
+      if (fields.size() > 6) {
+        new_options->compression_opts.use_dict_for_flush =
+            ParseBoolean(name, fields[6]);
+      }
+    } else if (name == "compaction_options_fifo") {
+      // max_table_files_size[:ttl[:allow_compaction]]
+      size_t start = 0;
+      size_t end = value.find(':');
+      new_options->compaction_options_fifo.max_table_files_size =
+          ParseUint64(value.substr(start, end - start));
       if (end != std::string::npos) {
         start = end + 1;
         if (start >= value.size()) {
           return Status::InvalidArgument(
               "unable to parse the specified CF option " + name);
         }
-        new_options->compression_opts.max_dict_bytes =
-            ParseInt(value.substr(start, value.size() - start));
+        end = value.find(':', start);
+        new_options->compaction_options_fifo.ttl = ParseUint64(
+            value.substr(start, end == std::string::npos ? end : end - start));
+      }
+      if (end != std::string::npos) {
+        start = end + 1;
+        if (start >= value.size()) {
+          return Status::InvalidArgument(
+              "unable to parse the specified CF option " + name);
+        }
+        new_options->compaction_options_fifo.allow_compaction =
+            ParseBoolean(name, value.substr(start));
       }
-    } else if (name == "compaction_options_fifo") {
-      new_options->compaction_options_fifo.max_table_files_size =
-          ParseUint64(value);
     } else {
       auto iter = cf_options_type_info.find(name);
       if (iter == cf_options_type_info.end()) {
@@ -1444,6 +1479,8 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   cf_opts.arena_block_size = mutable_cf_options.arena_block_size;
   cf_opts.memtable_prefix_bloom_size_ratio =
       mutable_cf_options.memtable_prefix_bloom_size_ratio;
+  cf_opts.memtable_whole_key_filtering =
+      mutable_cf_options.memtable_whole_key_filtering;
   cf_opts.memtable_huge_page_size = mutable_cf_options.memtable_huge_page_size;
   cf_opts.max_successive_merges = mutable_cf_options.max_successive_merges;
   cf_opts.inplace_update_num_locks =
@@ -1452,6 +1489,7 @@ ColumnFamilyOptions BuildColumnFamilyOptions(
   // Compaction related options
   cf_opts.disable_auto_compactions =
       mutable_cf_options.disable_auto_compactions;
+  cf_opts.adaptive_write_pacing = mutable_cf_options.adaptive_write_pacing;
   cf_opts.level0_file_num_compaction_trigger =
       mutable_cf_options.level0_file_num_compaction_trigger;
   cf_opts.level0_slowdown_writes_trigger =
@@ -89,6 +89,7 @@ enum class OptionType {
   kMergeOperator,
   kMemTableRepFactory,
   kBlockBasedTableIndexType,
+  kBlockBasedTableDataBlockIndexType,
   kFilterPolicy,
   kFlushBlockPolicyFactory,
   kChecksumType,
@@ -167,6 +168,12 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"allow_mmap_writes",
      {offsetof(struct DBOptions, allow_mmap_writes), OptionType::kBoolean,
       OptionVerificationType::kNormal}},
+    {"use_direct_reads",
+     {offsetof(struct DBOptions, use_direct_reads), OptionType::kBoolean,
+      OptionVerificationType::kNormal}},
+    {"use_direct_io_for_flush_and_compaction",
+     {offsetof(struct DBOptions, use_direct_io_for_flush_and_compaction),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"allow_2pc",
      {offsetof(struct DBOptions, allow_2pc), OptionType::kBoolean,
       OptionVerificationType::kNormal}},
@@ -305,6 +312,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"enable_write_thread_adaptive_yield",
      {offsetof(struct DBOptions, enable_write_thread_adaptive_yield),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"enable_pipelined_write",
+     {offsetof(struct DBOptions, enable_pipelined_write),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"write_thread_slow_yield_usec",
      {offsetof(struct DBOptions, write_thread_slow_yield_usec),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
@@ -322,6 +332,12 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
       OptionVerificationType::kNormal}},
     {"avoid_flush_during_recovery",
      {offsetof(struct DBOptions, avoid_flush_during_recovery),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"wal_recovery_threads",
+     {offsetof(struct DBOptions, wal_recovery_threads), OptionType::kInt,
+      OptionVerificationType::kNormal}},
+    {"skip_table_open_on_db_open",
+     {offsetof(struct DBOptions, skip_table_open_on_db_open),
       OptionType::kBoolean, OptionVerificationType::kNormal}}};
 
 static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
@@ -374,6 +390,9 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"hard_pending_compaction_bytes_limit",
      {offsetof(struct ColumnFamilyOptions, hard_pending_compaction_bytes_limit),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"adaptive_write_pacing",
+     {offsetof(struct ColumnFamilyOptions, adaptive_write_pacing),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"hard_rate_limit",
      {offsetof(struct ColumnFamilyOptions, hard_rate_limit),
       OptionType::kDouble, OptionVerificationType::kDeprecated}},
@@ -444,6 +463,9 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"memtable_prefix_bloom_size_ratio",
      {offsetof(struct ColumnFamilyOptions, memtable_prefix_bloom_size_ratio),
       OptionType::kDouble, OptionVerificationType::kNormal}},
+    {"memtable_whole_key_filtering",
+     {offsetof(struct ColumnFamilyOptions, memtable_whole_key_filtering),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"memtable_prefix_bloom_probes",
      {0, OptionType::kUInt32T, OptionVerificationType::kDeprecated}},
     {"min_partial_merge_operands",
@@ -520,6 +542,18 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"hash_index_allow_collision",
          {offsetof(struct BlockBasedTableOptions, hash_index_allow_collision),
           OptionType::kBoolean, OptionVerificationType::kNormal}},
+        {"data_block_index_type",
+         {offsetof(struct BlockBasedTableOptions, data_block_index_type),
+          OptionType::kBlockBasedTableDataBlockIndexType,
+          OptionVerificationType::kNormal}},
+        {"data_block_hash_table_util_ratio",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_hash_table_util_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal}},
+        {"data_block_restart_key_prefixes",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_restart_key_prefixes),
+          OptionType::kBoolean, OptionVerificationType::kNormal}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal}},
@@ -544,6 +578,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"whole_key_filtering",
          {offsetof(struct BlockBasedTableOptions, whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal}},
+        {"partition_filters",
+         {offsetof(struct BlockBasedTableOptions, partition_filters),
+          OptionType::kBoolean, OptionVerificationType::kNormal}},
         {"skip_table_builder_flush",
          {offsetof(struct BlockBasedTableOptions, skip_table_builder_flush),
           OptionType::kBoolean, OptionVerificationType::kNormal}},
@@ -552,7 +589,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
           OptionType::kUInt32T, OptionVerificationType::kNormal}},
         {"verify_compression",
          {offsetof(struct BlockBasedTableOptions, verify_compression),
-          OptionType::kBoolean, OptionVerificationType::kNormal}}};
+          OptionType::kBoolean, OptionVerificationType::kNormal}},
+        {"max_auto_readahead_size",
+         {offsetof(struct BlockBasedTableOptions, max_auto_readahead_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal}}};
 
 static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
     {"user_key_len",
@@ -595,7 +635,17 @@ static std::unordered_map<std::string, CompressionType>
 static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
     block_base_table_index_type_string_map = {
         {"kBinarySearch", BlockBasedTableOptions::IndexType::kBinarySearch},
-        {"kHashSearch", BlockBasedTableOptions::IndexType::kHashSearch}};
+        {"kHashSearch", BlockBasedTableOptions::IndexType::kHashSearch},
+        {"kTwoLevelIndexSearch",
+         BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch}};
+
+static std::unordered_map<std::string,
+                          BlockBasedTableOptions::DataBlockIndexType>
+    block_base_table_data_block_index_type_string_map = {
+        {"kDataBlockBinarySearch",
+         BlockBasedTableOptions::DataBlockIndexType::kDataBlockBinarySearch},
+        {"kDataBlockBinaryAndHash",
+         BlockBasedTableOptions::DataBlockIndexType::kDataBlockBinaryAndHash}};
 
 static std::unordered_map<std::string, EncodingType> encoding_type_string_map =
     {{"kPlain", kPlain}, {"kPrefix", kPrefix}};
@@ -58,7 +58,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
        "kXpressCompression:"
        "kZSTDNotFinalCompression"},
       {"bottommost_compression", "kLZ4Compression"},
-      {"compression_opts", "4:5:6:7"},
+      {"compression_opts", "4:5:6:7:8:9:true"},
       {"num_levels", "8"},
       {"level0_file_num_compaction_trigger", "8"},
       {"level0_slowdown_writes_trigger", "9"},
@@ -75,17 +75,19 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"soft_rate_limit", "1.1"},
       {"hard_rate_limit", "2.1"},
       {"hard_pending_compaction_bytes_limit", "211"},
+      {"adaptive_write_pacing", "true"},
       {"arena_block_size", "22"},
       {"disable_auto_compactions", "true"},
       {"compaction_style", "kCompactionStyleLevel"},
       {"verify_checksums_in_compaction", "false"},
-      {"compaction_options_fifo", "23"},
+      {"compaction_options_fifo", "23:3600:true"},
       {"max_sequential_skip_in_iterations", "24"},
       {"inplace_update_support", "true"},
       {"report_bg_io_stats", "true"},
       {"compaction_measure_io_stats", "false"},
       {"inplace_update_num_locks", "25"},
       {"memtable_prefix_bloom_size_ratio", "0.26"},
+      {"memtable_whole_key_filtering", "true"},
       {"memtable_huge_page_size", "28"},
       {"bloom_locality", "29"},
       {"max_successive_merges", "30"},
@@ -155,6 +157,9 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.compression_opts.level, 5);
   ASSERT_EQ(new_cf_opt.compression_opts.strategy, 6);
   ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 7);
+  ASSERT_EQ(new_cf_opt.compression_opts.parallel_threads, 8);
+  ASSERT_EQ(new_cf_opt.compression_opts.zstd_max_train_bytes, 9);
+  ASSERT_TRUE(new_cf_opt.compression_opts.use_dict_for_flush);
   ASSERT_EQ(new_cf_opt.bottommost_compression, kLZ4Compression);
   ASSERT_EQ(new_cf_opt.num_levels, 8);
   ASSERT_EQ(new_cf_opt.level0_file_num_compaction_trigger, 8);
@@ -174,17 +179,21 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.max_grandparent_overlap_factor, 21);
   ASSERT_EQ(new_cf_opt.soft_rate_limit, 1.1);
   ASSERT_EQ(new_cf_opt.hard_pending_compaction_bytes_limit, 211);
+  ASSERT_EQ(new_cf_opt.adaptive_write_pacing, true);
   ASSERT_EQ(new_cf_opt.arena_block_size, 22U);
   ASSERT_EQ(new_cf_opt.disable_auto_compactions, true);
   ASSERT_EQ(new_cf_opt.compaction_style, kCompactionStyleLevel);
   ASSERT_EQ(new_cf_opt.verify_checksums_in_compaction, false);
   ASSERT_EQ(new_cf_opt.compaction_options_fifo.max_table_files_size,
             static_cast<uint64_t>(23));
+  ASSERT_EQ(new_cf_opt.compaction_options_fifo.ttl, 3600U);
+  ASSERT_EQ(new_cf_opt.compaction_options_fifo.allow_compaction, true);
   ASSERT_EQ(new_cf_opt.max_sequential_skip_in_iterations,
             static_cast<uint64_t>(24));
   ASSERT_EQ(new_cf_opt.inplace_update_support, true);
   ASSERT_EQ(new_cf_opt.inplace_update_num_locks, 25U);
   ASSERT_EQ(new_cf_opt.memtable_prefix_bloom_size_ratio, 0.26);
+  ASSERT_EQ(new_cf_opt.memtable_whole_key_filtering, true);
   ASSERT_EQ(new_cf_opt.memtable_huge_page_size, 28U);
   ASSERT_EQ(new_cf_opt.bloom_locality, 29U);
   ASSERT_EQ(new_cf_opt.max_successive_merges, 30U);
@@ -276,6 +285,25 @@ TEST_F(OptionsTest, GetColumnFamilyOptionsFromStringTest) {
             &new_cf_opt));
   ASSERT_EQ(new_cf_opt.write_buffer_size, 11U);
   ASSERT_EQ(new_cf_opt.max_write_buffer_number, 12);
+  // Every field of compression_opts is parsed on its own
+  ASSERT_OK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7", &new_cf_opt));
+  ASSERT_EQ(6, new_cf_opt.compression_opts.strategy);
+  ASSERT_EQ(7U, new_cf_opt.compression_opts.max_dict_bytes);
+  ASSERT_EQ(1U, new_cf_opt.compression_opts.parallel_threads);
+  ASSERT_OK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7:8", &new_cf_opt));
+  ASSERT_EQ(7U, new_cf_opt.compression_opts.max_dict_bytes);
+  ASSERT_EQ(8U, new_cf_opt.compression_opts.parallel_threads);
+  ASSERT_EQ(0U, new_cf_opt.compression_opts.zstd_max_train_bytes);
+  ASSERT_NOK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5", &new_cf_opt));
+  ASSERT_NOK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:", &new_cf_opt));
+  ASSERT_NOK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6::8", &new_cf_opt));
+  ASSERT_NOK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7:8:9:true:10", &new_cf_opt));
   // Wrong name "max_write_buffer_number_"
   ASSERT_NOK(GetColumnFamilyOptionsFromString(base_cf_opt,
              "write_buffer_size=13;max_write_buffer_number_=14;",
@@ -551,13 +579,15 @@ TEST_F(OptionsTest, GetOptionsFromStringTest) {
       "write_buffer_size=10;max_write_buffer_number=16;"
       "block_based_table_factory={block_cache=1M;block_size=4;};"
       "compression_opts=4:5:6;create_if_missing=true;max_open_files=1;"
-      "rate_limiter_bytes_per_sec=1024",
+      "rate_limiter_bytes_per_sec=1024;compaction_options_fifo=45",
       &new_options));
 
   ASSERT_EQ(new_options.compression_opts.window_bits, 4);
   ASSERT_EQ(new_options.compression_opts.level, 5);
   ASSERT_EQ(new_options.compression_opts.strategy, 6);
   ASSERT_EQ(new_options.compression_opts.max_dict_bytes, 0);
+  ASSERT_EQ(new_options.compaction_options_fifo.max_table_files_size, 45U);
+  ASSERT_EQ(new_options.compaction_options_fifo.ttl, 0U);
   ASSERT_EQ(new_options.bottommost_compression, kDisableCompressionOption);
   ASSERT_EQ(new_options.write_buffer_size, 10U);
   ASSERT_EQ(new_options.max_write_buffer_number, 16);
@@ -58,6 +58,9 @@ void PerfContext::Reset() {
   bloom_memtable_miss_count = 0;
   bloom_sst_hit_count = 0;
   bloom_sst_miss_count = 0;
+  block_prefetch_bytes = 0;
+  block_prefetch_hit_count = 0;
+  block_prefetch_wasted_bytes = 0;
 #endif
 }
 
@@ -109,6 +112,9 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(bloom_memtable_miss_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_hit_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_miss_count);
+  PERF_CONTEXT_OUTPUT(block_prefetch_bytes);
+  PERF_CONTEXT_OUTPUT(block_prefetch_hit_count);
+  PERF_CONTEXT_OUTPUT(block_prefetch_wasted_bytes);
   return ss.str();
 #endif
 }
@@ -14,6 +14,12 @@
 
 namespace rocksdb {
 
+namespace {
+// The auto-tuned range is [max / kAllowedRangeFactor, max] unless given
+const int64_t kAllowedRangeFactor = 20;
+// Number of refill periods between two tunings
+const int64_t kRefillsPerTune = 100;
+}  // namespace
 
 // Pending request
 struct GenericRateLimiter::Req {
@@ -27,11 +33,14 @@ struct GenericRateLimiter::Req {
 
 GenericRateLimiter::GenericRateLimiter(int64_t rate_bytes_per_sec,
                                        int64_t refill_period_us,
-                                       int32_t fairness)
+                                       int32_t fairness, bool auto_tuned,
+                                       int64_t min_rate_bytes_per_sec,
+                                       Env* env)
     : refill_period_us_(refill_period_us),
+      rate_bytes_per_sec_(rate_bytes_per_sec),
       refill_bytes_per_period_(
           CalculateRefillBytesPerPeriod(rate_bytes_per_sec)),
-      env_(Env::Default()),
+      env_(env),
       stop_(false),
       exit_cv_(&request_mutex_),
       requests_to_wait_(0),
@@ -39,11 +48,25 @@ GenericRateLimiter::GenericRateLimiter(int64_t rate_bytes_per_sec,
       next_refill_us_(env_->NowMicros()),
       fairness_(fairness > 100 ? 100 : fairness),
       rnd_((uint32_t)time(nullptr)),
-      leader_(nullptr) {
+      leader_(nullptr),
+      auto_tuned_(auto_tuned),
+      min_bytes_per_sec_(min_rate_bytes_per_sec > 0
+                             ? min_rate_bytes_per_sec
+                             : rate_bytes_per_sec / kAllowedRangeFactor),
+      max_bytes_per_sec_(rate_bytes_per_sec),
+      tuned_time_(static_cast<int64_t>(env_->NowMicros())),
+      num_drains_(0),
+      compaction_pressure_(false) {
   total_requests_[0] = 0;
   total_requests_[1] = 0;
   total_bytes_through_[0] = 0;
   total_bytes_through_[1] = 0;
+  if (auto_tuned_) {
+    min_bytes_per_sec_ = std::max<int64_t>(
+        1, std::min(min_bytes_per_sec_, max_bytes_per_sec_));
+    SetBytesPerSecondInternal(min_bytes_per_sec_ +
+                            (max_bytes_per_sec_ - min_bytes_per_sec_) / 2);
+  }
 }
 
 GenericRateLimiter::~GenericRateLimiter() {
@@ -63,21 +86,44 @@ GenericRateLimiter::~GenericRateLimiter() {
 }
 
 // This API allows user to dynamically change rate limiter's bytes per second.
+// When auto-tuned, it changes the upper end of the range instead. Only then
+// does it need request_mutex_, which protects the range.
 void GenericRateLimiter::SetBytesPerSecond(int64_t bytes_per_second) {
   assert(bytes_per_second > 0);
+  if (auto_tuned_) {
+    MutexLock g(&request_mutex_);
+    max_bytes_per_sec_ = bytes_per_second;
+    min_bytes_per_sec_ = std::min(min_bytes_per_sec_, max_bytes_per_sec_);
+    SetBytesPerSecondInternal(std::max(
+        min_bytes_per_sec_,
+        std::min(max_bytes_per_sec_, rate_bytes_per_sec_.load())));
+  } else {
+    SetBytesPerSecondInternal(bytes_per_second);
+  }
+}
+
+void GenericRateLimiter::SetBytesPerSecondInternal(int64_t bytes_per_second) {
+  rate_bytes_per_sec_.store(bytes_per_second, std::memory_order_relaxed);
   refill_bytes_per_period_.store(
       CalculateRefillBytesPerPeriod(bytes_per_second),
       std::memory_order_relaxed);
 }
 
 void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri) {
-  assert(bytes <= refill_bytes_per_period_.load(std::memory_order_relaxed));
+  // The auto-tuned rate may have gone down since the caller checked
+  assert(auto_tuned_ ||
+         bytes <= refill_bytes_per_period_.load(std::memory_order_relaxed));
   TEST_SYNC_POINT("GenericRateLimiter::Request");
   MutexLock g(&request_mutex_);
   if (stop_) {
     return;
   }
 
+  if (auto_tuned_ && static_cast<int64_t>(env_->NowMicros()) >=
+                         tuned_time_ + kRefillsPerTune * refill_period_us_) {
+    Tune();
+  }
+
   ++total_requests_[pri];
 
   if (available_bytes_ >= bytes) {
@@ -179,6 +225,8 @@ void GenericRateLimiter::Request(int64_t bytes, const Env::IOPriority pri) {
 void GenericRateLimiter::Refill() {
   TEST_SYNC_POINT("GenericRateLimiter::Refill");
   next_refill_us_ = env_->NowMicros() + refill_period_us_;
+  // Refills only happen when requests wait for them
+  ++num_drains_;
   // Carry over the left over quota from the last period
   auto refill_bytes_per_period =
       refill_bytes_per_period_.load(std::memory_order_relaxed);
@@ -212,6 +260,42 @@ void GenericRateLimiter::Refill() {
   }
 }
 
+void GenericRateLimiter::Tune() {
+  const int64_t kLowWatermarkPct = 50;
+  const int64_t kHighWatermarkPct = 90;
+  const int64_t kAdjustFactorPct = 5;
+
+  int64_t now = static_cast<int64_t>(env_->NowMicros());
+  int64_t elapsed_intervals =
+      (now - tuned_time_ + refill_period_us_ - 1) / refill_period_us_;
+  int64_t drained_pct = num_drains_ * 100 / elapsed_intervals;
+  bool compaction_pressure =
+      compaction_pressure_.exchange(false, std::memory_order_relaxed);
+  // Keep the scaling below from overflowing
+  int64_t prev_bytes_per_sec =
+      std::min(rate_bytes_per_sec_.load(), port::kMaxInt64 / 200);
+
+  int64_t new_bytes_per_sec = prev_bytes_per_sec;
+  if (drained_pct > kHighWatermarkPct ||
+      (compaction_pressure && drained_pct >= kLowWatermarkPct)) {
+    new_bytes_per_sec = prev_bytes_per_sec * (100 + kAdjustFactorPct) / 100;
+  } else if (compaction_pressure) {
+    // Compaction is behind, so this is no time to slow it down.
+  } else if (drained_pct == 0) {
+    new_bytes_per_sec = min_bytes_per_sec_;
+  } else if (drained_pct < kLowWatermarkPct) {
+    new_bytes_per_sec = prev_bytes_per_sec * 100 / (100 + kAdjustFactorPct);
+  }
+  new_bytes_per_sec = std::max(min_bytes_per_sec_,
+                               std::min(max_bytes_per_sec_, new_bytes_per_sec));
+  if (new_bytes_per_sec != rate_bytes_per_sec_.load()) {
+    SetBytesPerSecondInternal(new_bytes_per_sec);
+  }
+
+  tuned_time_ = now;
+  num_drains_ = 0;
+}
+
 int64_t GenericRateLimiter::CalculateRefillBytesPerPeriod(
     int64_t rate_bytes_per_sec) {
   if (port::kMaxInt64 / rate_bytes_per_sec < refill_period_us_) {
@@ -224,13 +308,16 @@ int64_t GenericRateLimiter::CalculateRefillBytesPerPeriod(
   }
 }
 
-RateLimiter* NewGenericRateLimiter(
-    int64_t rate_bytes_per_sec, int64_t refill_period_us, int32_t fairness) {
+RateLimiter* NewGenericRateLimiter(int64_t rate_bytes_per_sec,
+                                  int64_t refill_period_us, int32_t fairness,
+                                  bool auto_tuned,
+                                  int64_t min_rate_bytes_per_sec) {
   assert(rate_bytes_per_sec > 0);
   assert(refill_period_us > 0);
   assert(fairness > 0);
-  return new GenericRateLimiter(
-      rate_bytes_per_sec, refill_period_us, fairness);
+  assert(min_rate_bytes_per_sec >= 0);
+  return new GenericRateLimiter(rate_bytes_per_sec, refill_period_us, fairness,
+                                auto_tuned, min_rate_bytes_per_sec);
 }
 
 }  // namespace rocksdb
@@ -22,8 +22,10 @@ namespace rocksdb {
 
 class GenericRateLimiter : public RateLimiter {
  public:
-  GenericRateLimiter(int64_t refill_bytes,
-      int64_t refill_period_us, int32_t fairness);
+  GenericRateLimiter(int64_t refill_bytes, int64_t refill_period_us,
+                     int32_t fairness, bool auto_tuned = false,
+                     int64_t min_rate_bytes_per_sec = 0,
+                     Env* env = Env::Default());
 
   virtual ~GenericRateLimiter();
 
@@ -58,9 +60,20 @@ class GenericRateLimiter : public RateLimiter {
     return total_requests_[pri];
   }
 
+  virtual int64_t GetBytesPerSecond() const override {
+    return rate_bytes_per_sec_.load(std::memory_order_relaxed);
+  }
+
+  virtual void ReportCompactionPressure() override {
+    compaction_pressure_.store(true, std::memory_order_relaxed);
+  }
+
  private:
   void Refill();
   int64_t CalculateRefillBytesPerPeriod(int64_t rate_bytes_per_sec);
+  void SetBytesPerSecondInternal(int64_t bytes_per_second);
+  // REQUIRES: request_mutex_ is held
+  void Tune();
 
   // This mutex guard all internal states
   mutable port::Mutex request_mutex_;
@@ -68,7 +81,8 @@ class GenericRateLimiter : public RateLimiter {
   const int64_t kMinRefillBytesPerPeriod = 100;
 
   const int64_t refill_period_us_;
-  // This variable can be changed dynamically.
+  // These variables can be changed dynamically.
+  std::atomic<int64_t> rate_bytes_per_sec_;
   std::atomic<int64_t> refill_bytes_per_period_;
   Env* const env_;
 
@@ -87,6 +101,16 @@ class GenericRateLimiter : public RateLimiter {
   struct Req;
   Req* leader_;
   std::deque<Req*> queue_[Env::IO_TOTAL];
+
+  // Auto-tuning state: the range of the rate, the time of the last tuning,
+  // and the number of refills, i.e. of periods in which requests had to
+  // wait, since then.
+  const bool auto_tuned_;
+  int64_t min_bytes_per_sec_;
+  int64_t max_bytes_per_sec_;
+  int64_t tuned_time_;
+  int64_t num_drains_;
+  std::atomic<bool> compaction_pressure_;
 };
 
 }  // namespace rocksdb
@@ -142,6 +142,74 @@ TEST_F(RateLimiterTest, LimitChangeTest) {
   }
 }
 
+TEST_F(RateLimiterTest, AutoTune) {
+  // Time only moves when the test says so. Since it stays far behind the
+  // real clock, a request that has to wait for a refill gets it at once.
+  class TimeSetEnv : public EnvWrapper {
+   public:
+    TimeSetEnv() : EnvWrapper(Env::Default()) {}
+    uint64_t now_micros_ = 0;
+    virtual uint64_t NowMicros() override { return now_micros_; }
+  };
+
+  const int64_t kRefillPeriod = 1000;
+  const int64_t kMaxRate = 1000000;
+  TimeSetEnv env;
+  GenericRateLimiter limiter(kMaxRate, kRefillPeriod, 10, true /* auto_tuned */,
+                             0 /* min_rate_bytes_per_sec */, &env);
+
+  // Runs the 100 refill periods between two tunings, draining the limiter in
+  // the first num_drained of them, then lets the next request tune the rate.
+  auto run_periods = [&](int num_drained) {
+    for (int i = 0; i < 100; ++i) {
+      if (i < num_drained) {
+        limiter.Request(limiter.GetSingleBurstBytes(), Env::IO_LOW);
+      }
+      env.now_micros_ += kRefillPeriod;
+    }
+    limiter.Request(0, Env::IO_LOW);
+  };
+
+  // The range is [kMaxRate / 20, kMaxRate] and starts in its middle
+  const int64_t kStartRate = 525000;
+  ASSERT_EQ(kStartRate, limiter.GetBytesPerSecond());
+  ASSERT_EQ(kStartRate * kRefillPeriod / 1000000,
+            limiter.GetSingleBurstBytes());
+
+  run_periods(100);
+  ASSERT_EQ(kStartRate * 105 / 100, limiter.GetBytesPerSecond());
+  run_periods(60);
+  ASSERT_EQ(kStartRate * 105 / 100, limiter.GetBytesPerSecond());
+  run_periods(10);
+  ASSERT_EQ(kStartRate, limiter.GetBytesPerSecond());
+
+  // Compaction pressure keeps the rate from going down, and raises it sooner
+  limiter.ReportCompactionPressure();
+  run_periods(10);
+  ASSERT_EQ(kStartRate, limiter.GetBytesPerSecond());
+  limiter.ReportCompactionPressure();
+  run_periods(60);
+  ASSERT_EQ(kStartRate * 105 / 100, limiter.GetBytesPerSecond());
+
+  // An idle limiter drops to the minimum
+  run_periods(0);
+  ASSERT_EQ(kMaxRate / 20, limiter.GetBytesPerSecond());
+
+  // It never goes beyond the maximum
+  for (int i = 0; i < 100; ++i) {
+    run_periods(100);
+  }
+  ASSERT_EQ(kMaxRate, limiter.GetBytesPerSecond());
+
+  // SetBytesPerSecond() moves the maximum
+  limiter.SetBytesPerSecond(kMaxRate / 2);
+  ASSERT_EQ(kMaxRate / 2, limiter.GetBytesPerSecond());
+  limiter.SetBytesPerSecond(kMaxRate / 100);
+  ASSERT_EQ(kMaxRate / 100, limiter.GetBytesPerSecond());
+  run_periods(0);
+  ASSERT_EQ(kMaxRate / 100, limiter.GetBytesPerSecond());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -40,10 +40,10 @@ void ShardedCache::SetStrictCapacityLimit(bool strict_capacity_limit) {
 
 Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
                             void (*deleter)(const Slice& key, void* value),
-                            Handle** handle) {
+                            Handle** handle, Priority priority) {
   uint32_t hash = HashSlice(key);
   return GetShard(Shard(hash))
-      ->Insert(key, hash, value, charge, deleter, handle);
+      ->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
 Cache::Handle* ShardedCache::Lookup(const Slice& key) {
@@ -6,13 +6,16 @@
 #pragma once
 #include "rocksdb/statistics.h"
 
-#include <vector>
 #include <atomic>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "port/likely.h"
+#include "port/port.h"
+#include "util/core_local.h"
 #include "util/histogram.h"
 #include "util/mutexlock.h"
-#include "port/likely.h"
 
 
 namespace rocksdb {
@@ -50,26 +53,42 @@ class StatisticsImpl : public Statistics {
   std::shared_ptr<Statistics> stats_shared_;
   Statistics* stats_;
   bool enable_internal_stats_;
-
-  struct Ticker {
-    Ticker() : value(uint_fast64_t()) {}
-
-    std::atomic_uint_fast64_t value;
-    // Pad the structure to make it size of 64 bytes. A plain array of
-    // std::atomic_uint_fast64_t results in huge performance degradataion
-    // due to false sharing.
-    char padding[64 - sizeof(std::atomic_uint_fast64_t)];
+  // Synchronizes setTickerCount() with the aggregation of the tickers, so
+  // that a reader doesn't see a ticker half reset. recordTick() and
+  // measureTime() don't take it.
+  mutable port::Mutex aggregate_lock_;
+
+  // The tickers and histograms of one core. Updates go to the data of the
+  // core the thread runs on, so threads on different cores don't share
+  // cache lines; reads sum over all the cores. Before C++17, new[] ignores
+  // the alignment of the struct, so it allocates the aligned memory itself.
+  struct ALIGN_AS(CACHE_LINE_SIZE) StatisticsData {
+    std::atomic_uint_fast64_t tickers_[INTERNAL_TICKER_ENUM_MAX] = {{0}};
+    HistogramImpl histograms_[INTERNAL_HISTOGRAM_ENUM_MAX];
+    char padding[CACHE_LINE_SIZE -
+                 (INTERNAL_TICKER_ENUM_MAX * sizeof(std::atomic_uint_fast64_t) +
+                  INTERNAL_HISTOGRAM_ENUM_MAX * sizeof(HistogramImpl)) %
+                     CACHE_LINE_SIZE];
+
+    void* operator new(size_t size) {
+      return port::cacheline_aligned_alloc(size);
+    }
+    void* operator new[](size_t size) {
+      return port::cacheline_aligned_alloc(size);
+    }
+    void operator delete(void* p) { port::cacheline_aligned_free(p); }
+    void operator delete[](void* p) { port::cacheline_aligned_free(p); }
   };
 
-  static_assert(sizeof(Ticker) == 64, "Expecting to fit into 64 bytes");
+  static_assert(sizeof(StatisticsData) % CACHE_LINE_SIZE == 0,
+                "Expecting to fill whole cache lines");
+
+  CoreLocalArray<StatisticsData> per_core_stats_;
 
-  // Attributes expand to nothing depending on the platform
-  __declspec(align(64))
-  Ticker tickers_[INTERNAL_TICKER_ENUM_MAX]
-     __attribute__((aligned(64)));
-  __declspec(align(64))
-  HistogramImpl histograms_[INTERNAL_HISTOGRAM_ENUM_MAX]
-      __attribute__((aligned(64)));
+  uint64_t getTickerCountLocked(uint32_t ticker_type) const;
+  std::unique_ptr<HistogramImpl> getHistogramImplLocked(
+      uint32_t histogram_type) const;
+  void setTickerCountLocked(uint32_t ticker_type, uint64_t count);
 };
 
 // Utility functions
@@ -4,6 +4,9 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 //
 
+#include <thread>
+#include <vector>
+
 #include "port/stack_trace.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
@@ -26,6 +29,37 @@ TEST_F(StatisticsTest, Sanity) {
   }
 }
 
+TEST_F(StatisticsTest, ConcurrentUpdates) {
+  // Updates from many threads land on per-core data and must all be counted
+  // once the data is aggregated
+  std::shared_ptr<Statistics> stats = CreateDBStatistics();
+  const int kNumThreads = 16;
+  const int kNumUpdates = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&]() {
+      for (int j = 0; j < kNumUpdates; j++) {
+        stats->recordTick(NUMBER_KEYS_WRITTEN, 2);
+        stats->measureTime(DB_GET, 10);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(2U * kNumThreads * kNumUpdates,
+            stats->getTickerCount(NUMBER_KEYS_WRITTEN));
+  HistogramData data;
+  stats->histogramData(DB_GET, &data);
+  ASSERT_DOUBLE_EQ(10.0, data.average);
+
+  // Setting a ticker replaces the counts of all the cores
+  stats->setTickerCount(NUMBER_KEYS_WRITTEN, 5);
+  ASSERT_EQ(5U, stats->getTickerCount(NUMBER_KEYS_WRITTEN));
+  stats->recordTick(NUMBER_KEYS_WRITTEN, 1);
+  ASSERT_EQ(6U, stats->getTickerCount(NUMBER_KEYS_WRITTEN));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {